@@ -48,7 +48,7 @@ bool Application::OnInit()
 
     SetAppName(L"RealTimeSync");
 
-    initResourceImages(fff::getResourceDirPf() + Zstr("Resources.zip"));
+    initResourceImages(fff::getResourceDirPf() + Zstr("Resources.zip"), fff::getConfigDirPathPf() + Zstr("Resources.cache"));
 
     try
     {
@@ -12,6 +12,7 @@
 #include <zen/guid.h>
 #include <zen/file_access.h> //needed for TempFileBuffer only
 #include <zen/serialize.h>
+#include <zen/thread.h>
 #include "norm_filter.h"
 #include "db_file.h"
 #include "cmp_filetime.h"
@@ -294,6 +295,57 @@ bool stillInSync(const InSyncFolder& dbFolder)
 
 //----------------------------------------------------------------------------------------------
 
+//comparison subtree + associated database folders: subtrees can be processed independently
+struct SubTreeTask
+{
+    ContainerObject* hierObj;
+    const InSyncFolder* dbFolderL;
+    const InSyncFolder* dbFolderR;
+};
+
+
+//process the top levels on the calling thread until there are enough subtrees to keep all threads busy
+template <class ProcessLevel> //void(const SubTreeTask& task, std::vector<SubTreeTask>& subTasks): process direct children only, return sub folders in "subTasks"
+std::vector<SubTreeTask> splitIntoSubTrees(const SubTreeTask& rootTask, size_t threadCount, ProcessLevel processLevel)
+{
+    std::vector<SubTreeTask> tasks{ rootTask };
+
+    while (!tasks.empty() && tasks.size() < 4 * threadCount) //a few tasks per thread: subtree sizes vary greatly
+    {
+        std::vector<SubTreeTask> subTasks;
+        for (const SubTreeTask& task : tasks)
+            processLevel(task, subTasks);
+        tasks.swap(subTasks);
+    }
+    return tasks;
+}
+
+
+template <class Function> //void(size_t taskIdx)
+void runSubTreeTasks(size_t taskCount, size_t threadCount, Function processTask, const std::string& groupName)
+{
+    if (taskCount == 0)
+        return;
+
+    if (threadCount <= 1 || taskCount == 1)
+    {
+        for (size_t i = 0; i < taskCount; ++i)
+            processTask(i);
+        return;
+    }
+
+    ThreadGroup<std::function<void()>> tg(threadCount, groupName);
+    for (size_t i = 0; i < taskCount; ++i)
+        tg.run([i, &processTask] { processTask(i); });
+    tg.wait();
+}
+
+
+inline
+size_t getSubTreeThreadCount() { return std::max<size_t>(std::thread::hardware_concurrency(), 1); } //hardware_concurrency() returns 0 if not computable
+
+//----------------------------------------------------------------------------------------------
+
 class DetectMovedFiles
 {
 public:
@@ -305,22 +357,77 @@ private:
         fileTimeTolerance_(baseFolder.getFileTimeTolerance()),
         ignoreTimeShiftMinutes_(baseFolder.getIgnoredTimeShift())
     {
-        recurse(baseFolder, &dbFolder, &dbFolder);
+        const size_t threadCount = getSubTreeThreadCount();
+
+        //subtrees are independent except for the one-side-only maps => fill one shard per subtree, then merge
+        const std::vector<SubTreeTask> tasks = splitIntoSubTrees({ &baseFolder, &dbFolder, &dbFolder }, threadCount, [&](const SubTreeTask& task, std::vector<SubTreeTask>& subTasks)
+        {
+            processLevel(*task.hierObj, task.dbFolderL, task.dbFolderR, exOneSideOnly_, subTasks);
+        });
+
+        std::vector<OneSideOnlyFiles> shards(tasks.size());
 
-        if ((!exLeftOnlyById_ .empty() || !exLeftOnlyByPath_ .empty()) &&
-            (!exRightOnlyById_.empty() || !exRightOnlyByPath_.empty()))
+        runSubTreeTasks(tasks.size(), threadCount, [&](size_t taskIdx)
+        {
+            const SubTreeTask& task = tasks[taskIdx];
+            recurse(*task.hierObj, task.dbFolderL, task.dbFolderR, shards[taskIdx]);
+        }, "Detect Moved Files");
+
+        for (const OneSideOnlyFiles& shard : shards)
+            mergeShard(exOneSideOnly_, shard);
+
+        if ((!exOneSideOnly_.leftById .empty() || !exOneSideOnly_.leftByPath .empty()) &&
+            (!exOneSideOnly_.rightById.empty() || !exOneSideOnly_.rightByPath.empty()))
             detectMovePairs(dbFolder);
     }
 
-    void recurse(ContainerObject& hierObj, const InSyncFolder* dbFolderL, const InSyncFolder* dbFolderR)
+    struct OneSideOnlyFiles
+    {
+        std::unordered_map<AFS::FileId, FilePair*, StringHash> leftById;  //FilePair* == nullptr for duplicate ids! => consider aliasing through symlinks!
+        std::unordered_map<AFS::FileId, FilePair*, StringHash> rightById; //=> avoid ambiguity for mixtures of files/symlinks on one side and allow 1-1 mapping only!
+        //MSVC: std::unordered_map: about twice as fast as std::map for 1 million items!
+
+        std::unordered_map<const InSyncFile*, FilePair*> leftByPath; //MSVC: only 4% faster than std::map for 1 million items!
+        std::unordered_map<const InSyncFile*, FilePair*> rightByPath;
+    };
+
+    static void mergeShard(OneSideOnlyFiles& trg, const OneSideOnlyFiles& shard)
+    {
+        auto mergeById = [](std::unordered_map<AFS::FileId, FilePair*, StringHash>& byIdTrg, const std::unordered_map<AFS::FileId, FilePair*, StringHash>& byIdShard)
+        {
+            for (const auto& [fileId, file] : byIdShard)
+            {
+                auto rv = byIdTrg.emplace(fileId, file);
+                if (!rv.second) //duplicate file ID across subtrees
+                    rv.first->second = nullptr;
+            }
+        };
+        mergeById(trg.leftById,  shard.leftById);
+        mergeById(trg.rightById, shard.rightById);
+
+        //database entries are unique per subtree
+        trg.leftByPath .insert(shard.leftByPath .begin(), shard.leftByPath .end());
+        trg.rightByPath.insert(shard.rightByPath.begin(), shard.rightByPath.end());
+    }
+
+    void recurse(ContainerObject& hierObj, const InSyncFolder* dbFolderL, const InSyncFolder* dbFolderR, OneSideOnlyFiles& exOneSideOnly) const
+    {
+        std::vector<SubTreeTask> subTasks;
+        processLevel(hierObj, dbFolderL, dbFolderR, exOneSideOnly, subTasks);
+
+        for (const SubTreeTask& task : subTasks)
+            recurse(*task.hierObj, task.dbFolderL, task.dbFolderR, exOneSideOnly);
+    }
+
+    void processLevel(ContainerObject& hierObj, const InSyncFolder* dbFolderL, const InSyncFolder* dbFolderR, OneSideOnlyFiles& exOneSideOnly, std::vector<SubTreeTask>& subTasks) const
     {
         for (FilePair& file : hierObj.refSubFiles())
         {
-            auto getDbEntry = [](const InSyncFolder* dbFolder, const Zstring& fileName) -> const InSyncFile*
+            auto getDbEntry = [](const InSyncFolder* dbFolder, const Zstring& fileNameNorm) -> const InSyncFile*
             {
                 if (dbFolder)
                 {
-                    auto it = dbFolder->files.find(fileName);
+                    auto it = dbFolder->files.find(fileNameNorm);
                     if (it != dbFolder->files.end())
                         return &it->second;
                 }
@@ -331,22 +438,22 @@ private:
 
             if (cat == FILE_LEFT_SIDE_ONLY)
             {
-                if (const InSyncFile* dbEntry = getDbEntry(dbFolderL, file.getItemName<LEFT_SIDE>()))
-                    exLeftOnlyByPath_.emplace(dbEntry, &file);
+                if (const InSyncFile* dbEntry = getDbEntry(dbFolderL, getUnicodeNormalForm(file.getItemName<LEFT_SIDE>())))
+                    exOneSideOnly.leftByPath.emplace(dbEntry, &file);
                 else if (!file.getFileId<LEFT_SIDE>().empty())
                 {
-                    auto rv = exLeftOnlyById_.emplace(file.getFileId<LEFT_SIDE>(), &file);
+                    auto rv = exOneSideOnly.leftById.emplace(file.getFileId<LEFT_SIDE>(), &file);
                     if (!rv.second) //duplicate file ID! NTFS hard link/symlink?
                         rv.first->second = nullptr;
                 }
             }
             else if (cat == FILE_RIGHT_SIDE_ONLY)
             {
-                if (const InSyncFile* dbEntry = getDbEntry(dbFolderR, file.getItemName<RIGHT_SIDE>()))
-                    exRightOnlyByPath_.emplace(dbEntry, &file);
+                if (const InSyncFile* dbEntry = getDbEntry(dbFolderR, getUnicodeNormalForm(file.getItemName<RIGHT_SIDE>())))
+                    exOneSideOnly.rightByPath.emplace(dbEntry, &file);
                 else if (!file.getFileId<RIGHT_SIDE>().empty())
                 {
-                    auto rv = exRightOnlyById_.emplace(file.getFileId<RIGHT_SIDE>(), &file);
+                    auto rv = exOneSideOnly.rightById.emplace(file.getFileId<RIGHT_SIDE>(), &file);
                     if (!rv.second) //duplicate file ID! NTFS hard link/symlink?
                         rv.first->second = nullptr;
                 }
@@ -355,22 +462,25 @@ private:
 
         for (FolderPair& folder : hierObj.refSubFolders())
         {
-            auto getDbEntry = [](const InSyncFolder* dbFolder, const Zstring& folderName) -> const InSyncFolder*
+            auto getDbEntry = [](const InSyncFolder* dbFolder, const Zstring& folderNameNorm) -> const InSyncFolder*
             {
                 if (dbFolder)
                 {
-                    auto it = dbFolder->folders.find(folderName);
+                    auto it = dbFolder->folders.find(folderNameNorm);
                     if (it != dbFolder->folders.end())
                         return &it->second;
                 }
                 return nullptr;
             };
-            const InSyncFolder* dbEntryL = getDbEntry(dbFolderL, folder.getItemName<LEFT_SIDE>());
+            const Zstring itemNameNormL = getUnicodeNormalForm(folder.getItemName< LEFT_SIDE>()); //database keys are normalized: see InSyncFolder
+            const Zstring itemNameNormR = getUnicodeNormalForm(folder.getItemName<RIGHT_SIDE>()); //
+
+            const InSyncFolder* dbEntryL = getDbEntry(dbFolderL, itemNameNormL);
             const InSyncFolder* dbEntryR = dbEntryL;
-            if (dbFolderL != dbFolderR || getUnicodeNormalForm(folder.getItemName<LEFT_SIDE>()) != getUnicodeNormalForm(folder.getItemName<RIGHT_SIDE>()))
-                dbEntryR = getDbEntry(dbFolderR, folder.getItemName<RIGHT_SIDE>());
+            if (dbFolderL != dbFolderR || itemNameNormL != itemNameNormR)
+                dbEntryR = getDbEntry(dbFolderR, itemNameNormR);
 
-            recurse(folder, dbEntryL, dbEntryR);
+            subTasks.push_back({ &folder, dbEntryL, dbEntryR });
         }
     }
 
@@ -399,15 +509,15 @@ private:
     template <SelectedSide side>
     FilePair* getAssocFilePair(const InSyncFile& dbFile) const
     {
-        const std::unordered_map<AFS::FileId,       FilePair*, StringHash>& exOneSideById   = SelectParam<side>::ref(exLeftOnlyById_,   exRightOnlyById_);
-        const std::unordered_map<const InSyncFile*, FilePair*            >& exOneSideByPath = SelectParam<side>::ref(exLeftOnlyByPath_, exRightOnlyByPath_);
+        const std::unordered_map<AFS::FileId,       FilePair*, StringHash>& exOneSideById   = SelectParam<side>::ref(exOneSideOnly_.leftById,   exOneSideOnly_.rightById);
+        const std::unordered_map<const InSyncFile*, FilePair*            >& exOneSideByPath = SelectParam<side>::ref(exOneSideOnly_.leftByPath, exOneSideOnly_.rightByPath);
         {
             auto it = exOneSideByPath.find(&dbFile);
             if (it != exOneSideByPath.end())
                 return it->second; //if there is an association by path, don't care if there is also an association by id,
             //even if the association by path doesn't match time and size while the association by id does!
             //- there doesn't seem to be (any?) value in allowing this!
-            //- note: exOneSideById isn't filled in this case, see recurse()
+            //- note: exOneSideById isn't filled in this case, see processLevel()
         }
 
         const AFS::FileId fileId = SelectParam<side>::ref(dbFile.left, dbFile.right).fileId;
@@ -439,12 +549,7 @@ private:
     const int fileTimeTolerance_;
     const std::vector<unsigned int> ignoreTimeShiftMinutes_;
 
-    std::unordered_map<AFS::FileId, FilePair*, StringHash> exLeftOnlyById_;  //FilePair* == nullptr for duplicate ids! => consider aliasing through symlinks!
-    std::unordered_map<AFS::FileId, FilePair*, StringHash> exRightOnlyById_; //=> avoid ambiguity for mixtures of files/symlinks on one side and allow 1-1 mapping only!
-    //MSVC: std::unordered_map: about twice as fast as std::map for 1 million items!
-
-    std::unordered_map<const InSyncFile*, FilePair*> exLeftOnlyByPath_; //MSVC: only 4% faster than std::map for 1 million items!
-    std::unordered_map<const InSyncFile*, FilePair*> exRightOnlyByPath_;
+    OneSideOnlyFiles exOneSideOnly_;
     /*
     detect renamed files:
 
@@ -488,20 +593,67 @@ private:
         //-> considering filter not relevant:
         //  if stricter filter than last time: all ok;
         //  if less strict filter (if file ex on both sides -> conflict, fine; if file ex. on one side: copy to other side: fine)
-        recurse(baseFolder, &dbFolder, &dbFolder);
+        const size_t threadCount = getSubTreeThreadCount();
+
+        const std::vector<SubTreeTask> tasks = splitIntoSubTrees({ &baseFolder, &dbFolder, &dbFolder }, threadCount, [&](const SubTreeTask& task, std::vector<SubTreeTask>& subTasks)
+        {
+            std::vector<SyncDirUpdate> updates;
+            processLevel(*task.hierObj, task.dbFolderL, task.dbFolderR, updates, subTasks);
+            applyUpdates(updates);
+        });
+
+        std::vector<std::vector<SyncDirUpdate>> taskUpdates(tasks.size());
+
+        runSubTreeTasks(tasks.size(), threadCount, [&](size_t taskIdx)
+        {
+            const SubTreeTask& task = tasks[taskIdx];
+            recurse(*task.hierObj, task.dbFolderL, task.dbFolderR, taskUpdates[taskIdx]);
+        }, "Two-Way Sync Directions");
+
+        for (const std::vector<SyncDirUpdate>& updates : taskUpdates)
+            applyUpdates(updates);
     }
 
-    void recurse(ContainerObject& hierObj, const InSyncFolder* dbFolderL, const InSyncFolder* dbFolderR) const
+    //setting the sync direction notifies all parent folders, which are shared between subtrees => collect on worker threads, apply on main thread
+    struct SyncDirUpdate
+    {
+        FileSystemObject* fsObj;
+        SyncDirection dir;
+        const std::wstring* conflictMsg = nullptr; //!= nullptr: set conflict instead of direction
+        bool recursive = false;
+    };
+
+    static void applyUpdates(const std::vector<SyncDirUpdate>& updates)
+    {
+        for (const SyncDirUpdate& upd : updates)
+            if (upd.conflictMsg)
+                upd.fsObj->setSyncDirConflict(*upd.conflictMsg);
+            else if (upd.recursive)
+                setSyncDirectionRec(upd.dir, *upd.fsObj);
+            else
+                upd.fsObj->setSyncDir(upd.dir);
+    }
+
+    void recurse(ContainerObject& hierObj, const InSyncFolder* dbFolderL, const InSyncFolder* dbFolderR, std::vector<SyncDirUpdate>& updates) const
+    {
+        std::vector<SubTreeTask> subTasks;
+        processLevel(hierObj, dbFolderL, dbFolderR, updates, subTasks);
+
+        for (const SubTreeTask& task : subTasks)
+            recurse(*task.hierObj, task.dbFolderL, task.dbFolderR, updates);
+    }
+
+    void processLevel(ContainerObject& hierObj, const InSyncFolder* dbFolderL, const InSyncFolder* dbFolderR, std::vector<SyncDirUpdate>& updates, std::vector<SubTreeTask>& subTasks) const
     {
         for (FilePair& file : hierObj.refSubFiles())
-            processFile(file, dbFolderL, dbFolderR);
+            processFile(file, dbFolderL, dbFolderR, updates);
         for (SymlinkPair& link : hierObj.refSubLinks())
-            processSymlink(link, dbFolderL, dbFolderR);
+            processSymlink(link, dbFolderL, dbFolderR, updates);
         for (FolderPair& folder : hierObj.refSubFolders())
-            processDir(folder, dbFolderL, dbFolderR);
+            processDir(folder, dbFolderL, dbFolderR, updates, subTasks);
     }
 
-    void processFile(FilePair& file, const InSyncFolder* dbFolderL, const InSyncFolder* dbFolderR) const
+    void processFile(FilePair& file, const InSyncFolder* dbFolderL, const InSyncFolder* dbFolderR, std::vector<SyncDirUpdate>& updates) const
     {
         const CompareFilesResult cat = file.getCategory();
         if (cat == FILE_EQUAL)
@@ -509,26 +661,29 @@ private:
 
         //##################### schedule old temporary files for deletion ####################
         if (cat == FILE_LEFT_SIDE_ONLY && endsWith(file.getItemName<LEFT_SIDE>(), AFS::TEMP_FILE_ENDING))
-            return file.setSyncDir(SyncDirection::LEFT);
+            return updates.push_back({ &file, SyncDirection::LEFT });
         else if (cat == FILE_RIGHT_SIDE_ONLY && endsWith(file.getItemName<RIGHT_SIDE>(), AFS::TEMP_FILE_ENDING))
-            return file.setSyncDir(SyncDirection::RIGHT);
+            return updates.push_back({ &file, SyncDirection::RIGHT });
         //####################################################################################
 
         //try to find corresponding database entry
-        auto getDbEntry = [](const InSyncFolder* dbFolder, const Zstring& fileName) -> const InSyncFile*
+        auto getDbEntry = [](const InSyncFolder* dbFolder, const Zstring& fileNameNorm) -> const InSyncFile*
         {
             if (dbFolder)
             {
-                auto it = dbFolder->files.find(fileName);
+                auto it = dbFolder->files.find(fileNameNorm);
                 if (it != dbFolder->files.end())
                     return &it->second;
             }
             return nullptr;
         };
-        const InSyncFile* dbEntryL = getDbEntry(dbFolderL, file.getItemName<LEFT_SIDE>());
+        const Zstring itemNameNormL = getUnicodeNormalForm(file.getItemName< LEFT_SIDE>()); //database keys are normalized: see InSyncFolder
+        const Zstring itemNameNormR = getUnicodeNormalForm(file.getItemName<RIGHT_SIDE>()); //
+
+        const InSyncFile* dbEntryL = getDbEntry(dbFolderL, itemNameNormL);
         const InSyncFile* dbEntryR = dbEntryL;
-        if (dbFolderL != dbFolderR || getUnicodeNormalForm(file.getItemName<LEFT_SIDE>()) != getUnicodeNormalForm(file.getItemName<RIGHT_SIDE>()))
-            dbEntryR = getDbEntry(dbFolderR, file.getItemName<RIGHT_SIDE>());
+        if (dbFolderL != dbFolderR || itemNameNormL != itemNameNormR)
+            dbEntryR = getDbEntry(dbFolderR, itemNameNormR);
 
         //evaluation
         const bool changeOnLeft  = !matchesDbEntry< LEFT_SIDE>(file, dbEntryL, ignoreTimeShiftMinutes_);
@@ -539,40 +694,43 @@ private:
             //if database entry not in sync according to current settings! -> set direction based on sync status only!
             if ((dbEntryL && !stillInSync(*dbEntryL, cmpVar_, fileTimeTolerance_, ignoreTimeShiftMinutes_)) ||
                 (dbEntryR && !stillInSync(*dbEntryR, cmpVar_, fileTimeTolerance_, ignoreTimeShiftMinutes_)))
-                file.setSyncDirConflict(txtDbNotInSync_);
+                updates.push_back({ &file, SyncDirection::NONE, &txtDbNotInSync_ });
             else
-                file.setSyncDir(changeOnLeft ? SyncDirection::RIGHT : SyncDirection::LEFT);
+                updates.push_back({ &file, changeOnLeft ? SyncDirection::RIGHT : SyncDirection::LEFT });
         }
         else
         {
             if (changeOnLeft)
-                file.setSyncDirConflict(txtBothSidesChanged_);
+                updates.push_back({ &file, SyncDirection::NONE, &txtBothSidesChanged_ });
             else
-                file.setSyncDirConflict(txtNoSideChanged_);
+                updates.push_back({ &file, SyncDirection::NONE, &txtNoSideChanged_ });
         }
     }
 
-    void processSymlink(SymlinkPair& symlink, const InSyncFolder* dbFolderL, const InSyncFolder* dbFolderR) const
+    void processSymlink(SymlinkPair& symlink, const InSyncFolder* dbFolderL, const InSyncFolder* dbFolderR, std::vector<SyncDirUpdate>& updates) const
     {
         const CompareSymlinkResult cat = symlink.getLinkCategory();
         if (cat == SYMLINK_EQUAL)
             return;
 
         //try to find corresponding database entry
-        auto getDbEntry = [](const InSyncFolder* dbFolder, const Zstring& linkName) -> const InSyncSymlink*
+        auto getDbEntry = [](const InSyncFolder* dbFolder, const Zstring& linkNameNorm) -> const InSyncSymlink*
         {
             if (dbFolder)
             {
-                auto it = dbFolder->symlinks.find(linkName);
+                auto it = dbFolder->symlinks.find(linkNameNorm);
                 if (it != dbFolder->symlinks.end())
                     return &it->second;
             }
             return nullptr;
         };
-        const InSyncSymlink* dbEntryL = getDbEntry(dbFolderL, symlink.getItemName<LEFT_SIDE>());
+        const Zstring itemNameNormL = getUnicodeNormalForm(symlink.getItemName< LEFT_SIDE>()); //database keys are normalized: see InSyncFolder
+        const Zstring itemNameNormR = getUnicodeNormalForm(symlink.getItemName<RIGHT_SIDE>()); //
+
+        const InSyncSymlink* dbEntryL = getDbEntry(dbFolderL, itemNameNormL);
         const InSyncSymlink* dbEntryR = dbEntryL;
-        if (dbFolderL != dbFolderR || getUnicodeNormalForm(symlink.getItemName<LEFT_SIDE>()) != getUnicodeNormalForm(symlink.getItemName<RIGHT_SIDE>()))
-            dbEntryR = getDbEntry(dbFolderR, symlink.getItemName<RIGHT_SIDE>());
+        if (dbFolderL != dbFolderR || itemNameNormL != itemNameNormR)
+            dbEntryR = getDbEntry(dbFolderR, itemNameNormR);
 
         //evaluation
         const bool changeOnLeft  = !matchesDbEntry< LEFT_SIDE>(symlink, dbEntryL, ignoreTimeShiftMinutes_);
@@ -583,45 +741,48 @@ private:
             //if database entry not in sync according to current settings! -> set direction based on sync status only!
             if ((dbEntryL && !stillInSync(*dbEntryL, cmpVar_, fileTimeTolerance_, ignoreTimeShiftMinutes_)) ||
                 (dbEntryR && !stillInSync(*dbEntryR, cmpVar_, fileTimeTolerance_, ignoreTimeShiftMinutes_)))
-                symlink.setSyncDirConflict(txtDbNotInSync_);
+                updates.push_back({ &symlink, SyncDirection::NONE, &txtDbNotInSync_ });
             else
-                symlink.setSyncDir(changeOnLeft ? SyncDirection::RIGHT : SyncDirection::LEFT);
+                updates.push_back({ &symlink, changeOnLeft ? SyncDirection::RIGHT : SyncDirection::LEFT });
         }
         else
         {
             if (changeOnLeft)
-                symlink.setSyncDirConflict(txtBothSidesChanged_);
+                updates.push_back({ &symlink, SyncDirection::NONE, &txtBothSidesChanged_ });
             else
-                symlink.setSyncDirConflict(txtNoSideChanged_);
+                updates.push_back({ &symlink, SyncDirection::NONE, &txtNoSideChanged_ });
         }
     }
 
-    void processDir(FolderPair& folder, const InSyncFolder* dbFolderL, const InSyncFolder* dbFolderR) const
+    void processDir(FolderPair& folder, const InSyncFolder* dbFolderL, const InSyncFolder* dbFolderR, std::vector<SyncDirUpdate>& updates, std::vector<SubTreeTask>& subTasks) const
     {
         const CompareDirResult cat = folder.getDirCategory();
 
         //########### schedule abandoned temporary recycle bin directory for deletion  ##########
         if (cat == DIR_LEFT_SIDE_ONLY && endsWith(folder.getItemName<LEFT_SIDE>(), AFS::TEMP_FILE_ENDING))
-            return setSyncDirectionRec(SyncDirection::LEFT, folder); //
+            return updates.push_back({ &folder, SyncDirection::LEFT, nullptr, true }); //
         else if (cat == DIR_RIGHT_SIDE_ONLY && endsWith(folder.getItemName<RIGHT_SIDE>(), AFS::TEMP_FILE_ENDING))
-            return setSyncDirectionRec(SyncDirection::RIGHT, folder); //don't recurse below!
+            return updates.push_back({ &folder, SyncDirection::RIGHT, nullptr, true }); //don't recurse below!
         //#######################################################################################
 
         //try to find corresponding database entry
-        auto getDbEntry = [](const InSyncFolder* dbFolder, const Zstring& folderName) -> const InSyncFolder*
+        auto getDbEntry = [](const InSyncFolder* dbFolder, const Zstring& folderNameNorm) -> const InSyncFolder*
         {
             if (dbFolder)
             {
-                auto it = dbFolder->folders.find(folderName);
+                auto it = dbFolder->folders.find(folderNameNorm);
                 if (it != dbFolder->folders.end())
                     return &it->second;
             }
             return nullptr;
         };
-        const InSyncFolder* dbEntryL = getDbEntry(dbFolderL, folder.getItemName<LEFT_SIDE>());
+        const Zstring itemNameNormL = getUnicodeNormalForm(folder.getItemName< LEFT_SIDE>()); //database keys are normalized: see InSyncFolder
+        const Zstring itemNameNormR = getUnicodeNormalForm(folder.getItemName<RIGHT_SIDE>()); //
+
+        const InSyncFolder* dbEntryL = getDbEntry(dbFolderL, itemNameNormL);
         const InSyncFolder* dbEntryR = dbEntryL;
-        if (dbFolderL != dbFolderR || getUnicodeNormalForm(folder.getItemName<LEFT_SIDE>()) != getUnicodeNormalForm(folder.getItemName<RIGHT_SIDE>()))
-            dbEntryR = getDbEntry(dbFolderR, folder.getItemName<RIGHT_SIDE>());
+        if (dbFolderL != dbFolderR || itemNameNormL != itemNameNormR)
+            dbEntryR = getDbEntry(dbFolderR, itemNameNormR);
 
         if (cat != DIR_EQUAL)
         {
@@ -634,20 +795,20 @@ private:
                 //if database entry not in sync according to current settings! -> set direction based on sync status only!
                 if ((dbEntryL && !stillInSync(*dbEntryL)) ||
                     (dbEntryR && !stillInSync(*dbEntryR)))
-                    folder.setSyncDirConflict(txtDbNotInSync_);
+                    updates.push_back({ &folder, SyncDirection::NONE, &txtDbNotInSync_ });
                 else
-                    folder.setSyncDir(changeOnLeft ? SyncDirection::RIGHT : SyncDirection::LEFT);
+                    updates.push_back({ &folder, changeOnLeft ? SyncDirection::RIGHT : SyncDirection::LEFT });
             }
             else
             {
                 if (changeOnLeft)
-                    folder.setSyncDirConflict(txtBothSidesChanged_);
+                    updates.push_back({ &folder, SyncDirection::NONE, &txtBothSidesChanged_ });
                 else
-                    folder.setSyncDirConflict(txtNoSideChanged_);
+                    updates.push_back({ &folder, SyncDirection::NONE, &txtNoSideChanged_ });
             }
         }
 
-        recurse(folder, dbEntryL, dbEntryR);
+        subTasks.push_back({ &folder, dbEntryL, dbEntryR });
     }
 
     const std::wstring txtBothSidesChanged_ = _("Both sides have changed since last synchronization.");
@@ -6,6 +6,7 @@
 
 #include "application.h"
 #include <memory>
+#include <optional>
 #include <zen/file_access.h>
 #include <zen/perf.h>
 #include <wx/tooltip.h>
@@ -22,6 +23,7 @@
 #include "fatal_error.h"
 #include "resolve_path.h"
 #include "generate_logfile.h"
+#include "startup_trace.h"
 #include "../ui/batch_status_handler.h"
 #include "../ui/main_dlg.h"
 
@@ -54,9 +56,13 @@ const wxEventType EVENT_ENTER_EVENT_LOOP = wxNewEventType();
 bool Application::OnInit()
 {
     //do not call wxApp::OnInit() to avoid using wxWidgets command line parser
+    StartupPhase phaseInit("OnInit");
 
-    ::gtk_init(nullptr, nullptr);
-    ::gtk_rc_parse((getResourceDirPf() + "styles.gtk_rc").c_str()); //remove excessive inner border from bitmap buttons
+    {
+        StartupPhase phase("gtk_init");
+        ::gtk_init(nullptr, nullptr);
+        ::gtk_rc_parse((getResourceDirPf() + "styles.gtk_rc").c_str()); //remove excessive inner border from bitmap buttons
+    }
 
 
     //Windows User Experience Interaction Guidelines: tool tips should have 5s timeout, info tips no timeout => compromise:
@@ -65,10 +71,14 @@ bool Application::OnInit()
 
     SetAppName(L"FreeFileSync"); //if not set, the default is the executable's name!
 
-    initResourceImages(getResourceDirPf() + Zstr("Resources.zip")); //parallel xBRZ-scaling! => run as early as possible
+    {
+        StartupPhase phase("initResourceImages");
+        initResourceImages(getResourceDirPf() + Zstr("Resources.zip"), getConfigDirPathPf() + Zstr("Resources.cache")); //parallel xBRZ-scaling! => run as early as possible
+    }
 
     try
     {
+        StartupPhase phase("setLanguage");
         //tentatively set program language to OS default until GlobalSettings.xml is read later
         setLanguage(XmlGlobalSettings().programLanguage); //throw FileError
     }
@@ -148,6 +158,9 @@ void Application::launch(const std::vector<Zstring>& commandArgs)
     wxTheApp->SetExitOnFrameDelete(false); //prevent popup-windows from becoming temporary top windows leading to program exit after closure
     ZEN_ON_SCOPE_EXIT(if (!mainWindowWasSet()) wxTheApp->ExitMainLoop();); //quit application, if no main window was set (batch silent mode)
 
+    ZEN_ON_SCOPE_EXIT(writeStartupTrace()); //noexcept; GUI: main dialog is shown, batch mode: job has completed
+    StartupPhase phaseLaunch("launch");
+
     auto notifyFatalError = [&](const std::wstring& msg, const std::wstring& title)
     {
         logFatalError(utfTo<std::string>(msg));
@@ -175,6 +188,7 @@ void Application::launch(const std::vector<Zstring>& commandArgs)
         const Zchar optionRightDir[] = Zstr("-rightdir"); //
         const Zchar optionDirPair [] = Zstr("-dirpair");
         const Zchar optionSendTo  [] = Zstr("-sendto"); //remaining arguments are unspecified number of folder paths; wonky syntax; let's keep it undocumented
+        const Zchar optionStartupTrace[] = Zstr("-startuptrace"); //diagnostics only: keep undocumented
 
         auto syntaxHelpRequested = [&](const Zstring& arg)
         {
@@ -194,6 +208,7 @@ void Application::launch(const std::vector<Zstring>& commandArgs)
                    equalAsciiNoCase(arg, optionRightDir) ||
                    equalAsciiNoCase(arg, optionDirPair ) ||
                    equalAsciiNoCase(arg, optionSendTo  ) ||
+                   equalAsciiNoCase(arg, optionStartupTrace) ||
                    syntaxHelpRequested(arg);
         };
 
@@ -214,6 +229,12 @@ void Application::launch(const std::vector<Zstring>& commandArgs)
                     return notifyFatalError(replaceCpy(_("A directory path is expected after %x."), L"%x", utfTo<std::wstring>(optionRightDir)), _("Syntax error"));
                 dirPathPhrasesRight.push_back(*it);
             }
+            else if (equalAsciiNoCase(*it, optionStartupTrace))
+            {
+                if (++it == commandArgs.end() || isCommandLineOption(*it))
+                    return notifyFatalError(replaceCpy<std::wstring>(L"A file path is expected after %x.", L"%x", utfTo<std::wstring>(optionStartupTrace)), _("Syntax error")); //diagnostics only: no translation
+                setStartupTraceFilePath(*it);
+            }
             else if (equalAsciiNoCase(*it, optionDirPair))
             {
                 if (++it == commandArgs.end() || isCommandLineOption(*it))
@@ -370,6 +391,7 @@ void Application::launch(const std::vector<Zstring>& commandArgs)
             XmlBatchConfig batchCfg;
             try
             {
+                StartupPhase phase("readConfig");
                 std::wstring warningMsg;
                 readConfig(filepath, batchCfg, warningMsg); //throw FileError
 
@@ -390,6 +412,7 @@ void Application::launch(const std::vector<Zstring>& commandArgs)
             XmlGuiConfig guiCfg;
             try
             {
+                StartupPhase phase("readConfig");
                 std::wstring warningMsg;
                 readAnyConfig({ filepath }, guiCfg, warningMsg); //throw FileError
 
@@ -422,6 +445,7 @@ void Application::launch(const std::vector<Zstring>& commandArgs)
         XmlGuiConfig guiCfg; //structure to receive gui settings with default values
         try
         {
+            StartupPhase phase("readConfig");
             std::wstring warningMsg;
             readAnyConfig(filePaths, guiCfg, warningMsg); //throw FileError
 
@@ -438,7 +462,11 @@ void Application::launch(const std::vector<Zstring>& commandArgs)
 }
 
 
-void runGuiMode(const Zstring& globalConfigFilePath) { MainDialog::create(globalConfigFilePath); }
+void runGuiMode(const Zstring& globalConfigFilePath)
+{
+    StartupPhase phase("MainDialog::create");
+    MainDialog::create(globalConfigFilePath);
+}
 
 
 void runGuiMode(const Zstring& globalConfigFilePath,
@@ -446,6 +474,7 @@ void runGuiMode(const Zstring& globalConfigFilePath,
                 const std::vector<Zstring>& cfgFilePaths,
                 bool startComparison)
 {
+    StartupPhase phase("MainDialog::create");
     MainDialog::create(globalConfigFilePath, nullptr, guiCfg, cfgFilePaths, startComparison);
 }
 
@@ -493,6 +522,7 @@ void runBatchMode(const Zstring& globalConfigFilePath, const XmlBatchConfig& bat
     XmlGlobalSettings globalCfg;
     try
     {
+        StartupPhase phase("readGlobalConfig");
         std::wstring warningMsg;
         readConfig(globalConfigFilePath, globalCfg, warningMsg); //throw FileError
         assert(warningMsg.empty()); //ignore parsing errors: should be migration problems only *cross-fingers*
@@ -512,6 +542,7 @@ void runBatchMode(const Zstring& globalConfigFilePath, const XmlBatchConfig& bat
 
     try
     {
+        StartupPhase phase("setLanguage");
         setLanguage(globalCfg.programLanguage); //throw FileError
     }
     catch (const FileError& e)
@@ -536,6 +567,7 @@ void runBatchMode(const Zstring& globalConfigFilePath, const XmlBatchConfig& bat
     const std::chrono::system_clock::time_point syncStartTime = std::chrono::system_clock::now();
 
     //class handling status updates and error messages
+    std::optional<StartupPhase> phaseStatusHandler("BatchStatusHandler");
     BatchStatusHandler statusHandler(!batchCfg.batchExCfg.runMinimized,
                                      batchCfg.batchExCfg.autoCloseSummary,
                                      extractJobName(cfgFilePath),
@@ -547,7 +579,11 @@ void runBatchMode(const Zstring& globalConfigFilePath, const XmlBatchConfig& bat
                                      batchCfg.mainCfg.automaticRetryDelay,
                                      batchCfg.mainCfg.postSyncCommand,
                                      batchCfg.mainCfg.postSyncCondition,
-                                     batchCfg.batchExCfg.postSyncAction);
+                                     batchCfg.batchExCfg.postSyncAction,
+                                     batchCfg.mainCfg.altLogFolderPathPhrase,
+                                     globalCfg.logfilesMaxAgeDays,
+                                     logFilePathsToKeep);
+    phaseStatusHandler.reset();
     try
     {
         //inform about (important) non-default global settings
@@ -557,6 +593,7 @@ void runBatchMode(const Zstring& globalConfigFilePath, const XmlBatchConfig& bat
         std::unique_ptr<LockHolder> dirLocks;
 
         //COMPARE DIRECTORIES
+        std::optional<StartupPhase> phaseCompare("compare");
         FolderComparison cmpResult = compare(globalCfg.warnDlgs,
                                              globalCfg.fileTimeTolerance,
                                              showPopupAllowed, //allowUserInteraction
@@ -566,7 +603,10 @@ void runBatchMode(const Zstring& globalConfigFilePath, const XmlBatchConfig& bat
                                              extractCompareCfg(batchCfg.mainCfg),
                                              deviceParallelOps,
                                              statusHandler); //throw AbortProcess
+        phaseCompare.reset();
+
         //START SYNCHRONIZATION
+        StartupPhase phaseSync("synchronize");
         synchronize(syncStartTime,
                     globalCfg.verifyFileCopy,
                     globalCfg.copyLockedFiles,
@@ -581,7 +621,7 @@ void runBatchMode(const Zstring& globalConfigFilePath, const XmlBatchConfig& bat
     }
     catch (AbortProcess&) {} //exit used by statusHandler
 
-    BatchStatusHandler::Result r = statusHandler.reportFinalStatus(batchCfg.mainCfg.altLogFolderPathPhrase, globalCfg.logfilesMaxAgeDays, logFilePathsToKeep); //noexcept
+    BatchStatusHandler::Result r = statusHandler.reportFinalStatus(); //noexcept
     //----------------------------------------------------------------------
 
     raiseReturnCode(returnCode, mapToReturnCode(r.finalStatus));
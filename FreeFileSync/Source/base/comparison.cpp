@@ -5,6 +5,7 @@
 // *****************************************************************************
 
 #include "comparison.h"
+#include <list>
 #include <zen/process_priority.h>
 #include <zen/perf.h>
 #include "algorithm.h"
@@ -139,15 +140,16 @@ ResolvedBaseFolders initializeBaseFolders(const std::vector<FolderPairCfg>& fpCf
 class ComparisonBuffer
 {
 public:
-    ComparisonBuffer(const std::set<DirectoryKey>& foldersToRead,
+    ComparisonBuffer(const std::map<DirectoryKey, size_t>& foldersToRead, //+ number of folder pairs using each folder
                      const std::map<AfsDevice, size_t>& deviceParallelOps,
                      int fileTimeTolerance,
                      ProcessCallback& callback);
 
     //create comparison result table and fill category except for files existing on both sides: undefinedFiles and undefinedSymlinks are appended!
-    std::shared_ptr<BaseFolderPair> compareByTimeSize(const ResolvedFolderPair& fp, const FolderPairCfg& fpConfig) const;
-    std::shared_ptr<BaseFolderPair> compareBySize    (const ResolvedFolderPair& fp, const FolderPairCfg& fpConfig) const;
-    std::list<std::shared_ptr<BaseFolderPair>> compareByContent(const std::vector<std::pair<ResolvedFolderPair, FolderPairCfg>>& workLoad) const;
+    //each call consumes the buffered folder content: reduce peak memory by releasing it as soon as the last folder pair using it is compared
+    std::shared_ptr<BaseFolderPair> compareByTimeSize(const ResolvedFolderPair& fp, const FolderPairCfg& fpConfig);
+    std::shared_ptr<BaseFolderPair> compareBySize    (const ResolvedFolderPair& fp, const FolderPairCfg& fpConfig);
+    std::list<std::shared_ptr<BaseFolderPair>> compareByContent(const std::vector<std::pair<ResolvedFolderPair, FolderPairCfg>>& workLoad);
 
 private:
     ComparisonBuffer           (const ComparisonBuffer&) = delete;
@@ -156,20 +158,21 @@ private:
     std::shared_ptr<BaseFolderPair> performComparison(const ResolvedFolderPair& fp,
                                                       const FolderPairCfg& fpCfg,
                                                       std::vector<FilePair*>& undefinedFiles,
-                                                      std::vector<SymlinkPair*>& undefinedSymlinks) const;
+                                                      std::vector<SymlinkPair*>& undefinedSymlinks);
 
     std::map<DirectoryKey, DirectoryValue> directoryBuffer_; //contains only *existing* directories
+    std::map<DirectoryKey, size_t> pendingFolderPairs_; //number of folder pairs yet to be compared per buffered directory
     const int fileTimeTolerance_;
     ProcessCallback& cb_;
     const std::map<AfsDevice, size_t> deviceParallelOps_;
 };
 
 
-ComparisonBuffer::ComparisonBuffer(const std::set<DirectoryKey>& foldersToRead,
+ComparisonBuffer::ComparisonBuffer(const std::map<DirectoryKey, size_t>& foldersToRead,
                                    const std::map<AfsDevice, size_t>& deviceParallelOps,
                                    int fileTimeTolerance,
                                    ProcessCallback& callback) :
-    fileTimeTolerance_(fileTimeTolerance), cb_(callback), deviceParallelOps_(deviceParallelOps)
+    pendingFolderPairs_(foldersToRead), fileTimeTolerance_(fileTimeTolerance), cb_(callback), deviceParallelOps_(deviceParallelOps)
 {
     auto onError = [&](const std::wstring& msg, size_t retryNumber)
     {
@@ -196,7 +199,11 @@ ComparisonBuffer::ComparisonBuffer(const std::set<DirectoryKey>& foldersToRead,
         callback.reportStatus(textScanning + statusLine); //throw X
     };
 
-    parallelDeviceTraversal(foldersToRead, //in
+    std::set<DirectoryKey> folderKeys;
+    for (const auto& [folderKey, folderPairCount] : foldersToRead)
+        folderKeys.insert(folderKey);
+
+    parallelDeviceTraversal(folderKeys, //in
                             directoryBuffer_, //out
                             deviceParallelOps,
                             onError, onStatusUpdate, //throw X
@@ -301,7 +308,7 @@ void categorizeSymlinkByTime(SymlinkPair& symlink)
 }
 
 
-std::shared_ptr<BaseFolderPair> ComparisonBuffer::compareByTimeSize(const ResolvedFolderPair& fp, const FolderPairCfg& fpConfig) const
+std::shared_ptr<BaseFolderPair> ComparisonBuffer::compareByTimeSize(const ResolvedFolderPair& fp, const FolderPairCfg& fpConfig)
 {
     //do basis scan and retrieve files existing on both sides as "compareCandidates"
     std::vector<FilePair*> uncategorizedFiles;
@@ -399,7 +406,7 @@ void categorizeSymlinkByContent(SymlinkPair& symlink, ProcessCallback& callback)
 }
 
 
-std::shared_ptr<BaseFolderPair> ComparisonBuffer::compareBySize(const ResolvedFolderPair& fp, const FolderPairCfg& fpConfig) const
+std::shared_ptr<BaseFolderPair> ComparisonBuffer::compareBySize(const ResolvedFolderPair& fp, const FolderPairCfg& fpConfig)
 {
     //do basis scan and retrieve files existing on both sides as "compareCandidates"
     std::vector<FilePair*> uncategorizedFiles;
@@ -497,7 +504,7 @@ void categorizeFileByContent(FilePair& file, const std::wstring& txtComparingCon
 }
 
 
-std::list<std::shared_ptr<BaseFolderPair>> ComparisonBuffer::compareByContent(const std::vector<std::pair<ResolvedFolderPair, FolderPairCfg>>& workLoad) const
+std::list<std::shared_ptr<BaseFolderPair>> ComparisonBuffer::compareByContent(const std::vector<std::pair<ResolvedFolderPair, FolderPairCfg>>& workLoad)
 {
     struct ParallelOps
     {
@@ -653,12 +660,16 @@ class MergeSides
 public:
     MergeSides(const std::map<ZstringNoCase, Zstringw>& errorsByRelPath,
                std::vector<FilePair*>& undefinedFilesOut,
-               std::vector<SymlinkPair*>& undefinedSymlinksOut) :
-        errorsByRelPath_(errorsByRelPath),
-        undefinedFiles_(undefinedFilesOut),
-        undefinedSymlinks_(undefinedSymlinksOut) {}
-
-    void execute(const FolderContainer& lhs, const FolderContainer& rhs, ContainerObject& output)
+               std::vector<SymlinkPair*>& undefinedSymlinksOut,
+               bool releaseInputL, //release folder content right after merging:
+               bool releaseInputR) //=> scan result and comparison result are not held in memory completely at the same time
+        : errorsByRelPath_(errorsByRelPath),
+          undefinedFiles_(undefinedFilesOut),
+          undefinedSymlinks_(undefinedSymlinksOut),
+          releaseInputL_(releaseInputL),
+          releaseInputR_(releaseInputR) {}
+
+    void execute(FolderContainer& lhs, FolderContainer& rhs, ContainerObject& output)
     {
         auto it = errorsByRelPath_.find(Zstring()); //empty path if read-error for whole base directory
 
@@ -668,16 +679,32 @@ public:
     }
 
 private:
-    void mergeTwoSides(const FolderContainer& lhs, const FolderContainer& rhs, const Zstringw* errorMsg, ContainerObject& output);
+    void mergeTwoSides(FolderContainer& lhs, FolderContainer& rhs, const Zstringw* errorMsg, ContainerObject& output);
 
     template <SelectedSide side>
-    void fillOneSide(const FolderContainer& folderCont, const Zstringw* errorMsg, ContainerObject& output);
+    void fillOneSide(FolderContainer& folderCont, const Zstringw* errorMsg, ContainerObject& output);
 
     const Zstringw* checkFailedRead(FileSystemObject& fsObj, const Zstringw* errorMsg);
 
+    template <class ItemList>
+    void releaseInput(ItemList& lhs, ItemList& rhs) //caveat: lhs and rhs may alias!
+    {
+        if (releaseInputL_) lhs.clear();
+        if (releaseInputR_) rhs.clear();
+    }
+
+    template <SelectedSide side, class ItemList>
+    void releaseInput(ItemList& items)
+    {
+        if (SelectParam<side>::ref(releaseInputL_, releaseInputR_))
+            items.clear();
+    }
+
     const std::map<ZstringNoCase, Zstringw>& errorsByRelPath_; //base-relative paths or empty if read-error for whole base directory
     std::vector<FilePair*>&    undefinedFiles_;
     std::vector<SymlinkPair*>& undefinedSymlinks_;
+    bool releaseInputL_;
+    bool releaseInputR_;
 };
 
 
@@ -702,43 +729,46 @@ const Zstringw* MergeSides::checkFailedRead(FileSystemObject& fsObj, const Zstri
 
 
 template <SelectedSide side>
-void MergeSides::fillOneSide(const FolderContainer& folderCont, const Zstringw* errorMsg, ContainerObject& output)
+void MergeSides::fillOneSide(FolderContainer& folderCont, const Zstringw* errorMsg, ContainerObject& output)
 {
     for (const auto& [fileName, attrib] : folderCont.files)
     {
         FilePair& newItem = output.addSubFile<side>(fileName, attrib);
         checkFailedRead(newItem, errorMsg);
     }
+    releaseInput<side>(folderCont.files);
 
     for (const auto& [linkName, attrib] : folderCont.symlinks)
     {
         SymlinkPair& newItem = output.addSubLink<side>(linkName, attrib);
         checkFailedRead(newItem, errorMsg);
     }
+    releaseInput<side>(folderCont.symlinks);
 
-    for (const auto& [folderName, attrAndSub] : folderCont.folders)
+    for (auto& [folderName, attrAndSub] : folderCont.folders)
     {
         FolderPair& newFolder = output.addSubFolder<side>(folderName, attrAndSub.first);
         const Zstringw* errorMsgNew = checkFailedRead(newFolder, errorMsg);
         fillOneSide<side>(attrAndSub.second, errorMsgNew, newFolder); //recurse
     }
+    releaseInput<side>(folderCont.folders);
 }
 
 
 template <class MapType, class ProcessLeftOnly, class ProcessRightOnly, class ProcessBoth> inline
-void matchFolders(const MapType& mapLeft, const MapType& mapRight, ProcessLeftOnly lo, ProcessRightOnly ro, ProcessBoth bo)
+void matchFolders(MapType& mapLeft, MapType& mapRight, ProcessLeftOnly lo, ProcessRightOnly ro, ProcessBoth bo)
 {
     struct FileRef
     {
         Zstring upperCaseName; //buffer expensive makeUpperCopy() calls!!
-        const typename MapType::value_type* ref;
+        typename MapType::value_type* ref;
         bool leftSide;
     };
     std::vector<FileRef> fileList;
     fileList.reserve(mapLeft.size() + mapRight.size()); //perf: ~5% shorter runtime
 
-    for (const auto& item : mapLeft ) fileList.push_back({ makeUpperCopy(item.first), &item, true });
-    for (const auto& item : mapRight) fileList.push_back({ makeUpperCopy(item.first), &item, false });
+    for (auto& item : mapLeft ) fileList.push_back({ makeUpperCopy(item.first), &item, true });
+    for (auto& item : mapRight) fileList.push_back({ makeUpperCopy(item.first), &item, false });
 
     //primary sort: ignore unicode normal form and case
     //bonus: natural default sequence on file guid UI
@@ -797,7 +827,7 @@ void matchFolders(const MapType& mapLeft, const MapType& mapRight, ProcessLeftOn
 }
 
 
-void MergeSides::mergeTwoSides(const FolderContainer& lhs, const FolderContainer& rhs, const Zstringw* errorMsg, ContainerObject& output)
+void MergeSides::mergeTwoSides(FolderContainer& lhs, FolderContainer& rhs, const Zstringw* errorMsg, ContainerObject& output)
 {
     using FileData = FolderContainer::FileList::value_type;
 
@@ -820,8 +850,9 @@ void MergeSides::mergeTwoSides(const FolderContainer& lhs, const FolderContainer
                                               fileRight.second);
         if (!checkFailedRead(newItem, errorMsg))
             undefinedFiles_.push_back(&newItem);
-        static_assert(std::is_same_v<ContainerObject::FileList, std::list<FilePair>>); //ContainerObject::addSubFile() must NOT invalidate references used in "undefinedFiles"!
+        static_assert(std::is_same_v<ContainerObject::FileList, FixedList<FilePair>>); //ContainerObject::addSubFile() must NOT invalidate references used in "undefinedFiles"!
     });
+    releaseInput(lhs.files, rhs.files);
 
     //-----------------------------------------------------------------------------------------------
     using SymlinkData = FolderContainer::SymlinkList::value_type;
@@ -846,23 +877,24 @@ void MergeSides::mergeTwoSides(const FolderContainer& lhs, const FolderContainer
         if (!checkFailedRead(newItem, errorMsg))
             undefinedSymlinks_.push_back(&newItem);
     });
+    releaseInput(lhs.symlinks, rhs.symlinks);
 
     //-----------------------------------------------------------------------------------------------
     using FolderData = FolderContainer::FolderList::value_type;
 
-    matchFolders(lhs.folders, rhs.folders, [&](const FolderData& dirLeft, const Zstringw* conflictMsg)
+    matchFolders(lhs.folders, rhs.folders, [&](FolderData& dirLeft, const Zstringw* conflictMsg)
     {
         FolderPair& newFolder = output.addSubFolder<LEFT_SIDE>(dirLeft.first, dirLeft.second.first);
         const Zstringw* errorMsgNew = checkFailedRead(newFolder, conflictMsg ? conflictMsg : errorMsg);
         this->fillOneSide<LEFT_SIDE>(dirLeft.second.second, errorMsgNew, newFolder); //recurse
     },
-    [&](const FolderData& dirRight, const Zstringw* conflictMsg)
+    [&](FolderData& dirRight, const Zstringw* conflictMsg)
     {
         FolderPair& newFolder = output.addSubFolder<RIGHT_SIDE>(dirRight.first, dirRight.second.first);
         const Zstringw* errorMsgNew = checkFailedRead(newFolder, conflictMsg ? conflictMsg : errorMsg);
         this->fillOneSide<RIGHT_SIDE>(dirRight.second.second, errorMsgNew, newFolder); //recurse
     },
-    [&](const FolderData& dirLeft, const FolderData& dirRight)
+    [&](FolderData& dirLeft, FolderData& dirRight)
     {
         FolderPair& newFolder = output.addSubFolder(dirLeft.first, dirLeft.second.first, DIR_EQUAL, dirRight.first, dirRight.second.first);
         const Zstringw* errorMsgNew = checkFailedRead(newFolder, errorMsg);
@@ -874,6 +906,7 @@ void MergeSides::mergeTwoSides(const FolderContainer& lhs, const FolderContainer
 
         mergeTwoSides(dirLeft.second.second, dirRight.second.second, errorMsgNew, newFolder); //recurse
     });
+    releaseInput(lhs.folders, rhs.folders);
 }
 
 //-----------------------------------------------------------------------------------------------
@@ -886,8 +919,8 @@ void stripExcludedDirectories(ContainerObject& hierObj, const PathFilter& filter
 
     //remove superfluous directories:
     //   this does not invalidate "std::vector<FilePair*>& undefinedFiles", since we delete folders only
-    //   and there is no side-effect for memory positions of FilePair and SymlinkPair thanks to std::list!
-    static_assert(std::is_same_v<std::list<FolderPair>, ContainerObject::FolderList>);
+    //   and there is no side-effect for memory positions of FilePair and SymlinkPair thanks to FixedList!
+    static_assert(std::is_same_v<FixedList<FolderPair>, ContainerObject::FolderList>);
 
     hierObj.refSubFolders().remove_if([&](FolderPair& folder)
     {
@@ -908,19 +941,40 @@ void stripExcludedDirectories(ContainerObject& hierObj, const PathFilter& filter
 std::shared_ptr<BaseFolderPair> ComparisonBuffer::performComparison(const ResolvedFolderPair& fp,
                                                                     const FolderPairCfg& fpCfg,
                                                                     std::vector<FilePair*>& undefinedFiles,
-                                                                    std::vector<SymlinkPair*>& undefinedSymlinks) const
+                                                                    std::vector<SymlinkPair*>& undefinedSymlinks)
 {
     cb_.reportStatus(_("Generating file list...")); //throw X
     cb_.forceUiRefresh(); //throw X
 
-    auto getDirValue = [&](const AbstractPath& folderPath) -> const DirectoryValue*
+    const DirectoryKey dirKeyL{ fp.folderPathLeft,  fpCfg.filter.nameFilter, fpCfg.handleSymlinks };
+    const DirectoryKey dirKeyR{ fp.folderPathRight, fpCfg.filter.nameFilter, fpCfg.handleSymlinks };
+
+    auto getDirValue = [&](const DirectoryKey& dirKey) -> DirectoryValue*
     {
-        auto it = directoryBuffer_.find({ folderPath, fpCfg.filter.nameFilter, fpCfg.handleSymlinks });
+        auto it = directoryBuffer_.find(dirKey);
         return it != directoryBuffer_.end() ? &it->second : nullptr;
     };
 
-    const DirectoryValue* bufValueLeft  = getDirValue(fp.folderPathLeft);
-    const DirectoryValue* bufValueRight = getDirValue(fp.folderPathRight);
+    DirectoryValue* bufValueLeft  = getDirValue(dirKeyL);
+    DirectoryValue* bufValueRight = getDirValue(dirKeyR);
+
+    //is this the last folder pair using the buffered folder content? (left and right may be the same directory!)
+    auto notifyFolderPairDone = [&](const DirectoryKey& dirKey)
+    {
+        auto it = pendingFolderPairs_.find(dirKey);
+        if (it != pendingFolderPairs_.end() && it->second > 0)
+            --it->second;
+    };
+    notifyFolderPairDone(dirKeyL);
+    notifyFolderPairDone(dirKeyR);
+
+    auto isLastUse = [&](const DirectoryKey& dirKey)
+    {
+        auto it = pendingFolderPairs_.find(dirKey);
+        return it != pendingFolderPairs_.end() && it->second == 0;
+    };
+    const bool releaseBufL = bufValueLeft  && isLastUse(dirKeyL);
+    const bool releaseBufR = bufValueRight && isLastUse(dirKeyR);
 
     std::map<ZstringNoCase, Zstringw> failedReads; //base-relative paths or empty if read-error for whole base directory
     {
@@ -963,10 +1017,14 @@ std::shared_ptr<BaseFolderPair> ComparisonBuffer::performComparison(const Resolv
 
     //PERF_START;
     FolderContainer emptyFolderCont; //WTF!!! => using a temporary in the ternary conditional would implicitly call the FolderContainer copy-constructor!!!!!!
-    MergeSides(failedReads, undefinedFiles, undefinedSymlinks).execute(bufValueLeft  ? bufValueLeft ->folderCont : emptyFolderCont,
-                                                                       bufValueRight ? bufValueRight->folderCont : emptyFolderCont, *output);
+    MergeSides(failedReads, undefinedFiles, undefinedSymlinks, releaseBufL, releaseBufR).execute(bufValueLeft  ? bufValueLeft ->folderCont : emptyFolderCont,
+                                                                                                 bufValueRight ? bufValueRight->folderCont : emptyFolderCont, *output);
     //PERF_STOP;
 
+    //folder content was consumed: drop remaining buffer data, too
+    if (releaseBufL) directoryBuffer_.erase(dirKeyL);
+    if (releaseBufR) directoryBuffer_.erase(dirKeyR);
+
     //##################### in/exclude rows according to filtering #####################
     //NOTE: we need to finish de-activating rows BEFORE binary comparison is run so that it can skip them!
 
@@ -1123,14 +1181,14 @@ FolderComparison fff::compare(WarningDialogs& warnings,
     try
     {
         //------------------- fill directory buffer ---------------------------------------------------
-        std::set<DirectoryKey> foldersToRead;
+        std::map<DirectoryKey, size_t> foldersToRead; //+ number of folder pairs using each folder
 
         for (const auto& [folderPair, fpCfg] : workLoad)
         {
             if (basefolderExisting(folderPair.folderPathLeft)) //only traverse *currently existing* folders: at this point user is aware that non-ex + empty string are seen as empty folder!
-                foldersToRead.emplace(DirectoryKey({ folderPair.folderPathLeft, fpCfg.filter.nameFilter, fpCfg.handleSymlinks }));
+                ++foldersToRead[DirectoryKey({ folderPair.folderPathLeft, fpCfg.filter.nameFilter, fpCfg.handleSymlinks })];
             if (basefolderExisting(folderPair.folderPathRight))
-                foldersToRead.emplace(DirectoryKey({ folderPair.folderPathRight, fpCfg.filter.nameFilter, fpCfg.handleSymlinks }));
+                ++foldersToRead[DirectoryKey({ folderPair.folderPathRight, fpCfg.filter.nameFilter, fpCfg.handleSymlinks })];
         }
 
         FolderComparison output;
@@ -0,0 +1,332 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#include "console_application.h"
+#include <iostream>
+#include <optional>
+#include <zen/file_access.h>
+#include "comparison.h"
+#include "synchronization.h"
+#include "process_xml.h"
+#include "fatal_error.h"
+#include "resolve_path.h"
+#include "localization.h"
+#include "startup_trace.h"
+#include "console_status_handler.h"
+
+using namespace zen;
+using namespace fff;
+
+
+IMPLEMENT_APP_CONSOLE(ConsoleApplication)
+
+
+namespace
+{
+std::vector<Zstring> getCommandlineArgs(const wxAppConsole& app)
+{
+    std::vector<Zstring> args;
+    for (int i = 1; i < app.argc; ++i)
+        args.push_back(utfTo<Zstring>(wxString(app.argv[i])));
+    return args;
+}
+
+
+void showSyntaxHelp()
+{
+    std::cout << utfTo<std::string>(_("Syntax:") + L"\n\n" +
+                                    L"./FreeFileSync_Batch " + L"\n" +
+                                    L"    " + _("config files:") + L" *.ffs_batch" + L"\n" +
+                                    L"    [" + _("global config file:") + L" GlobalSettings.xml]" + L"\n" +
+                                    L"\n" +
+
+                                    _("global config file:") + L"\n" +
+                                    _("Path to an alternate GlobalSettings.xml file.")) << "\n";
+}
+
+
+void runBatchJob(const Zstring& globalConfigFilePath, const XmlBatchConfig& batchCfg, const Zstring& cfgFilePath, FfsReturnCode& returnCode);
+}
+
+//##################################################################################################################
+
+bool ConsoleApplication::OnInit()
+{
+    //do not call wxAppConsole::OnInit() to avoid using wxWidgets command line parser
+    SetAppName(L"FreeFileSync"); //if not set, the default is the executable's name!
+
+    try
+    {
+        StartupPhase phase("setLanguage");
+        //tentatively set program language to OS default until GlobalSettings.xml is read later
+        setLanguage(XmlGlobalSettings().programLanguage); //throw FileError
+    }
+    catch (FileError&) { assert(false); }
+
+    return true; //true: continue processing; false: exit immediately.
+}
+
+
+int ConsoleApplication::OnExit()
+{
+    releaseWxLocale();
+    return wxAppConsole::OnExit();
+}
+
+
+int ConsoleApplication::OnRun()
+{
+    try
+    {
+        launch(getCommandlineArgs(*this));
+    }
+    catch (const std::bad_alloc& e) //the only kind of exception we don't want crash dumps for
+    {
+        logFatalError(e.what()); //it's not always possible to display a message box, e.g. corrupted stack, however low-level file output works!
+
+        const auto titleFmt = copyStringTo<std::wstring>(GetAppDisplayName()) + SPACED_DASH + _("An exception occurred");
+        std::cerr << utfTo<std::string>(titleFmt + SPACED_DASH) << e.what() << "\n";
+        return FFS_RC_EXCEPTION;
+    }
+    //catch (...) -> let it crash and create mini dump!!!
+
+    return returnCode_;
+}
+
+
+void ConsoleApplication::launch(const std::vector<Zstring>& commandArgs)
+{
+    ZEN_ON_SCOPE_EXIT(writeStartupTrace()); //noexcept; trace file is only written if FFS_STARTUP_TRACE is set
+    StartupPhase phaseLaunch("launch");
+
+    auto notifyFatalError = [&](const std::wstring& msg, const std::wstring& title)
+    {
+        logFatalError(utfTo<std::string>(msg));
+
+        //no sync log output available at this point!
+        auto titleFmt = copyStringTo<std::wstring>(GetAppDisplayName()) + SPACED_DASH + title;
+        std::cerr << utfTo<std::string>(titleFmt + SPACED_DASH + msg) << "\n";
+        raiseReturnCode(returnCode_, FFS_RC_ABORTED);
+    };
+
+    //parse command line arguments
+    std::vector<Zstring> batchFilePaths;
+    Zstring globalConfigFile;
+    {
+        auto syntaxHelpRequested = [&](const Zstring& arg)
+        {
+            auto it = std::find_if(arg.begin(), arg.end(), [](Zchar c) { return c != Zstr('/') && c != Zstr('-'); });
+            if (it == arg.begin()) return false; //require at least one prefix character
+
+            const Zstring argTmp(it, arg.end());
+            return equalAsciiNoCase(argTmp, Zstr("help")) ||
+                   equalAsciiNoCase(argTmp, Zstr("h"))    ||
+                   argTmp == Zstr("?");
+        };
+
+        for (const Zstring& arg : commandArgs)
+            if (syntaxHelpRequested(arg))
+                return showSyntaxHelp();
+            else
+            {
+                Zstring filePath = getResolvedFilePath(arg);
+
+                if (!fileAvailable(filePath)) //...be a little tolerant
+                {
+                    if (fileAvailable(filePath + Zstr(".ffs_batch")))
+                        filePath += Zstr(".ffs_batch");
+                    else if (fileAvailable(filePath + Zstr(".xml")))
+                        filePath += Zstr(".xml");
+                    else
+                        return notifyFatalError(replaceCpy(_("Cannot find file %x."), L"%x", fmtPath(filePath)), _("Error"));
+                }
+
+                try
+                {
+                    switch (getXmlType(filePath)) //throw FileError
+                    {
+                        case XML_TYPE_BATCH:
+                            batchFilePaths.push_back(filePath);
+                            break;
+                        case XML_TYPE_GLOBAL:
+                            globalConfigFile = filePath;
+                            break;
+                        case XML_TYPE_GUI: //no GUI available: *.ffs_gui is not a valid configuration here
+                        case XML_TYPE_OTHER:
+                            return notifyFatalError(replaceCpy(_("File %x does not contain a valid configuration."), L"%x", fmtPath(filePath)), _("Error"));
+                    }
+                }
+                catch (const FileError& e)
+                {
+                    return notifyFatalError(e.toString(), _("Error"));
+                }
+            }
+    }
+    //----------------------------------------------------------------------------------------------------
+
+    if (batchFilePaths.empty())
+    {
+        showSyntaxHelp();
+        raiseReturnCode(returnCode_, FFS_RC_ABORTED);
+        return;
+    }
+
+    const Zstring globalConfigFilePath = !globalConfigFile.empty() ? globalConfigFile : getGlobalConfigFile();
+
+    //multiple batch jobs: run one after the other; return code: worst result
+    for (const Zstring& filePath : batchFilePaths)
+    {
+        XmlBatchConfig batchCfg;
+        try
+        {
+            StartupPhase phase("readConfig");
+            std::wstring warningMsg;
+            readConfig(filePath, batchCfg, warningMsg); //throw FileError
+
+            if (!warningMsg.empty())
+                throw FileError(warningMsg); //batch mode: break on errors AND even warnings!
+        }
+        catch (const FileError& e)
+        {
+            notifyFatalError(e.toString(), _("Error"));
+            continue;
+        }
+        runBatchJob(globalConfigFilePath, batchCfg, filePath, returnCode_);
+    }
+}
+
+
+namespace
+{
+void runBatchJob(const Zstring& globalConfigFilePath, const XmlBatchConfig& batchCfg, const Zstring& cfgFilePath, FfsReturnCode& returnCode)
+{
+    auto notifyError = [&](const std::wstring& msg, FfsReturnCode rc)
+    {
+        logFatalError(utfTo<std::string>(msg));
+        std::cerr << utfTo<std::string>(msg) << "\n";
+
+        raiseReturnCode(returnCode, rc);
+    };
+
+    XmlGlobalSettings globalCfg;
+    try
+    {
+        StartupPhase phase("readGlobalConfig");
+        std::wstring warningMsg;
+        readConfig(globalConfigFilePath, globalCfg, warningMsg); //throw FileError
+        assert(warningMsg.empty()); //ignore parsing errors: should be migration problems only *cross-fingers*
+    }
+    catch (FileError&)
+    {
+        try
+        {
+            if (itemStillExists(globalConfigFilePath)) //throw FileError
+                throw;
+        }
+        catch (const FileError& e)
+        {
+            return notifyError(e.toString(), FFS_RC_ABORTED); //abort sync!
+        }
+    }
+
+    try
+    {
+        StartupPhase phase("setLanguage");
+        setLanguage(globalCfg.programLanguage); //throw FileError
+    }
+    catch (const FileError& e)
+    {
+        notifyError(e.toString(), FFS_RC_FINISHED_WITH_WARNINGS);
+        //continue!
+    }
+
+    const std::map<AfsDevice, size_t>& deviceParallelOps = batchCfg.mainCfg.deviceParallelOps;
+
+    std::set<AbstractPath> logFilePathsToKeep;
+    for (const ConfigFileItem& item : globalCfg.gui.mainDlg.cfgFileHistory)
+        logFilePathsToKeep.insert(item.logFilePath);
+
+    const std::chrono::system_clock::time_point syncStartTime = std::chrono::system_clock::now();
+
+    //class handling status updates and error messages
+    ConsoleStatusHandler statusHandler(extractJobName(cfgFilePath),
+                                       syncStartTime,
+                                       batchCfg.mainCfg.ignoreErrors,
+                                       batchCfg.mainCfg.automaticRetryCount,
+                                       batchCfg.mainCfg.automaticRetryDelay,
+                                       batchCfg.mainCfg.postSyncCommand,
+                                       batchCfg.mainCfg.postSyncCondition,
+                                       batchCfg.batchExCfg.postSyncAction,
+                                       batchCfg.mainCfg.altLogFolderPathPhrase,
+                                       globalCfg.logfilesMaxAgeDays,
+                                       logFilePathsToKeep);
+    try
+    {
+        //inform about (important) non-default global settings
+        logNonDefaultSettings(globalCfg, statusHandler); //throw AbortProcess
+
+        //batch mode: place directory locks on directories during both comparison AND synchronization
+        std::unique_ptr<LockHolder> dirLocks;
+
+        //COMPARE DIRECTORIES
+        std::optional<StartupPhase> phaseCompare("compare");
+        FolderComparison cmpResult = compare(globalCfg.warnDlgs,
+                                             globalCfg.fileTimeTolerance,
+                                             false /*allowUserInteraction*/,
+                                             globalCfg.runWithBackgroundPriority,
+                                             globalCfg.createLockFile,
+                                             dirLocks,
+                                             extractCompareCfg(batchCfg.mainCfg),
+                                             deviceParallelOps,
+                                             statusHandler); //throw AbortProcess
+        phaseCompare.reset();
+
+        //START SYNCHRONIZATION
+        StartupPhase phaseSync("synchronize");
+        synchronize(syncStartTime,
+                    globalCfg.verifyFileCopy,
+                    globalCfg.copyLockedFiles,
+                    globalCfg.copyFilePermissions,
+                    globalCfg.failSafeFileCopy,
+                    globalCfg.runWithBackgroundPriority,
+                    extractSyncCfg(batchCfg.mainCfg),
+                    cmpResult,
+                    deviceParallelOps,
+                    globalCfg.warnDlgs,
+                    statusHandler); //throw AbortProcess
+    }
+    catch (AbortProcess&) {} //exit used by statusHandler
+
+    ConsoleStatusHandler::Result r = statusHandler.reportFinalStatus(); //noexcept
+    //----------------------------------------------------------------------
+
+    raiseReturnCode(returnCode, mapToReturnCode(r.finalStatus));
+
+    //update last sync stats for the selected cfg file
+    for (ConfigFileItem& cfi : globalCfg.gui.mainDlg.cfgFileHistory)
+        if (equalNativePath(cfi.cfgFilePath, cfgFilePath))
+        {
+            if (r.finalStatus != SyncResult::ABORTED)
+                cfi.lastSyncTime = std::chrono::system_clock::to_time_t(syncStartTime);
+            assert(!AFS::isNullPath(r.logFilePath));
+            if (!AFS::isNullPath(r.logFilePath))
+            {
+                cfi.logFilePath = r.logFilePath;
+                cfi.logResult   = r.finalStatus;
+            }
+            break;
+        }
+
+    try //save global settings to XML: e.g. ignored warnings
+    {
+        writeConfig(globalCfg, globalConfigFilePath); //FileError
+    }
+    catch (const FileError& e)
+    {
+        notifyError(e.toString(), FFS_RC_FINISHED_WITH_WARNINGS);
+    }
+}
+}
@@ -0,0 +1,32 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#ifndef CONSOLE_APPLICATION_H_7390145627803412
+#define CONSOLE_APPLICATION_H_7390145627803412
+
+#include <vector>
+#include <zen/zstring.h>
+#include <wx/app.h>
+#include "return_codes.h"
+
+
+namespace fff
+{
+//headless batch runner "FreeFileSync_Batch": wxBase only (paths, locale, translations) => no GTK, no display required
+class ConsoleApplication : public wxAppConsole
+{
+private:
+    bool OnInit() override;
+    int  OnRun () override;
+    int  OnExit() override;
+
+    void launch(const std::vector<Zstring>& commandArgs);
+
+    FfsReturnCode returnCode_ = FFS_RC_SUCCESS;
+};
+}
+
+#endif //CONSOLE_APPLICATION_H_7390145627803412
@@ -0,0 +1,296 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#include "console_status_handler.h"
+#include <atomic>
+#include <csignal>
+#include <iostream>
+#include <zen/shell_execute.h>
+#include <zen/shutdown.h>
+#include <zen/format_unit.h>
+#include <wx/utils.h> //wxSetEnv
+#include "resolve_path.h"
+#include "../fs/concrete.h"
+
+    #include <unistd.h>    //isatty
+    #include <sys/ioctl.h> //TIOCGWINSZ
+
+using namespace zen;
+using namespace fff;
+
+
+namespace
+{
+//Ctrl+C, "kill": stop like the "Cancel" button would, so that the log file is still written
+std::atomic<bool> stopSignalReceived{ false }; //signal handler => lock-free atomic only
+
+extern "C" void onStopSignal(int sig) { stopSignalReceived = true; }
+
+
+size_t getTerminalWidth()
+{
+    struct ::winsize ws = {};
+    if (::ioctl(STDOUT_FILENO, TIOCGWINSZ, &ws) == 0 && ws.ws_col > 0)
+        return ws.ws_col;
+    return 80;
+}
+}
+
+
+ConsoleStatusHandler::ConsoleStatusHandler(const std::wstring& jobName,
+                                           const std::chrono::system_clock::time_point& startTime,
+                                           bool ignoreErrors,
+                                           size_t automaticRetryCount,
+                                           std::chrono::seconds automaticRetryDelay,
+                                           const Zstring& postSyncCommand,
+                                           PostSyncCondition postSyncCondition,
+                                           PostSyncAction postSyncAction,
+                                           const Zstring& altLogFolderPathPhrase,
+                                           int logfilesMaxAgeDays,
+                                           const std::set<AbstractPath>& logFilePathsToKeep) :
+    logFileWriter_(jobName, startTime, altLogFolderPathPhrase, logfilesMaxAgeDays, logFilePathsToKeep),
+    ignoreErrors_(ignoreErrors),
+    automaticRetryCount_(automaticRetryCount),
+    automaticRetryDelay_(automaticRetryDelay),
+    jobName_(jobName),
+    startTime_(startTime),
+    postSyncCommand_(postSyncCommand),
+    postSyncCondition_(postSyncCondition),
+    postSyncAction_(postSyncAction),
+    showStatusLine_(::isatty(STDOUT_FILENO) != 0)
+{
+    stopSignalReceived = false;
+    std::signal(SIGINT,  onStopSignal);
+    std::signal(SIGTERM, onStopSignal);
+}
+
+
+ConsoleStatusHandler::~ConsoleStatusHandler()
+{
+    std::signal(SIGINT,  SIG_DFL);
+    std::signal(SIGTERM, SIG_DFL);
+
+    if (!finalStatusReported_) //reportFinalStatus() was not called!
+        std::abort();
+}
+
+
+void ConsoleStatusHandler::logMsg(const std::wstring& msg, MessageType type)
+{
+    errorLog_.logMsg(msg, type);
+    const LogEntry entry = errorLog_.getEntry(errorLog_.size() - 1);
+    logFileWriter_.write(entry);
+
+    clearStatusLine(); //don't interleave with status line
+    (type == MSG_TYPE_INFO ? std::cout : std::cerr) << utfTo<std::string>(formatMessage(entry)) << std::endl;
+}
+
+
+void ConsoleStatusHandler::clearStatusLine()
+{
+    if (statusLineLen_ > 0)
+    {
+        std::cout << '\r' << std::string(statusLineLen_, ' ') << '\r' << std::flush;
+        statusLineLen_ = 0;
+    }
+}
+
+
+ConsoleStatusHandler::Result ConsoleStatusHandler::reportFinalStatus() //noexcept!!
+{
+    const auto totalTime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now() - startTime_);
+
+    //determine post-sync status irrespective of further errors during tear-down
+    const SyncResult finalStatus = [&]
+    {
+        if (getAbortStatus())
+        {
+            logMsg(_("Stopped"), MSG_TYPE_ERROR); //= user cancel; *not* a MSG_TYPE_FATAL_ERROR!
+            return SyncResult::ABORTED;
+        }
+        else if (errorLog_.getItemCount(MSG_TYPE_ERROR | MSG_TYPE_FATAL_ERROR) > 0)
+            return SyncResult::FINISHED_WITH_ERROR;
+        else if (errorLog_.getItemCount(MSG_TYPE_WARNING) > 0)
+            return SyncResult::FINISHED_WITH_WARNINGS;
+
+        if (getStatsTotal(currentPhase()) == ProgressStats())
+            logMsg(_("Nothing to synchronize"), MSG_TYPE_INFO);
+        return SyncResult::FINISHED_WITH_SUCCESS;
+    }();
+
+    assert(finalStatus == SyncResult::ABORTED || currentPhase() == PHASE_SYNCHRONIZING);
+
+    const ProcessSummary summary
+    {
+        finalStatus, jobName_,
+        getStatsCurrent(currentPhase()),
+        getStatsTotal  (currentPhase()),
+        totalTime
+    };
+
+    const bool userCancelled = getAbortStatus() && *getAbortStatus() == AbortTrigger::USER; //Ctrl+C
+
+    //post sync command
+    Zstring commandLine = [&]
+    {
+        if (userCancelled)
+            ; //user cancelled => don't run post sync command!
+        else
+            switch (postSyncCondition_)
+            {
+                case PostSyncCondition::COMPLETION:
+                    return postSyncCommand_;
+                case PostSyncCondition::ERRORS:
+                    if (finalStatus == SyncResult::ABORTED ||
+                        finalStatus == SyncResult::FINISHED_WITH_ERROR)
+                        return postSyncCommand_;
+                    break;
+                case PostSyncCondition::SUCCESS:
+                    if (finalStatus == SyncResult::FINISHED_WITH_WARNINGS ||
+                        finalStatus == SyncResult::FINISHED_WITH_SUCCESS)
+                        return postSyncCommand_;
+                    break;
+            }
+        return Zstring();
+    }();
+    trim(commandLine);
+
+    if (!commandLine.empty())
+        logMsg(replaceCpy(_("Executing command %x"), L"%x", fmtPath(commandLine)), MSG_TYPE_INFO);
+
+    //----------------- always save log under %appdata%\FreeFileSync\Logs ------------------------
+    AbstractPath logFilePath = getNullPath();
+    try
+    {
+        //do NOT use tryReportingError()! saving log files should not be cancellable!
+        auto notifyStatusNoThrow = [&](const std::wstring& msg) { try { reportStatus(msg); /*throw X*/ } catch (...) {} };
+        logFilePath = logFileWriter_.finalize(summary, errorLog_, notifyStatusNoThrow /*throw X*/); //throw FileError
+    }
+    catch (const FileError& e) { logMsg(e.toString(), MSG_TYPE_ERROR); }
+
+    //execute post sync command *after* writing log files, so that user can refer to the log via the command!
+    if (!commandLine.empty())
+        try
+        {
+            //----------------------------------------------------------------------
+            ::wxSetEnv(L"logfile_path", AFS::getDisplayPath(logFilePath));
+            //----------------------------------------------------------------------
+            //use ExecutionType::ASYNC until there is reason not to: https://freefilesync.org/forum/viewtopic.php?t=31
+            shellExecute(expandMacros(commandLine), ExecutionType::ASYNC); //throw FileError
+        }
+        catch (const FileError& e) { logMsg(e.toString(), MSG_TYPE_ERROR); }
+
+    //post sync action: no count down, there is nobody to cancel it
+    if (!userCancelled)
+        switch (postSyncAction_)
+        {
+            case PostSyncAction::NONE:
+                break;
+            case PostSyncAction::SLEEP:
+                try { suspendSystem(); /*throw FileError*/ }
+                catch (const FileError& e) { logMsg(e.toString(), MSG_TYPE_ERROR); }
+                break;
+            case PostSyncAction::SHUTDOWN:
+                try { shutdownSystem(); /*throw FileError*/ }
+                catch (const FileError& e) { logMsg(e.toString(), MSG_TYPE_ERROR); }
+                break;
+        }
+
+    clearStatusLine();
+    std::cout << utfTo<std::string>(getFinalStatusLabel(finalStatus)) << "\n";
+    if (!AFS::isNullPath(logFilePath))
+        std::cout << utfTo<std::string>(AFS::getDisplayPath(logFilePath)) << "\n";
+    std::cout << std::flush;
+
+    finalStatusReported_ = true;
+    return { finalStatus, logFilePath };
+}
+
+
+void ConsoleStatusHandler::initNewPhase(int itemsTotal, int64_t bytesTotal, ProcessCallback::Phase phaseID)
+{
+    StatusHandler::initNewPhase(itemsTotal, bytesTotal, phaseID);
+    forceUiRefresh(); //throw X
+}
+
+
+void ConsoleStatusHandler::logInfo(const std::wstring& msg)
+{
+    logMsg(msg, MSG_TYPE_INFO);
+}
+
+
+void ConsoleStatusHandler::reportWarning(const std::wstring& msg, bool& warningActive)
+{
+    logMsg(msg, MSG_TYPE_WARNING);
+
+    if (!warningActive)
+        return;
+
+    if (!ignoreErrors_)
+        abortProcessNow(); //nobody to ask: not user-initiated! throw AbortProcess
+}
+
+
+ProcessCallback::Response ConsoleStatusHandler::reportError(const std::wstring& msg, size_t retryNumber)
+{
+    //auto-retry
+    if (retryNumber < automaticRetryCount_)
+    {
+        logMsg(msg + L"\n-> " + _("Automatic retry"), MSG_TYPE_INFO);
+        delayAndCountDown(_("Automatic retry") + (automaticRetryCount_ <= 1 ? L"" :  L" " + numberTo<std::wstring>(retryNumber + 1) + L"/" + numberTo<std::wstring>(automaticRetryCount_)),
+        automaticRetryDelay_, [&](const std::wstring& statusMsg) { this->reportStatus(_("Error") + L": " + statusMsg); });
+        return ProcessCallback::RETRY;
+    }
+
+    logMsg(msg, MSG_TYPE_ERROR);
+
+    if (!ignoreErrors_)
+        abortProcessNow(); //nobody to ask: not user-initiated! throw AbortProcess
+
+    return ProcessCallback::IGNORE_ERROR;
+}
+
+
+void ConsoleStatusHandler::reportFatalError(const std::wstring& msg)
+{
+    logMsg(msg, MSG_TYPE_FATAL_ERROR);
+
+    if (!ignoreErrors_)
+        abortProcessNow(); //nobody to ask: not user-initiated! throw AbortProcess
+}
+
+
+void ConsoleStatusHandler::forceUiRefreshNoThrow()
+{
+    if (stopSignalReceived.exchange(false))
+        userRequestAbort(); //=> AbortProcess is thrown by forceUiRefresh()
+
+    if (showStatusLine_ && !finalStatusReported_)
+    {
+        const ProgressStats statsCurrent = getStatsCurrent(currentPhase());
+        const ProgressStats statsTotal   = getStatsTotal  (currentPhase());
+
+        std::wstring statusLine = formatNumber(statsCurrent.items);
+        if (statsTotal.items >= 0) //unknown during folder scan
+            statusLine += L"/" + formatNumber(statsTotal.items) + L" (" + formatFilesizeShort(statsCurrent.bytes) + L"/" + formatFilesizeShort(statsTotal.bytes) + L")";
+        statusLine += L"  " + currentStatusText();
+
+        replace(statusLine, L"\n", L" ");
+
+        const size_t lineLenMax = getTerminalWidth() - 1; //don't trigger line wrap!
+        if (statusLine.size() > lineLenMax)
+            statusLine.resize(lineLenMax);
+
+        const size_t lineLenOld = statusLineLen_;
+        statusLineLen_ = statusLine.size(); //considers UTF-16, not Unicode code points: good enough
+
+        std::cout << '\r' << utfTo<std::string>(statusLine);
+        if (lineLenOld > statusLineLen_)
+            std::cout << std::string(lineLenOld - statusLineLen_, ' ') << '\r' << utfTo<std::string>(statusLine);
+        std::cout << std::flush;
+    }
+}
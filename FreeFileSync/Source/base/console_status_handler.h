@@ -0,0 +1,78 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#ifndef CONSOLE_STATUS_HANDLER_H_0471983461238954
+#define CONSOLE_STATUS_HANDLER_H_0471983461238954
+
+#include <chrono>
+#include <zen/error_log.h>
+#include "status_handler.h"
+#include "process_xml.h"
+#include "generate_logfile.h"
+
+
+namespace fff
+{
+/* batch job status handler without any GUI: used by the headless batch runner (FreeFileSync_Batch)
+    - log messages are written to stdout (info) and stderr (warnings, errors) using the same format as the log file
+    - progress is shown as a single status line, but only if stdout is a terminal
+    - no user interaction: BatchErrorHandling::SHOW_POPUP is handled like BatchErrorHandling::CANCEL    */
+class ConsoleStatusHandler : public StatusHandler
+{
+public:
+    ConsoleStatusHandler(const std::wstring& jobName, //should not be empty for a batch job!
+                         const std::chrono::system_clock::time_point& startTime,
+                         bool ignoreErrors,
+                         size_t automaticRetryCount,
+                         std::chrono::seconds automaticRetryDelay,
+                         const Zstring& postSyncCommand,
+                         PostSyncCondition postSyncCondition,
+                         PostSyncAction postSyncAction,
+                         const Zstring& altLogFolderPathPhrase,
+                         int logfilesMaxAgeDays,
+                         const std::set<AbstractPath>& logFilePathsToKeep); //noexcept!!
+    ~ConsoleStatusHandler();
+
+    void     initNewPhase    (int itemsTotal, int64_t bytesTotal, Phase phaseID) override; //
+    void     logInfo         (const std::wstring& msg)                           override; //
+    void     reportWarning   (const std::wstring& msg, bool& warningActive)      override; //throw AbortProcess
+    Response reportError     (const std::wstring& msg, size_t retryNumber)       override; //
+    void     reportFatalError(const std::wstring& msg)                           override; //
+
+    void forceUiRefreshNoThrow() override; //noexcept
+
+    struct Result
+    {
+        SyncResult finalStatus;
+        AbstractPath logFilePath;
+    };
+    Result reportFinalStatus(); //noexcept!!
+
+private:
+    void logMsg(const std::wstring& msg, zen::MessageType type); //add to errorLog_, log file and console
+    void clearStatusLine(); //noexcept
+
+    zen::ErrorLog errorLog_; //list of non-resolved errors and warnings
+    LogFileWriter logFileWriter_;
+
+    const bool ignoreErrors_;
+    const size_t automaticRetryCount_;
+    const std::chrono::seconds automaticRetryDelay_;
+
+    const std::wstring jobName_;
+    const std::chrono::system_clock::time_point startTime_;
+
+    const Zstring postSyncCommand_;
+    const PostSyncCondition postSyncCondition_;
+    const PostSyncAction postSyncAction_;
+
+    const bool showStatusLine_; //stdout is a terminal
+    size_t statusLineLen_ = 0;  //number of characters to overwrite
+    bool finalStatusReported_ = false;
+};
+}
+
+#endif //CONSOLE_STATUS_HANDLER_H_0471983461238954
@@ -7,7 +7,9 @@
 #include "db_file.h"
 #include <zen/guid.h>
 #include <zen/crc.h>
+#include <zen/thread.h>
 #include <wx+/zlib_wrap.h>
+#include <wx+/zstd_wrap.h>
 
 
 using namespace zen;
@@ -18,8 +20,20 @@ namespace
 {
 //-------------------------------------------------------------------------------------------------------------------------------
 const char FILE_FORMAT_DESCR[] = "FreeFileSync";
-const int DB_FORMAT_CONTAINER = 10; //since 2017-02-01
-const int DB_FORMAT_STREAM    =  3; //
+const int DB_FORMAT_CONTAINER = 11; //since 2019-01-07: keep older versions from ignoring the journal file
+const int DB_FORMAT_STREAM    =  4; //since 2019-01-14: pluggable codec
+const int DB_FORMAT_JOURNAL   =  1; //since 2019-01-07
+
+//compact journal into base file if it grows too large:
+const size_t DB_JOURNAL_MAX_RECORDS      = 100;
+const size_t DB_JOURNAL_MAX_SIZE_PERCENT =  25; //of the compressed session stream size
+
+enum class StreamCodec : int8_t //persisted!
+{
+    ZLIB = 0,
+    ZSTD = 1,
+};
+const StreamCodec DB_STREAM_CODEC = StreamCodec::ZSTD;
 //-------------------------------------------------------------------------------------------------------------------------------
 
 struct SessionData
@@ -32,18 +46,19 @@ bool operator==(const SessionData& lhs, const SessionData& rhs) { return lhs.isL
 using UniqueId  = std::string;
 using DbStreams = std::map<UniqueId, SessionData>; //list of streams ordered by session UUID
 
+struct JournalData
+{
+    UniqueId journalId; //changes with each journaled save => detect left and right journals being out of sync
+    std::vector<ByteArray> deltaRecords; //compressed, oldest first, lead side data first
+};
+using DbJournals = std::map<UniqueId, JournalData>; //journal per session UUID
+
 /*------------------------------------------------------------------------------
   | ensure 32/64 bit portability: use fixed size data types only e.g. uint32_t |
   ------------------------------------------------------------------------------*/
 
-template <SelectedSide side> inline
-AbstractPath getDatabaseFilePath(const BaseFolderPair& baseFolder, bool tempfile = false)
+AbstractPath getDbFilePathImpl(const AbstractPath& baseFolderPath, const Zstring& dbName, bool tempfile)
 {
-    //Linux and Windows builds are binary incompatible: different file id?, problem with case sensitivity?
-    //precomposed/decomposed UTF? are UTC file times really compatible? what about endianess!?
-    //however 32 and 64-bit FreeFileSync are designed to produce binary-identical db files!
-    //Give db files different names.
-    const Zstring dbName = Zstr(".sync"); //files beginning with dots are hidden e.g. in Nautilus
     Zstring dbFileName;
     if (tempfile) //generate (hopefully) unique file name to avoid clashing with some remnant ffs_tmp file
     {
@@ -51,9 +66,27 @@ AbstractPath getDatabaseFilePath(const BaseFolderPair& baseFolder, bool tempfile
         dbFileName = dbName + Zstr('.') + shortGuid + AFS::TEMP_FILE_ENDING;
     }
     else
-        dbFileName = dbName + SYNC_DB_FILE_ENDING;
+        dbFileName = dbName + SYNC_DB_FILE_ENDING; //journal must share the file ending: excluded from comparison and RealTimeSync
 
-    return AFS::appendRelPath(baseFolder.getAbstractPath<side>(), dbFileName);
+    return AFS::appendRelPath(baseFolderPath, dbFileName);
+}
+
+
+template <SelectedSide side> inline
+AbstractPath getDatabaseFilePath(const BaseFolderPair& baseFolder, bool tempfile = false)
+{
+    //Linux and Windows builds are binary incompatible: different file id?, problem with case sensitivity?
+    //precomposed/decomposed UTF? are UTC file times really compatible? what about endianess!?
+    //however 32 and 64-bit FreeFileSync are designed to produce binary-identical db files!
+    //Give db files different names.
+    return getDbFilePathImpl(baseFolder.getAbstractPath<side>(), Zstr(".sync"), tempfile); //files beginning with dots are hidden e.g. in Nautilus
+}
+
+
+template <SelectedSide side> inline
+AbstractPath getJournalFilePath(const BaseFolderPair& baseFolder, bool tempfile = false)
+{
+    return getDbFilePathImpl(baseFolder.getAbstractPath<side>(), Zstr(".sync.journal"), tempfile);
 }
 
 //#######################################################################################################################################
@@ -86,7 +119,7 @@ void saveStreams(const DbStreams& streamList, const AbstractPath& dbPath, const
 }
 
 
-DbStreams loadStreams(const AbstractPath& dbPath, const IOCallback& notifyUnbufferedIO) //throw FileError, FileErrorDatabaseNotExisting
+DbStreams loadStreams(const AbstractPath& dbPath, const IOCallback& notifyUnbufferedIO, int* formatVersion = nullptr) //throw FileError, FileErrorDatabaseNotExisting
 {
     try
     {
@@ -102,10 +135,14 @@ DbStreams loadStreams(const AbstractPath& dbPath, const IOCallback& notifyUnbuff
         const int version = readNumber<int32_t>(*fileStreamIn); //throw FileError, ErrorFileLocked, X, UnexpectedEndOfStreamError
 
         //TODO: remove migration code at some time! 2017-02-01
-        if (version != 9 &&
+        if (version != 9  &&
+            version != 10 &&
             version != DB_FORMAT_CONTAINER) //read file format version number
             throw FileError(replaceCpy(_("Database file %x is incompatible."), L"%x", fmtPath(AFS::getDisplayPath(dbPath))));
 
+        if (formatVersion) //version 10: same layout as DB_FORMAT_CONTAINER, but older FreeFileSync versions would ignore a journal!
+            *formatVersion = version;
+
         DbStreams output;
 
         //read stream list
@@ -161,6 +198,141 @@ DbStreams loadStreams(const AbstractPath& dbPath, const IOCallback& notifyUnbuff
     }
 }
 
+
+void saveJournal(const DbJournals& journals, const AbstractPath& journalPath, const IOCallback& notifyUnbufferedIO) //throw FileError
+{
+    const std::unique_ptr<AFS::OutputStream> fileStreamOut = AFS::getOutputStream(journalPath, //throw FileError
+                                                                                  nullptr /*streamSize*/,
+                                                                                  notifyUnbufferedIO /*throw X*/);
+    writeArray(*fileStreamOut, FILE_FORMAT_DESCR, sizeof(FILE_FORMAT_DESCR)); //throw FileError, X
+    writeNumber<int32_t>(*fileStreamOut, DB_FORMAT_JOURNAL); //throw FileError, X
+
+    writeNumber<uint32_t>(*fileStreamOut, static_cast<uint32_t>(journals.size())); //throw FileError, X
+    for (const auto& [sessionID, journal] : journals)
+    {
+        writeContainer<std::string>(*fileStreamOut, sessionID);         //throw FileError, X
+        writeContainer<std::string>(*fileStreamOut, journal.journalId); //
+
+        writeNumber<uint32_t>(*fileStreamOut, static_cast<uint32_t>(journal.deltaRecords.size()));
+        for (const ByteArray& delta : journal.deltaRecords)
+            writeContainer<ByteArray>(*fileStreamOut, delta); //throw FileError, X
+    }
+
+    fileStreamOut->finalize(); //throw FileError, X
+}
+
+
+DbJournals loadJournal(const AbstractPath& journalPath, const IOCallback& notifyUnbufferedIO) //throw FileError
+{
+    try
+    {
+        const std::unique_ptr<AFS::InputStream> fileStreamIn = AFS::getInputStream(journalPath, notifyUnbufferedIO); //throw FileError, ErrorFileLocked, X
+
+        char formatDescr[sizeof(FILE_FORMAT_DESCR)] = {};
+        readArray(*fileStreamIn, formatDescr, sizeof(formatDescr)); //throw FileError, ErrorFileLocked, X, UnexpectedEndOfStreamError
+
+        if (!std::equal(FILE_FORMAT_DESCR, FILE_FORMAT_DESCR + sizeof(FILE_FORMAT_DESCR), formatDescr) ||
+            readNumber<int32_t>(*fileStreamIn) != DB_FORMAT_JOURNAL) //throw FileError, ErrorFileLocked, X, UnexpectedEndOfStreamError
+            throw FileError(replaceCpy(_("Database file %x is incompatible."), L"%x", fmtPath(AFS::getDisplayPath(journalPath))));
+
+        DbJournals output;
+
+        size_t journalCount = readNumber<uint32_t>(*fileStreamIn); //throw FileError, ErrorFileLocked, X, UnexpectedEndOfStreamError
+        while (journalCount-- != 0)
+        {
+            const std::string sessionID = readContainer<std::string>(*fileStreamIn); //throw FileError, ErrorFileLocked, X, UnexpectedEndOfStreamError
+
+            JournalData journal;
+            journal.journalId = readContainer<std::string>(*fileStreamIn); //
+
+            size_t deltaCount = readNumber<uint32_t>(*fileStreamIn); //
+            while (deltaCount-- != 0)
+                journal.deltaRecords.push_back(readContainer<ByteArray>(*fileStreamIn)); //
+
+            output[sessionID] = std::move(journal);
+        }
+        return output;
+    }
+    catch (FileError&)
+    {
+        bool journalNotExisting = false;
+        try { journalNotExisting = !AFS::itemStillExists(journalPath); /*throw FileError*/ }
+        catch (FileError&) {} //previous exception is more relevant
+
+        if (journalNotExisting) //journal is optional: nothing to apply on top of the base file
+            return {};
+        throw;
+    }
+    catch (UnexpectedEndOfStreamError&)
+    {
+        throw FileError(_("Database file is corrupted:") + L"\n" + fmtPath(AFS::getDisplayPath(journalPath)), L"Unexpected end of stream.");
+    }
+    catch (const std::bad_alloc& e)
+    {
+        throw FileError(_("Database file is corrupted:") + L"\n" + fmtPath(AFS::getDisplayPath(journalPath)),
+                        _("Out of memory.") + L" " + utfTo<std::wstring>(e.what()));
+    }
+}
+
+
+template <class FunctionL, class FunctionR>
+void saveDbFilesTransactional(const AbstractPath& dbPathLeft,    const AbstractPath& dbPathRight, //throw FileError
+                              const AbstractPath& dbPathLeftTmp, const AbstractPath& dbPathRightTmp,
+                              FunctionL saveLeft /*throw FileError*/, FunctionR saveRight /*throw FileError*/)
+{
+    //write (temp-) files as a transaction
+    saveLeft(dbPathLeftTmp); //throw FileError
+    auto guardTmpL = makeGuard<ScopeGuardRunMode::ON_FAIL>([&] { try { AFS::removeFilePlain(dbPathLeftTmp); } catch (FileError&) {} });
+    saveRight(dbPathRightTmp); //
+    auto guardTmpR = makeGuard<ScopeGuardRunMode::ON_FAIL>([&] { try { AFS::removeFilePlain(dbPathRightTmp); } catch (FileError&) {} });
+
+    //operation finished: rename temp files -> this should work (almost) transactionally:
+    //if there were no write access, creation of temp files would have failed
+    AFS::removeFileIfExists(dbPathLeft);               //throw FileError
+    AFS::moveAndRenameItem(dbPathLeftTmp, dbPathLeft); //throw FileError, (ErrorDifferentVolume)
+    guardTmpL.dismiss();
+
+    AFS::removeFileIfExists(dbPathRight);                //
+    AFS::moveAndRenameItem(dbPathRightTmp, dbPathRight); //
+    guardTmpR.dismiss();
+}
+
+//#######################################################################################################################################
+
+void writeUtf8(MemoryStreamOut<ByteArray>& streamOut, const Zstring& str) { writeContainer(streamOut, utfTo<Zbase<char>>(str)); }
+
+void writeFileDescr(MemoryStreamOut<ByteArray>& streamOut, const InSyncDescrFile& descr)
+{
+    writeNumber<std::int64_t>(streamOut, descr.modTime);
+    writeContainer(streamOut, descr.fileId);
+    static_assert(std::is_same_v<decltype(descr.fileId), Zbase<char>>);
+}
+
+void writeLinkDescr(MemoryStreamOut<ByteArray>& streamOut, const InSyncDescrLink& descr)
+{
+    writeNumber<int64_t>(streamOut, descr.modTime);
+}
+
+
+Zstring readUtf8(MemoryStreamIn<ByteArray>& streamIn) { return utfTo<Zstring>(readContainer<Zbase<char>>(streamIn)); } //throw UnexpectedEndOfStreamError
+//optional: use null-termiation: 5% overall size reduction
+//optional: split into streamInText_/streamInSmallNum_: overall size increase! (why?)
+
+InSyncDescrFile readFileDescr(MemoryStreamIn<ByteArray>& streamIn) //throw UnexpectedEndOfStreamError
+{
+    //attention: order of function argument evaluation is undefined! So do it one after the other...
+    const auto modTime = readNumber<int64_t>(streamIn); //throw UnexpectedEndOfStreamError
+    const AFS::FileId fileId = readContainer<Zbase<char>>(streamIn);
+
+    return InSyncDescrFile(modTime, fileId);
+}
+
+InSyncDescrLink readLinkDescr(MemoryStreamIn<ByteArray>& streamIn) //throw UnexpectedEndOfStreamError
+{
+    const auto modTime = readNumber<int64_t>(streamIn);
+    return InSyncDescrLink(modTime);
+}
+
 //#######################################################################################################################################
 
 class StreamGenerator
@@ -178,28 +350,24 @@ public:
         writeNumber<int32_t>(outL, DB_FORMAT_STREAM);
         writeNumber<int32_t>(outR, DB_FORMAT_STREAM);
 
-        auto compStream = [&](const ByteArray& stream) -> ByteArray //throw FileError
+        auto compStream = [](const ByteArray& stream) -> ByteArray //throw ZstdInternalError
         {
-            try
-            {
-                /* Zlib: optimal level - test case 1 million files
-                level|size [MB]|time [ms]
-                  0    49.54      272 (uncompressed)
-                  1    14.53     1013
-                  2    14.13     1106
-                  3    13.76     1288 - best compromise between speed and compression
-                  4    13.20     1526
-                  5    12.73     1916
-                  6    12.58     2765
-                  7    12.54     3633
-                  8    12.51     9032
-                  9    12.50    19698 (maximal compression) */
-                return compress(stream, 3); //throw ZlibInternalError
-            }
-            catch (ZlibInternalError&)
-            {
-                throw FileError(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(displayFilePathL + L"/" + displayFilePathR)), L"zlib internal error");
-            }
+            /* Zlib: optimal level - test case 1 million files
+            level|size [MB]|time [ms]
+              0    49.54      272 (uncompressed)
+              1    14.53     1013
+              2    14.13     1106
+              3    13.76     1288 - best compromise between speed and compression
+              4    13.20     1526
+              5    12.73     1916
+              6    12.58     2765
+              7    12.54     3633
+              8    12.51     9032
+              9    12.50    19698 (maximal compression)
+
+              Zstd: level 3 (default) compresses similar to zlib level 3, but several times faster */
+            static_assert(DB_STREAM_CODEC == StreamCodec::ZSTD);
+            return compressZstd(stream, 3); //throw ZstdInternalError
         };
 
         StreamGenerator generator;
@@ -207,11 +375,25 @@ public:
         generator.recurse(dbFolder);
         //PERF_STOP
 
-        const ByteArray bufText     = compStream(generator.streamOutText_    .ref());
-        const ByteArray bufSmallNum = compStream(generator.streamOutSmallNum_.ref());
-        const ByteArray bufBigNum   = compStream(generator.streamOutBigNum_  .ref());
+        ByteArray bufText;
+        ByteArray bufSmallNum;
+        ByteArray bufBigNum;
+        try
+        {
+            //compress streams concurrently: capture by value! worker threads may outlive this scope if an exception is thrown
+            auto ftText     = runAsync([stream = generator.streamOutText_    .ref(), compStream] { return compStream(stream); });
+            auto ftSmallNum = runAsync([stream = generator.streamOutSmallNum_.ref(), compStream] { return compStream(stream); });
+            bufBigNum   = compStream(generator.streamOutBigNum_.ref()); //throw ZstdInternalError
+            bufText     = ftText    .get();                             //
+            bufSmallNum = ftSmallNum.get();                             //
+        }
+        catch (ZstdInternalError&)
+        {
+            throw FileError(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(displayFilePathL + L"/" + displayFilePathR)), L"zstd internal error");
+        }
 
         MemoryStreamOut<ByteArray> streamOut;
+        writeNumber<int8_t>(streamOut, static_cast<int8_t>(DB_STREAM_CODEC));
         writeContainer(streamOut, bufText);
         writeContainer(streamOut, bufSmallNum);
         writeContainer(streamOut, bufBigNum);
@@ -233,11 +415,25 @@ public:
     }
 
 private:
+    //hash map iteration order is arbitrary => serialize sorted by name: deterministic output + better compression
+    template <class Map>
+    static std::vector<const typename Map::value_type*> getSortedItems(const Map& itemMap)
+    {
+        std::vector<const typename Map::value_type*> items;
+        items.reserve(itemMap.size());
+        for (const auto& item : itemMap)
+            items.push_back(&item);
+
+        std::sort(items.begin(), items.end(), [](const typename Map::value_type* lhs, const typename Map::value_type* rhs) { return lhs->first < rhs->first; });
+        return items;
+    }
+
     void recurse(const InSyncFolder& container)
     {
         writeNumber<uint32_t>(streamOutSmallNum_, static_cast<uint32_t>(container.files.size()));
-        for (const auto& dbFile : container.files)
+        for (const auto* itFile : getSortedItems(container.files))
         {
+            const auto& dbFile = *itFile;
             writeUtf8(streamOutText_, dbFile.first);
             writeNumber(streamOutSmallNum_, static_cast<int32_t>(dbFile.second.cmpVar));
             writeNumber<uint64_t>(streamOutSmallNum_, dbFile.second.fileSize);
@@ -247,8 +443,9 @@ private:
         }
 
         writeNumber<uint32_t>(streamOutSmallNum_, static_cast<uint32_t>(container.symlinks.size()));
-        for (const auto& dbSymlink : container.symlinks)
+        for (const auto* itSymlink : getSortedItems(container.symlinks))
         {
+            const auto& dbSymlink = *itSymlink;
             writeUtf8(streamOutText_, dbSymlink.first);
             writeNumber(streamOutSmallNum_, static_cast<int32_t>(dbSymlink.second.cmpVar));
 
@@ -266,20 +463,6 @@ private:
         }
     }
 
-    static void writeUtf8(MemoryStreamOut<ByteArray>& streamOut, const Zstring& str) { writeContainer(streamOut, utfTo<Zbase<char>>(str)); }
-
-    static void writeFileDescr(MemoryStreamOut<ByteArray>& streamOut, const InSyncDescrFile& descr)
-    {
-        writeNumber<std::int64_t>(streamOut, descr.modTime);
-        writeContainer(streamOut, descr.fileId);
-        static_assert(std::is_same_v<decltype(descr.fileId), Zbase<char>>);
-    }
-
-    static void writeLinkDescr(MemoryStreamOut<ByteArray>& streamOut, const InSyncDescrLink& descr)
-    {
-        writeNumber<int64_t>(streamOut, descr.modTime);
-    }
-
     //maximize zlib compression by grouping similar data (=> 20% size reduction!)
     // -> further ~5% reduction possible by having one container per data type
     MemoryStreamOut<ByteArray> streamOutText_;     //
@@ -309,6 +492,42 @@ public:
             }
         };
 
+        //decompress streams concurrently
+        auto decompStreams = [&](StreamCodec codec, const ByteArray& bufText, const ByteArray& bufSmallNum, const ByteArray& bufBigNum) //throw FileError
+        {
+            auto decompStreamAsync = [codec](const ByteArray& stream) //throw ZlibInternalError, ZstdInternalError
+            {
+                //capture by value! worker threads may outlive this scope if an exception is thrown
+                return runAsync([codec, stream]
+                {
+                    switch (codec)
+                    {
+                        case StreamCodec::ZLIB:
+                            return decompress(stream); //throw ZlibInternalError
+                        case StreamCodec::ZSTD:
+                            return decompressZstd(stream); //throw ZstdInternalError
+                    }
+                    assert(false);
+                    return ByteArray();
+                });
+            };
+            try
+            {
+                auto ftText     = decompStreamAsync(bufText);
+                auto ftSmallNum = decompStreamAsync(bufSmallNum);
+                auto ftBigNum   = decompStreamAsync(bufBigNum);
+                return std::make_tuple(ftText.get(), ftSmallNum.get(), ftBigNum.get()); //throw ZlibInternalError, ZstdInternalError
+            }
+            catch (ZlibInternalError&)
+            {
+                throw FileError(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(displayFilePathL + L"/" + displayFilePathR)), L"Zlib internal error");
+            }
+            catch (ZstdInternalError&)
+            {
+                throw FileError(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(displayFilePathL + L"/" + displayFilePathR)), L"zstd internal error");
+            }
+        };
+
         try
         {
             MemoryStreamIn<ByteArray> streamInL(streamL);
@@ -320,8 +539,9 @@ public:
             if (streamVersion != streamVersionR)
                 throw FileError(_("Database file is corrupted:") + L"\n" + fmtPath(displayFilePathL) + L"\n" + fmtPath(displayFilePathR), L"Different stream formats");
 
-            //TODO: remove migration code at some time! 2017-02-01
+            //TODO: remove migration code at some time! 2017-02-01 + 2019-01-14
             if (streamVersion != 2 &&
+                streamVersion != 3 &&
                 streamVersion != DB_FORMAT_STREAM)
                 throw FileError(replaceCpy(_("Database file %x is incompatible."), L"%x", fmtPath(displayFilePathL)), L"Unknown stream format");
 
@@ -372,15 +592,25 @@ public:
                 if (sizePart2 > 0) readArray(streamInPart2, &*buf.begin() + sizePart1, sizePart2); //
 
                 MemoryStreamIn<ByteArray> streamIn(buf);
+
+                StreamCodec codec = StreamCodec::ZLIB;
+                //TODO: remove migration code at some time! 2019-01-14
+                if (streamVersion != 3)
+                {
+                    codec = static_cast<StreamCodec>(readNumber<int8_t>(streamIn)); //throw UnexpectedEndOfStreamError
+                    if (codec != StreamCodec::ZLIB &&
+                        codec != StreamCodec::ZSTD)
+                        throw FileError(replaceCpy(_("Database file %x is incompatible."), L"%x", fmtPath(displayFilePathL)), L"Unknown stream codec");
+                }
+
                 const ByteArray bufText     = readContainer<ByteArray>(streamIn); //
                 const ByteArray bufSmallNum = readContainer<ByteArray>(streamIn); //throw UnexpectedEndOfStreamError
                 const ByteArray bufBigNum   = readContainer<ByteArray>(streamIn); //
 
+                const auto [bufTextDec, bufSmallNumDec, bufBigNumDec] = decompStreams(codec, bufText, bufSmallNum, bufBigNum); //throw FileError
+
                 auto output = std::make_shared<InSyncFolder>(InSyncFolder::DIR_STATUS_IN_SYNC);
-                StreamParser parser(streamVersion,
-                                    decompStream(bufText),
-                                    decompStream(bufSmallNum),
-                                    decompStream(bufBigNum)); //throw FileError
+                StreamParser parser(streamVersion, bufTextDec, bufSmallNumDec, bufBigNumDec);
                 if (leadStreamLeft)
                     parser.recurse<LEFT_SIDE>(*output); //throw UnexpectedEndOfStreamError
                 else
@@ -452,25 +682,6 @@ private:
         }
     }
 
-    static Zstring readUtf8(MemoryStreamIn<ByteArray>& streamIn) { return utfTo<Zstring>(readContainer<Zbase<char>>(streamIn)); } //throw UnexpectedEndOfStreamError
-    //optional: use null-termiation: 5% overall size reduction
-    //optional: split into streamInText_/streamInSmallNum_: overall size increase! (why?)
-
-    static InSyncDescrFile readFileDescr(MemoryStreamIn<ByteArray>& streamIn) //throw UnexpectedEndOfStreamError
-    {
-        //attention: order of function argument evaluation is undefined! So do it one after the other...
-        const auto modTime = readNumber<int64_t>(streamIn); //throw UnexpectedEndOfStreamError
-        const AFS::FileId fileId = readContainer<Zbase<char>>(streamIn);
-
-        return InSyncDescrFile(modTime, fileId);
-    }
-
-    static InSyncDescrLink readLinkDescr(MemoryStreamIn<ByteArray>& streamIn) //throw UnexpectedEndOfStreamError
-    {
-        const auto modTime = readNumber<int64_t>(streamIn);
-        return InSyncDescrLink(modTime);
-    }
-
     //TODO: remove migration code at some time! 2017-02-01
     class StreamParserV2
     {
@@ -530,6 +741,192 @@ private:
 
 //#######################################################################################################################################
 
+struct InSyncFolderDelta //changes applied to the last synchronous state by a single sync
+{
+    InSyncFolder::InSyncStatus status = InSyncFolder::DIR_STATUS_STRAW_MAN;
+    bool statusChanged = false; //folder entry was added or its status modified
+
+    InSyncFolder::FileList    filesUpdated;    //added or modified items
+    InSyncFolder::SymlinkList symlinksUpdated; //
+    std::map<Zstring, InSyncFolderDelta> foldersUpdated; //folders with changes in status or child items
+
+    std::vector<Zstring> filesRemoved;    //
+    std::vector<Zstring> symlinksRemoved; //key: item name in Unicode normal form (see InSyncFolder)
+    std::vector<Zstring> foldersRemoved;  //
+
+    bool empty() const //foldersUpdated contains non-empty deltas only!
+    {
+        return !statusChanged &&
+               filesUpdated   .empty() && filesRemoved   .empty() &&
+               symlinksUpdated.empty() && symlinksRemoved.empty() &&
+               foldersUpdated .empty() && foldersRemoved .empty();
+    }
+};
+
+
+class JournalGenerator
+{
+public:
+    static ByteArray execute(const InSyncFolderDelta& delta, bool leadStreamLeft, //throw FileError
+                             const std::wstring& displayFilePathL, //used for diagnostics only
+                             const std::wstring& displayFilePathR)
+    {
+        JournalGenerator generator;
+        if (leadStreamLeft)
+            generator.recurse<LEFT_SIDE>(delta);
+        else
+            generator.recurse<RIGHT_SIDE>(delta);
+
+        try
+        {
+            return compress(generator.streamOut_.ref(), 3); //throw ZlibInternalError
+        }
+        catch (ZlibInternalError&)
+        {
+            throw FileError(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(displayFilePathL + L"/" + displayFilePathR)), L"zlib internal error");
+        }
+    }
+
+private:
+    //delta records are small => no need to split into separate streams like StreamGenerator
+    template <SelectedSide leadSide>
+    void recurse(const InSyncFolderDelta& delta)
+    {
+        writeNumber<uint32_t>(streamOut_, static_cast<uint32_t>(delta.filesUpdated.size()));
+        for (const auto& [fileName, dbFile] : delta.filesUpdated)
+        {
+            writeUtf8(streamOut_, fileName);
+            writeNumber<int32_t>(streamOut_, static_cast<int32_t>(dbFile.cmpVar));
+            writeNumber<uint64_t>(streamOut_, dbFile.fileSize);
+
+            writeFileDescr(streamOut_, SelectParam<leadSide>::ref(dbFile.left, dbFile.right));
+            writeFileDescr(streamOut_, SelectParam<leadSide>::ref(dbFile.right, dbFile.left));
+        }
+        writeItemNames(delta.filesRemoved);
+
+        writeNumber<uint32_t>(streamOut_, static_cast<uint32_t>(delta.symlinksUpdated.size()));
+        for (const auto& [linkName, dbSymlink] : delta.symlinksUpdated)
+        {
+            writeUtf8(streamOut_, linkName);
+            writeNumber<int32_t>(streamOut_, static_cast<int32_t>(dbSymlink.cmpVar));
+
+            writeLinkDescr(streamOut_, SelectParam<leadSide>::ref(dbSymlink.left, dbSymlink.right));
+            writeLinkDescr(streamOut_, SelectParam<leadSide>::ref(dbSymlink.right, dbSymlink.left));
+        }
+        writeItemNames(delta.symlinksRemoved);
+
+        writeItemNames(delta.foldersRemoved);
+        writeNumber<uint32_t>(streamOut_, static_cast<uint32_t>(delta.foldersUpdated.size()));
+        for (const auto& [folderName, folderDelta] : delta.foldersUpdated)
+        {
+            writeUtf8(streamOut_, folderName);
+            writeNumber<int32_t>(streamOut_, folderDelta.status);
+
+            recurse<leadSide>(folderDelta);
+        }
+    }
+
+    void writeItemNames(const std::vector<Zstring>& itemNames)
+    {
+        writeNumber<uint32_t>(streamOut_, static_cast<uint32_t>(itemNames.size()));
+        for (const Zstring& itemName : itemNames)
+            writeUtf8(streamOut_, itemName);
+    }
+
+    MemoryStreamOut<ByteArray> streamOut_;
+};
+
+
+class JournalParser
+{
+public:
+    static void execute(InSyncFolder& dbFolder, const ByteArray& deltaRecord, bool leadStreamLeft, //throw FileError
+                        const std::wstring& displayFilePathL, //used for diagnostics only
+                        const std::wstring& displayFilePathR)
+    {
+        try
+        {
+            JournalParser parser(decompress(deltaRecord)); //throw ZlibInternalError
+            if (leadStreamLeft)
+                parser.recurse<LEFT_SIDE>(dbFolder); //throw UnexpectedEndOfStreamError
+            else
+                parser.recurse<RIGHT_SIDE>(dbFolder); //throw UnexpectedEndOfStreamError
+        }
+        catch (ZlibInternalError&)
+        {
+            throw FileError(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(displayFilePathL + L"/" + displayFilePathR)), L"Zlib internal error");
+        }
+        catch (const UnexpectedEndOfStreamError&)
+        {
+            throw FileError(_("Database file is corrupted:") + L"\n" + fmtPath(displayFilePathL) + L"\n" + fmtPath(displayFilePathR), L"Unexpected end of stream.");
+        }
+        catch (const std::bad_alloc& e)
+        {
+            throw FileError(_("Database file is corrupted:") + L"\n" + fmtPath(displayFilePathL) + L"\n" + fmtPath(displayFilePathR),
+                            _("Out of memory.") + L" " + utfTo<std::wstring>(e.what()));
+        }
+    }
+
+private:
+    JournalParser(const ByteArray& stream) : streamIn_(stream) {}
+
+    template <SelectedSide leadSide>
+    void recurse(InSyncFolder& container) //throw UnexpectedEndOfStreamError
+    {
+        size_t fileCount = readNumber<uint32_t>(streamIn_);
+        while (fileCount-- != 0)
+        {
+            const Zstring itemName = readUtf8(streamIn_);
+            const auto cmpVar = static_cast<CompareVariant>(readNumber<int32_t>(streamIn_));
+            const uint64_t fileSize = readNumber<uint64_t>(streamIn_);
+
+            const InSyncDescrFile dataL = readFileDescr(streamIn_);
+            const InSyncDescrFile dataT = readFileDescr(streamIn_);
+
+            container.files.insert_or_assign(getUnicodeNormalForm(itemName), InSyncFile(SelectParam<leadSide>::ref(dataL, dataT),
+                                                                  SelectParam<leadSide>::ref(dataT, dataL), cmpVar, fileSize));
+        }
+        size_t fileRemoveCount = readNumber<uint32_t>(streamIn_);
+        while (fileRemoveCount-- != 0)
+            container.files.erase(getUnicodeNormalForm(readUtf8(streamIn_)));
+
+        size_t linkCount = readNumber<uint32_t>(streamIn_);
+        while (linkCount-- != 0)
+        {
+            const Zstring itemName = readUtf8(streamIn_);
+            const auto cmpVar = static_cast<CompareVariant>(readNumber<int32_t>(streamIn_));
+
+            const InSyncDescrLink dataL = readLinkDescr(streamIn_);
+            const InSyncDescrLink dataT = readLinkDescr(streamIn_);
+
+            container.symlinks.insert_or_assign(getUnicodeNormalForm(itemName), InSyncSymlink(SelectParam<leadSide>::ref(dataL, dataT),
+                                                                        SelectParam<leadSide>::ref(dataT, dataL), cmpVar));
+        }
+        size_t linkRemoveCount = readNumber<uint32_t>(streamIn_);
+        while (linkRemoveCount-- != 0)
+            container.symlinks.erase(getUnicodeNormalForm(readUtf8(streamIn_)));
+
+        size_t dirRemoveCount = readNumber<uint32_t>(streamIn_);
+        while (dirRemoveCount-- != 0)
+            container.folders.erase(getUnicodeNormalForm(readUtf8(streamIn_)));
+
+        size_t dirCount = readNumber<uint32_t>(streamIn_);
+        while (dirCount-- != 0)
+        {
+            const Zstring itemName = readUtf8(streamIn_);
+            const auto status = static_cast<InSyncFolder::InSyncStatus>(readNumber<int32_t>(streamIn_));
+
+            InSyncFolder& dbFolder = container.addFolder(itemName, status); //get or create
+            dbFolder.status = status;
+            recurse<leadSide>(dbFolder);
+        }
+    }
+
+    MemoryStreamIn<ByteArray> streamIn_;
+};
+
+//#######################################################################################################################################
+
 class LastSynchronousStateUpdater
 {
     /*
@@ -539,10 +936,10 @@ class LastSynchronousStateUpdater
         => update all database entries!
     */
 public:
-    static void execute(const BaseFolderPair& baseFolder, InSyncFolder& dbFolder)
+    static void execute(const BaseFolderPair& baseFolder, InSyncFolder& dbFolder, InSyncFolderDelta& delta)
     {
         LastSynchronousStateUpdater updater(baseFolder.getCompVariant(), baseFolder.getFilter());
-        updater.recurse(baseFolder, dbFolder);
+        updater.recurse(baseFolder, dbFolder, delta);
     }
 
 private:
@@ -550,27 +947,36 @@ private:
         filter_(filter),
         activeCmpVar_(activeCmpVar) {}
 
-    void recurse(const ContainerObject& hierObj, InSyncFolder& dbFolder)
+    void recurse(const ContainerObject& hierObj, InSyncFolder& dbFolder, InSyncFolderDelta& delta)
     {
-        process(hierObj.refSubFiles  (), hierObj.getRelativePathAny(), dbFolder.files);
-        process(hierObj.refSubLinks  (), hierObj.getRelativePathAny(), dbFolder.symlinks);
-        process(hierObj.refSubFolders(), hierObj.getRelativePathAny(), dbFolder.folders);
+        process(hierObj.refSubFiles  (), hierObj.getRelativePathAny(), dbFolder.files,    delta);
+        process(hierObj.refSubLinks  (), hierObj.getRelativePathAny(), dbFolder.symlinks, delta);
+        process(hierObj.refSubFolders(), hierObj.getRelativePathAny(), dbFolder.folders,  delta);
     }
 
     template <class M, class V>
-    static V& mapAddOrUpdate(M& map, const Zstring& key, V&& value)
+    static bool mapAddOrUpdate(M& map, const Zstring& key, const V& value) //return true if added or changed
     {
         //C++17's map::try_emplace() is faster than map::emplace() if key is already existing
-        auto rv = map.try_emplace(key, std::forward<V>(value)); //and does NOT MOVE r-value arguments unlike map::emplace()!
+        auto rv = map.try_emplace(key, value);
         if (!rv.second)
-            rv.first->second = std::forward<V>(value);
+        {
+            if (rv.first->second == value)
+                return false;
+            rv.first->second = value;
+        }
+        return true;
+    }
 
-        return rv.first->second;
+    static void addFolderDelta(InSyncFolderDelta& delta, const Zstring& folderName, InSyncFolderDelta&& folderDelta)
+    {
+        if (!folderDelta.empty()) //keep delta size proportional to the change set
+            delta.foldersUpdated.emplace(folderName, std::move(folderDelta));
     }
 
-    void process(const ContainerObject::FileList& currentFiles, const Zstring& parentRelPath, InSyncFolder::FileList& dbFiles)
+    void process(const ContainerObject::FileList& currentFiles, const Zstring& parentRelPath, InSyncFolder::FileList& dbFiles, InSyncFolderDelta& delta)
     {
-        std::set<Zstring, LessUnicodeNormal> toPreserve;
+        std::unordered_set<Zstring, StringHash> toPreserve; //item names in Unicode normal form
 
         for (const FilePair& file : currentFiles)
             if (!file.isPairEmpty())
@@ -584,19 +990,21 @@ private:
                     assert(file.getFileSize<LEFT_SIDE>() == file.getFileSize<RIGHT_SIDE>());
 
                     //create or update new "in-sync" state
-                    mapAddOrUpdate(dbFiles, file.getItemNameAny(),
-                                   InSyncFile(InSyncDescrFile(file.getLastWriteTime< LEFT_SIDE>(),
-                                                              file.getFileId       < LEFT_SIDE>()),
-                                              InSyncDescrFile(file.getLastWriteTime<RIGHT_SIDE>(),
-                                                              file.getFileId       <RIGHT_SIDE>()),
-                                              activeCmpVar_,
-                                              file.getFileSize<LEFT_SIDE>()));
-                    toPreserve.insert(file.getItemNameAny());
+                    const InSyncFile dbFile(InSyncDescrFile(file.getLastWriteTime< LEFT_SIDE>(),
+                                                            file.getFileId       < LEFT_SIDE>()),
+                                            InSyncDescrFile(file.getLastWriteTime<RIGHT_SIDE>(),
+                                                            file.getFileId       <RIGHT_SIDE>()),
+                                            activeCmpVar_,
+                                            file.getFileSize<LEFT_SIDE>());
+                    const Zstring& fileNameNorm = getUnicodeNormalForm(file.getItemNameAny());
+                    if (mapAddOrUpdate(dbFiles, fileNameNorm, dbFile))
+                        delta.filesUpdated.insert_or_assign(fileNameNorm, dbFile);
+                    toPreserve.insert(fileNameNorm);
                 }
                 else //not in sync: preserve last synchronous state
                 {
-                    toPreserve.insert(file.getItemName< LEFT_SIDE>()); //left/right may differ in case!
-                    toPreserve.insert(file.getItemName<RIGHT_SIDE>()); //
+                    toPreserve.insert(getUnicodeNormalForm(file.getItemName< LEFT_SIDE>())); //left/right may differ in case!
+                    toPreserve.insert(getUnicodeNormalForm(file.getItemName<RIGHT_SIDE>())); //
                 }
             }
 
@@ -607,14 +1015,17 @@ private:
                 return false;
             //all items not existing in "currentFiles" have either been deleted meanwhile or been excluded via filter:
             const Zstring& itemRelPath = nativeAppendPaths(parentRelPath, v.first);
-            return filter_.passFileFilter(itemRelPath);
+            if (!filter_.passFileFilter(itemRelPath))
+                return false;
             //note: items subject to traveral errors are also excluded by this file filter here! see comparison.cpp, modified file filter for read errors
+            delta.filesRemoved.push_back(v.first);
+            return true;
         });
     }
 
-    void process(const ContainerObject::SymlinkList& currentSymlinks, const Zstring& parentRelPath, InSyncFolder::SymlinkList& dbSymlinks)
+    void process(const ContainerObject::SymlinkList& currentSymlinks, const Zstring& parentRelPath, InSyncFolder::SymlinkList& dbSymlinks, InSyncFolderDelta& delta)
     {
-        std::set<Zstring, LessUnicodeNormal> toPreserve;
+        std::unordered_set<Zstring, StringHash> toPreserve; //item names in Unicode normal form
 
         for (const SymlinkPair& symlink : currentSymlinks)
             if (!symlink.isPairEmpty())
@@ -624,16 +1035,18 @@ private:
                     assert(getUnicodeNormalForm(symlink.getItemName<LEFT_SIDE>()) == getUnicodeNormalForm(symlink.getItemName<RIGHT_SIDE>()));
 
                     //create or update new "in-sync" state
-                    mapAddOrUpdate(dbSymlinks, symlink.getItemNameAny(),
-                                   InSyncSymlink(InSyncDescrLink(symlink.getLastWriteTime< LEFT_SIDE>()),
-                                                 InSyncDescrLink(symlink.getLastWriteTime<RIGHT_SIDE>()),
-                                                 activeCmpVar_));
-                    toPreserve.insert(symlink.getItemNameAny());
+                    const InSyncSymlink dbSymlink(InSyncDescrLink(symlink.getLastWriteTime< LEFT_SIDE>()),
+                                                  InSyncDescrLink(symlink.getLastWriteTime<RIGHT_SIDE>()),
+                                                  activeCmpVar_);
+                    const Zstring& linkNameNorm = getUnicodeNormalForm(symlink.getItemNameAny());
+                    if (mapAddOrUpdate(dbSymlinks, linkNameNorm, dbSymlink))
+                        delta.symlinksUpdated.insert_or_assign(linkNameNorm, dbSymlink);
+                    toPreserve.insert(linkNameNorm);
                 }
                 else //not in sync: preserve last synchronous state
                 {
-                    toPreserve.insert(symlink.getItemName< LEFT_SIDE>()); //left/right may differ in case!
-                    toPreserve.insert(symlink.getItemName<RIGHT_SIDE>()); //
+                    toPreserve.insert(getUnicodeNormalForm(symlink.getItemName< LEFT_SIDE>())); //left/right may differ in case!
+                    toPreserve.insert(getUnicodeNormalForm(symlink.getItemName<RIGHT_SIDE>())); //
                 }
             }
 
@@ -644,11 +1057,14 @@ private:
                 return false;
             //all items not existing in "currentSymlinks" have either been deleted meanwhile or been excluded via filter:
             const Zstring& itemRelPath = nativeAppendPaths(parentRelPath, v.first);
-            return filter_.passFileFilter(itemRelPath);
+            if (!filter_.passFileFilter(itemRelPath))
+                return false;
+            delta.symlinksRemoved.push_back(v.first);
+            return true;
         });
     }
 
-    void process(const ContainerObject::FolderList& currentFolders, const Zstring& parentRelPath, InSyncFolder::FolderList& dbFolders)
+    void process(const ContainerObject::FolderList& currentFolders, const Zstring& parentRelPath, InSyncFolder::FolderList& dbFolders, InSyncFolderDelta& delta)
     {
         std::unordered_set<const InSyncFolder*> toPreserve;
 
@@ -660,28 +1076,42 @@ private:
                     assert(getUnicodeNormalForm(folder.getItemName<LEFT_SIDE>()) == getUnicodeNormalForm(folder.getItemName<RIGHT_SIDE>()));
 
                     //update directory entry only (shallow), but do *not touch* exising child elements!!!
-                    InSyncFolder& dbFolder = dbFolders.emplace(folder.getItemNameAny(), InSyncFolder(InSyncFolder::DIR_STATUS_IN_SYNC)).first->second; //get or create
+                    const Zstring& folderNameNorm = getUnicodeNormalForm(folder.getItemNameAny());
+                    auto rv = dbFolders.emplace(folderNameNorm, InSyncFolder(InSyncFolder::DIR_STATUS_IN_SYNC)); //get or create
+                    InSyncFolder& dbFolder = rv.first->second;
+
+                    InSyncFolderDelta folderDelta;
+                    folderDelta.status = InSyncFolder::DIR_STATUS_IN_SYNC;
+                    folderDelta.statusChanged = rv.second || dbFolder.status != InSyncFolder::DIR_STATUS_IN_SYNC;
+
                     dbFolder.status = InSyncFolder::DIR_STATUS_IN_SYNC; //update immediate directory entry
 
                     toPreserve.insert(&dbFolder);
-                    recurse(folder, dbFolder);
+                    recurse(folder, dbFolder, folderDelta);
+                    addFolderDelta(delta, folderNameNorm, std::move(folderDelta));
                 }
                 else //not in sync: preserve last synchronous state
                 {
-                    auto preserveDbEntry = [&](const Zstring& folderName)
+                    auto preserveDbEntry = [&](const Zstring& folderNameNorm)
                     {
-                        auto it = dbFolders.find(folderName);
+                        auto it = dbFolders.find(folderNameNorm);
                         if (it != dbFolders.end())
                         {
+                            InSyncFolderDelta folderDelta;
+                            folderDelta.status = it->second.status;
+
                             toPreserve.insert(&it->second);
-                            recurse(folder, it->second); //required: existing child-items may not be in sync, but items deleted on both sides *are* in-sync!!!
+                            recurse(folder, it->second, folderDelta); //required: existing child-items may not be in sync, but items deleted on both sides *are* in-sync!!!
+                            addFolderDelta(delta, it->first, std::move(folderDelta));
                         }
                     };
-                    preserveDbEntry(folder.getItemName<LEFT_SIDE>());
+                    const Zstring& folderNameNormL = getUnicodeNormalForm(folder.getItemName< LEFT_SIDE>());
+                    const Zstring& folderNameNormR = getUnicodeNormalForm(folder.getItemName<RIGHT_SIDE>());
+                    preserveDbEntry(folderNameNormL);
 
                     //folder match with names differing in case? => treat like any other folder rename => no *new* database entries even if child items are in sync
-                    if (getUnicodeNormalForm(folder.getItemName<LEFT_SIDE>()) != getUnicodeNormalForm(folder.getItemName<RIGHT_SIDE>()))
-                        preserveDbEntry(folder.getItemName<RIGHT_SIDE>());
+                    if (folderNameNormL != folderNameNormR)
+                        preserveDbEntry(folderNameNormR);
                 }
             }
 
@@ -698,16 +1128,35 @@ private:
             bool childItemMightMatch = true;
             const bool passFilter = filter_.passDirFilter(itemRelPath, &childItemMightMatch);
             if (!passFilter && childItemMightMatch)
-                dbSetEmptyState(v.second, appendSeparator(itemRelPath)); //child items might match, e.g. *.txt include filter!
+                dbSetEmptyState(v, appendSeparator(itemRelPath), delta); //child items might match, e.g. *.txt include filter!
+            if (passFilter)
+                delta.foldersRemoved.push_back(v.first);
             return passFilter;
         });
     }
 
     //delete all entries for removed folder (= "in-sync") from database
-    void dbSetEmptyState(InSyncFolder& dbFolder, const Zstring& parentRelPathPf)
+    void dbSetEmptyState(InSyncFolder::FolderList::value_type& dbFolderEntry, const Zstring& parentRelPathPf, InSyncFolderDelta& parentDelta)
     {
-        eraseIf(dbFolder.files,    [&](const InSyncFolder::FileList   ::value_type& v) { return filter_.passFileFilter(parentRelPathPf + v.first); });
-        eraseIf(dbFolder.symlinks, [&](const InSyncFolder::SymlinkList::value_type& v) { return filter_.passFileFilter(parentRelPathPf + v.first); });
+        InSyncFolder& dbFolder = dbFolderEntry.second;
+
+        InSyncFolderDelta delta;
+        delta.status = dbFolder.status;
+
+        eraseIf(dbFolder.files, [&](const InSyncFolder::FileList::value_type& v)
+        {
+            if (!filter_.passFileFilter(parentRelPathPf + v.first))
+                return false;
+            delta.filesRemoved.push_back(v.first);
+            return true;
+        });
+        eraseIf(dbFolder.symlinks, [&](const InSyncFolder::SymlinkList::value_type& v)
+        {
+            if (!filter_.passFileFilter(parentRelPathPf + v.first))
+                return false;
+            delta.symlinksRemoved.push_back(v.first);
+            return true;
+        });
 
         eraseIf(dbFolder.folders, [&](InSyncFolder::FolderList::value_type& v)
         {
@@ -716,9 +1165,13 @@ private:
             bool childItemMightMatch = true;
             const bool passFilter = filter_.passDirFilter(itemRelPath, &childItemMightMatch);
             if (!passFilter && childItemMightMatch)
-                dbSetEmptyState(v.second, appendSeparator(itemRelPath));
+                dbSetEmptyState(v, appendSeparator(itemRelPath), delta);
+            if (passFilter)
+                delta.foldersRemoved.push_back(v.first);
             return passFilter;
         });
+
+        addFolderDelta(parentDelta, dbFolderEntry.first, std::move(delta));
     }
 
     const PathFilter& filter_; //filter used while scanning directory: generates view on actual files!
@@ -777,6 +1230,32 @@ std::pair<DbStreams::const_iterator,
 
     return { itCommonL, itCommonR };
 }
+
+
+const JournalData* getSessionJournal(const DbJournals& journalsLeft, const DbJournals& journalsRight, const UniqueId& sessionID) //throw FileErrorDatabaseNotExisting
+{
+    auto itL = journalsLeft .find(sessionID);
+    auto itR = journalsRight.find(sessionID);
+
+    if (itL == journalsLeft.end() && itR == journalsRight.end())
+        return nullptr; //base file is up to date
+
+    //journals must have been written by the same sync: one of them may be outdated, e.g. a former copy or the second rename failed
+    if (itL == journalsLeft.end() || itR == journalsRight.end() || itL->second.journalId != itR->second.journalId)
+        throw FileErrorDatabaseNotExisting(_("Initial synchronization:") + L" \n" +
+                                           _("The database files do not yet contain information about the last synchronization."));
+    assert(itL->second.deltaRecords == itR->second.deltaRecords);
+    return &itL->second;
+}
+
+
+//remove journals not belonging to any session of the base file
+bool discardOrphanedJournals(DbJournals& journals, const DbStreams& streams) //return true if journals were changed
+{
+    const size_t journalCountOld = journals.size();
+    eraseIf(journals, [&](const DbJournals::value_type& v) { return streams.find(v.first) == streams.end(); });
+    return journals.size() != journalCountOld;
+}
 }
 
 //#######################################################################################################################################
@@ -815,9 +1294,25 @@ std::shared_ptr<InSyncFolder> fff::loadLastSynchronousState(const BaseFolderPair
     const ByteArray& streamL = session.first ->second.rawStream;
     const ByteArray& streamR = session.second->second.rawStream;
 
-    return StreamParser::execute(leadStreamLeft, streamL, streamR, //throw FileError
-                                 AFS::getDisplayPath(dbPathLeft),
-                                 AFS::getDisplayPath(dbPathRight));
+    std::shared_ptr<InSyncFolder> lastSyncState = StreamParser::execute(leadStreamLeft, streamL, streamR, //throw FileError
+                                                                        AFS::getDisplayPath(dbPathLeft),
+                                                                        AFS::getDisplayPath(dbPathRight));
+    //apply changes of the syncs since the base file was written:
+    const AbstractPath journalPathLeft  = getJournalFilePath< LEFT_SIDE>(baseFolder);
+    const AbstractPath journalPathRight = getJournalFilePath<RIGHT_SIDE>(baseFolder);
+
+    StreamStatusNotifier notifyJournalL(replaceCpy(_("Loading file %x..."), L"%x", fmtPath(AFS::getDisplayPath(journalPathLeft) )), notifyStatus);
+    StreamStatusNotifier notifyJournalR(replaceCpy(_("Loading file %x..."), L"%x", fmtPath(AFS::getDisplayPath(journalPathRight))), notifyStatus);
+
+    const DbJournals journalsLeft  = ::loadJournal(journalPathLeft,  notifyJournalL); //throw FileError, X
+    const DbJournals journalsRight = ::loadJournal(journalPathRight, notifyJournalR); //
+
+    if (const JournalData* journal = getSessionJournal(journalsLeft, journalsRight, session.first->first)) //throw FileErrorDatabaseNotExisting
+        for (const ByteArray& deltaRecord : journal->deltaRecords)
+            JournalParser::execute(*lastSyncState, deltaRecord, leadStreamLeft, //throw FileError
+                                   AFS::getDisplayPath(journalPathLeft),
+                                   AFS::getDisplayPath(journalPathRight));
+    return lastSyncState;
 }
 
 
@@ -830,25 +1325,52 @@ void fff::saveLastSynchronousState(const BaseFolderPair& baseFolder, const std::
     const AbstractPath dbPathLeftTmp  = getDatabaseFilePath< LEFT_SIDE>(baseFolder, true /*tempfile*/);
     const AbstractPath dbPathRightTmp = getDatabaseFilePath<RIGHT_SIDE>(baseFolder, true /*tempfile*/);
 
+    const AbstractPath journalPathLeft  = getJournalFilePath< LEFT_SIDE>(baseFolder);
+    const AbstractPath journalPathRight = getJournalFilePath<RIGHT_SIDE>(baseFolder);
+
+    const AbstractPath journalPathLeftTmp  = getJournalFilePath< LEFT_SIDE>(baseFolder, true /*tempfile*/);
+    const AbstractPath journalPathRightTmp = getJournalFilePath<RIGHT_SIDE>(baseFolder, true /*tempfile*/);
+
     StreamStatusNotifier notifyLoadL(replaceCpy(_("Loading file %x..."), L"%x", fmtPath(AFS::getDisplayPath(dbPathLeft) )), notifyStatus);
     StreamStatusNotifier notifyLoadR(replaceCpy(_("Loading file %x..."), L"%x", fmtPath(AFS::getDisplayPath(dbPathRight))), notifyStatus);
 
+    StreamStatusNotifier notifyLoadJournalL(replaceCpy(_("Loading file %x..."), L"%x", fmtPath(AFS::getDisplayPath(journalPathLeft) )), notifyStatus);
+    StreamStatusNotifier notifyLoadJournalR(replaceCpy(_("Loading file %x..."), L"%x", fmtPath(AFS::getDisplayPath(journalPathRight))), notifyStatus);
+
     StreamStatusNotifier notifySaveL(replaceCpy(_("Saving file %x..."), L"%x", fmtPath(AFS::getDisplayPath(dbPathLeft) )), notifyStatus);
     StreamStatusNotifier notifySaveR(replaceCpy(_("Saving file %x..."), L"%x", fmtPath(AFS::getDisplayPath(dbPathRight))), notifyStatus);
 
+    StreamStatusNotifier notifySaveJournalL(replaceCpy(_("Saving file %x..."), L"%x", fmtPath(AFS::getDisplayPath(journalPathLeft) )), notifyStatus);
+    StreamStatusNotifier notifySaveJournalR(replaceCpy(_("Saving file %x..."), L"%x", fmtPath(AFS::getDisplayPath(journalPathRight))), notifyStatus);
+
     //(try to) load old database files...
     DbStreams streamsLeft; //list of session ID + DirInfo-stream
     DbStreams streamsRight;
+    int formatVersionL = 0;
+    int formatVersionR = 0;
 
-    try { streamsLeft  = ::loadStreams(dbPathLeft, notifyLoadL); }
+    try { streamsLeft  = ::loadStreams(dbPathLeft,  notifyLoadL, &formatVersionL); }
     catch (FileError&) {}
-    try { streamsRight = ::loadStreams(dbPathRight, notifyLoadR); }
+    try { streamsRight = ::loadStreams(dbPathRight, notifyLoadR, &formatVersionR); }
     catch (FileError&) {}
     //if error occurs: just overwrite old file! User is already informed about issues right after comparing!
 
+    DbJournals journalsLeft;
+    DbJournals journalsRight;
+    bool journalsChangedL = false;
+    bool journalsChangedR = false;
+
+    try { journalsLeft  = ::loadJournal(journalPathLeft,  notifyLoadJournalL); }
+    catch (FileError&) { journalsChangedL = true; } //overwrite corrupted journal
+    try { journalsRight = ::loadJournal(journalPathRight, notifyLoadJournalR); }
+    catch (FileError&) { journalsChangedR = true; }
+
     auto lastSyncState = std::make_shared<InSyncFolder>(InSyncFolder::DIR_STATUS_IN_SYNC);
     auto itStreamOldL = streamsLeft .cend();
     auto itStreamOldR = streamsRight.cend();
+    bool leadStreamLeft = true;
+    const JournalData* journalOld = nullptr;
+    bool oldStateLoaded = false;
     try
     {
         //find associated session: there can be at most one session within intersection of left and right ids
@@ -856,19 +1378,76 @@ void fff::saveLastSynchronousState(const BaseFolderPair& baseFolder, const std::
                                                                 AFS::getDisplayPath(dbPathLeft),
                                                                 AFS::getDisplayPath(dbPathRight));
 
-        const bool leadStreamLeft = itStreamOldL->second.isLeadStream;
+        leadStreamLeft = itStreamOldL->second.isLeadStream;
 
         //load last synchrounous state
-        lastSyncState = StreamParser::execute(leadStreamLeft,
-                                              itStreamOldL->second.rawStream, //throw FileError
-                                              itStreamOldR->second.rawStream,
-                                              AFS::getDisplayPath(dbPathLeft),
-                                              AFS::getDisplayPath(dbPathRight));
+        std::shared_ptr<InSyncFolder> syncState = StreamParser::execute(leadStreamLeft,
+                                                                        itStreamOldL->second.rawStream, //throw FileError
+                                                                        itStreamOldR->second.rawStream,
+                                                                        AFS::getDisplayPath(dbPathLeft),
+                                                                        AFS::getDisplayPath(dbPathRight));
+
+        journalOld = getSessionJournal(journalsLeft, journalsRight, itStreamOldL->first); //throw FileErrorDatabaseNotExisting
+        if (journalOld)
+            for (const ByteArray& deltaRecord : journalOld->deltaRecords)
+                JournalParser::execute(*syncState, deltaRecord, leadStreamLeft, //throw FileError
+                                       AFS::getDisplayPath(journalPathLeft),
+                                       AFS::getDisplayPath(journalPathRight));
+        lastSyncState = syncState;
+        oldStateLoaded = true;
     }
-    catch (FileError&) {} //if error occurs: just overwrite old file! User is already informed about issues right after comparing!
+    catch (FileError&) { journalOld = nullptr; } //if error occurs: just overwrite old file! User is already informed about issues right after comparing!
 
     //update last synchrounous state
-    LastSynchronousStateUpdater::execute(baseFolder, *lastSyncState);
+    InSyncFolderDelta delta;
+    LastSynchronousStateUpdater::execute(baseFolder, *lastSyncState, delta);
+
+    if (oldStateLoaded)
+    {
+        //check if there is some work to do at all
+        if (delta.empty())
+        {
+            if (!journalsChangedL && !journalsChangedR)
+                return; //some users monitor the *.ffs_db file with RTS => don't touch the file if it isnt't strictly needed
+            //else: corrupted journal would fail every later loadLastSynchronousState() => compact into base file and clean up journals below
+        }
+        //only append a delta record if older versions can't ignore it: see DB_FORMAT_CONTAINER
+        else if (formatVersionL == DB_FORMAT_CONTAINER &&
+                 formatVersionR == DB_FORMAT_CONTAINER)
+        {
+            JournalData journalNew;
+            if (journalOld)
+                journalNew.deltaRecords = journalOld->deltaRecords;
+
+            journalNew.deltaRecords.push_back(JournalGenerator::execute(delta, leadStreamLeft, //throw FileError
+                                                                        AFS::getDisplayPath(journalPathLeft),
+                                                                        AFS::getDisplayPath(journalPathRight)));
+            size_t journalSize = 0;
+            for (const ByteArray& deltaRecord : journalNew.deltaRecords)
+                journalSize += deltaRecord.size();
+
+            const size_t sessionSize = itStreamOldL->second.rawStream.size() + itStreamOldR->second.rawStream.size();
+
+            if (journalNew.deltaRecords.size() <= DB_JOURNAL_MAX_RECORDS &&
+                journalSize * 100 <= sessionSize * DB_JOURNAL_MAX_SIZE_PERCENT)
+            {
+                journalNew.journalId = zen::generateGUID();
+
+                const UniqueId sessionID = itStreamOldL->first;
+                discardOrphanedJournals(journalsLeft,  streamsLeft);
+                discardOrphanedJournals(journalsRight, streamsRight);
+                journalsLeft [sessionID] = journalNew; //journalOld is dangling from here on!
+                journalsRight[sessionID] = std::move(journalNew);
+
+                //base files remain untouched
+                saveDbFilesTransactional(journalPathLeft, journalPathRight, journalPathLeftTmp, journalPathRightTmp, //throw FileError
+                [&](const AbstractPath& journalPath) { saveJournal(journalsLeft,  journalPath, notifySaveJournalL); }, //throw FileError
+                [&](const AbstractPath& journalPath) { saveJournal(journalsRight, journalPath, notifySaveJournalR); }); //
+                return;
+            }
+        }
+        //else: compact journal into base file
+    }
 
     //serialize again
     SessionData sessionDataL = {};
@@ -882,11 +1461,6 @@ void fff::saveLastSynchronousState(const BaseFolderPair& baseFolder, const std::
                              sessionDataL.rawStream,
                              sessionDataR.rawStream);
 
-    //check if there is some work to do at all
-    if (itStreamOldL != streamsLeft .end() && itStreamOldL->second == sessionDataL &&
-        itStreamOldR != streamsRight.end() && itStreamOldR->second == sessionDataR)
-        return; //some users monitor the *.ffs_db file with RTS => don't touch the file if it isnt't strictly needed
-
     //erase old session data
     if (itStreamOldL != streamsLeft.end())
         streamsLeft.erase(itStreamOldL);
@@ -899,19 +1473,29 @@ void fff::saveLastSynchronousState(const BaseFolderPair& baseFolder, const std::
     streamsLeft [sessionID] = std::move(sessionDataL);
     streamsRight[sessionID] = std::move(sessionDataR);
 
-    //write (temp-) files as a transaction
-    saveStreams(streamsLeft,  dbPathLeftTmp,  notifySaveL); //throw FileError
-    auto guardTmpL = makeGuard<ScopeGuardRunMode::ON_FAIL>([&] { try { AFS::removeFilePlain(dbPathLeftTmp); } catch (FileError&) {} });
-    saveStreams(streamsRight, dbPathRightTmp, notifySaveR); //
-    auto guardTmpR = makeGuard<ScopeGuardRunMode::ON_FAIL>([&] { try { AFS::removeFilePlain(dbPathRightTmp); } catch (FileError&) {} });
-
-    //operation finished: rename temp files -> this should work (almost) transactionally:
-    //if there were no write access, creation of temp files would have failed
-    AFS::removeFileIfExists(dbPathLeft);               //throw FileError
-    AFS::moveAndRenameItem(dbPathLeftTmp, dbPathLeft); //throw FileError, (ErrorDifferentVolume)
-    guardTmpL.dismiss();
+    saveDbFilesTransactional(dbPathLeft, dbPathRight, dbPathLeftTmp, dbPathRightTmp, //throw FileError
+    [&](const AbstractPath& dbPath) { saveStreams(streamsLeft,  dbPath, notifySaveL); }, //throw FileError
+    [&](const AbstractPath& dbPath) { saveStreams(streamsRight, dbPath, notifySaveR); }); //
 
-    AFS::removeFileIfExists(dbPathRight);                //
-    AFS::moveAndRenameItem(dbPathRightTmp, dbPathRight); //
-    guardTmpR.dismiss();
+    //journal of the old session is obsolete now:
+    auto cleanUpJournal = [](DbJournals& journals, bool journalsChanged, const DbStreams& streams,
+                             const AbstractPath& journalPath, const AbstractPath& journalPathTmp, const IOCallback& notifySave)
+    {
+        if (discardOrphanedJournals(journals, streams) || journalsChanged)
+            try
+            {
+                if (journals.empty())
+                    AFS::removeFileIfExists(journalPath); //throw FileError
+                else
+                {
+                    saveJournal(journals, journalPathTmp, notifySave); //throw FileError
+                    AFS::removeFileIfExists(journalPath);               //
+                    AFS::moveAndRenameItem(journalPathTmp, journalPath); //throw FileError, (ErrorDifferentVolume)
+                }
+            }
+            catch (FileError&) { try { AFS::removeFileIfExists(journalPathTmp); } catch (FileError&) {} }
+        //not critical: orphaned journals are never applied and will be discarded by the next save
+    };
+    cleanUpJournal(journalsLeft,  journalsChangedL, streamsLeft,  journalPathLeft,  journalPathLeftTmp,  notifySaveJournalL);
+    cleanUpJournal(journalsRight, journalsChangedR, streamsRight, journalPathRight, journalPathRightTmp, notifySaveJournalR);
 }
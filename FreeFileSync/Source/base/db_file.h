@@ -7,7 +7,9 @@
 #ifndef DB_FILE_H_834275398588021574
 #define DB_FILE_H_834275398588021574
 
+#include <unordered_map>
 #include <zen/file_error.h>
+#include <zen/stl_tools.h>
 #include "file_hierarchy.h"
 
 
@@ -51,6 +53,20 @@ struct InSyncSymlink
     CompareVariant cmpVar = CompareVariant::TIME_SIZE;
 };
 
+inline bool operator==(const InSyncDescrFile& lhs, const InSyncDescrFile& rhs) { return lhs.modTime == rhs.modTime && lhs.fileId == rhs.fileId; }
+inline bool operator==(const InSyncDescrLink& lhs, const InSyncDescrLink& rhs) { return lhs.modTime == rhs.modTime; }
+
+inline bool operator==(const InSyncFile& lhs, const InSyncFile& rhs)
+{
+    return lhs.left     == rhs.left     &&
+           lhs.right    == rhs.right    &&
+           lhs.cmpVar   == rhs.cmpVar   &&
+           lhs.fileSize == rhs.fileSize;
+}
+
+inline bool operator==(const InSyncSymlink& lhs, const InSyncSymlink& rhs) { return lhs.left == rhs.left && lhs.right == rhs.right && lhs.cmpVar == rhs.cmpVar; }
+
+
 struct InSyncFolder
 {
     //for directories we have a logical problem: we cannot have "not existent" as an indicator for
@@ -65,9 +81,10 @@ struct InSyncFolder
     InSyncStatus status = DIR_STATUS_STRAW_MAN;
 
     //------------------------------------------------------------------
-    using FolderList  = std::map<Zstring, InSyncFolder,  LessUnicodeNormal>; //
-    using FileList    = std::map<Zstring, InSyncFile,    LessUnicodeNormal>; // key: file name (ignoring Unicode normal forms)
-    using SymlinkList = std::map<Zstring, InSyncSymlink, LessUnicodeNormal>; //
+    //key: item name in Unicode normal form => normalize once per insertion/lookup instead of for each comparison
+    using FolderList  = std::map          <Zstring, InSyncFolder>;                   //std::unordered_map does not support incomplete types
+    using FileList    = std::unordered_map<Zstring, InSyncFile,    zen::StringHash>; //
+    using SymlinkList = std::unordered_map<Zstring, InSyncSymlink, zen::StringHash>; //
     //------------------------------------------------------------------
 
     FolderList  folders;
@@ -77,23 +94,28 @@ struct InSyncFolder
     //convenience
     InSyncFolder& addFolder(const Zstring& folderName, InSyncStatus st)
     {
-        return folders.emplace(folderName, InSyncFolder(st)).first->second;
+        return folders.emplace(getUnicodeNormalForm(folderName), InSyncFolder(st)).first->second;
     }
 
     void addFile(const Zstring& fileName, const InSyncDescrFile& dataL, const InSyncDescrFile& dataR, CompareVariant cmpVar, uint64_t fileSize)
     {
-        files.emplace(fileName, InSyncFile(dataL, dataR, cmpVar, fileSize));
+        files.emplace(getUnicodeNormalForm(fileName), InSyncFile(dataL, dataR, cmpVar, fileSize));
     }
 
     void addSymlink(const Zstring& linkName, const InSyncDescrLink& dataL, const InSyncDescrLink& dataR, CompareVariant cmpVar)
     {
-        symlinks.emplace(linkName, InSyncSymlink(dataL, dataR, cmpVar));
+        symlinks.emplace(getUnicodeNormalForm(linkName), InSyncSymlink(dataL, dataR, cmpVar));
     }
 };
 
 
 DEFINE_NEW_FILE_ERROR(FileErrorDatabaseNotExisting);
 
+/*  database layout per side:
+    - sync.ffs_db:         base file containing the full last synchronous state of each session (= sync partner)
+    - sync.journal.ffs_db: delta records of the syncs since the base file was last written
+                           => saving costs are proportional to the change set; the base file is rewritten (compacted) once the journal grows too large */
+
 std::shared_ptr<InSyncFolder> loadLastSynchronousState(const BaseFolderPair& baseDirObj, //throw FileError, FileErrorDatabaseNotExisting -> return value always bound!
                                                        const std::function<void(const std::wstring& statusMsg)>& notifyStatus);
 
@@ -61,9 +61,10 @@ bool fff::isPortableVersion()
 Zstring fff::getResourceDirPf()
 {
     //make independent from wxWidgets global variable "appname"; support being called by RealTimeSync
-    auto appName = wxTheApp->GetAppName();
-    wxTheApp->SetAppName(L"FreeFileSync");
-    ZEN_ON_SCOPE_EXIT(wxTheApp->SetAppName(appName));
+    //use wxAppConsole, not wxTheApp: headless batch runner has no wxApp
+    auto appName = wxAppConsole::GetInstance()->GetAppName();
+    wxAppConsole::GetInstance()->SetAppName(L"FreeFileSync");
+    ZEN_ON_SCOPE_EXIT(wxAppConsole::GetInstance()->SetAppName(appName));
 
     //if (isPortableVersion())
     return appendSeparator(getExeFolderParentPath());
@@ -75,9 +76,9 @@ Zstring fff::getResourceDirPf()
 Zstring fff::getConfigDirPathPf()
 {
     //make independent from wxWidgets global variable "appname"; support being called by RealTimeSync
-    auto appName = wxTheApp->GetAppName();
-    wxTheApp->SetAppName(L"FreeFileSync");
-    ZEN_ON_SCOPE_EXIT(wxTheApp->SetAppName(appName));
+    auto appName = wxAppConsole::GetInstance()->GetAppName();
+    wxAppConsole::GetInstance()->SetAppName(L"FreeFileSync");
+    ZEN_ON_SCOPE_EXIT(wxAppConsole::GetInstance()->SetAppName(appName));
 
     Zstring cfgFolderPath;
     if (isPortableVersion())
@@ -10,12 +10,12 @@
 #include <map>
 #include <string>
 #include <memory>
-#include <list>
 #include <functional>
 #include <unordered_set>
 #include <zen/zstring.h>
 #include <zen/stl_tools.h>
 #include <zen/file_id_def.h>
+#include <zen/fixed_list.h>
 #include "structures.h"
 #include "path_filter.h"
 #include "../fs/abstract.h"
@@ -197,9 +197,9 @@ class ContainerObject : public virtual PathInformation
     friend class FileSystemObject;
 
 public:
-    using FileList    = std::list<FilePair>;    //MergeSides::execute() requires a structure that doesn't invalidate pointers after push_back()
-    using SymlinkList = std::list<SymlinkPair>; //
-    using FolderList  = std::list<FolderPair>;
+    using FileList    = zen::FixedList<FilePair>;    //MergeSides::execute() requires a structure that doesn't invalidate pointers after push_back()
+    using SymlinkList = zen::FixedList<SymlinkPair>; //singly-linked: one pointer less per item than std::list => matters for multi-million row comparisons
+    using FolderList  = zen::FixedList<FolderPair>;  //
 
     FolderPair& addSubFolder(const Zstring&          itemNameL,
                              const FolderAttributes& left,    //file exists on both sides
@@ -242,6 +242,9 @@ public:
 
     BaseFolderPair& getBase() { return base_; }
 
+    //incremented whenever sync direction, active status or item existence of any object in this sub-tree changes: allows views to detect stale buffers
+    uint64_t getChangeCount() const { return changeCount_; }
+
 protected:
     ContainerObject(BaseFolderPair& baseFolder) : //used during BaseFolderPair constructor
         base_(baseFolder) {} //take reference only: baseFolder *not yet* fully constructed at this point!
@@ -261,7 +264,7 @@ private:
     ContainerObject           (const ContainerObject&) = delete; //this class is referenced by its child elements => make it non-copyable/movable!
     ContainerObject& operator=(const ContainerObject&) = delete;
 
-    virtual void notifySyncCfgChanged() {}
+    virtual void notifySyncCfgChanged() { ++changeCount_; }
 
     Zstring getRelativePathL() const override { return relPathL_; }
     Zstring getRelativePathR() const override { return relPathR_; }
@@ -274,6 +277,8 @@ private:
     Zstring relPathR_; //
 
     BaseFolderPair& base_;
+
+    uint64_t changeCount_ = 0;
 };
 
 //------------------------------------------------------------------
@@ -313,6 +318,7 @@ private:
     AbstractPath getAbstractPathL() const override { return folderPathLeft_; }
     AbstractPath getAbstractPathR() const override { return folderPathRight_; }
 
+
     const FilterRef filter_; //filter used while scanning directory: represents sub-view of actual files!
     const CompareVariant cmpVar_;
     const int fileTimeTolerance_;
@@ -375,39 +381,118 @@ struct FSObjectVisitor
 
 //inherit from this class to allow safe random access by id instead of unsafe raw pointer
 //allow for similar semantics like std::weak_ptr without having to use std::shared_ptr
+//slot map: id = (slot index, generation) => O(1) validation without hashing, no per-object node allocation
 template <class T>
 class ObjectMgr
 {
+    template <class Obj>
+    class IdImpl
+    {
+    public:
+        IdImpl(std::nullptr_t = nullptr) {}
+
+        template <class Obj2, class = std::enable_if_t<std::is_convertible_v<Obj2*, Obj*>>> //ObjectId => ObjectIdConst
+        IdImpl(const IdImpl<Obj2>& other) : slot_(other.slot_), generation_(other.generation_) {}
+
+        explicit operator bool() const { return generation_ != 0; }
+
+        inline friend bool operator==(const IdImpl& lhs, const IdImpl& rhs) { return lhs.slot_ == rhs.slot_ && lhs.generation_ == rhs.generation_; }
+        inline friend bool operator!=(const IdImpl& lhs, const IdImpl& rhs) { return !(lhs == rhs); }
+
+        size_t getHash() const { return (static_cast<size_t>(generation_) << 32 | slot_) * 0x9e3779b97f4a7c15ULL; } //not the "identity": slots are handed out sequentially!
+
+    private:
+        IdImpl(uint32_t slot, uint32_t generation) : slot_(slot), generation_(generation) {}
+
+        uint32_t slot_       = 0;
+        uint32_t generation_ = 0; //0: nullptr
+
+        friend class ObjectMgr;
+        template <class Obj2> friend class IdImpl;
+    };
+
 public:
-    using ObjectId      =       ObjectMgr* ;
-    using ObjectIdConst = const ObjectMgr*;
+    using ObjectId      = IdImpl<      ObjectMgr>;
+    using ObjectIdConst = IdImpl<const ObjectMgr>;
+
+    struct ObjectIdHash
+    {
+        size_t operator()(const ObjectIdConst& id) const { return id.getHash(); }
+    };
 
-    ObjectIdConst  getId() const { return this; }
-    /**/  ObjectId getId()       { return this; }
+    ObjectIdConst  getId() const { return { slot_, generation_ }; }
+    /**/  ObjectId getId()       { return { slot_, generation_ }; }
 
     static const T* retrieve(ObjectIdConst id) //returns nullptr if object is not valid anymore
     {
-        const auto& aObj = activeObjects();
-        return static_cast<const T*>(aObj.find(id) == aObj.end() ? nullptr : id);
+        const Registry& reg = registry();
+        if (id.slot_ < reg.slots.size())
+            if (const ObjectMgr* obj = reg.slots[id.slot_]) //free slot: nullptr
+                if (obj->generation_ == id.generation_)
+                    return static_cast<const T*>(obj);
+        return nullptr;
     }
     static T* retrieve(ObjectId id) { return const_cast<T*>(retrieve(static_cast<ObjectIdConst>(id))); }
 
 protected:
-    ObjectMgr () { activeObjects().insert(this); }
-    ~ObjectMgr() { activeObjects().erase (this); }
+    ObjectMgr()
+    {
+        Registry& reg = registry();
+
+        if (++reg.lastGeneration == 0) //generations are unique across slots => a stale id never matches a reused slot, even after registry reset
+            reg.lastGeneration = 1;    //0 is reserved for nullptr
+        generation_ = reg.lastGeneration;
+
+        if (reg.freeSlots.empty())
+        {
+            slot_ = static_cast<uint32_t>(reg.slots.size());
+            reg.slots.push_back(this);
+        }
+        else
+        {
+            slot_ = reg.freeSlots.back();
+            /**/    reg.freeSlots.pop_back();
+            reg.slots[slot_] = this;
+        }
+    }
+
+    ~ObjectMgr()
+    {
+        Registry& reg = registry();
+        assert(reg.slots[slot_] == this);
+        reg.slots[slot_] = nullptr;
+
+        if (reg.freeSlots.size() + 1 == reg.slots.size()) //last object gone (e.g. FolderComparison dropped) => release registry memory
+        {
+            std::vector<const ObjectMgr*>().swap(reg.slots);
+            std::vector<uint32_t>        ().swap(reg.freeSlots);
+        }
+        else
+            reg.freeSlots.push_back(slot_);
+    }
 
 private:
     ObjectMgr           (const ObjectMgr& rhs) = delete;
     ObjectMgr& operator=(const ObjectMgr& rhs) = delete; //it's not well-defined what copying an objects means regarding object-identity in this context
 
-    static std::unordered_set<const ObjectMgr*>& activeObjects()
+    struct Registry
+    {
+        std::vector<const ObjectMgr*> slots; //nullptr if free
+        std::vector<uint32_t> freeSlots;
+        uint32_t lastGeneration = 0;
+    };
+
+    static Registry& registry()
     {
         //our global ObjectMgr is not thread-safe (and currently does not need to be!)
         //assert(runningMainThread()); -> still, may be accessed by synchronization worker threads, one thread at a time
 
-        static std::unordered_set<const ObjectMgr*> inst;
+        static Registry inst;
         return inst; //external linkage (even in header file!)
     }
+
+    uint32_t slot_       = 0;
+    uint32_t generation_ = 0;
 };
 
 //------------------------------------------------------------------
@@ -489,14 +574,15 @@ private:
     void propagateChangedItemName(const Zstring& itemNameOld); //required after any itemName changes
 
     //categorization
-    Zstringw cmpResultDescr_; //only filled if getCategory() == FILE_CONFLICT or FILE_DIFFERENT_METADATA
+    std::unique_ptr<const Zstringw> cmpResultDescr_; //only set if getCategory() == FILE_CONFLICT or FILE_DIFFERENT_METADATA
+    //rarely set => pointer: an empty Zstringw still allocates (80 bytes) => 2 per FilePair = 1/3 of the memory of large comparisons!
     CompareFilesResult cmpResult_; //although this uses 4 bytes there is currently *no* space wasted in class layout!
 
     bool selectedForSync_ = true;
 
-    //Note: we model *four* states with following two variables => "syncDirectionConflict is empty or syncDir == NONE" is a class invariant!!!
+    //Note: we model *four* states with following two variables => "syncDirectionConflict is not set or syncDir == NONE" is a class invariant!!!
     SyncDirection syncDir_ = SyncDirection::NONE; //1 byte: optimize memory layout!
-    Zstringw syncDirectionConflict_; //non-empty if we have a conflict setting sync-direction
+    std::unique_ptr<const Zstringw> syncDirectionConflict_; //set if we have a conflict setting sync-direction
     //get rid of std::wstring small string optimization (consumes 32/48 byte on VS2010 x86/x64!)
 
     Zstring itemNameL_; //slightly redundant under Linux, but on Windows the "same" file paths can differ in case
@@ -573,7 +659,7 @@ public:
     template <SelectedSide side> bool       isFollowedSymlink() const;
     template <SelectedSide side> FileAttributes getAttributes() const;
 
-    void setMoveRef(ObjectId refId) { moveFileRef_ = refId; } //reference to corresponding renamed file
+    void setMoveRef(ObjectId refId) { moveFileRef_ = refId; notifySyncCfgChanged(); } //reference to corresponding renamed file
     ObjectId getMoveRef() const { return moveFileRef_; } //may be nullptr
 
     CompareFilesResult getFileCategory() const;
@@ -601,6 +687,15 @@ private:
     void removeObjectL() override { attrL_ = FileAttributes(); }
     void removeObjectR() override { attrR_ = FileAttributes(); }
 
+    void notifySyncCfgChanged() override
+    {
+        FileSystemObject::notifySyncCfgChanged();
+        //sync operation of the move partner depends on this file, see applyMoveOptimization() => notify its parent chain, too, e.g. located in a different folder
+        if (moveFileRef_)
+            if (auto refFile = dynamic_cast<FilePair*>(FileSystemObject::retrieve(moveFileRef_)))
+                refFile->FileSystemObject::notifySyncCfgChanged(); //no virtual call: don't bounce back!
+    }
+
     FileAttributes attrL_;
     FileAttributes attrR_;
 
@@ -727,7 +822,7 @@ inline
 std::wstring FileSystemObject::getCatExtraDescription() const
 {
     assert(getCategory() == FILE_CONFLICT || getCategory() == FILE_DIFFERENT_METADATA);
-    return zen::copyStringTo<std::wstring>(cmpResultDescr_);
+    return cmpResultDescr_ ? zen::copyStringTo<std::wstring>(*cmpResultDescr_) : std::wstring();
 }
 
 
@@ -735,7 +830,7 @@ inline
 void FileSystemObject::setSyncDir(SyncDirection newDir)
 {
     syncDir_ = newDir;
-    syncDirectionConflict_.clear();
+    syncDirectionConflict_.reset();
 
     notifySyncCfgChanged();
 }
@@ -746,7 +841,7 @@ void FileSystemObject::setSyncDirConflict(const std::wstring& description)
 {
     assert(!description.empty());
     syncDir_ = SyncDirection::NONE;
-    syncDirectionConflict_ = zen::copyStringTo<Zstringw>(description);
+    syncDirectionConflict_ = std::make_unique<const Zstringw>(zen::copyStringTo<Zstringw>(description));
 
     notifySyncCfgChanged();
 }
@@ -756,7 +851,7 @@ inline
 std::wstring FileSystemObject::getSyncOpConflict() const
 {
     assert(getSyncOperation() == SO_UNRESOLVED_CONFLICT);
-    return zen::copyStringTo<std::wstring>(syncDirectionConflict_);
+    return syncDirectionConflict_ ? zen::copyStringTo<std::wstring>(*syncDirectionConflict_) : std::wstring();
 }
 
 
@@ -860,7 +955,7 @@ void FileSystemObject::setCategoryConflict(const Zstringw& description)
 {
     assert(!description.empty());
     cmpResult_ = FILE_CONFLICT;
-    cmpResultDescr_ = description;
+    cmpResultDescr_ = std::make_unique<const Zstringw>(description); //ref-counted: shares the string
 }
 
 inline
@@ -868,7 +963,7 @@ void FileSystemObject::setCategoryDiffMetadata(const Zstringw& description)
 {
     assert(!description.empty());
     cmpResult_ = FILE_DIFFERENT_METADATA;
-    cmpResultDescr_ = description;
+    cmpResultDescr_ = std::make_unique<const Zstringw>(description); //ref-counted: shares the string
 }
 
 inline
@@ -1165,8 +1260,8 @@ void FilePair::setSyncedTo(const Zstring& itemName,
     SelectParam<sideTrg>::ref(attrL_, attrR_) = FileAttributes(lastWriteTimeTrg, fileSize, fileIdTrg, isSymlinkTrg);
     SelectParam<sideSrc>::ref(attrL_, attrR_) = FileAttributes(lastWriteTimeSrc, fileSize, fileIdSrc, isSymlinkSrc);
 
+    FileSystemObject::setSynced(itemName); //set FileSystemObject specific part; notifies move partner while moveFileRef_ is still set
     moveFileRef_ = nullptr;
-    FileSystemObject::setSynced(itemName); //set FileSystemObject specific part
 }
 
 
@@ -0,0 +1,97 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+/* Standalone benchmark: memory footprint of the comparison tree (FolderComparison) per file pair
+
+    - builds <folders> x <files per folder> FilePairs existing on both sides via the regular ContainerObject API
+    - item names and file IDs are created up front => "nodes" = FilePair/FolderPair objects + list and registry overhead
+    - "names + IDs" = the Zstring/FileId heap allocations referenced by the nodes (no string interning: worst case)
+    - heap usage from mallinfo2() (glibc): includes malloc chunk headers, unlike sizeof()
+
+    build + run: make benchmark_tree (FreeFileSync/Source/Makefile)               */
+
+#include <iostream>
+#include <malloc.h>
+#include <zen/perf.h>
+#include "file_hierarchy.h"
+#include "../fs/concrete.h"
+
+using namespace zen;
+using namespace fff;
+
+
+namespace
+{
+size_t getHeapBytesInUse()
+{
+    ::malloc_trim(0);
+    return ::mallinfo2().uordblks;
+}
+}
+
+
+int main(int argc, char* argv[])
+{
+    const size_t folderCount    = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000;
+    const size_t filesPerFolder = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 1000;
+    const size_t fileCount = folderCount * filesPerFolder;
+
+    if (fileCount == 0)
+    {
+        std::cerr << "Usage: file_hierarchy_benchmark [folders] [files per folder]\n";
+        return EXIT_FAILURE;
+    }
+
+    const size_t heapStart = getHeapBytesInUse();
+
+    std::vector<Zstring> folderNames;
+    std::vector<Zstring> fileNames;
+    std::vector<AFS::FileId> fileIds;
+    for (size_t i = 0; i < folderCount; ++i)
+        folderNames.push_back(Zstr("Folder ") + numberTo<Zstring>(i));
+
+    for (size_t i = 0; i < fileCount; ++i)
+    {
+        fileNames.push_back(Zstr("IMG_") + printNumber<Zstring>(Zstr("%08d"), static_cast<int>(i)) + Zstr(".jpg"));
+
+        const uint64_t fileIndex[2] = { 2049, i }; //native: volume ID + inode number
+        fileIds.emplace_back(reinterpret_cast<const char*>(fileIndex), sizeof(fileIndex));
+    }
+
+    const size_t heapNamesIds = getHeapBytesInUse();
+
+    StopWatch watch;
+    {
+        BaseFolderPair baseFolder(createAbstractPath(Zstr("/tmp/Left")),  true, //
+                                  createAbstractPath(Zstr("/tmp/Right")), true, //
+                                  makeSharedRef<NullFilter>(), CompareVariant::TIME_SIZE, 2 /*fileTimeTolerance*/, {});
+
+        const size_t heapBase = getHeapBytesInUse();
+
+        for (size_t i = 0; i < folderCount; ++i)
+        {
+            FolderPair& folder = baseFolder.addSubFolder(folderNames[i], FolderAttributes(), DIR_EQUAL, folderNames[i], FolderAttributes());
+
+            for (size_t k = i * filesPerFolder; k < (i + 1) * filesPerFolder; ++k)
+                folder.addSubFile(fileNames[k], FileAttributes(1500000000, 4096, fileIds[k], false), FILE_EQUAL,
+                                  fileNames[k], FileAttributes(1500000000, 4096, fileIds[k], false));
+        }
+
+        const std::chrono::nanoseconds buildTime = watch.elapsed();
+        const size_t heapTree = getHeapBytesInUse();
+
+        std::cout << "File pairs: " << fileCount << " in " << folderCount << " folders, build time: " <<
+                  std::chrono::duration_cast<std::chrono::milliseconds>(buildTime).count() << " ms\n\n" <<
+                  "sizeof(FilePair)   " << sizeof(FilePair)   << " bytes\n" <<
+                  "sizeof(FolderPair) " << sizeof(FolderPair) << " bytes\n\n" <<
+                  "heap per file pair:\n" <<
+                  "    nodes          " << static_cast<double>(heapTree - heapBase) / fileCount << " bytes\n" <<
+                  "    names + IDs    " << static_cast<double>(heapNamesIds - heapStart) / fileCount << " bytes\n" <<
+                  "    total          " << static_cast<double>(heapTree - heapBase + heapNamesIds - heapStart) / fileCount << " bytes\n" <<
+                  "    10M file pairs " << (heapTree - heapBase + heapNamesIds - heapStart) * (10'000'000.0 / fileCount) / (1024 * 1024 * 1024) << " GB\n";
+    }
+    return EXIT_SUCCESS;
+}
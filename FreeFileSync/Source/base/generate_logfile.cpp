@@ -6,6 +6,7 @@
 
 #include "generate_logfile.h"
 #include <zen/file_io.h>
+#include <zen/thread.h>
 #include <wx/datetime.h>
 #include "ffs_paths.h"
 #include "../fs/concrete.h"
@@ -17,6 +18,15 @@ using AFS = AbstractFileSystem;
 
 namespace
 {
+std::wstring generateHeaderLine(const std::wstring& jobName)
+{
+    std::wstring headerLine = formatTime<std::wstring>(FORMAT_DATE); //+ L" [" + formatTime<std::wstring>(FORMAT_TIME, startTime + L"]";
+    if (!jobName.empty())
+        headerLine += L"  " + jobName;
+    return headerLine;
+}
+
+
 std::wstring generateLogHeader(const ProcessSummary& s, const ErrorLog& log, const std::wstring& finalStatusMsg)
 {
     //assemble summary box
@@ -24,11 +34,7 @@ std::wstring generateLogHeader(const ProcessSummary& s, const ErrorLog& log, con
 
     const std::wstring tabSpace(4, L' '); //4, the one true space count for tabs
 
-    std::wstring headerLine = formatTime<std::wstring>(FORMAT_DATE); //+ L" [" + formatTime<std::wstring>(FORMAT_TIME, startTime + L"]";
-    if (!s.jobName.empty())
-        headerLine += L"  " + s.jobName;
-
-    summary.push_back(headerLine);
+    summary.push_back(generateHeaderLine(s.jobName));
     summary.push_back(L"");
     summary.push_back(tabSpace +  finalStatusMsg);
 
@@ -72,19 +78,20 @@ std::wstring generateLogHeader(const ProcessSummary& s, const ErrorLog& log, con
 }
 
 
+std::string fmtForTxtFile(const std::wstring& str)
+{
+    std::string utfStr = utfTo<std::string>(str);
+    if (!equalString(LINE_BREAK, '\n'))
+        replace(utfStr, '\n', LINE_BREAK);
+    return utfStr;
+}
+
+
 void streamToLogFile(const ProcessSummary& summary, //throw FileError
                      const ErrorLog& log,
                      const std::wstring& finalStatusLabel,
                      AFS::OutputStream& streamOut)
 {
-    auto fmtForTxtFile = [needLbReplace = !equalString(LINE_BREAK, '\n')](const std::wstring& str)
-    {
-        std::string utfStr = utfTo<std::string>(str);
-        if (needLbReplace)
-            replace(utfStr, '\n', LINE_BREAK);
-        return utfStr;
-    };
-
     std::string buffer = fmtForTxtFile(generateLogHeader(summary, log, finalStatusLabel)); //don't replace line break any earlier
 
     streamOut.write(&buffer[0], buffer.size()); //throw FileError, X
@@ -108,17 +115,9 @@ const int TIME_STAMP_LENGTH = 21;
 const Zchar STATUS_BEGIN_TOKEN[] = Zstr(" [");
 const Zchar STATUS_END_TOKEN     = Zstr(']');
 
-//"Backup FreeFileSync 2013-09-15 015052.123.log" ->
-//"Backup FreeFileSync 2013-09-15 015052.123 [Error].log"
-AbstractPath saveNewLogFile(const ProcessSummary& summary, //throw FileError
-                            const ErrorLog& log,
-                            const AbstractPath& logFolderPath,
-                            const std::chrono::system_clock::time_point& syncStartTime,
-                            const std::function<void(const std::wstring& msg)>& notifyStatus /*throw X*/)
+//"Backup FreeFileSync 2013-09-15 015052.123"
+Zstring generateLogFileNameBase(const std::wstring& jobName, const std::chrono::system_clock::time_point& syncStartTime) //throw FileError
 {
-    //create logfile folder if required
-    AFS::createFolderIfMissingRecursion(logFolderPath); //throw FileError
-
     //const std::string colon = "\xcb\xb8"; //="modifier letter raised colon" => regular colon is forbidden in file names on Windows and OS X
     //=> too many issues, most notably cmd.exe is not Unicode-aware: https://freefilesync.org/forum/viewtopic.php?t=1679
 
@@ -132,16 +131,26 @@ AbstractPath saveNewLogFile(const ProcessSummary& summary, //throw FileError
 
     Zstring logFileName;
 
-    if (!summary.jobName.empty())
-        logFileName += utfTo<Zstring>(summary.jobName) + Zstr(' ');
+    if (!jobName.empty())
+        logFileName += utfTo<Zstring>(jobName) + Zstr(' ');
 
     logFileName += formatTime<Zstring>(Zstr("%Y-%m-%d %H%M%S"), tc) +
                    Zstr(".") + printNumber<Zstring>(Zstr("%03d"), static_cast<int>(timeMs)); //[ms] should yield a fairly unique name
     static_assert(TIME_STAMP_LENGTH == 21);
 
+    return logFileName;
+}
+
+
+//"Backup FreeFileSync 2013-09-15 015052.123" ->
+//"Backup FreeFileSync 2013-09-15 015052.123 [Error].log"
+Zstring generateLogFileName(const Zstring& logFileNameBase, SyncResult finalStatus)
+{
+    Zstring logFileName = logFileNameBase;
+
     const std::wstring failStatus = [&]
     {
-        switch (summary.finalStatus)
+        switch (finalStatus)
         {
             case SyncResult::FINISHED_WITH_SUCCESS:
                 break;
@@ -159,7 +168,21 @@ AbstractPath saveNewLogFile(const ProcessSummary& summary, //throw FileError
         logFileName += STATUS_BEGIN_TOKEN + utfTo<Zstring>(failStatus) + STATUS_END_TOKEN;
     logFileName += Zstr(".log");
 
-    const AbstractPath logFilePath = AFS::appendRelPath(logFolderPath, logFileName);
+    return logFileName;
+}
+
+
+AbstractPath saveNewLogFile(const ProcessSummary& summary, //throw FileError
+                            const ErrorLog& log,
+                            const AbstractPath& logFolderPath,
+                            const std::chrono::system_clock::time_point& syncStartTime,
+                            const std::function<void(const std::wstring& msg)>& notifyStatus /*throw X*/)
+{
+    //create logfile folder if required
+    AFS::createFolderIfMissingRecursion(logFolderPath); //throw FileError
+
+    const AbstractPath logFilePath = AFS::appendRelPath(logFolderPath, generateLogFileName(generateLogFileNameBase(summary.jobName, syncStartTime), //throw FileError
+                                                                                          summary.finalStatus));
 
     auto notifyUnbufferedIO = [notifyStatus,
                                bytesWritten_ = int64_t(0),
@@ -275,6 +298,46 @@ void limitLogfileCount(const AbstractPath& logFolderPath, //throw FileError
             std::rethrow_exception(firstError);
     }
 }
+
+
+//LogFileWriter appends to the .ffs_tmp file with every log entry => not modified for a day: the job was killed or crashed
+const int TEMP_LOG_STALE_SECONDS = 24 * 3600;
+
+//"Backup FreeFileSync 2013-09-15 015052.123.log.ffs_tmp" left behind by a dead run =>
+//"Backup FreeFileSync 2013-09-15 015052.123 [Stopped].log": keep what was written, listed by getLogFiles() and trimmed by limitLogfileCount()
+//worst case: a live job writing nothing for a day loses its .ffs_tmp file => LogFileWriter::finalize() falls back to saveNewLogFile()
+void recoverStaleTempLogFiles(const AbstractPath& logFolderPath) //throw FileError
+{
+    if (!AFS::itemStillExists(logFolderPath)) //throw FileError
+        return; //first run: folder not yet created
+
+    const Zstring tmpLogEnding = Zstring(Zstr(".log")) + AFS::TEMP_FILE_ENDING;
+    const time_t staleTime = std::time(nullptr) - TEMP_LOG_STALE_SECONDS;
+
+    std::vector<Zstring> staleFileNames;
+
+    AFS::traverseFolderFlat(logFolderPath, [&](const AFS::FileInfo& fi) //throw FileError
+    {
+        if (endsWith(fi.itemName, tmpLogEnding) && fi.modTime < staleTime)
+            staleFileNames.push_back(fi.itemName);
+    },
+    nullptr /*onFolder*/, //traverse only one level deep
+    nullptr /*onSymlink*/);
+
+    std::exception_ptr firstError;
+
+    for (const Zstring& fileName : staleFileNames)
+        try
+        {
+            const Zstring logFileNameBase = beforeLast(fileName, tmpLogEnding, IF_MISSING_RETURN_NONE);
+            AFS::moveAndRenameItem(AFS::appendRelPath(logFolderPath, fileName), //throw FileError, (ErrorDifferentVolume)
+                                   AFS::appendRelPath(logFolderPath, generateLogFileName(logFileNameBase, SyncResult::ABORTED)));
+        }
+        catch (const FileError&) { if (!firstError) firstError = std::current_exception(); };
+
+    if (firstError) //late failure!
+        std::rethrow_exception(firstError);
+}
 }
 
 
@@ -312,3 +375,208 @@ AbstractPath fff::saveLogFile(const ProcessSummary& summary, //throw FileError
 
     return *logFilePath;
 }
+
+//################################################################################################################################################
+
+struct LogFileWriter::Impl
+{
+    Impl(const std::wstring& jobNameIn, const std::chrono::system_clock::time_point& syncStartTimeIn, const AbstractPath& logFolderPathIn) :
+        jobName(jobNameIn), syncStartTime(syncStartTimeIn), logFolderPath(logFolderPathIn) {}
+
+    struct SharedData //accessed by main and writer thread
+    {
+        std::mutex lockEntries;
+        std::condition_variable conditionNewEntries;
+        std::vector<LogEntry> entries; //not yet written
+        std::wstring footer;
+        bool finishRequested = false;
+    };
+
+    void requestFinish(const std::wstring& footer)
+    {
+        {
+            std::lock_guard dummy(shared->lockEntries);
+            shared->footer = footer;
+            shared->finishRequested = true;
+        }
+        shared->conditionNewEntries.notify_all();
+    }
+
+    const std::wstring jobName;
+    const std::chrono::system_clock::time_point syncStartTime;
+    const AbstractPath logFolderPath;
+
+    Zstring logFileNameBase; //empty if not available
+    std::optional<AbstractPath> tmpFilePath;
+
+    const std::shared_ptr<SharedData> shared = std::make_shared<SharedData>(); //worker threads may outlive LogFileWriter
+    std::future<void> writerDone;
+    std::future<void> cleanupDone;
+    bool finalized = false;
+};
+
+
+LogFileWriter::LogFileWriter(const std::wstring& jobName,
+                             const std::chrono::system_clock::time_point& syncStartTime,
+                             const Zstring& altLogFolderPathPhrase, //optional
+                             int logfilesMaxAgeDays,
+                             const std::set<AbstractPath>& logFilePathsToKeep) :
+    pimpl_(std::make_unique<Impl>(jobName, syncStartTime, [&]
+{
+    AbstractPath logFolderPath = createAbstractPath(altLogFolderPathPhrase);
+    if (AFS::isNullPath(logFolderPath))
+        logFolderPath = createAbstractPath(getDefaultLogFolderPath());
+    return logFolderPath;
+}()))
+{
+    //clean up while syncing instead of afterwards: listing the log folder may take a while
+    pimpl_->cleanupDone = runAsync([logFolderPath = pimpl_->logFolderPath, logfilesMaxAgeDays, logFilePathsToKeep]
+    {
+        setCurrentThreadName("Log Cleanup");
+
+        std::exception_ptr firstError;
+        try
+        {
+            recoverStaleTempLogFiles(logFolderPath); //throw FileError
+        }
+        catch (const FileError&) { if (!firstError) firstError = std::current_exception(); };
+
+        try
+        {
+            limitLogfileCount(logFolderPath, logfilesMaxAgeDays, logFilePathsToKeep, nullptr /*notifyStatus*/); //throw FileError
+        }
+        catch (const FileError&) { if (!firstError) firstError = std::current_exception(); };
+
+        if (firstError) //late failure!
+            std::rethrow_exception(firstError);
+    });
+
+    try
+    {
+        pimpl_->logFileNameBase = generateLogFileNameBase(jobName, syncStartTime); //throw FileError
+    }
+    catch (FileError&) { return; } //=> finalize() reports the error via saveLogFile()
+
+    //"Backup FreeFileSync 2013-09-15 015052.123.log.ffs_tmp" => ignored by getLogFiles() and RealTimeSync; see recoverStaleTempLogFiles()
+    pimpl_->tmpFilePath = AFS::appendRelPath(pimpl_->logFolderPath, pimpl_->logFileNameBase + Zstr(".log") + AFS::TEMP_FILE_ENDING);
+
+    pimpl_->writerDone = runAsync([logFolderPath = pimpl_->logFolderPath,
+                                   tmpFilePath   = *pimpl_->tmpFilePath,
+                                   headerLine    = generateHeaderLine(jobName),
+                                   shared        = pimpl_->shared]
+    {
+        setCurrentThreadName("Log Writer");
+
+        AFS::createFolderIfMissingRecursion(logFolderPath); //throw FileError
+
+        std::unique_ptr<AFS::OutputStream> logFileStream = AFS::getOutputStream(tmpFilePath, nullptr /*streamSize*/, nullptr /*notifyUnbufferedIO*/); //throw FileError
+
+        std::string buffer = fmtForTxtFile(headerLine) + LINE_BREAK + LINE_BREAK;
+        logFileStream->write(&buffer[0], buffer.size()); //throw FileError
+
+        for (;;)
+        {
+            std::vector<LogEntry> entries;
+            std::wstring footer;
+            bool finishRequested = false;
+            {
+                std::unique_lock dummy(shared->lockEntries);
+                shared->conditionNewEntries.wait(dummy, [&] { return !shared->entries.empty() || shared->finishRequested; });
+
+                entries.swap(shared->entries);
+                footer.swap(shared->footer);
+                finishRequested = shared->finishRequested;
+            }
+
+            buffer.clear();
+            for (const LogEntry& entry : entries)
+            {
+                buffer += fmtForTxtFile(formatMessage(entry));
+                buffer += LINE_BREAK;
+            }
+            if (!footer.empty())
+            {
+                buffer += LINE_BREAK;
+                buffer += fmtForTxtFile(footer);
+            }
+            if (!buffer.empty())
+                logFileStream->write(&buffer[0], buffer.size()); //throw FileError
+
+            if (finishRequested)
+                break;
+        }
+        logFileStream->finalize(); //throw FileError
+    });
+}
+
+
+LogFileWriter::~LogFileWriter()
+{
+    if (!pimpl_->finalized) //keep what was written so far
+        pimpl_->requestFinish(std::wstring());
+}
+
+
+void LogFileWriter::write(const LogEntry& entry) //noexcept
+{
+    if (pimpl_->finalized || !pimpl_->writerDone.valid() || isReady(pimpl_->writerDone)) //writer failed: see finalize()
+        return;
+    {
+        std::lock_guard dummy(pimpl_->shared->lockEntries);
+        pimpl_->shared->entries.push_back(entry);
+    }
+    pimpl_->shared->conditionNewEntries.notify_all();
+}
+
+
+AbstractPath LogFileWriter::finalize(const ProcessSummary& summary, const ErrorLog& log, //throw FileError
+                                     const std::function<void(const std::wstring& msg)>& notifyStatus /*throw X*/)
+{
+    assert(!pimpl_->finalized);
+    pimpl_->finalized = true;
+
+    std::optional<AbstractPath> logFilePath;
+    std::exception_ptr firstError;
+
+    if (pimpl_->writerDone.valid())
+    {
+        pimpl_->requestFinish(generateLogHeader(summary, log, getFinalStatusLabel(summary.finalStatus)));
+
+        //usually only the summary is left to write
+        const std::wstring msg = replaceCpy(_("Saving file %x..."), L"%x", fmtPath(AFS::getDisplayPath(*pimpl_->tmpFilePath)));
+        while (pimpl_->writerDone.wait_for(UI_UPDATE_INTERVAL) != std::future_status::ready)
+            if (notifyStatus) notifyStatus(msg); //throw X
+
+        try
+        {
+            pimpl_->writerDone.get(); //throw FileError
+
+            const AbstractPath logFilePathFinal = AFS::appendRelPath(pimpl_->logFolderPath, generateLogFileName(pimpl_->logFileNameBase, summary.finalStatus));
+            AFS::moveAndRenameItem(*pimpl_->tmpFilePath, logFilePathFinal); //throw FileError, (ErrorDifferentVolume)
+            logFilePath = logFilePathFinal;
+        }
+        catch (FileError&) //e.g. log folder not accessible when sync started => retry the traditional way
+        {
+            try { AFS::removeFilePlain(*pimpl_->tmpFilePath); /*throw FileError*/ }
+            catch (FileError&) {}
+        }
+    }
+
+    if (!logFilePath)
+        try
+        {
+            logFilePath = saveNewLogFile(summary, log, pimpl_->logFolderPath, pimpl_->syncStartTime, notifyStatus); //throw FileError, X
+        }
+        catch (const FileError&) { if (!firstError) firstError = std::current_exception(); };
+
+    try
+    {
+        pimpl_->cleanupDone.get(); //throw FileError
+    }
+    catch (const FileError&) { if (!firstError) firstError = std::current_exception(); };
+
+    if (firstError) //late failure!
+        std::rethrow_exception(firstError);
+
+    return *logFilePath;
+}
@@ -26,6 +26,34 @@ AbstractPath saveLogFile(const ProcessSummary& summary, //throw FileError
                          int logfilesMaxAgeDays,
                          const std::set<AbstractPath>& logFilePathsToKeep,
                          const std::function<void(const std::wstring& msg)>& notifyStatus /*throw X*/);
+
+
+//write log entries while syncing: even a crash leaves a usable log file ("*.log.ffs_tmp") and finalizing is cheap
+//- log file is created and written by a background thread; old log files are cleaned up in parallel
+//- finalize() appends the summary and renames the file to include the final status
+//- falls back to saveLogFile() if the log file could not be written incrementally
+class LogFileWriter
+{
+public:
+    LogFileWriter(const std::wstring& jobName,
+                  const std::chrono::system_clock::time_point& syncStartTime,
+                  const Zstring& altLogFolderPathPhrase, //optional
+                  int logfilesMaxAgeDays,
+                  const std::set<AbstractPath>& logFilePathsToKeep); //noexcept: errors are reported by finalize()
+    ~LogFileWriter();
+
+    void write(const zen::LogEntry& entry); //noexcept; buffered
+
+    AbstractPath finalize(const ProcessSummary& summary, const zen::ErrorLog& log, //throw FileError
+                          const std::function<void(const std::wstring& msg)>& notifyStatus /*throw X*/);
+
+private:
+    LogFileWriter           (const LogFileWriter&) = delete;
+    LogFileWriter& operator=(const LogFileWriter&) = delete;
+
+    struct Impl;
+    const std::unique_ptr<Impl> pimpl_;
+};
 }
 
 #endif //GENERATE_LOGFILE_H_931726432167489732164
@@ -9,9 +9,16 @@
 #include <set>
 #include <zen/thread.h> //includes <std/thread.hpp>
 #include <zen/scope_guard.h>
+#include <zen/file_access.h>
+#include <zen/file_io.h>
+#include <zen/file_traverser.h>
 #include <wx+/image_resources.h>
 #include <wx+/dc.h>
+#include <wx+/zstd_wrap.h>
 #include "icon_loader.h"
+#include "ffs_paths.h"
+
+    #include <sys/stat.h>
 
 
 using namespace zen;
@@ -22,6 +29,14 @@ using AFS = AbstractFileSystem;
 namespace
 {
 const size_t BUFFER_SIZE_MAX = 800; //maximum number of icons to hold in buffer: must be big enough to hold visible icons + preload buffer! Consider OS limit on GDI resources (wxBitmap)!!!
+const size_t BUFFER_BYTES_MAX = 48 * 1024 * 1024; //... and their pixel data: 128 px thumbnail = 64 kB, four times that on high DPI
+
+const size_t ICON_LOADER_THREADS_MAX = 4;
+
+const uint64_t ICON_CACHE_BYTES_MAX = 100 * 1024 * 1024; //persistent cache on disk (compressed)
+const uint64_t ICON_CACHE_PRUNE_BYTES = ICON_CACHE_BYTES_MAX / 10; //don't wait until next session to prune a fast-growing cache: e.g. browsing folders of photos
+const size_t   ICON_CACHE_PRUNE_COUNT = 1000;                      //
+const int ICON_CACHE_FORMAT_VER = 1;
 
 
 //destroys raw icon! Call from GUI thread only!
@@ -39,11 +54,169 @@ wxBitmap extractWxBitmap(ImageHolder&& ih)
 }
 
 
+size_t getByteCount(const ImageHolder& img) { return static_cast<size_t>(img.getWidth()) * img.getHeight() * 4; } //RGB + alpha
+
+
+//persistent icon cache shared by all sessions: one zstd-compressed file per icon, survives restarts of FreeFileSync
+//- file icons: keyed by icon theme + file extension
+//- thumbnails: keyed by file path + size + modification time => outdated entries are never hit again and eventually pruned
+class IconDiskCache
+{
+public:
+    IconDiskCache(const Zstring& folderPath) : folderPath_(folderPath) {}
+
+    //called by worker threads:
+    std::optional<ImageHolder> load(const std::string& key) const //noexcept
+    {
+        const Zstring& entryPath = getEntryPath(key);
+        try
+        {
+            const ByteArray stream = decompressZstd(loadBinContainer<ByteArray>(entryPath, nullptr /*notifyUnbufferedIO*/)); //throw FileError, ZstdInternalError
+            MemoryStreamIn<ByteArray> streamIn(stream);
+
+            if (readNumber<int32_t>(streamIn) != ICON_CACHE_FORMAT_VER || //throw UnexpectedEndOfStreamError
+                readContainer<std::string>(streamIn) != key) //hash collision
+                return {};
+
+            const int  width     = readNumber<int32_t>(streamIn);      //
+            const int  height    = readNumber<int32_t>(streamIn);      //throw UnexpectedEndOfStreamError
+            const bool withAlpha = readNumber<int8_t >(streamIn) != 0; //
+
+            if (width <= 0 || height <= 0 || width > 4096 || height > 4096)
+                throw UnexpectedEndOfStreamError(); //data corruption
+
+            ImageHolder img(width, height, withAlpha);
+            readArray(streamIn, img.getRgb(), static_cast<size_t>(width) * height * 3); //throw UnexpectedEndOfStreamError
+            if (withAlpha)
+                readArray(streamIn, img.getAlpha(), static_cast<size_t>(width) * height); //
+            return img;
+        }
+        catch (FileError&) {} //not (yet) cached
+        catch (ZstdInternalError&)          { try { removeFilePlain(entryPath); } catch (FileError&) {} } //data corruption, e.g. incomplete write
+        catch (UnexpectedEndOfStreamError&) { try { removeFilePlain(entryPath); } catch (FileError&) {} } //
+        return {};
+    }
+
+    void store(const std::string& key, ImageHolder& img) //noexcept; caching is best effort only
+    {
+        assert(img);
+        MemoryStreamOut<ByteArray> streamOut;
+        writeNumber<int32_t>(streamOut, ICON_CACHE_FORMAT_VER);
+        writeContainer(streamOut, key);
+        writeNumber<int32_t>(streamOut, img.getWidth ());
+        writeNumber<int32_t>(streamOut, img.getHeight());
+        writeNumber<int8_t >(streamOut, img.getAlpha() != nullptr);
+        writeArray(streamOut, img.getRgb(), static_cast<size_t>(img.getWidth()) * img.getHeight() * 3);
+        if (img.getAlpha())
+            writeArray(streamOut, img.getAlpha(), static_cast<size_t>(img.getWidth()) * img.getHeight());
+
+        std::call_once(folderCreated_, [&] { try { createDirectoryIfMissingRecursion(folderPath_); /*throw FileError*/ } catch (FileError&) {} });
+
+        //write to temporary file first: other threads and FreeFileSync instances may be reading the same entry
+        const Zstring& entryPath = getEntryPath(key);
+        const Zstring tmpPath = entryPath + Zstr('.') + numberTo<Zstring>(getThreadId()) + Zstr(".tmp");
+        try
+        {
+            const ByteArray streamCompressed = compressZstd(streamOut.ref(), 3); //throw ZstdInternalError
+            saveBinContainer(tmpPath, streamCompressed, nullptr /*notifyUnbufferedIO*/); //throw FileError
+            try
+            {
+                renameFile(tmpPath, entryPath); //throw FileError, ErrorDifferentVolume, ErrorTargetExisting
+            }
+            catch (FileError&) //includes ErrorTargetExisting: someone else was faster
+            {
+                removeFilePlain(tmpPath); //throw FileError
+                return;
+            }
+
+            bool pruneNow = false;
+            {
+                std::lock_guard dummy(lockStored_);
+                ++storedCount_;
+                storedBytes_ += streamCompressed.size();
+
+                if (storedCount_ >= ICON_CACHE_PRUNE_COUNT ||
+                    storedBytes_ >= ICON_CACHE_PRUNE_BYTES)
+                {
+                    storedCount_ = 0;
+                    storedBytes_ = 0;
+                    pruneNow = true;
+                }
+            }
+            if (pruneNow)
+                limitSize(); //noexcept
+        }
+        catch (FileError&) {}
+        catch (ZstdInternalError&) {}
+    }
+
+    void limitSize() //noexcept; remove oldest entries: called at session start and by store() after ICON_CACHE_PRUNE_COUNT/ICON_CACHE_PRUNE_BYTES
+    {
+        std::vector<FileInfo> entries;
+        uint64_t totalBytes = 0;
+
+        traverseFolder(folderPath_, [&](const FileInfo& fi) { entries.push_back(fi); totalBytes += fi.fileSize; },
+                       nullptr, nullptr, [](const std::wstring& errorMsg) {}); //e.g. cache folder not yet existing
+
+        if (totalBytes > ICON_CACHE_BYTES_MAX)
+        {
+            std::sort(entries.begin(), entries.end(), [](const FileInfo& lhs, const FileInfo& rhs) { return lhs.modTime < rhs.modTime; });
+
+            for (const FileInfo& fi : entries)
+            {
+                if (totalBytes <= ICON_CACHE_BYTES_MAX / 2) //leave some room: don't prune every session
+                    break;
+                try
+                {
+                    removeFilePlain(fi.fullPath); //throw FileError
+                    totalBytes -= fi.fileSize;
+                }
+                catch (FileError&) {}
+            }
+        }
+    }
+
+private:
+    Zstring getEntryPath(const std::string& key) const
+    {
+        const uint64_t keyHash = hashBytes<uint64_t>(key.begin(), key.end());
+        return appendSeparator(folderPath_) + printNumber<Zstring>(Zstr("%016llx"), static_cast<unsigned long long>(keyHash)) + Zstr(".dat");
+    }
+
+    const Zstring folderPath_;
+    std::once_flag folderCreated_;
+
+    std::mutex lockStored_;
+    size_t   storedCount_ = 0; //since last limitSize()
+    uint64_t storedBytes_ = 0; //
+};
+
+
+ImageHolder getThumbnailImageCached(const AbstractPath& itemPath, int pixelSize, IconDiskCache& diskCache)
+{
+    //thumbnails are supported for native files only => identify file content via size + modification time
+    std::string cacheKey;
+    if (const std::optional<Zstring> nativePath = AFS::getNativeItemPath(itemPath))
+    {
+        struct ::stat fileInfo = {};
+        if (::stat(nativePath->c_str(), &fileInfo) == 0 && S_ISREG(fileInfo.st_mode))
+            cacheKey = "thumb|" + utfTo<std::string>(*nativePath) + '|' + numberTo<std::string>(fileInfo.st_size) + '|' + numberTo<std::string>(fileInfo.st_mtime);
+    }
+
+    if (!cacheKey.empty())
+        if (std::optional<ImageHolder> img = diskCache.load(cacheKey))
+            return std::move(*img);
+
+    ImageHolder img = AFS::getThumbnailImage(itemPath, pixelSize);
+    if (img && !cacheKey.empty())
+        diskCache.store(cacheKey, img);
+    return img;
+}
 }
 
 //################################################################################################################################################
 
-ImageHolder getDisplayIcon(const AbstractPath& itemPath, IconBuffer::IconSize sz)
+ImageHolder getDisplayIcon(const AbstractPath& itemPath, IconBuffer::IconSize sz, const Zstring& iconThemeName, IconDiskCache& diskCache)
 {
     //1. try to load thumbnails
     switch (sz)
@@ -52,7 +225,7 @@ ImageHolder getDisplayIcon(const AbstractPath& itemPath, IconBuffer::IconSize sz
             break;
         case IconBuffer::SIZE_MEDIUM:
         case IconBuffer::SIZE_LARGE:
-            if (ImageHolder img = AFS::getThumbnailImage(itemPath, IconBuffer::getSize(sz)))
+            if (ImageHolder img = getThumbnailImageCached(itemPath, IconBuffer::getSize(sz), diskCache))
                 return img;
             //else: fallback to non-thumbnail icon
             break;
@@ -60,11 +233,26 @@ ImageHolder getDisplayIcon(const AbstractPath& itemPath, IconBuffer::IconSize sz
 
     const Zstring& templateName = AFS::getItemName(itemPath);
 
+    //file icons are determined by extension in the common case => share across files and sessions
+    //but not for: files without extension, e.g. "AUTHORS" has own mime type on Linux; *.desktop files with individual icons
+    std::string cacheKey;
+    const Zstring& ext = getFileExtension(templateName);
+    if (!ext.empty() && !hasLinkExtension(templateName))
+        cacheKey = "icon|" + utfTo<std::string>(iconThemeName) + '|' + utfTo<std::string>(ext);
+
+    if (!cacheKey.empty())
+        if (std::optional<ImageHolder> ih = diskCache.load(cacheKey))
+            return std::move(*ih);
+
     //2. retrieve file icons
-        if (ImageHolder ih = AFS::getFileIcon(itemPath, IconBuffer::getSize(sz)))
-            return ih;
+    if (ImageHolder ih = AFS::getFileIcon(itemPath, IconBuffer::getSize(sz)))
+    {
+        if (!cacheKey.empty())
+            diskCache.store(cacheKey, ih);
+        return ih;
+    }
 
-    //3. fallbacks
+    //3. fallbacks: do NOT cache! they'd be shared by all files with this extension, e.g. if lookup failed for a single inaccessible file
     if (ImageHolder ih = getIconByTemplatePath(templateName, IconBuffer::getSize(sz)))
         return ih;
 
@@ -108,11 +296,23 @@ public:
         assert(!runningMainThread());
         std::unique_lock dummy(lockFiles_);
 
-        interruptibleWait(conditionNewWork_, dummy, [this] { return !workLoad_.empty(); }); //throw ThreadInterruption
+        for (;;)
+        {
+            interruptibleWait(conditionNewWork_, dummy, [this] { return !workLoad_.empty(); }); //throw ThreadInterruption
 
-        AbstractPath filePath = workLoad_.    back(); //yes, no strong exception guarantee (std::bad_alloc)
-        /**/                    workLoad_.pop_back(); //
-        return filePath;
+            AbstractPath filePath = workLoad_.    back(); //yes, no strong exception guarantee (std::bad_alloc)
+            /**/                    workLoad_.pop_back(); //
+
+            if (inProgress_.insert(filePath).second) //else: already being loaded by another worker thread
+                return filePath;
+        }
+    }
+
+    //context of worker thread: call after icon was inserted into buffer
+    void markDone(const AbstractPath& filePath)
+    {
+        std::lock_guard dummy(lockFiles_);
+        inProgress_.erase(filePath);
     }
 
 private:
@@ -120,6 +320,7 @@ private:
     std::mutex                lockFiles_;
     std::condition_variable   conditionNewWork_; //signal event: data for processing available
     std::vector<AbstractPath> workLoad_; //processes last elements of vector first!
+    std::set<AbstractPath>    inProgress_;
 };
 
 
@@ -164,7 +365,9 @@ public:
         assert(rc.second); //insertion took place
         if (rc.second)
         {
+            refData(rc.first).byteCount = getByteCount(icon);
             refData(rc.first).iconRaw = std::move(icon);
+            totalBytes_ += refData(rc.first).byteCount;
             priorityListPushBack(rc.first);
         }
     }
@@ -176,11 +379,12 @@ public:
         assert(runningMainThread());
         std::lock_guard dummy(lockIconList_);
 
-        while (iconList.size() > BUFFER_SIZE_MAX)
+        while (iconList.size() > BUFFER_SIZE_MAX || totalBytes_ > BUFFER_BYTES_MAX)
         {
             auto itDelPos = firstInsertPos_;
             priorityListPopFront();
-            iconList.erase(itDelPos); //remove oldest element
+            totalBytes_ -= refData(itDelPos).byteCount;
+            iconList.erase(itDelPos); //remove least recently used element
         }
     }
 
@@ -249,7 +453,7 @@ private:
     struct IconData
     {
         IconData() {}
-        IconData(IconData&& tmp) noexcept : iconRaw(std::move(tmp.iconRaw)), iconFmt(std::move(tmp.iconFmt)), prev(tmp.prev), next(tmp.next) {}
+        IconData(IconData&& tmp) noexcept : iconRaw(std::move(tmp.iconRaw)), iconFmt(std::move(tmp.iconFmt)), byteCount(tmp.byteCount), prev(tmp.prev), next(tmp.next) {}
 
         ImageHolder iconRaw; //native icon representation: may be used by any thread
 
@@ -259,12 +463,15 @@ private:
         //- prohibit calls to ~wxBitmap() and transitively ~IconData()
         //- prohibit even wxBitmap() default constructor - better be safe than sorry!
 
+        size_t byteCount = 0; //pixel data of iconRaw, later iconFmt
+
         FileIconMap::iterator prev; //store list sorted by time of insertion into buffer
         FileIconMap::iterator next; //
     };
 
     mutable std::mutex lockIconList_;
     FileIconMap iconList; //shared resource; Zstring is thread-safe like an int
+    size_t totalBytes_ = 0;
     FileIconMap::iterator firstInsertPos_ = iconList.end();
     FileIconMap::iterator lastInsertPos_  = iconList.end();
 };
@@ -276,30 +483,46 @@ private:
 
 struct IconBuffer::Impl
 {
+    Impl(const Zstring& cacheFolderPath) : diskCache(cacheFolderPath) {}
+
     //communication channel used by threads:
-    WorkLoad workload; //manage life time: enclose InterruptibleThread's (until joined)!!!
-    Buffer   buffer;   //
+    WorkLoad      workload;  //manage life time: enclose InterruptibleThread's (until joined)!!!
+    Buffer        buffer;    //
+    IconDiskCache diskCache; //
 
-    InterruptibleThread worker;
+    std::vector<InterruptibleThread> workers;
     //-------------------------
     //-------------------------
     std::map<Zstring, wxBitmap, LessAsciiNoCase> extensionIcons; //no item count limit!? Test case C:\ ~ 3800 unique file extensions
 };
 
 
-IconBuffer::IconBuffer(IconSize sz) : pimpl_(std::make_unique<Impl>()), iconSizeType_(sz)
+IconBuffer::IconBuffer(IconSize sz) :
+    pimpl_(std::make_unique<Impl>(getConfigDirPathPf() + Zstr("IconCache") + FILE_NAME_SEPARATOR + numberTo<Zstring>(getSize(sz)))),
+    iconSizeType_(sz)
 {
-    pimpl_->worker = InterruptibleThread([&workload = pimpl_->workload, &buffer = pimpl_->buffer, sz]
+    const Zstring iconThemeName = getIconThemeName(); //GTK: main thread only!
+
+    //disk cache reads and thumbnail decoding are CPU-bound => load several icons in parallel
+    //icon theme lookups are serialized: GtkIconTheme is not thread-safe (see icon_loader.cpp)
+    const size_t threadCount = std::min<size_t>(std::max<size_t>(std::thread::hardware_concurrency(), 1), ICON_LOADER_THREADS_MAX);
+
+    for (size_t threadIdx = 0; threadIdx < threadCount; ++threadIdx)
+        pimpl_->workers.emplace_back([&workload = pimpl_->workload, &buffer = pimpl_->buffer, &diskCache = pimpl_->diskCache, sz, iconThemeName, threadIdx]
     {
-        setCurrentThreadName("Icon Buffer");
+        setCurrentThreadName(("Icon Buffer " + numberTo<std::string>(threadIdx + 1)).c_str());
+
+        if (threadIdx == 0)
+            diskCache.limitSize();
 
         for (;;)
         {
             //start work: blocks until next icon to load is retrieved:
             const AbstractPath itemPath = workload.extractNext(); //throw ThreadInterruption
+            ZEN_ON_SCOPE_EXIT(workload.markDone(itemPath));
 
             if (!buffer.hasIcon(itemPath)) //perf: workload may contain duplicate entries?
-                buffer.insert(itemPath, getDisplayIcon(itemPath, sz));
+                buffer.insert(itemPath, getDisplayIcon(itemPath, sz, iconThemeName, diskCache));
         }
     });
 }
@@ -308,8 +531,10 @@ IconBuffer::IconBuffer(IconSize sz) : pimpl_(std::make_unique<Impl>()), iconSize
 IconBuffer::~IconBuffer()
 {
     setWorkload({}); //make sure interruption point is always reached! //needed???
-    pimpl_->worker.interrupt();
-    pimpl_->worker.join();
+    for (InterruptibleThread& worker : pimpl_->workers)
+        worker.interrupt();
+    for (InterruptibleThread& worker : pimpl_->workers)
+        worker.join();
 }
 
 
@@ -5,7 +5,9 @@
 // *****************************************************************************
 
 #include "icon_loader.h"
+#include <mutex>
 #include <zen/scope_guard.h>
+#include <zen/thread.h>
 
     #include <gtk/gtk.h>
     #include <sys/stat.h>
@@ -76,19 +78,32 @@ ImageHolder copyToImageHolder(const GdkPixbuf* pixbuf)
 }
 
 
+//GtkIconTheme is not thread-safe, but we're called by several icon loader threads => serialize theme lookups
+//GIO (content type, file info) and GdkPixbuf (thumbnails) are thread-safe and don't need the lock
+std::mutex lockIconTheme;
+
+
 ImageHolder imageHolderFromGicon(GIcon* gicon, int pixelSize)
 {
     if (gicon)
-        if (GtkIconTheme* defaultTheme = ::gtk_icon_theme_get_default()) //not owned!
-            if (GtkIconInfo* iconInfo = ::gtk_icon_theme_lookup_by_gicon(defaultTheme, gicon, pixelSize, GTK_ICON_LOOKUP_USE_BUILTIN)) //this may fail if icon is not installed on system
-            {
-                ZEN_ON_SCOPE_EXIT(::gtk_icon_info_free(iconInfo));
-                if (GdkPixbuf* pixBuf = ::gtk_icon_info_load_icon(iconInfo, nullptr))
+    {
+        GdkPixbuf* pixBuf = nullptr;
+        {
+            std::lock_guard dummy(lockIconTheme);
+
+            if (GtkIconTheme* defaultTheme = ::gtk_icon_theme_get_default()) //not owned!
+                if (GtkIconInfo* iconInfo = ::gtk_icon_theme_lookup_by_gicon(defaultTheme, gicon, pixelSize, GTK_ICON_LOOKUP_USE_BUILTIN)) //this may fail if icon is not installed on system
                 {
-                    ZEN_ON_SCOPE_EXIT(::g_object_unref(pixBuf)); //supersedes "::gdk_pixbuf_unref"!
-                    return copyToImageHolder(pixBuf);
+                    ZEN_ON_SCOPE_EXIT(::gtk_icon_info_free(iconInfo));
+                    pixBuf = ::gtk_icon_info_load_icon(iconInfo, nullptr);
                 }
-            }
+        }
+        if (pixBuf)
+        {
+            ZEN_ON_SCOPE_EXIT(::g_object_unref(pixBuf)); //supersedes "::gdk_pixbuf_unref"!
+            return copyToImageHolder(pixBuf); //pixel copy doesn't need the lock
+        }
+    }
     return ImageHolder();
 }
 }
@@ -190,3 +205,20 @@ ImageHolder fff::getThumbnailImage(const Zstring& filePath, int pixelSize) //ret
 
     return ImageHolder();
 }
+
+
+Zstring fff::getIconThemeName()
+{
+    assert(runningMainThread()); //GtkSettings is not thread-safe
+
+    gchar* themeName = nullptr;
+    if (GtkSettings* settings = ::gtk_settings_get_default()) //not owned!
+        ::g_object_get(settings, "gtk-icon-theme-name", &themeName, nullptr);
+
+    if (themeName)
+    {
+        ZEN_ON_SCOPE_EXIT(::g_free(themeName));
+        return themeName;
+    }
+    return Zstring();
+}
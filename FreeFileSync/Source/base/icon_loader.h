@@ -13,7 +13,7 @@
 
 namespace fff
 {
-//=> all functions are safe to call from multiple threads!
+//=> all functions are safe to call from multiple threads! (icon theme lookups are serialized internally)
 //!!!Note: init COM + system image list before loading icons!!!
 //=> don't call from WM_PAINT handler! https://blogs.msdn.microsoft.com/yvesdolc/2009/08/06/do-you-receive-wm_paint-when-waiting-for-a-com-call-to-return/
 
@@ -23,6 +23,8 @@ zen::ImageHolder genericFileIcon(int pixelSize);
 zen::ImageHolder genericDirIcon (int pixelSize);
 zen::ImageHolder getFileIcon      (const Zstring& filePath, int pixelSize);
 zen::ImageHolder getThumbnailImage(const Zstring& filePath, int pixelSize);
+
+Zstring getIconThemeName(); //call from main thread only! identifies the icon set, e.g. for persistent caching
 }
 
 #endif //ICON_LOADER_H_1348701985713445
@@ -5,13 +5,18 @@
 // *****************************************************************************
 
 #include "localization.h"
-#include <unordered_map>
 #include <map>
 #include <list>
 #include <iterator>
+#include <cstring>
+#include <optional>
 #include <zen/string_tools.h>
 #include <zen/file_traverser.h>
+#include <zen/file_access.h>
 #include <zen/file_io.h>
+#include <zen/stl_tools.h>
+#include <zen/scope_guard.h>
+#include <zen/thread.h>
 #include <zen/i18n.h>
 #include <zen/format_unit.h>
 #include <wx/intl.h>
@@ -19,6 +24,7 @@
 #include "parse_plural.h"
 #include "parse_lng.h"
 #include "ffs_paths.h"
+#include "startup_trace.h"
 
     #include <wchar.h> //wcscasecmp
 
@@ -29,48 +35,412 @@ using namespace fff;
 
 namespace
 {
+/* Translation catalog: compiled from a .lng file and read in place without parsing, e.g. from a memory-mapped file
+    uint32 byte code size, int64 plural form byte code[]
+    uint32 bucket count,   { uint32 hash, uint32 entry position } singular buckets[] (open addressing with linear probing; position 0: empty)
+    uint32 bucket count,   { uint32 hash, uint32 entry position } plural buckets[]   (
+    singular entries: container original, container translation
+    plural entries:   container singular, container plural, uint32 form count, container form[]
+
+    all strings are UTF-8 => 4x smaller than std::wstring on Linux for most languages       */
+struct CatalogBucket
+{
+    uint32_t hash     = 0;
+    uint32_t entryPos = 0;
+};
+
+
+size_t getBucketCount(size_t itemCount) //power of 2 and load factor <= 50%: short probe sequences, at least one empty bucket
+{
+    size_t bucketCount = 2;
+    while (bucketCount < 2 * itemCount)
+        bucketCount *= 2;
+    return bucketCount;
+}
+
+
+uint32_t hashCatalogKey(std::string_view original)
+{
+    return hashBytes<uint32_t>(original.begin(), original.end());
+}
+
+
+uint32_t hashCatalogKey(std::string_view singular, std::string_view plural)
+{
+    const char separator = 0;
+    uint32_t hashVal = hashCatalogKey(singular);
+    hashVal = hashBytesAppend(hashVal, &separator, &separator + 1);
+    return    hashBytesAppend(hashVal, plural.begin(), plural.end());
+}
+
+
+std::string compileCatalog(const lng::TransHeader& header, const lng::TranslationMap& trans, const lng::TranslationPluralMap& transPlural) //throw plural::ParsingError
+{
+    const plural::ByteCode byteCode = plural::PluralForm(header.pluralDefinition).getByteCode(); //throw plural::ParsingError
+
+    std::vector<std::pair<std::string_view, std::string_view>> transNonEmpty;
+    for (const auto& [original, translation] : trans)
+        if (!translation.empty()) //empty translation: fall back to original text
+            transNonEmpty.emplace_back(original, translation);
+
+    std::vector<CatalogBucket> buckets  (getBucketCount(transNonEmpty.size()));
+    std::vector<CatalogBucket> bucketsPl(getBucketCount(transPlural  .size()));
+
+    //entries are placed after the hash tables => positions can be calculated in advance
+    const size_t entriesPos = sizeof(uint32_t) + byteCode .size() * sizeof(int64_t) +
+                              sizeof(uint32_t) + buckets  .size() * sizeof(CatalogBucket) +
+                              sizeof(uint32_t) + bucketsPl.size() * sizeof(CatalogBucket);
+    MemoryStreamOut<std::string> entries;
+
+    auto insertBucket = [&](std::vector<CatalogBucket>& bucketTable, uint32_t hash)
+    {
+        for (size_t i = hash;; ++i)
+            if (CatalogBucket& bucket = bucketTable[i & (bucketTable.size() - 1)];
+                bucket.entryPos == 0)
+            {
+                bucket = { hash, static_cast<uint32_t>(entriesPos + entries.ref().size()) };
+                return;
+            }
+    };
+
+    for (const auto& [original, translation] : transNonEmpty)
+    {
+        insertBucket(buckets, hashCatalogKey(original));
+        writeContainer(entries, original);
+        writeContainer(entries, translation);
+    }
+
+    for (const auto& [singAndPlural, pluralForms] : transPlural)
+    {
+        insertBucket(bucketsPl, hashCatalogKey(singAndPlural.first, singAndPlural.second));
+        writeContainer(entries, singAndPlural.first);
+        writeContainer(entries, singAndPlural.second);
+        writeNumber<uint32_t>(entries, static_cast<uint32_t>(pluralForms.size()));
+        for (const std::string& pf : pluralForms)
+            writeContainer(entries, pf);
+    }
+
+    MemoryStreamOut<std::string> catalog;
+    writeNumber<uint32_t>(catalog, static_cast<uint32_t>(byteCode.size()));
+    writeArray(catalog, byteCode.data(), byteCode.size() * sizeof(int64_t));
+    writeNumber<uint32_t>(catalog, static_cast<uint32_t>(buckets.size()));
+    writeArray(catalog, buckets.data(), buckets.size() * sizeof(CatalogBucket));
+    writeNumber<uint32_t>(catalog, static_cast<uint32_t>(bucketsPl.size()));
+    writeArray(catalog, bucketsPl.data(), bucketsPl.size() * sizeof(CatalogBucket));
+    assert(catalog.ref().size() == entriesPos);
+    writeArray(catalog, entries.ref().c_str(), entries.ref().size());
+    return catalog.ref();
+}
+
+
+//bounds-checked reading at arbitrary positions: catalog data might be corrupted
+class CatalogReader
+{
+public:
+    CatalogReader(std::string_view catalog, size_t pos) : catalog_(catalog), pos_(pos) {}
+
+    template <class T>
+    T readPod() //throw UnexpectedEndOfStreamError
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        T val;
+        std::memcpy(&val, readBytes(sizeof(val)).data(), sizeof(val)); //no alignment requirements
+        return val;
+    }
+
+    std::string_view readString() //throw UnexpectedEndOfStreamError
+    {
+        const size_t len = readPod<uint32_t>(); //throw UnexpectedEndOfStreamError
+        return readBytes(len);                  //
+    }
+
+    std::string_view readBytes(size_t len) //throw UnexpectedEndOfStreamError
+    {
+        if (pos_ > catalog_.size() || catalog_.size() - pos_ < len)
+            throw UnexpectedEndOfStreamError();
+        const std::string_view bytes = catalog_.substr(pos_, len);
+        pos_ += len;
+        return bytes;
+    }
+
+private:
+    std::string_view catalog_;
+    size_t pos_;
+};
+
+
+std::wstring utf8ToWide(std::string_view str)
+{
+    return utfTo<std::wstring>(StringRef<const char>(str.data(), str.data() + str.size()));
+}
+
+
+const char LNG_CACHE_FILE_ID[] = "FFS_LNG"; //8 bytes including 0-termination
+const int LNG_CACHE_FORMAT_VER = 1;
+
+//header index of all .lng files plus their compiled catalogs: application startup only needs to read the index
+class LngCacheFile
+{
+public:
+    struct Entry
+    {
+        Zstring lngFilePath;
+        lng::TransHeader header; //empty if .lng file could not be read
+        std::string_view catalog; //empty if .lng file has errors => reported when language is selected
+    };
+
+    static std::shared_ptr<const LngCacheFile> load(const Zstring& cacheFilePath, const Zstring& lngFolderPath, const std::vector<FileInfo>& lngFiles) //noexcept; nullptr if not existing, outdated or corrupted
+    {
+        try
+        {
+            auto cache = std::make_shared<LngCacheFile>();
+            cache->file_ = std::make_unique<MemoryMappedFile>(cacheFilePath); //throw FileError
+
+            if (cache->parseIndex(cache->file_->ref(), lngFolderPath, lngFiles)) //throw UnexpectedEndOfStreamError
+                return cache;
+        }
+        catch (FileError&) {} //not (yet) cached
+        catch (UnexpectedEndOfStreamError&) {} //data corruption => rebuild
+        return nullptr;
+    }
+
+    static std::shared_ptr<const LngCacheFile> create(const Zstring& cacheFilePath, const Zstring& lngFolderPath, const std::vector<FileInfo>& lngFiles) //noexcept; writing cache file is best effort only
+    {
+        MemoryStreamOut<std::string> streamOut;
+        writeArray(streamOut, LNG_CACHE_FILE_ID, sizeof(LNG_CACHE_FILE_ID));
+        writeNumber<int32_t >(streamOut, LNG_CACHE_FORMAT_VER);
+        writeContainer       (streamOut, utfTo<std::string>(lngFolderPath));
+        writeNumber<uint32_t>(streamOut, static_cast<uint32_t>(lngFiles.size()));
+
+        MemoryStreamOut<std::string> catalogs;
+        for (const FileInfo& fi : lngFiles)
+        {
+            lng::TransHeader header;
+            std::string catalog;
+            try
+            {
+                const std::string stream = loadBinContainer<std::string>(fi.fullPath, nullptr /*notifyUnbufferedIO*/); //throw FileError
+                lng::parseHeader(stream, header); //throw ParsingError
+                try
+                {
+                    lng::TranslationMap       transUtf;
+                    lng::TranslationPluralMap transPluralUtf;
+                    lng::parseLng(stream, header, transUtf, transPluralUtf); //throw ParsingError
+                    catalog = compileCatalog(header, transUtf, transPluralUtf); //throw plural::ParsingError
+                }
+                catch (lng::ParsingError&) {} //report details when language is selected
+                catch (plural::ParsingError&) {} //
+            }
+            catch (FileError&) { assert(false); header = {}; }
+            catch (lng::ParsingError&) { assert(false); header = {}; } //better not show an error message here; scenario: batch jobs
+
+            writeContainer       (streamOut, utfTo<std::string>(fi.itemName));
+            writeNumber<uint64_t>(streamOut, fi.fileSize);
+            writeNumber<int64_t >(streamOut, fi.modTime);
+            writeContainer       (streamOut, header.languageName);
+            writeContainer       (streamOut, header.translatorName);
+            writeContainer       (streamOut, header.localeName);
+            writeContainer       (streamOut, header.flagFile);
+            writeNumber<uint64_t>(streamOut, catalogs.ref().size()); //relative to end of index
+            writeNumber<uint64_t>(streamOut, catalog.size());
+            writeArray(catalogs, catalog.c_str(), catalog.size());
+        }
+        writeArray(streamOut, catalogs.ref().c_str(), catalogs.ref().size());
+
+        //write to temporary file first: other FreeFileSync instances may have the cache file mapped into memory
+        const Zstring tmpPath = cacheFilePath + Zstr('.') + numberTo<Zstring>(getThreadId()) + Zstr(".tmp");
+        try
+        {
+            saveBinContainer(tmpPath, streamOut.ref(), nullptr /*notifyUnbufferedIO*/); //throw FileError
+            ZEN_ON_SCOPE_FAIL(try { removeFilePlain(tmpPath); } catch (FileError&) {});
+            try
+            {
+                renameFile(tmpPath, cacheFilePath); //throw FileError, ErrorDifferentVolume, ErrorTargetExisting
+            }
+            catch (ErrorTargetExisting&) //replace outdated cache: existing memory maps remain valid after the file is deleted
+            {
+                removeFilePlain(cacheFilePath); //throw FileError
+                renameFile(tmpPath, cacheFilePath); //throw FileError, ErrorDifferentVolume, ErrorTargetExisting
+            }
+
+            if (std::shared_ptr<const LngCacheFile> cache = load(cacheFilePath, lngFolderPath, lngFiles)) //noexcept
+                return cache; //prefer memory map: only the selected language's catalog is paged in
+        }
+        catch (FileError&) {}
+
+        //config folder not writable: use in-memory catalogs
+        auto cache = std::make_shared<LngCacheFile>();
+        cache->buffer_ = streamOut.ref();
+        try
+        {
+            [[maybe_unused]] const bool indexValid = cache->parseIndex(cache->buffer_, lngFolderPath, lngFiles); //throw UnexpectedEndOfStreamError
+            assert(indexValid);
+        }
+        catch (UnexpectedEndOfStreamError&) { assert(false); }
+        return cache;
+    }
+
+    const std::vector<Entry>& getEntries() const { return entries_; }
+
+    std::string_view getCatalog(const Zstring& lngFilePath) const
+    {
+        for (const Entry& entry : entries_)
+            if (entry.lngFilePath == lngFilePath)
+                return entry.catalog;
+        return {};
+    }
+
+private:
+    bool parseIndex(std::string_view stream, const Zstring& lngFolderPath, const std::vector<FileInfo>& lngFiles) //throw UnexpectedEndOfStreamError
+    {
+        MemoryStreamIn<std::string_view> streamIn(stream);
+
+        char fileId[sizeof(LNG_CACHE_FILE_ID)] = {};
+        readArray(streamIn, fileId, sizeof(fileId)); //throw UnexpectedEndOfStreamError
+
+        if (!std::equal(fileId, fileId + sizeof(fileId), LNG_CACHE_FILE_ID) ||
+            readNumber<int32_t >(streamIn) != LNG_CACHE_FORMAT_VER ||                //throw UnexpectedEndOfStreamError
+            readContainer<std::string>(streamIn) != utfTo<std::string>(lngFolderPath) || //
+            readNumber<uint32_t>(streamIn) != lngFiles.size())                         //
+            return false;
+
+        std::vector<std::pair<uint64_t, uint64_t>> catalogRanges;
+        entries_.clear();
+
+        for (const FileInfo& fi : lngFiles) //detect changed .lng files, e.g. after an update
+        {
+            if (readContainer<std::string>(streamIn) != utfTo<std::string>(fi.itemName) || //throw UnexpectedEndOfStreamError
+                readNumber<uint64_t>(streamIn) != fi.fileSize ||                        //
+                readNumber<int64_t >(streamIn) != fi.modTime)                           //
+                return false;
+
+            Entry entry;
+            entry.lngFilePath = fi.fullPath;
+            entry.header.languageName   = readContainer<std::string>(streamIn); //
+            entry.header.translatorName = readContainer<std::string>(streamIn); //throw UnexpectedEndOfStreamError
+            entry.header.localeName     = readContainer<std::string>(streamIn); //
+            entry.header.flagFile       = readContainer<std::string>(streamIn); //
+            const uint64_t catalogPos  = readNumber<uint64_t>(streamIn); //
+            const uint64_t catalogSize = readNumber<uint64_t>(streamIn); //
+
+            catalogRanges.emplace_back(catalogPos, catalogSize);
+            entries_.push_back(std::move(entry));
+        }
+
+        const std::string_view catalogs = stream.substr(streamIn.pos());
+        for (size_t i = 0; i < entries_.size(); ++i)
+        {
+            const auto [catalogPos, catalogSize] = catalogRanges[i];
+            if (catalogPos > catalogs.size() || catalogs.size() - catalogPos < catalogSize)
+                throw UnexpectedEndOfStreamError(); //data corruption
+
+            entries_[i].catalog = catalogs.substr(catalogPos, catalogSize);
+        }
+        return true;
+    }
+
+    std::unique_ptr<MemoryMappedFile> file_; //either
+    std::string buffer_;                     //or: cache file could not be written
+    std::vector<Entry> entries_;             //string_views point into file_ or buffer_
+};
+
+//-------------------------------------------------------------------------------------------------
+
 class FFSTranslation : public TranslationHandler
 {
 public:
-    FFSTranslation(const Zstring& lngFilePath, wxLanguage langId); //throw lng::ParsingError, plural::ParsingError
+    FFSTranslation(const Zstring& lngFilePath, wxLanguage langId, const std::shared_ptr<const LngCacheFile>& cacheFile); //throw lng::ParsingError, plural::ParsingError
 
     wxLanguage getLangId() const { return langId_; }
 
     std::wstring translate(const std::wstring& text) const override
     {
-        //look for translation in buffer table
-        auto it = transMapping_.find(text);
-        if (it != transMapping_.end() && !it->second.empty())
-            return it->second;
+        try
+        {
+            //look for translation in catalog's hash table
+            const std::string original = utfTo<std::string>(text);
+            if (std::optional<CatalogReader> entry = findEntry(buckets_, hashCatalogKey(original),
+                                                               [&](CatalogReader& r) { return r.readString() == original; })) //throw UnexpectedEndOfStreamError
+                return utf8ToWide(entry->readString()); //throw UnexpectedEndOfStreamError
+        }
+        catch (UnexpectedEndOfStreamError&) {} //data corruption
         return text; //fallback
     }
 
     std::wstring translate(const std::wstring& singular, const std::wstring& plural, int64_t n) const override
     {
-        auto it = transMappingPl_.find({ singular, plural });
-        if (it != transMappingPl_.end())
+        try
         {
-            const size_t formNo = pluralParser_->getForm(n);
-            assert(formNo < it->second.size());
-            if (formNo < it->second.size())
-                return replaceCpy(it->second[formNo], L"%x", formatNumber(n));
+            const std::string singularUtf = utfTo<std::string>(singular);
+            const std::string pluralUtf   = utfTo<std::string>(plural);
+            if (std::optional<CatalogReader> entry = findEntry(bucketsPl_, hashCatalogKey(singularUtf, pluralUtf),
+                                                               [&](CatalogReader& r) { return r.readString() == singularUtf && r.readString() == pluralUtf; })) //throw UnexpectedEndOfStreamError
+            {
+                const size_t formCount = entry->readPod<uint32_t>(); //throw UnexpectedEndOfStreamError
+                const size_t formNo = pluralParser_->getForm(n);
+                assert(formNo < formCount);
+                if (formNo < formCount)
+                {
+                    for (size_t i = 0; i < formNo; ++i)
+                        entry->readString(); //throw UnexpectedEndOfStreamError
+                    return replaceCpy(utf8ToWide(entry->readString()), L"%x", formatNumber(n)); //throw UnexpectedEndOfStreamError
+                }
+            }
         }
+        catch (UnexpectedEndOfStreamError&) {} //data corruption
         return replaceCpy(std::abs(n) == 1 ? singular : plural, L"%x", formatNumber(n)); //fallback
     }
 
 private:
-    using Translation       = std::unordered_map<std::wstring, std::wstring>; //hash_map is 15% faster than std::map on GCC
-    using TranslationPlural = std::map<std::pair<std::wstring, std::wstring>, std::vector<std::wstring>>;
+    void initCatalog(std::string_view catalog); //throw UnexpectedEndOfStreamError, plural::ParsingError
 
-    Translation       transMapping_; //map original text |-> translation
-    TranslationPlural transMappingPl_;
-    std::unique_ptr<plural::PluralForm> pluralParser_; //bound!
+    template <class KeyMatches>
+    std::optional<CatalogReader> findEntry(std::string_view buckets, uint32_t hash, KeyMatches keyMatches) const //throw UnexpectedEndOfStreamError
+    {
+        const size_t bucketCount = buckets.size() / sizeof(CatalogBucket);
+        for (size_t i = 0; i < bucketCount; ++i) //bound probe sequence: catalog data might be corrupted
+        {
+            CatalogBucket bucket;
+            std::memcpy(&bucket, buckets.data() + ((hash + i) & (bucketCount - 1)) * sizeof(bucket), sizeof(bucket));
+            if (bucket.entryPos == 0)
+                break;
+
+            if (bucket.hash == hash)
+            {
+                CatalogReader entry(catalog_, bucket.entryPos);
+                if (keyMatches(entry)) //throw UnexpectedEndOfStreamError
+                    return entry; //positioned after the key
+            }
+        }
+        return {};
+    }
+
+    std::shared_ptr<const LngCacheFile> cacheFile_; //either: catalog within (memory-mapped) cache file
+    std::string catalogBuf_;                        //or: catalog compiled from .lng file
+
+    std::string_view catalog_;
+    std::string_view buckets_;   //singular translations
+    std::string_view bucketsPl_; //plural translations
+    std::unique_ptr<plural::PluralForm> pluralParser_;
     const wxLanguage langId_;
 };
 
 
-FFSTranslation::FFSTranslation(const Zstring& lngFilePath, wxLanguage langId) : langId_(langId) //throw lng::ParsingError, plural::ParsingError
+FFSTranslation::FFSTranslation(const Zstring& lngFilePath, wxLanguage langId, const std::shared_ptr<const LngCacheFile>& cacheFile) : langId_(langId) //throw lng::ParsingError, plural::ParsingError
 {
+    //perf: use precompiled catalog instead of parsing .lng file
+    if (cacheFile)
+        if (const std::string_view catalog = cacheFile->getCatalog(lngFilePath);
+            !catalog.empty())
+            try
+            {
+                initCatalog(catalog); //throw UnexpectedEndOfStreamError, plural::ParsingError
+                cacheFile_ = cacheFile;
+                return;
+            }
+            catch (UnexpectedEndOfStreamError&) {} //data corruption => compile from .lng file
+            catch (plural::ParsingError&) {}       //
+
     std::string inputStream;
     try
     {
@@ -87,31 +457,49 @@ FFSTranslation::FFSTranslation(const Zstring& lngFilePath, wxLanguage langId) :
     lng::TranslationPluralMap transPluralUtf;
     lng::parseLng(inputStream, header, transUtf, transPluralUtf); //throw ParsingError
 
-    pluralParser_ = std::make_unique<plural::PluralForm>(header.pluralDefinition); //throw plural::ParsingError
+    catalogBuf_ = compileCatalog(header, transUtf, transPluralUtf); //throw plural::ParsingError
+    try
+    {
+        initCatalog(catalogBuf_); //throw UnexpectedEndOfStreamError, plural::ParsingError
+    }
+    catch (UnexpectedEndOfStreamError&) { assert(false); throw plural::ParsingError(); }
+}
 
-    for (const auto& [original, translation] : transUtf)
-        transMapping_.emplace(utfTo<std::wstring>(original),
-                              utfTo<std::wstring>(translation));
 
-    for (const auto& [singAndPlural, pluralForms] : transPluralUtf)
-    {
-        std::vector<std::wstring> transPluralForms;
-        for (const std::string& pf : pluralForms)
-            transPluralForms.push_back(utfTo<std::wstring>(pf));
+void FFSTranslation::initCatalog(std::string_view catalog) //throw UnexpectedEndOfStreamError, plural::ParsingError
+{
+    CatalogReader reader(catalog, 0);
 
-        transMappingPl_.insert(
-        {
-            {
-                utfTo<std::wstring>(singAndPlural.first),
-                utfTo<std::wstring>(singAndPlural.second)
-            },
-            std::move(transPluralForms) });
-    }
+    const size_t byteCodeSize = reader.readPod<uint32_t>(); //throw UnexpectedEndOfStreamError
+    const std::string_view byteCodeBuf = reader.readBytes(byteCodeSize * sizeof(int64_t)); //
+    plural::ByteCode byteCode(byteCodeSize);
+    std::memcpy(byteCode.data(), byteCodeBuf.data(), byteCodeBuf.size());
+    pluralParser_ = std::make_unique<plural::PluralForm>(byteCode); //throw plural::ParsingError
+
+    auto readBuckets = [&]
+    {
+        const size_t bucketCount = reader.readPod<uint32_t>(); //throw UnexpectedEndOfStreamError
+        if (bucketCount == 0 || (bucketCount & (bucketCount - 1)) != 0) //power of 2
+            throw UnexpectedEndOfStreamError(); //data corruption
+        return reader.readBytes(bucketCount * sizeof(CatalogBucket)); //throw UnexpectedEndOfStreamError
+    };
+    buckets_   = readBuckets(); //throw UnexpectedEndOfStreamError
+    bucketsPl_ = readBuckets(); //
+    catalog_ = catalog;
 }
 
 
-std::vector<TranslationInfo> loadTranslations()
+struct TranslationIndex
+{
+    std::vector<TranslationInfo> translations;
+    std::shared_ptr<const LngCacheFile> cacheFile;
+};
+
+
+TranslationIndex loadTranslations()
 {
+    StartupPhase phase("loadTranslations");
+
     std::vector<TranslationInfo> locMapping;
     {
         //default entry:
@@ -125,26 +513,31 @@ std::vector<TranslationInfo> loadTranslations()
     }
 
     //search language files available
-    std::vector<Zstring> lngFilePaths;
+    const Zstring lngFolderPath = fff::getResourceDirPf() + Zstr("Languages");
+    std::vector<FileInfo> lngFiles;
 
-    traverseFolder(fff::getResourceDirPf() + Zstr("Languages"), [&](const FileInfo& fi) //FileInfo is ambiguous on OS X
+    traverseFolder(lngFolderPath, [&](const FileInfo& fi) //FileInfo is ambiguous on OS X
     {
         if (endsWith(fi.fullPath, Zstr(".lng")))
-            lngFilePaths.push_back(fi.fullPath);
+            lngFiles.push_back(fi);
     }, nullptr, nullptr, [&](const std::wstring& errorMsg) { assert(false); }); //errors are not really critical in this context
 
-    for (const Zstring& filePath : lngFilePaths)
-    {
-        try
-        {
-            const std::string stream = loadBinContainer<std::string>(filePath, nullptr /*notifyUnbufferedIO*/); //throw FileError
+    std::sort(lngFiles.begin(), lngFiles.end(), [](const FileInfo& lhs, const FileInfo& rhs) { return lhs.itemName < rhs.itemName; }); //fixed order for cache validation
+
+    //perf: don't parse all .lng files during startup, but read the header index of the cache file (recreated if any .lng file has changed)
+    const Zstring cacheFilePath = fff::getConfigDirPathPf() + Zstr("Languages.cache");
 
-            lng::TransHeader lngHeader;
-            lng::parseHeader(stream, lngHeader); //throw ParsingError
+    std::shared_ptr<const LngCacheFile> cacheFile = LngCacheFile::load(cacheFilePath, lngFolderPath, lngFiles); //noexcept
+    if (!cacheFile)
+        cacheFile = LngCacheFile::create(cacheFilePath, lngFolderPath, lngFiles); //noexcept
+
+    for (const LngCacheFile::Entry& entry : cacheFile->getEntries())
+        if (!entry.header.localeName.empty()) //.lng file could not be read
+        {
+            const lng::TransHeader& lngHeader = entry.header;
 
             assert(!lngHeader.languageName  .empty());
             assert(!lngHeader.translatorName.empty());
-            assert(!lngHeader.localeName    .empty());
             assert(!lngHeader.flagFile      .empty());
             /*
             Some ISO codes are used by multiple wxLanguage IDs which can lead to incorrect mapping by wxLocale::FindLanguageInfo()!!!
@@ -161,21 +554,25 @@ std::vector<TranslationInfo> loadTranslations()
                 newEntry.languageName   = utfTo<std::wstring>(lngHeader.languageName);
                 newEntry.translatorName = utfTo<std::wstring>(lngHeader.translatorName);
                 newEntry.languageFlag   = utfTo<std::wstring>(lngHeader.flagFile);
-                newEntry.langFilePath   = filePath;
+                newEntry.langFilePath   = entry.lngFilePath;
                 locMapping.push_back(newEntry);
             }
             else assert(false);
         }
-        catch (FileError&) { assert(false); }
-        catch (lng::ParsingError&) { assert(false); } //better not show an error message here; scenario: batch jobs
-    }
 
     std::sort(locMapping.begin(), locMapping.end(), [](const TranslationInfo& lhs, const TranslationInfo& rhs)
     {
         return LessNaturalSort()(utfTo<Zstring>(lhs.languageName),
                                  utfTo<Zstring>(rhs.languageName)); //use a more "natural" sort: ignore case and diacritics
     });
-    return locMapping;
+    return { locMapping, cacheFile };
+}
+
+
+const TranslationIndex& getTranslationIndex()
+{
+    static const TranslationIndex index = loadTranslations();
+    return index;
 }
 
 
@@ -445,8 +842,7 @@ private:
 
 const std::vector<TranslationInfo>& fff::getExistingTranslations()
 {
-    static const std::vector<TranslationInfo> translations = loadTranslations();
-    return translations;
+    return getTranslationIndex().translations;
 }
 
 
@@ -481,7 +877,7 @@ void fff::setLanguage(wxLanguage lng) //throw FileError
     else
         try
         {
-            setTranslator(std::make_unique<FFSTranslation>(langFilePath, lng)); //throw lng::ParsingError, plural::ParsingError
+            setTranslator(std::make_unique<FFSTranslation>(langFilePath, lng, getTranslationIndex().cacheFile)); //throw lng::ParsingError, plural::ParsingError
         }
         catch (lng::ParsingError& e)
         {
@@ -10,6 +10,7 @@
 #include <zen/basic_math.h>
 #include <zen/thread.h>
 #include <zen/scope_guard.h>
+#include <zen/string_pool.h>
 //#include "db_file.h"
 //#include "lock_holder.h"
 
@@ -325,6 +326,8 @@ struct TraverserConfig
     AsyncCallback& acb;
     const int threadIdx;
     std::chrono::steady_clock::time_point& lastReportTime; //thread-level
+
+    StringPool<Zstring>& itemNamePool; //shared by all worker threads
 };
 
 
@@ -361,7 +364,7 @@ class BaseDirCallback : public DirCallback
 {
 public:
     BaseDirCallback(const DirectoryKey& baseFolderKey, DirectoryValue& output,
-                    AsyncCallback& acb, int threadIdx, std::chrono::steady_clock::time_point& lastReportTime) :
+                    AsyncCallback& acb, int threadIdx, std::chrono::steady_clock::time_point& lastReportTime, StringPool<Zstring>& itemNamePool) :
         DirCallback(travCfg_ /*not yet constructed!!!*/, Zstring(), output.folderCont, 0 /*level*/),
         travCfg_
     {
@@ -372,7 +375,8 @@ public:
         output.failedItemReads,
         acb,
         threadIdx,
-        lastReportTime
+        lastReportTime,
+        itemNamePool
     }
     {
         if (acb.mayReportCurrentFile(threadIdx, lastReportTime))
@@ -412,7 +416,7 @@ void DirCallback::onFile(const AFS::FileInfo& fi) //throw ThreadInterruption
         Linux: retrieveFileID takes about 50% longer in VM! (avoidable because of redundant stat() call!)
     */
 
-    output_.addSubFile(fi.itemName, FileAttributes(fi.modTime, fi.fileSize, fi.fileId, fi.symlinkInfo != nullptr));
+    output_.addSubFile(cfg_.itemNamePool.intern(fi.itemName), FileAttributes(fi.modTime, fi.fileSize, fi.fileId, fi.symlinkInfo != nullptr));
 
     cfg_.acb.incItemsScanned(); //add 1 element to the progress indicator
 }
@@ -436,7 +440,7 @@ std::shared_ptr<AFS::TraverserCallback> DirCallback::onFolder(const AFS::FolderI
         return nullptr; //do NOT traverse subdirs
     //else: attention! ensure directory filtering is applied later to exclude actually filtered directories
 
-    FolderContainer& subFolder = output_.addSubFolder(fi.itemName, fi.symlinkInfo != nullptr);
+    FolderContainer& subFolder = output_.addSubFolder(cfg_.itemNamePool.intern(fi.itemName), fi.symlinkInfo != nullptr);
     if (passFilter)
         cfg_.acb.incItemsScanned(); //add 1 element to the progress indicator
 
@@ -475,7 +479,7 @@ DirCallback::HandleLink DirCallback::onSymlink(const AFS::SymlinkInfo& si) //thr
         case SymLinkHandling::DIRECT:
             if (cfg_.filter.ref().passFileFilter(linkRelPath)) //always use file filter: Link type may not be "stable" on Linux!
             {
-                output_.addSubLink(si.itemName, LinkAttributes(si.modTime));
+                output_.addSubLink(cfg_.itemNamePool.intern(si.itemName), LinkAttributes(si.modTime));
                 cfg_.acb.incItemsScanned(); //add 1 element to the progress indicator
             }
             return LINK_SKIP;
@@ -535,6 +539,9 @@ void fff::parallelDeviceTraversal(const std::set<DirectoryKey>& foldersToRead,
     for (const DirectoryKey& key : foldersToRead)
         perDeviceFolders[key.folderPath.afsDevice].insert(key);
 
+    //identical item names on left/right side and across folders share memory: FolderContainer => FilePair::itemNameL_/itemNameR_
+    StringPool<Zstring> itemNamePool; //manage life time: enclose InterruptibleThread's!!!
+
     //communication channel used by threads
     AsyncCallback acb(perDeviceFolders.size() /*threadsToFinish*/, cbInterval); //manage life time: enclose InterruptibleThread's!!!
 
@@ -553,7 +560,7 @@ void fff::parallelDeviceTraversal(const std::set<DirectoryKey>& foldersToRead,
         for (const DirectoryKey& key : dirKeys)
             workload.emplace(key, &output[key]); //=> DirectoryValue* unshared for lock-free worker-thread access
 
-        worker.emplace_back([afsDevice = afsDevice /*clang bug :>*/, workload, threadIdx, &acb, parallelOps]() mutable
+        worker.emplace_back([afsDevice = afsDevice /*clang bug :>*/, workload, threadIdx, &acb, parallelOps, &itemNamePool]() mutable
         {
             setCurrentThreadName(("Comp Worker[" + numberTo<std::string>(threadIdx) + "]").c_str());
 
@@ -567,7 +574,7 @@ void fff::parallelDeviceTraversal(const std::set<DirectoryKey>& foldersToRead,
             for (auto& [folderKey, folderVal] : workload)
             {
                 assert(folderKey.folderPath.afsDevice == afsDevice);
-                travWorkload.emplace_back(folderKey.folderPath.afsPath, std::make_shared<BaseDirCallback>(folderKey, *folderVal, acb, threadIdx, lastReportTime));
+                travWorkload.emplace_back(folderKey.folderPath.afsPath, std::make_shared<BaseDirCallback>(folderKey, *folderVal, acb, threadIdx, lastReportTime, itemNamePool));
             }
             AFS::traverseFolderRecursive(afsDevice, travWorkload, parallelOps); //throw ThreadInterruption
         });
@@ -7,23 +7,29 @@
 #ifndef PARSE_PLURAL_H_180465845670839576
 #define PARSE_PLURAL_H_180465845670839576
 
+#include <array>
 #include <memory>
 #include <cstdint>
 #include <functional>
+#include <vector>
 #include <zen/string_base.h>
 
 
 namespace plural
 {
-//expression interface
-struct Expression { virtual ~Expression() {} };
+//byte code for a simple stack machine: plural form definitions are compiled once, e.g. when generating a binary translation catalog
+using ByteCode = std::vector<int64_t>;
 
-template <class T>
-struct Expr : public Expression
+//expression interface
+struct Expression
 {
-    virtual T eval() const = 0;
+    virtual ~Expression() {}
+    virtual void compile(ByteCode& byteCode) const = 0; //append instructions
 };
 
+template <class T>
+struct Expr : public Expression {};
+
 
 class ParsingError {};
 
@@ -31,11 +37,19 @@ class PluralForm
 {
 public:
     PluralForm(const std::string& stream); //throw ParsingError
-    int getForm(int64_t n) const { n_ = std::abs(n) ; return static_cast<int>(expr_->eval()); }
+    explicit PluralForm(const ByteCode& byteCode); //throw ParsingError: validated, e.g. when loaded from file
+
+    int getForm(int64_t n) const;
+
+    const ByteCode& getByteCode() const { return byteCode_; }
 
 private:
-    std::shared_ptr<Expr<int64_t>> expr_;
-    mutable int64_t n_ = 0;
+    void validate(); //throw ParsingError
+
+    //getForm() is const and called concurrently => evaluate on a local stack of fixed size
+    static constexpr int STACK_DEPTH_MAX = 32; //real-world plural forms need < 10, e.g. Arabic: 3
+
+    ByteCode byteCode_;
 };
 
 
@@ -113,6 +127,34 @@ pm-expression:
 
 namespace impl
 {
+enum OpCode : int64_t
+{
+    OP_VARIABLE_N,
+    OP_CONST_NUMBER, //operand: number
+    OP_MODULUS,
+    OP_EQUAL,
+    OP_NOT_EQUAL,
+    OP_LESS,
+    OP_LESS_EQUAL,
+    OP_GREATER,
+    OP_GREATER_EQUAL,
+    OP_AND,
+    OP_OR,
+    OP_JUMP_IF_FALSE, //operand: target position
+    OP_JUMP,          //
+};
+
+inline OpCode getOpCode(std::modulus      <>) { return OP_MODULUS;       }
+inline OpCode getOpCode(std::equal_to     <>) { return OP_EQUAL;         }
+inline OpCode getOpCode(std::not_equal_to <>) { return OP_NOT_EQUAL;     }
+inline OpCode getOpCode(std::less         <>) { return OP_LESS;          }
+inline OpCode getOpCode(std::less_equal   <>) { return OP_LESS_EQUAL;    }
+inline OpCode getOpCode(std::greater      <>) { return OP_GREATER;       }
+inline OpCode getOpCode(std::greater_equal<>) { return OP_GREATER_EQUAL; }
+inline OpCode getOpCode(std::logical_and  <>) { return OP_AND;           }
+inline OpCode getOpCode(std::logical_or   <>) { return OP_OR;            }
+
+
 template <class BinaryOp, class ParamType, class ResultType>
 struct BinaryExp : public Expr<ResultType>
 {
@@ -120,7 +162,13 @@ struct BinaryExp : public Expr<ResultType>
     using ExpRhs = std::shared_ptr<Expr<ParamType>>;
 
     BinaryExp(const ExpLhs& lhs, const ExpRhs& rhs) : lhs_(lhs), rhs_(rhs) { assert(lhs && rhs); }
-    ResultType eval() const override { return BinaryOp()(lhs_->eval(), rhs_->eval()); }
+
+    void compile(ByteCode& byteCode) const override
+    {
+        lhs_->compile(byteCode); //both operands are evaluated, even for && and ||
+        rhs_->compile(byteCode);
+        byteCode.push_back(getOpCode(BinaryOp()));
+    }
 private:
     ExpLhs lhs_;
     ExpRhs rhs_;
@@ -147,7 +195,22 @@ struct ConditionalExp : public Expr<T>
                    const std::shared_ptr<Expr<T>>& thenExp,
                    const std::shared_ptr<Expr<T>>& elseExp) : ifExp_(ifExp), thenExp_(thenExp), elseExp_(elseExp) { assert(ifExp && thenExp && elseExp); }
 
-    T eval() const override { return ifExp_->eval() ? thenExp_->eval() : elseExp_->eval(); }
+    void compile(ByteCode& byteCode) const override
+    {
+        ifExp_->compile(byteCode);
+        byteCode.push_back(OP_JUMP_IF_FALSE);
+        const size_t jumpElsePos = byteCode.size();
+        byteCode.push_back(-1); //set below
+
+        thenExp_->compile(byteCode);
+        byteCode.push_back(OP_JUMP);
+        const size_t jumpEndPos = byteCode.size();
+        byteCode.push_back(-1); //set below
+
+        byteCode[jumpElsePos] = byteCode.size();
+        elseExp_->compile(byteCode);
+        byteCode[jumpEndPos] = byteCode.size();
+    }
 private:
     std::shared_ptr<Expr<bool>> ifExp_;
     std::shared_ptr<Expr<T>> thenExp_;
@@ -158,7 +221,8 @@ private:
 struct ConstNumberExp : public Expr<int64_t>
 {
     ConstNumberExp(int64_t n) : n_(n) {}
-    int64_t eval() const override { return n_; }
+    int64_t getValue() const { return n_; }
+    void compile(ByteCode& byteCode) const override { byteCode.push_back(OP_CONST_NUMBER); byteCode.push_back(n_); }
 private:
     int64_t n_;
 };
@@ -166,10 +230,7 @@ private:
 
 struct VariableNumberNExp : public Expr<int64_t>
 {
-    VariableNumberNExp(int64_t& n) : n_(n) {}
-    int64_t eval() const override { return n_; }
-private:
-    int64_t& n_;
+    void compile(ByteCode& byteCode) const override { byteCode.push_back(OP_VARIABLE_N); }
 };
 
 //-------------------------------------------------------------------------------
@@ -267,10 +328,9 @@ private:
 class Parser
 {
 public:
-    Parser(const std::string& stream, int64_t& n) :
+    Parser(const std::string& stream) :
         scn_(stream),
-        tk_(scn_.getNextToken()), //throw ParsingError
-        n_(n) {}
+        tk_(scn_.getNextToken()) {} //throw ParsingError
 
     std::shared_ptr<Expr<int64_t>> parse() //throw ParsingError; return value always bound!
     {
@@ -380,7 +440,7 @@ private:
 
             //"compile-time" check: n % 0
             if (auto literal = std::dynamic_pointer_cast<ConstNumberExp>(rhs))
-                if (literal->eval() == 0)
+                if (literal->getValue() == 0)
                     throw ParsingError();
 
             e = makeBiExp<std::modulus<>, int64_t>(e, rhs); //throw ParsingError
@@ -393,7 +453,7 @@ private:
         if (token().type == Token::TK_VARIABLE_N)
         {
             nextToken(); //throw ParsingError
-            return std::make_shared<VariableNumberNExp>(n_);
+            return std::make_shared<VariableNumberNExp>();
         }
         else if (token().type == Token::TK_CONST_NUMBER)
         {
@@ -432,7 +492,6 @@ private:
 
     Scanner scn_;
     Token tk_;
-    int64_t& n_;
 };
 }
 
@@ -476,7 +535,167 @@ PluralFormInfo::PluralFormInfo(const std::string& definition, int pluralCount) /
 
 
 inline
-PluralForm::PluralForm(const std::string& stream) : expr_(impl::Parser(stream, n_).parse()) {} //throw ParsingError
+PluralForm::PluralForm(const std::string& stream) //throw ParsingError
+{
+    impl::Parser(stream).parse()->compile(byteCode_); //throw ParsingError
+    validate(); //throw ParsingError
+}
+
+
+inline
+PluralForm::PluralForm(const ByteCode& byteCode) : byteCode_(byteCode) //throw ParsingError
+{
+    validate(); //throw ParsingError
+}
+
+
+inline
+void PluralForm::validate() //throw ParsingError
+{
+    using namespace impl;
+
+    //determine stack depth at each instruction: jumps are forward-only => single pass
+    std::vector<int> depthAt(byteCode_.size() + 1, -1);
+    depthAt[0] = 0;
+
+    auto setDepth = [&](int64_t pos, int depth)
+    {
+        if (pos < 0 || pos >= static_cast<int64_t>(depthAt.size()) ||
+            (depthAt[pos] != -1 && depthAt[pos] != depth))
+            throw ParsingError();
+        depthAt[pos] = depth;
+    };
+
+    for (size_t pos = 0; pos < byteCode_.size();)
+    {
+        int depth = depthAt[pos];
+        if (depth < 0) //unreachable instruction
+            throw ParsingError();
+
+        auto getOperand = [&]
+        {
+            if (pos + 1 >= byteCode_.size() || depthAt[pos + 1] != -1) //no jumps into an operand
+                throw ParsingError();
+            return byteCode_[pos + 1];
+        };
+
+        switch (byteCode_[pos])
+        {
+            case OP_VARIABLE_N:
+                setDepth(pos + 1, ++depth);
+                pos += 1;
+                break;
+
+            case OP_CONST_NUMBER:
+                getOperand(); //throw ParsingError
+                setDepth(pos + 2, ++depth);
+                pos += 2;
+                break;
+
+            case OP_MODULUS:
+            case OP_EQUAL:
+            case OP_NOT_EQUAL:
+            case OP_LESS:
+            case OP_LESS_EQUAL:
+            case OP_GREATER:
+            case OP_GREATER_EQUAL:
+            case OP_AND:
+            case OP_OR:
+                if (depth < 2)
+                    throw ParsingError();
+                setDepth(pos + 1, --depth);
+                pos += 1;
+                break;
+
+            case OP_JUMP_IF_FALSE:
+            {
+                const int64_t target = getOperand(); //throw ParsingError
+                if (depth < 1 || target < static_cast<int64_t>(pos + 2))
+                    throw ParsingError();
+                setDepth(pos + 2, --depth);
+                setDepth(target,    depth);
+                pos += 2;
+            }
+            break;
+
+            case OP_JUMP:
+            {
+                const int64_t target = getOperand(); //throw ParsingError
+                if (target < static_cast<int64_t>(pos + 2))
+                    throw ParsingError();
+                setDepth(target, depth);
+                pos += 2;
+            }
+            break;
+
+            default:
+                throw ParsingError();
+        }
+        if (depth > STACK_DEPTH_MAX)
+            throw ParsingError();
+    }
+
+    if (depthAt.back() != 1)
+        throw ParsingError();
+}
+
+
+inline
+int PluralForm::getForm(int64_t n) const
+{
+    using namespace impl;
+    n = std::abs(n);
+
+    std::array<int64_t, STACK_DEPTH_MAX> stack; //no initialization needed
+    int64_t* sp = stack.data(); //stack depth was checked by validate()
+    for (size_t pos = 0; pos < byteCode_.size();)
+        switch (byteCode_[pos])
+        {
+            case OP_VARIABLE_N:
+                *sp++ = n;
+                pos += 1;
+                break;
+
+            case OP_CONST_NUMBER:
+                *sp++ = byteCode_[pos + 1];
+                pos += 2;
+                break;
+
+            case OP_JUMP_IF_FALSE:
+                pos = *--sp ? pos + 2 : byteCode_[pos + 1];
+                break;
+
+            case OP_JUMP:
+                pos = byteCode_[pos + 1];
+                break;
+
+            default: //binary operators
+            {
+                const int64_t rhs = *--sp;
+                int64_t& lhs = sp[-1];
+                switch (byteCode_[pos])
+                {
+                    case OP_MODULUS:
+                        lhs = rhs != 0 ? lhs % rhs : 0; //n % 0 is only detected at compile time for literals
+                        break;
+                    case OP_EQUAL:         lhs = lhs == rhs; break;
+                    case OP_NOT_EQUAL:     lhs = lhs != rhs; break;
+                    case OP_LESS:          lhs = lhs <  rhs; break;
+                    case OP_LESS_EQUAL:    lhs = lhs <= rhs; break;
+                    case OP_GREATER:       lhs = lhs >  rhs; break;
+                    case OP_GREATER_EQUAL: lhs = lhs >= rhs; break;
+                    case OP_AND:           lhs = lhs && rhs; break;
+                    case OP_OR:            lhs = lhs || rhs; break;
+                    default: assert(false);
+                }
+                pos += 1;
+            }
+            break;
+        }
+
+    assert(sp == stack.data() + 1);
+    return static_cast<int>(stack[0]);
+}
 }
 
 #endif //PARSE_PLURAL_H_180465845670839576
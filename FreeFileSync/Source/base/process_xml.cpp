@@ -10,6 +10,7 @@
 #include <zen/file_io.h>
 #include <zen/time.h>
 #include <wx/intl.h>
+#include <wx+/dpi.h>
 #include "ffs_paths.h"
 #include "../fs/concrete.h"
 
@@ -1450,8 +1451,8 @@ void readConfig(const XmlIn& in, XmlGlobalSettings& cfg, int formatVer)
     XmlIn inWnd = inGui["MainDialog"];
 
     //read application window size and position
-    inWnd.attribute("Width",     cfg.gui.mainDlg.dlgSize.x);
-    inWnd.attribute("Height",    cfg.gui.mainDlg.dlgSize.y);
+    inWnd.attribute("Width",     cfg.gui.mainDlg.dlgSize.width);
+    inWnd.attribute("Height",    cfg.gui.mainDlg.dlgSize.height);
     inWnd.attribute("PosX",      cfg.gui.mainDlg.dlgPos.x);
     inWnd.attribute("PosY",      cfg.gui.mainDlg.dlgPos.y);
     inWnd.attribute("Maximized", cfg.gui.mainDlg.isMaximized);
@@ -2068,8 +2069,8 @@ void writeConfig(const XmlGlobalSettings& cfg, XmlOut& out)
     XmlOut outWnd = outGui["MainDialog"];
 
     //write application window size and position
-    outWnd.attribute("Width",     cfg.gui.mainDlg.dlgSize.x);
-    outWnd.attribute("Height",    cfg.gui.mainDlg.dlgSize.y);
+    outWnd.attribute("Width",     cfg.gui.mainDlg.dlgSize.width);
+    outWnd.attribute("Height",    cfg.gui.mainDlg.dlgSize.height);
     outWnd.attribute("PosX",      cfg.gui.mainDlg.dlgPos.x);
     outWnd.attribute("PosY",      cfg.gui.mainDlg.dlgPos.y);
     outWnd.attribute("Maximized", cfg.gui.mainDlg.isMaximized);
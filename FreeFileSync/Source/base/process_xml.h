@@ -7,12 +7,12 @@
 #ifndef PROCESS_XML_H_28345825704254262435
 #define PROCESS_XML_H_28345825704254262435
 
-#include <wx/gdicmn.h>
+#include <wx/string.h>
 #include "localization.h"
 #include "structures.h"
 #include "../ui/file_grid_attr.h"
 #include "../ui/tree_grid_attr.h" //RTS: avoid tree grid's "file_hierarchy.h" dependency!
-#include "../ui/cfg_grid.h"
+#include "../ui/cfg_grid_attr.h"  //FreeFileSync_Batch: avoid wxWidgets GUI library dependency!
 
 
 namespace fff
@@ -135,6 +135,19 @@ enum FileIconSize
     ICON_SIZE_LARGE
 };
 
+//no wxPoint/wxSize: keep wxWidgets GUI library out of the headless batch runner
+struct WindowPos
+{
+    int x = 0;
+    int y = 0;
+};
+
+struct WindowSize
+{
+    int width  = 0;
+    int height = 0;
+};
+
 
 struct ViewFilterDefault
 {
@@ -192,8 +205,8 @@ struct XmlGlobalSettings
         Gui() {} //clang needs this anyway
         struct
         {
-            wxPoint dlgPos;
-            wxSize dlgSize;
+            WindowPos  dlgPos;
+            WindowSize dlgSize;
             bool isMaximized = false;
 
             bool textSearchRespectCase = false; //good default for Linux, too!
@@ -0,0 +1,122 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#include "startup_trace.h"
+#include <iostream>
+#include <optional>
+#include <vector>
+#include <zen/perf.h>
+#include <zen/thread.h>
+#include <zen/file_io.h>
+#include <zen/time.h>
+#include "resolve_path.h"
+#include "../version/version.h"
+
+    #include <stdlib.h> //getenv()
+    #include <unistd.h> //getpid()
+
+using namespace zen;
+using namespace fff;
+
+
+namespace
+{
+struct PhaseRecord
+{
+    std::string name; //"parent/child"
+    std::chrono::nanoseconds startTime;
+    std::chrono::nanoseconds duration;
+};
+
+
+struct StartupTrace
+{
+    StopWatch processTime; //started during static initialization: close enough to process start
+    std::vector<const char*> activePhases;
+    std::vector<PhaseRecord> phases; //in order of completion
+    std::optional<Zstring> filePathPhrase;
+    bool finished = false;
+} globalTrace; //main thread only: no synchronization needed
+
+
+std::string formatMs(std::chrono::nanoseconds duration)
+{
+    return printNumber<std::string>("%.3f", std::chrono::duration<double, std::milli>(duration).count());
+}
+}
+
+
+StartupPhase::StartupPhase(const char* name) :
+    active_(!globalTrace.finished),
+    startTime_(globalTrace.processTime.elapsed())
+{
+    assert(runningMainThread());
+    if (active_)
+        globalTrace.activePhases.push_back(name);
+}
+
+
+StartupPhase::~StartupPhase()
+{
+    if (active_ && !globalTrace.finished) //writeStartupTrace() may have been called in between
+    {
+        std::string name;
+        for (const char* phaseName : globalTrace.activePhases)
+        {
+            if (!name.empty())
+                name += '/';
+            name += phaseName;
+        }
+        globalTrace.phases.push_back({ name, startTime_, globalTrace.processTime.elapsed() - startTime_ });
+    }
+    if (active_)
+        globalTrace.activePhases.pop_back();
+}
+
+
+void fff::setStartupTraceFilePath(const Zstring& filePathPhrase)
+{
+    assert(runningMainThread());
+    globalTrace.filePathPhrase = filePathPhrase;
+}
+
+
+void fff::writeStartupTrace() //noexcept
+{
+    assert(runningMainThread());
+    if (globalTrace.finished)
+        return;
+    globalTrace.finished = true;
+
+    const std::chrono::nanoseconds totalTime = globalTrace.processTime.elapsed();
+
+    Zstring filePathPhrase;
+    if (globalTrace.filePathPhrase)
+        filePathPhrase = *globalTrace.filePathPhrase;
+    else if (const char* envValue = ::getenv("FFS_STARTUP_TRACE")) //getenv() is not thread-safe!
+        filePathPhrase = envValue;
+
+    if (trimCpy(filePathPhrase).empty()) //not requested
+        return;
+
+    std::vector<PhaseRecord> phases = std::move(globalTrace.phases);
+    std::stable_sort(phases.begin(), phases.end(), [](const PhaseRecord& lhs, const PhaseRecord& rhs) { return lhs.startTime < rhs.startTime; }); //parents before children
+
+    std::string trace = std::string("# FreeFileSync ") + ffsVersion + " startup trace: " +
+                        formatTime<std::string>(Zstr("%Y-%m-%d %H:%M:%S")) + ", process " + numberTo<std::string>(::getpid()) + "\n" +
+                        "phase\tstart_ms\tduration_ms\n" +
+                        "total\t0.000\t" + formatMs(totalTime) + "\n";
+
+    for (const PhaseRecord& pr : phases)
+        trace += pr.name + '\t' + formatMs(pr.startTime) + '\t' + formatMs(pr.duration) + '\n';
+
+    const Zstring filePath = getResolvedFilePath(filePathPhrase);
+    try
+    {
+        saveBinContainer(filePath, trace, nullptr /*notifyUnbufferedIO*/); //throw FileError
+    }
+    catch (const FileError& e) { std::cerr << utfTo<std::string>(e.toString()) << "\n"; } //explicitly requested: don't fail silently
+}
@@ -0,0 +1,42 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#ifndef STARTUP_TRACE_H_3840917325490813
+#define STARTUP_TRACE_H_3840917325490813
+
+#include <chrono>
+#include <zen/zstring.h>
+
+
+namespace fff
+{
+/* Where does the startup time go?
+    - phases are always recorded (negligible overhead), but the trace file is only written on request:
+        environment variable: FFS_STARTUP_TRACE=<file path>
+        command line:         -StartupTrace <file path>
+    - file path supports macros, e.g. %timestamp%: one file per batch job run
+    - tab-separated text, one line per phase: name, start [ms], duration [ms]
+        => times are relative to process start; nested phases are named "parent/child"      */
+class StartupPhase //measure from construction until destruction
+{
+public:
+    explicit StartupPhase(const char* name); //string literal!
+    ~StartupPhase();
+
+private:
+    StartupPhase           (const StartupPhase&) = delete;
+    StartupPhase& operator=(const StartupPhase&) = delete;
+
+    const bool active_;
+    const std::chrono::nanoseconds startTime_;
+};
+
+void setStartupTraceFilePath(const Zstring& filePathPhrase); //takes precedence over FFS_STARTUP_TRACE
+
+void writeStartupTrace(); //noexcept; call once startup is complete; stops recording
+}
+
+#endif //STARTUP_TRACE_H_3840917325490813
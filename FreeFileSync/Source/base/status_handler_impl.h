@@ -10,6 +10,7 @@
 #include <zen/file_error.h>
 #include <zen/thread.h>
 #include "process_callback.h"
+#include "../fs/abstract.h"
 
 
 namespace fff
@@ -481,6 +482,202 @@ void massParallelExecute(const std::vector<std::pair<AbstractPath, ParallelWorkI
 
     acb.waitUntilDone(UI_UPDATE_INTERVAL / 2 /*every ~50 ms*/, callback); //throw X
 }
+
+
+//run "task" on an idle thread of the calling thread's worker pool as soon as one is available: no extra threads!
+using ScheduleHelperTask = std::function<void(const std::function<void()>& task)>;
+
+/* process a folder hierarchy bottom-up, e.g. recursive deletion or versioning: a folder is processed after all of its child items
+   - calling thread processes items itself, while up to "parallelOps - 1" helper tasks join in via "scheduleHelperTask"
+     => parallelism stays within the budget of the caller's worker pool
+   - all callbacks run on the calling thread *and* on helper threads => must be thread-safe!
+   - onBeforeItem() is called right before the item's I/O starts
+   - first exception (FileError, ThreadInterruption, ...): stop processing further items, rethrow after in-flight items are done */
+void processFolderTreeParallel(const AbstractPath& folderPath, const Zstring& relPath, //throw FileError, ThreadInterruption, X
+                               size_t parallelOps,
+                               const ScheduleHelperTask& scheduleHelperTask,
+                               const std::function<void(const AFS::FileInfo& fi, const AbstractPath& filePath, const Zstring& fileRelPath)>& processFile, //throw FileError, X
+                               const std::function<void(const AbstractPath& linkPath,   const Zstring& linkRelPath  )>& processSymlink, //throw FileError, X
+                               const std::function<void(const AbstractPath& folderPath, const Zstring& folderRelPath)>& processFolder,  //throw FileError, X
+                               const std::function<void(AFS::ItemType type, const AbstractPath& itemPath, const Zstring& itemRelPath)>& onBeforeItem) //throw X; optional
+{
+    using namespace zen;
+
+    struct FolderNode
+    {
+        FolderNode(const AbstractPath& folderPathIn, const Zstring& relPathIn, const std::shared_ptr<FolderNode>& parentIn) :
+            folderPath(folderPathIn), relPath(relPathIn), parent(parentIn) {}
+
+        const AbstractPath folderPath;
+        const Zstring relPath;
+        const std::shared_ptr<FolderNode> parent;
+        std::atomic<size_t> tasksPending{ 1 }; //+1 until folder content is scheduled
+    };
+
+    struct SharedState
+    {
+        std::mutex lockState;
+        std::condition_variable conditionStateChanged;
+        RingBuffer<std::function<void()>> tasks; //
+        size_t tasksRunning  = 0;                //protected by "lockState"
+        size_t helpersActive = 0;                //
+        std::exception_ptr firstError;           //
+        std::atomic<bool> cancelled{ false };
+
+        //context of calling thread and helper threads: "tasks" must not be empty
+        void runNextTask(std::unique_lock<std::mutex>& lock) //noexcept
+        {
+            std::function<void()> task = std::move(tasks.    front());
+            /**/                                   tasks.pop_front();
+            ++tasksRunning;
+            lock.unlock();
+            try
+            {
+                task(); //throw FileError, ThreadInterruption, X
+                lock.lock();
+            }
+            catch (...)
+            {
+                lock.lock();
+                if (!firstError)
+                    firstError = std::current_exception();
+                cancelled = true;
+                tasks.clear(); //=> FolderNode::tasksPending never reaches zero: parent folders are skipped
+            }
+            --tasksRunning;
+            conditionStateChanged.notify_all();
+        }
+    };
+    //helper tasks may start after this function has returned => only access "tasks" which is empty by then!
+    const auto shared = std::make_shared<SharedState>();
+
+    auto helperTask = [shared]
+    {
+        std::unique_lock dummy(shared->lockState);
+        while (!shared->tasks.empty())
+            shared->runNextTask(dummy); //noexcept
+        --shared->helpersActive; //decide under same lock as scheduleTask() => no lost helper
+    };
+
+    auto scheduleTask = [&](std::function<void()>&& task)
+    {
+        bool needHelper = false;
+        {
+            std::lock_guard dummy(shared->lockState);
+            if (shared->cancelled)
+                return;
+            shared->tasks.push_back(std::move(task));
+
+            if (shared->helpersActive + 1 < parallelOps)
+            {
+                ++shared->helpersActive;
+                needHelper = true;
+            }
+        }
+        shared->conditionStateChanged.notify_all();
+
+        if (needHelper)
+            scheduleHelperTask(helperTask);
+    };
+
+    auto runItem = [&](AFS::ItemType type, const AbstractPath& itemPath, const Zstring& itemRelPath, const std::function<void()>& io)
+    {
+        if (onBeforeItem)
+            onBeforeItem(type, itemPath, itemRelPath); //throw X
+        io(); //throw FileError, X
+    };
+
+    auto taskDone = [&](std::shared_ptr<FolderNode> node) //no recursion: allow extremely deep hierarchies
+    {
+        for (; node && --node->tasksPending == 0 && !shared->cancelled; node = node->parent)
+            //all child items processed => process folder itself
+            runItem(AFS::ItemType::FOLDER, node->folderPath, node->relPath, [&] { processFolder(node->folderPath, node->relPath); }); //throw FileError, X
+    };
+
+    const size_t ITEMS_PER_TASK = 32; //amortize task overhead, but still distribute large flat folders
+
+    std::function<void(const std::shared_ptr<FolderNode>& node)> processFolderContent;
+    processFolderContent = [&](const std::shared_ptr<FolderNode>& node) //throw FileError
+    {
+        auto files        = std::make_shared<std::vector<AFS::FileInfo>>();
+        auto symlinkNames = std::make_shared<std::vector<Zstring>>();
+        std::vector<Zstring> folderNames;
+
+        AFS::traverseFolderFlat(node->folderPath, //throw FileError
+        [&](const AFS::FileInfo&    fi) { files       ->push_back(fi); },
+        [&](const AFS::FolderInfo&  fi) { folderNames   .push_back(fi.itemName); },
+        [&](const AFS::SymlinkInfo& si) { symlinkNames->push_back(si.itemName); });
+
+        const Zstring relPathPf = node->relPath.empty() ? Zstring() : appendSeparator(node->relPath);
+
+        node->tasksPending += (files       ->size() + ITEMS_PER_TASK - 1) / ITEMS_PER_TASK +
+                              (symlinkNames->size() + ITEMS_PER_TASK - 1) / ITEMS_PER_TASK +
+                              folderNames.size();
+
+        for (const Zstring& folderName : folderNames) //schedule folders first: maximize opportunity for parallelization ASAP
+        {
+            auto subNode = std::make_shared<FolderNode>(AFS::appendRelPath(node->folderPath, folderName), relPathPf + folderName, node);
+            scheduleTask([&, subNode] { processFolderContent(subNode); /*throw FileError*/ });
+        }
+
+        for (size_t i = 0; i < files->size(); i += ITEMS_PER_TASK)
+            scheduleTask([&, node, files, relPathPf, i]
+        {
+            for (size_t j = i; j < std::min(i + ITEMS_PER_TASK, files->size()) && !shared->cancelled; ++j)
+            {
+                const AFS::FileInfo& fi = (*files)[j];
+                const AbstractPath filePath = AFS::appendRelPath(node->folderPath, fi.itemName);
+                const Zstring fileRelPath = relPathPf + fi.itemName;
+
+                runItem(AFS::ItemType::FILE, filePath, fileRelPath, [&] { processFile(fi, filePath, fileRelPath); }); //throw FileError, X
+            }
+            taskDone(node); //throw FileError, X
+        });
+
+        for (size_t i = 0; i < symlinkNames->size(); i += ITEMS_PER_TASK)
+            scheduleTask([&, node, symlinkNames, relPathPf, i]
+        {
+            for (size_t j = i; j < std::min(i + ITEMS_PER_TASK, symlinkNames->size()) && !shared->cancelled; ++j)
+            {
+                const Zstring& linkName = (*symlinkNames)[j];
+                const AbstractPath linkPath = AFS::appendRelPath(node->folderPath, linkName);
+                const Zstring linkRelPath = relPathPf + linkName;
+
+                runItem(AFS::ItemType::SYMLINK, linkPath, linkRelPath, [&] { processSymlink(linkPath, linkRelPath); }); //throw FileError, X
+            }
+            taskDone(node); //throw FileError, X
+        });
+
+        taskDone(node); //folder content is scheduled; throw FileError, X
+    };
+
+    auto rootNode = std::make_shared<FolderNode>(folderPath, relPath, nullptr);
+    scheduleTask([&, rootNode] { processFolderContent(rootNode); /*throw FileError*/ });
+
+    //calling thread works, too: guaranteed progress even if no worker of the pool is idle
+    std::unique_lock dummy(shared->lockState);
+    try
+    {
+        for (;;)
+            if (!shared->tasks.empty())
+                shared->runNextTask(dummy); //noexcept
+            else if (shared->tasksRunning == 0)
+                break;
+            else
+                interruptibleWait(shared->conditionStateChanged, dummy, [&] { return !shared->tasks.empty() || shared->tasksRunning == 0; }); //throw ThreadInterruption
+    }
+    catch (ThreadInterruption&)
+    {
+        shared->cancelled = true;
+        shared->tasks.clear();
+        //in-flight items reference this stack frame => wait: their worker threads are being interrupted as well
+        shared->conditionStateChanged.wait(dummy, [&] { return shared->tasksRunning == 0; });
+        throw;
+    }
+
+    if (shared->firstError)
+        std::rethrow_exception(shared->firstError); //throw FileError, ThreadInterruption, X
+}
 }
 
 //=====================================================================================================================
@@ -470,6 +470,43 @@ void verifyFiles(const AbstractPath& sourcePath, const AbstractPath& targetPath,
     }
 }
 
+
+//same as AFS::removeFolderIfExistsRecursion(), but distributed over up to "parallelOps" threads of the caller's worker pool; callbacks must be thread-safe!
+void removeFolderIfExistsRecursionParallel(const AbstractPath& ap, //throw FileError, X
+                                           const std::function<void (const std::wstring& displayPath)>& onBeforeFileDeletion, //optional
+                                           const std::function<void (const std::wstring& displayPath)>& onBeforeFolderDeletion, //one call for each object!
+                                           size_t parallelOps,
+                                           const ScheduleHelperTask& scheduleHelperTask)
+{
+    if (parallelOps <= 1)
+        return AFS::removeFolderIfExistsRecursion(ap, onBeforeFileDeletion, onBeforeFolderDeletion); //throw FileError
+
+    //no error situation if directory is not existing! manual deletion relies on it!
+    if (std::optional<AFS::ItemType> type = AFS::itemStillExists(ap)) //throw FileError
+    {
+        if (*type == AFS::ItemType::SYMLINK)
+        {
+            if (onBeforeFileDeletion)
+                onBeforeFileDeletion(AFS::getDisplayPath(ap));
+
+            AFS::removeSymlinkPlain(ap); //throw FileError
+        }
+        else
+            processFolderTreeParallel(ap, Zstring(), parallelOps, scheduleHelperTask, //throw FileError, X
+            [](const AFS::FileInfo& /*fi*/, const AbstractPath& filePath, const Zstring& /*fileRelPath*/) { AFS::removeFilePlain(filePath); },
+            [](const AbstractPath& linkPath,   const Zstring& /*linkRelPath*/  ) { AFS::removeSymlinkPlain(linkPath); },
+            [](const AbstractPath& folderPath, const Zstring& /*folderRelPath*/) { AFS::removeFolderPlain(folderPath); },
+            [&](AFS::ItemType itemType, const AbstractPath& itemPath, const Zstring& /*itemRelPath*/)
+            {
+                const std::function<void(const std::wstring& displayPath)>& onBeforeDeletion = itemType == AFS::ItemType::FOLDER ? onBeforeFolderDeletion : onBeforeFileDeletion;
+                if (onBeforeDeletion)
+                    onBeforeDeletion(AFS::getDisplayPath(itemPath)); //throw X
+            });
+    }
+    else //even if the folder did not exist anymore, significant I/O work was done => report
+        if (onBeforeFolderDeletion) onBeforeFolderDeletion(AFS::getDisplayPath(ap));
+}
+
 //#################################################################################################################
 //#################################################################################################################
 
@@ -523,8 +560,10 @@ inline
 void removeFolderIfExistsRecursion(const AbstractPath& ap, //throw FileError
                                    const std::function<void (const std::wstring& displayPath)>& onBeforeFileDeletion, //optional
                                    const std::function<void (const std::wstring& displayPath)>& onBeforeFolderDeletion, //one call for each object!
+                                   size_t parallelOps,
+                                   const ScheduleHelperTask& scheduleHelperTask,
                                    std::mutex& singleThread)
-{ parallelScope([ap, onBeforeFileDeletion, onBeforeFolderDeletion] { AFS::removeFolderIfExistsRecursion(ap, onBeforeFileDeletion, onBeforeFolderDeletion); /*throw FileError*/ }, singleThread); }
+{ parallelScope([=] { removeFolderIfExistsRecursionParallel(ap, onBeforeFileDeletion, onBeforeFolderDeletion, parallelOps, scheduleHelperTask); /*throw FileError*/ }, singleThread); }
 
 
 inline
@@ -560,8 +599,10 @@ void revisionFolder(FileVersioner& versioner,
                     const std::function<void(const std::wstring& displayPathFrom, const std::wstring& displayPathTo)>& onBeforeFileMove,
                     const std::function<void(const std::wstring& displayPathFrom, const std::wstring& displayPathTo)>& onBeforeFolderMove,
                     const IOCallback& notifyUnbufferedIO,
+                    size_t parallelOps,
+                    const ScheduleHelperTask& scheduleHelperTask,
                     std::mutex& singleThread)
-{ parallelScope([=, &versioner] { versioner.revisionFolder(folderPath, relativePath, onBeforeFileMove, onBeforeFolderMove, notifyUnbufferedIO); /*throw FileError*/ }, singleThread); }
+{ parallelScope([=, &versioner] { versioner.revisionFolder(folderPath, relativePath, onBeforeFileMove, onBeforeFolderMove, notifyUnbufferedIO, parallelOps, scheduleHelperTask); /*throw FileError*/ }, singleThread); }
 
 inline
 void verifyFiles(const AbstractPath& apSource, const AbstractPath& apTarget, const IOCallback& notifyUnbufferedIO, std::mutex& singleThread) //throw FileError
@@ -579,12 +620,13 @@ public:
                     DeletionPolicy deletionPolicy,
                     const AbstractPath& versioningFolderPath,
                     VersioningStyle versioningStyle,
-                    time_t syncStartTime);
+                    time_t syncStartTime,
+                    size_t parallelOps); //recursive folder deletion/versioning
 
     //clean-up temporary directory (recycle bin optimization)
     void tryCleanup(ProcessCallback& cb /*throw X*/, bool allowCallbackException); //throw FileError -> call this in non-exceptional code path, i.e. somewhere after sync!
 
-    void removeDirWithCallback (const AbstractPath&   dirPath,   const Zstring& relativePath, AsyncItemStatReporter& statReporter, std::mutex& singleThread); //
+    void removeDirWithCallback (const AbstractPath&   dirPath,   const Zstring& relativePath, AsyncItemStatReporter& statReporter, const ScheduleHelperTask& scheduleHelperTask, std::mutex& singleThread); //
     void removeFileWithCallback(const FileDescriptor& fileDescr, const Zstring& relativePath, AsyncItemStatReporter& statReporter, std::mutex& singleThread); //throw FileError, ThreadInterruption
     void removeLinkWithCallback(const AbstractPath&   linkPath,  const Zstring& relativePath, AsyncItemStatReporter& statReporter, std::mutex& singleThread); //
 
@@ -615,6 +657,7 @@ private:
     const DeletionPolicy deletionPolicy_; //keep it invariant! e.g. consider getOrCreateVersioner() one-time construction!
 
     const AbstractPath baseFolderPath_;
+    const size_t parallelOps_;
     std::unique_ptr<AFS::RecycleSession> recyclerSession_;
 
     //used only for DeletionPolicy::VERSIONING:
@@ -636,9 +679,11 @@ DeletionHandler::DeletionHandler(const AbstractPath& baseFolderPath, //nothrow!
                                  DeletionPolicy deletionPolicy,
                                  const AbstractPath& versioningFolderPath,
                                  VersioningStyle versioningStyle,
-                                 time_t syncStartTime) :
+                                 time_t syncStartTime,
+                                 size_t parallelOps) :
     deletionPolicy_(deletionPolicy),
     baseFolderPath_(baseFolderPath),
+    parallelOps_(parallelOps),
     versioningFolderPath_(versioningFolderPath),
     versioningStyle_(versioningStyle),
     syncStartTime_(syncStartTime),
@@ -721,16 +766,19 @@ void DeletionHandler::tryCleanup(ProcessCallback& cb /*throw X*/, bool allowCall
 
 void DeletionHandler::removeDirWithCallback(const AbstractPath& folderPath,//throw FileError, ThreadInterruption
                                             const Zstring& relativePath,
-                                            AsyncItemStatReporter& statReporter, std::mutex& singleThread)
+                                            AsyncItemStatReporter& statReporter, const ScheduleHelperTask& scheduleHelperTask, std::mutex& singleThread)
 {
+    //callbacks run *outside* singleThread_ lock and on helper threads, too! => protect non-thread-safe statReporter
+    std::mutex lockStats;
+
     switch (deletionPolicy_)
     {
         case DeletionPolicy::PERMANENT:
         {
-            //callbacks run *outside* singleThread_ lock! => fine
-            auto notifyDeletion = [&statReporter](const std::wstring& statusText, const std::wstring& displayPath)
+            auto notifyDeletion = [&statReporter, &lockStats](const std::wstring& statusText, const std::wstring& displayPath)
             {
                 statReporter.reportStatus(replaceCpy(statusText, L"%x", fmtPath(displayPath))); //throw ThreadInterruption
+                std::lock_guard dummy(lockStats);
                 statReporter.reportDelta(1, 0); //it would be more correct to report *after* work was done!
                 //OTOH: ThreadInterruption must not happen after last deletion was successful: allow for transactional file model update!
                 warn_static("=> indeed; fix!?")
@@ -739,7 +787,7 @@ void DeletionHandler::removeDirWithCallback(const AbstractPath& folderPath,//thr
             auto onBeforeFileDeletion = [&](const std::wstring& displayPath) { notifyDeletion(txtRemovingFile_,   displayPath); };
             auto onBeforeDirDeletion  = [&](const std::wstring& displayPath) { notifyDeletion(txtRemovingFolder_, displayPath); };
 
-            parallel::removeFolderIfExistsRecursion(folderPath, onBeforeFileDeletion, onBeforeDirDeletion, singleThread); //throw FileError
+            parallel::removeFolderIfExistsRecursion(folderPath, onBeforeFileDeletion, onBeforeDirDeletion, parallelOps_, scheduleHelperTask, singleThread); //throw FileError
         }
         break;
 
@@ -750,19 +798,26 @@ void DeletionHandler::removeDirWithCallback(const AbstractPath& folderPath,//thr
 
         case DeletionPolicy::VERSIONING:
         {
-            //callbacks run *outside* singleThread_ lock! => fine
-            auto notifyMove = [&statReporter](const std::wstring& statusText, const std::wstring& displayPathFrom, const std::wstring& displayPathTo)
+            auto notifyMove = [&statReporter, &lockStats](const std::wstring& statusText, const std::wstring& displayPathFrom, const std::wstring& displayPathTo)
             {
                 statReporter.reportStatus(replaceCpy(replaceCpy(statusText, L"%x", L"\n" + fmtPath(displayPathFrom)), L"%y", L"\n" + fmtPath(displayPathTo))); //throw ThreadInterruption
+                std::lock_guard dummy(lockStats);
                 statReporter.reportDelta(1, 0); //it would be more correct to report *after* work was done!
                 warn_static("=> indeed; fix!?")
             };
             static_assert(std::is_const_v<decltype(txtMovingFileXtoY_)>, "callbacks better be thread-safe!");
             auto onBeforeFileMove   = [&](const std::wstring& displayPathFrom, const std::wstring& displayPathTo) { notifyMove(txtMovingFileXtoY_,   displayPathFrom, displayPathTo); };
             auto onBeforeFolderMove = [&](const std::wstring& displayPathFrom, const std::wstring& displayPathTo) { notifyMove(txtMovingFolderXtoY_, displayPathFrom, displayPathTo); };
-            auto notifyUnbufferedIO = [&](int64_t bytesDelta) { statReporter.reportDelta(0, bytesDelta); interruptionPoint(); }; //throw ThreadInterruption
+            auto notifyUnbufferedIO = [&](int64_t bytesDelta)
+            {
+                {
+                    std::lock_guard dummy(lockStats);
+                    statReporter.reportDelta(0, bytesDelta);
+                }
+                interruptionPoint(); //throw ThreadInterruption
+            };
 
-            parallel::revisionFolder(getOrCreateVersioner(), folderPath, relativePath, onBeforeFileMove, onBeforeFolderMove, notifyUnbufferedIO, singleThread); //throw FileError, ThreadInterruption
+            parallel::revisionFolder(getOrCreateVersioner(), folderPath, relativePath, onBeforeFileMove, onBeforeFolderMove, notifyUnbufferedIO, parallelOps_, scheduleHelperTask, singleThread); //throw FileError, ThreadInterruption
         }
         break;
     }
@@ -899,6 +954,18 @@ public:
         conditionNewWork_.notify_all();
     }
 
+    //run by the next worker thread that is out of work: e.g. help with a recursive folder deletion
+    void addHelperTask(WorkItem&& wi)
+    {
+        {
+            std::lock_guard dummy(lockWork_);
+            WorkItems items;
+            items.push_back(std::move(wi));
+            pendingWorkload_.push_front(std::move(items)); //don't wait behind regular buckets
+        }
+        conditionNewWork_.notify_all();
+    }
+
 private:
     Workload           (const Workload&) = delete;
     Workload& operator=(const Workload&) = delete;
@@ -946,7 +1013,7 @@ private:
         PASS_NEVER //skip item
     };
 
-    FolderPairSyncer(SyncCtx& syncCtx, std::mutex& singleThread, AsyncCallback& acb) :
+    FolderPairSyncer(SyncCtx& syncCtx, std::mutex& singleThread, AsyncCallback& acb, Workload& workload) :
         errorsModTime_      (syncCtx.errorsModTime),
         delHandlerLeft_     (syncCtx.delHandlerLeft),
         delHandlerRight_    (syncCtx.delHandlerRight),
@@ -954,7 +1021,12 @@ private:
         copyFilePermissions_(syncCtx.copyFilePermissions),
         failSafeFileCopy_   (syncCtx.failSafeFileCopy),
         singleThread_(singleThread),
-        acb_(acb) {}
+        acb_(acb),
+        scheduleHelperTask_([&singleThread, &workload](const std::function<void()>& task)
+    {
+        //helper tasks do file I/O => run *outside* singleThread lock
+        workload.addHelperTask([&singleThread, task] { parallelScope(task, singleThread); });
+    }) {}
 
     static PassNo getPass(const FilePair&    file);
     static PassNo getPass(const SymlinkPair& link);
@@ -1008,6 +1080,7 @@ private:
 
     std::mutex& singleThread_;
     AsyncCallback& acb_;
+    const ScheduleHelperTask scheduleHelperTask_; //recursive folder deletion/versioning: share worker threads of this sync pass
 
     //preload status texts (premature?)
     const std::wstring txtCreatingFile_      {_("Creating file %x"         )};
@@ -1052,9 +1125,9 @@ void FolderPairSyncer::runPass(PassNo pass, SyncCtx& syncCtx, BaseFolderPair& ba
 
     std::mutex singleThread; //only a single worker thread may run at a time, except for parallel file I/O
 
-    AsyncCallback acb;                                //
-    FolderPairSyncer fps(syncCtx, singleThread, acb); //manage life time: enclose InterruptibleThread's!!!
-    Workload workload(threadCount, acb);              //
+    AsyncCallback acb;                                          //
+    Workload workload(threadCount, acb);                        //manage life time: enclose InterruptibleThread's!!!
+    FolderPairSyncer fps(syncCtx, singleThread, acb, workload); //
     workload.addWorkItems(fps.getFolderLevelWorkItems(pass, baseFolder, workload)); //initial workload: set *before* threads get access!
 
     std::vector<InterruptibleThread> worker;
@@ -1200,8 +1273,8 @@ void FolderPairSyncer::setup2StepMove(FilePair& sourceFile, //throw FileError, T
 
     //update file hierarchy
     FilePair& tempFile = sourceFile.base().addSubFile<side>(afterLast(sourceRelPathTmp, FILE_NAME_SEPARATOR, IF_MISSING_RETURN_ALL), sourceFile.getAttributes<side>());
-    static_assert(std::is_same_v<ContainerObject::FileList, std::list<FilePair>>,
-                  "ATTENTION: we're adding to the file list WHILE looping over it! This is only working because std::list iterators are not invalidated by insertion!");
+    static_assert(std::is_same_v<ContainerObject::FileList, FixedList<FilePair>>,
+                  "ATTENTION: we're adding to the file list WHILE looping over it! This is only working because FixedList iterators are not invalidated by insertion!");
     sourceFile.removeObject<side>(); //remove only *after* evaluating "sourceFile, side"!
     //note: this new item is *not* considered at the end of 0th pass because "!sourceWillBeDeleted && !haveNameClash"
 
@@ -2014,9 +2087,7 @@ void FolderPairSyncer::synchronizeFolderInt(FolderPair& folder, SyncOperation sy
                 const SyncStatistics subStats(folder); //counts sub-objects only!
                 AsyncItemStatReporter statReporter(1 + getCUD(subStats), subStats.getBytesToProcess(), acb_);
 
-                delHandlerTrg.removeDirWithCallback(folder.getAbstractPath<sideTrg>(), folder.getRelativePath<sideTrg>(), statReporter, singleThread_); //throw FileError, X
-
-                //TODO: implement parallel folder deletion
+                delHandlerTrg.removeDirWithCallback(folder.getAbstractPath<sideTrg>(), folder.getRelativePath<sideTrg>(), statReporter, scheduleHelperTask_, singleThread_); //throw FileError, X
 
                 folder.refSubFiles  ().clear(); //
                 folder.refSubLinks  ().clear(); //update FolderPair
@@ -2637,17 +2708,27 @@ void fff::synchronize(const std::chrono::system_clock::time_point& syncStartTime
                 };
                 const AbstractPath versioningFolderPath = createAbstractPath(folderPairCfg.versioningFolderPhrase);
 
+                auto getDeletionParallelOps = [&](const AbstractPath& baseFolderPath)
+                {
+                    size_t parallelOps = getDeviceParallelOps(deviceParallelOps, baseFolderPath.afsDevice);
+                    if (folderPairCfg.handleDeletion == DeletionPolicy::VERSIONING)
+                        parallelOps = std::max(parallelOps, getDeviceParallelOps(deviceParallelOps, versioningFolderPath.afsDevice));
+                    return parallelOps;
+                };
+
                 DeletionHandler delHandlerL(baseFolder.getAbstractPath<LEFT_SIDE>(),
                                             getEffectiveDeletionPolicy(baseFolder.getAbstractPath<LEFT_SIDE>()),
                                             versioningFolderPath,
                                             folderPairCfg.versioningStyle,
-                                            std::chrono::system_clock::to_time_t(syncStartTime));
+                                            std::chrono::system_clock::to_time_t(syncStartTime),
+                                            getDeletionParallelOps(baseFolder.getAbstractPath<LEFT_SIDE>()));
 
                 DeletionHandler delHandlerR(baseFolder.getAbstractPath<RIGHT_SIDE>(),
                                             getEffectiveDeletionPolicy(baseFolder.getAbstractPath<RIGHT_SIDE>()),
                                             versioningFolderPath,
                                             folderPairCfg.versioningStyle,
-                                            std::chrono::system_clock::to_time_t(syncStartTime));
+                                            std::chrono::system_clock::to_time_t(syncStartTime),
+                                            getDeletionParallelOps(baseFolder.getAbstractPath<RIGHT_SIDE>()));
 
                 //always (try to) clean up, even if synchronization is aborted!
                 ZEN_ON_SCOPE_EXIT(
@@ -227,15 +227,39 @@ void FileVersioner::revisionSymlinkImpl(const AbstractPath& linkPath, const Zstr
 void FileVersioner::revisionFolder(const AbstractPath& folderPath, const Zstring& relativePath, //throw FileError
                                    const std::function<void(const std::wstring& displayPathFrom, const std::wstring& displayPathTo)>& onBeforeFileMove,
                                    const std::function<void(const std::wstring& displayPathFrom, const std::wstring& displayPathTo)>& onBeforeFolderMove,
-                                   const IOCallback& notifyUnbufferedIO) const
+                                   const IOCallback& notifyUnbufferedIO,
+                                   size_t parallelOps,
+                                   const std::function<void(const std::function<void()>& task)>& scheduleHelperTask) const
 {
     //no error situation if directory is not existing! manual deletion relies on it!
     if (std::optional<AFS::ItemType> type = AFS::itemStillExists(folderPath)) //throw FileError
     {
         if (*type == AFS::ItemType::SYMLINK) //on Linux there is just one type of symlink, and since we do revision file symlinks, we should revision dir symlinks as well!
             revisionSymlinkImpl(folderPath, relativePath, onBeforeFileMove); //throw FileError
-        else
+        else if (parallelOps <= 1)
             revisionFolderImpl(folderPath, relativePath, onBeforeFileMove, onBeforeFolderMove, notifyUnbufferedIO); //throw FileError
+        else
+            //create target directories only when needed in moveFileToVersioning(): avoid empty directories!
+            processFolderTreeParallel(folderPath, relativePath, parallelOps, scheduleHelperTask, //throw FileError, X
+            [&](const AFS::FileInfo& fi, const AbstractPath& filePath, const Zstring& fileRelPath)
+            {
+                assert(!fi.symlinkInfo);
+                const FileDescriptor fileDescr{ filePath, FileAttributes(fi.modTime, fi.fileSize, fi.fileId, false /*isSymlink*/) };
+
+                revisionFileImpl(fileDescr, fileRelPath, nullptr /*onBeforeMove: see onBeforeItem*/, notifyUnbufferedIO); //throw FileError
+            },
+            [&](const AbstractPath& linkPath, const Zstring& linkRelPath) { revisionSymlinkImpl(linkPath, linkRelPath, nullptr /*onBeforeMove*/); /*throw FileError*/ },
+            [&](const AbstractPath& subFolderPath, const Zstring& /*folderRelPath*/) { AFS::removeFolderPlain(subFolderPath); /*throw FileError*/ }, //delete source
+            [&](AFS::ItemType itemType, const AbstractPath& itemPath, const Zstring& itemRelPath)
+            {
+                if (itemType == AFS::ItemType::FOLDER)
+                {
+                    if (onBeforeFolderMove)
+                        onBeforeFolderMove(AFS::getDisplayPath(itemPath), AFS::getDisplayPath(AFS::appendRelPath(versioningFolderPath_, itemRelPath)));
+                }
+                else if (onBeforeFileMove)
+                    onBeforeFileMove(AFS::getDisplayPath(itemPath), AFS::getDisplayPath(generateVersionedPath(itemRelPath)));
+            });
     }
     else //even if the folder did not exist anymore, significant I/O work was done => report
         if (onBeforeFolderMove) onBeforeFolderMove(AFS::getDisplayPath(folderPath), AFS::getDisplayPath(AFS::appendRelPath(versioningFolderPath_, relativePath)));
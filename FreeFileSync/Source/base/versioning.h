@@ -64,7 +64,10 @@ public:
                         const std::function<void(const std::wstring& displayPathFrom, const std::wstring& displayPathTo)>& onBeforeFileMove,   //one call for each object!
                         const std::function<void(const std::wstring& displayPathFrom, const std::wstring& displayPathTo)>& onBeforeFolderMove, //
                         //called frequently if move has to revert to copy + delete => see zen::copyFile for limitations when throwing exceptions!
-                        const zen::IOCallback& notifyUnbufferedIO) const;
+                        const zen::IOCallback& notifyUnbufferedIO,
+                        //> 1: move child items in parallel on helper tasks of the caller's worker pool => callbacks must be thread-safe!
+                        size_t parallelOps,
+                        const std::function<void(const std::function<void()>& task)>& scheduleHelperTask) const;
 
 private:
     FileVersioner           (const FileVersioner&) = delete;
@@ -599,22 +599,30 @@ private:
     //----------------------------------------------------------------------------------------------------------------
     ImageHolder getFileIcon(const AfsPath& afsPath, int pixelSize) const override //noexcept; optional return value
     {
+#ifdef ZEN_HEADLESS //icon_loader.cpp requires GTK
+        return ImageHolder();
+#else
         try
         {
             initComForThread(); //throw FileError
             return fff::getFileIcon(getNativePath(afsPath), pixelSize);
         }
         catch (FileError&) { assert(false); return ImageHolder(); }
+#endif
     }
 
     ImageHolder getThumbnailImage(const AfsPath& afsPath, int pixelSize) const override //noexcept; optional return value
     {
+#ifdef ZEN_HEADLESS
+        return ImageHolder();
+#else
         try
         {
             initComForThread(); //throw FileError
             return fff::getThumbnailImage(getNativePath(afsPath), pixelSize);
         }
         catch (FileError&) { assert(false); return ImageHolder(); }
+#endif
     }
 
     void connectNetworkFolder(const AfsPath& afsPath, bool allowUserInteraction) const override //throw FileError
@@ -28,8 +28,12 @@ BatchStatusHandler::BatchStatusHandler(bool showProgress,
                                        std::chrono::seconds automaticRetryDelay,
                                        const Zstring& postSyncCommand,
                                        PostSyncCondition postSyncCondition,
-                                       PostSyncAction postSyncAction) :
+                                       PostSyncAction postSyncAction,
+                                       const Zstring& altLogFolderPathPhrase,
+                                       int logfilesMaxAgeDays,
+                                       const std::set<AbstractPath>& logFilePathsToKeep) :
     batchErrorHandling_(batchErrorHandling),
+    logFileWriter_(jobName, startTime, altLogFolderPathPhrase, logfilesMaxAgeDays, logFilePathsToKeep),
     automaticRetryCount_(automaticRetryCount),
     automaticRetryDelay_(automaticRetryDelay),
     progressDlg_(createProgressDialog(*this, [this] { this->onProgressDialogTerminate(); }, *this, nullptr /*parentWindow*/, showProgress, autoCloseDialog,
@@ -69,7 +73,14 @@ BatchStatusHandler::~BatchStatusHandler()
 }
 
 
-BatchStatusHandler::Result BatchStatusHandler::reportFinalStatus(const Zstring& altLogFolderPathPhrase, int logfilesMaxAgeDays, const std::set<AbstractPath>& logFilePathsToKeep) //noexcept!!
+void BatchStatusHandler::logMsg(const std::wstring& msg, MessageType type)
+{
+    errorLog_.logMsg(msg, type);
+    logFileWriter_.write(errorLog_.getEntry(errorLog_.size() - 1));
+}
+
+
+BatchStatusHandler::Result BatchStatusHandler::reportFinalStatus() //noexcept!!
 {
     const auto totalTime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now() - startTime_);
 
@@ -80,7 +91,7 @@ BatchStatusHandler::Result BatchStatusHandler::reportFinalStatus(const Zstring&
     {
         if (getAbortStatus())
         {
-            errorLog_.logMsg(_("Stopped"), MSG_TYPE_ERROR); //= user cancel; *not* a MSG_TYPE_FATAL_ERROR!
+            logMsg(_("Stopped"), MSG_TYPE_ERROR); //= user cancel; *not* a MSG_TYPE_FATAL_ERROR!
             return SyncResult::ABORTED;
         }
         else if (errorLog_.getItemCount(MSG_TYPE_ERROR | MSG_TYPE_FATAL_ERROR) > 0)
@@ -89,7 +100,7 @@ BatchStatusHandler::Result BatchStatusHandler::reportFinalStatus(const Zstring&
             return SyncResult::FINISHED_WITH_WARNINGS;
 
         if (getStatsTotal(currentPhase()) == ProgressStats())
-            errorLog_.logMsg(_("Nothing to synchronize"), MSG_TYPE_INFO);
+            logMsg(_("Nothing to synchronize"), MSG_TYPE_INFO);
         return SyncResult::FINISHED_WITH_SUCCESS;
     }();
 
@@ -129,19 +140,19 @@ BatchStatusHandler::Result BatchStatusHandler::reportFinalStatus(const Zstring&
     trim(commandLine);
 
     if (!commandLine.empty())
-        errorLog_.logMsg(replaceCpy(_("Executing command %x"), L"%x", fmtPath(commandLine)), MSG_TYPE_INFO);
+        logMsg(replaceCpy(_("Executing command %x"), L"%x", fmtPath(commandLine)), MSG_TYPE_INFO);
 
     //----------------- always save log under %appdata%\FreeFileSync\Logs ------------------------
-    //create not before destruction: 1. avoid issues with FFS trying to sync open log file 2. simplify transactional retry on failure 3. include status in log file name without rename
-    // 4. failure to write to particular stream must not be retried!
+    //written incrementally as "*.log.ffs_tmp" since sync start: 1. FFS does not sync the open log file 2. finalizing only appends the summary and renames the file to include the status
+    // 3. failure to write to particular stream must not be retried!
     AbstractPath logFilePath = getNullPath();
     try
     {
         //do NOT use tryReportingError()! saving log files should not be cancellable!
         auto notifyStatusNoThrow = [&](const std::wstring& msg) { try { reportStatus(msg); /*throw X*/ } catch (...) {} };
-        logFilePath = saveLogFile(summary, errorLog_, startTime_, altLogFolderPathPhrase, logfilesMaxAgeDays, logFilePathsToKeep, notifyStatusNoThrow /*throw X*/); //throw FileError
+        logFilePath = logFileWriter_.finalize(summary, errorLog_, notifyStatusNoThrow /*throw X*/); //throw FileError
     }
-    catch (const FileError& e) { errorLog_.logMsg(e.toString(), MSG_TYPE_ERROR); }
+    catch (const FileError& e) { logMsg(e.toString(), MSG_TYPE_ERROR); }
 
     //execute post sync command *after* writing log files, so that user can refer to the log via the command!
     if (!commandLine.empty())
@@ -153,7 +164,7 @@ BatchStatusHandler::Result BatchStatusHandler::reportFinalStatus(const Zstring&
             //use ExecutionType::ASYNC until there is reason not to: https://freefilesync.org/forum/viewtopic.php?t=31
             shellExecute(expandMacros(commandLine), ExecutionType::ASYNC); //throw FileError
         }
-        catch (const FileError& e) { errorLog_.logMsg(e.toString(), MSG_TYPE_ERROR); }
+        catch (const FileError& e) { logMsg(e.toString(), MSG_TYPE_ERROR); }
 
     if (progressDlg_)
     {
@@ -200,7 +211,7 @@ BatchStatusHandler::Result BatchStatusHandler::reportFinalStatus(const Zstring&
                             suspendSystem(); //throw FileError
                             autoClose = progressDlg_->getOptionAutoCloseDialog();
                         }
-                        catch (const FileError& e) { errorLog_.logMsg(e.toString(), MSG_TYPE_ERROR); }
+                        catch (const FileError& e) { logMsg(e.toString(), MSG_TYPE_ERROR); }
                     break;
                 case PostSyncAction2::SHUTDOWN:
                     if (mayRunAfterCountDown(_("System: Shut down")))
@@ -209,7 +220,7 @@ BatchStatusHandler::Result BatchStatusHandler::reportFinalStatus(const Zstring&
                             shutdownSystem(); //throw FileError
                             autoClose = true;
                         }
-                        catch (const FileError& e) { errorLog_.logMsg(e.toString(), MSG_TYPE_ERROR); }
+                        catch (const FileError& e) { logMsg(e.toString(), MSG_TYPE_ERROR); }
                     break;
             }
         }
@@ -263,7 +274,7 @@ void BatchStatusHandler::updateDataProcessed(int itemsDelta, int64_t bytesDelta)
 
 void BatchStatusHandler::logInfo(const std::wstring& msg)
 {
-    errorLog_.logMsg(msg, MSG_TYPE_INFO);
+    logMsg(msg, MSG_TYPE_INFO);
 }
 
 
@@ -272,7 +283,7 @@ void BatchStatusHandler::reportWarning(const std::wstring& msg, bool& warningAct
     if (!progressDlg_) abortProcessNow();
     PauseTimers dummy(*progressDlg_);
 
-    errorLog_.logMsg(msg, MSG_TYPE_WARNING);
+    logMsg(msg, MSG_TYPE_WARNING);
 
     if (!warningActive)
         return;
@@ -295,7 +306,7 @@ void BatchStatusHandler::reportWarning(const std::wstring& msg, bool& warningAct
                         break;
 
                     case QuestionButton2::NO: //switch
-                        errorLog_.logMsg(_("Switching to FreeFileSync's main window"), MSG_TYPE_INFO);
+                        logMsg(_("Switching to FreeFileSync's main window"), MSG_TYPE_INFO);
                         switchToGuiRequested_ = true; //treat as a special kind of cancel
                         userAbortProcessNow(); //throw AbortProcess
 
@@ -321,14 +332,14 @@ ProcessCallback::Response BatchStatusHandler::reportError(const std::wstring& ms
     //auto-retry
     if (retryNumber < automaticRetryCount_)
     {
-        errorLog_.logMsg(msg + L"\n-> " + _("Automatic retry"), MSG_TYPE_INFO);
+        logMsg(msg + L"\n-> " + _("Automatic retry"), MSG_TYPE_INFO);
         delayAndCountDown(_("Automatic retry") + (automaticRetryCount_ <= 1 ? L"" :  L" " + numberTo<std::wstring>(retryNumber + 1) + L"/" + numberTo<std::wstring>(automaticRetryCount_)),
         automaticRetryDelay_, [&](const std::wstring& statusMsg) { this->reportStatus(_("Error") + L": " + statusMsg); });
         return ProcessCallback::RETRY;
     }
 
     //always, except for "retry":
-    auto guardWriteLog = makeGuard<ScopeGuardRunMode::ON_EXIT>([&] { errorLog_.logMsg(msg, MSG_TYPE_ERROR); });
+    auto guardWriteLog = makeGuard<ScopeGuardRunMode::ON_EXIT>([&] { logMsg(msg, MSG_TYPE_ERROR); });
 
     if (!progressDlg_->getOptionIgnoreErrors())
     {
@@ -351,7 +362,7 @@ ProcessCallback::Response BatchStatusHandler::reportError(const std::wstring& ms
 
                     case ConfirmationButton3::DECLINE: //retry
                         guardWriteLog.dismiss();
-                        errorLog_.logMsg(msg + L"\n-> " + _("Retrying operation..."), MSG_TYPE_INFO);
+                        logMsg(msg + L"\n-> " + _("Retrying operation..."), MSG_TYPE_INFO);
                         return ProcessCallback::RETRY;
 
                     case ConfirmationButton3::CANCEL:
@@ -379,7 +390,7 @@ void BatchStatusHandler::reportFatalError(const std::wstring& msg)
     if (!progressDlg_) abortProcessNow();
     PauseTimers dummy(*progressDlg_);
 
-    errorLog_.logMsg(msg, MSG_TYPE_FATAL_ERROR);
+    logMsg(msg, MSG_TYPE_FATAL_ERROR);
 
     if (!progressDlg_->getOptionIgnoreErrors())
         switch (batchErrorHandling_)
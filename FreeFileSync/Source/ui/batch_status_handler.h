@@ -12,6 +12,7 @@
 #include "progress_indicator.h"
 #include "../base/status_handler.h"
 #include "../base/process_xml.h"
+#include "../base/generate_logfile.h"
 //#include "../base/return_codes.h"
 
 
@@ -32,7 +33,10 @@ public:
                        std::chrono::seconds automaticRetryDelay,
                        const Zstring& postSyncCommand,
                        PostSyncCondition postSyncCondition,
-                       PostSyncAction postSyncAction); //noexcept!!
+                       PostSyncAction postSyncAction,
+                       const Zstring& altLogFolderPathPhrase,
+                       int logfilesMaxAgeDays,
+                       const std::set<AbstractPath>& logFilePathsToKeep); //noexcept!!
     ~BatchStatusHandler();
 
     void     initNewPhase    (int itemsTotal, int64_t bytesTotal, Phase phaseID) override; //
@@ -50,15 +54,17 @@ public:
         bool switchToGuiRequested;
         AbstractPath logFilePath;
     };
-    Result reportFinalStatus(const Zstring& altLogFolderPathPhrase, int logfilesMaxAgeDays, const std::set<AbstractPath>& logFilePathsToKeep); //noexcept!!
+    Result reportFinalStatus(); //noexcept!!
 
 private:
     void onProgressDialogTerminate();
+    void logMsg(const std::wstring& msg, zen::MessageType type); //add to errorLog_ and log file
 
     bool switchToGuiRequested_ = false;
 
     const BatchErrorHandling batchErrorHandling_;
     zen::ErrorLog errorLog_; //list of non-resolved errors and warnings
+    LogFileWriter logFileWriter_;
 
     const size_t automaticRetryCount_;
     const std::chrono::seconds automaticRetryDelay_;
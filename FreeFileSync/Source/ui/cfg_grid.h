@@ -10,76 +10,12 @@
 #include <wx+/grid.h>
 #include <wx+/dc.h>
 #include <zen/zstring.h>
-#include "../base/return_codes.h"
+#include "cfg_grid_attr.h"
 #include "../fs/native.h"
 
 
 namespace fff
 {
-struct ConfigFileItem
-{
-    ConfigFileItem() {}
-    ConfigFileItem(const Zstring& filePath,
-                   time_t syncTime,
-                   const AbstractPath& logPath,
-                   SyncResult result) :
-        cfgFilePath(filePath),
-        lastSyncTime(syncTime),
-        logFilePath(logPath),
-        logResult(result) {}
-
-    Zstring    cfgFilePath;
-    time_t     lastSyncTime = 0;  //last COMPLETED sync (aborted syncs don't count)
-    AbstractPath logFilePath = getNullPath();     //ANY last sync attempt (including aborted syncs)
-    SyncResult   logResult = SyncResult::ABORTED; //
-};
-
-
-enum class ColumnTypeCfg
-{
-    NAME,
-    LAST_SYNC,
-    LAST_LOG,
-};
-
-
-struct ColAttributesCfg
-{
-    ColumnTypeCfg type    = ColumnTypeCfg::NAME;
-    int           offset  = 0;
-    int           stretch = 0;
-    bool          visible = false;
-};
-
-inline
-std::vector<ColAttributesCfg> getCfgGridDefaultColAttribs()
-{
-    using namespace zen;
-    return
-    {
-        { ColumnTypeCfg::NAME,      fastFromDIP(-117), 1, true },
-        { ColumnTypeCfg::LAST_SYNC, fastFromDIP(  75), 0, true },
-        { ColumnTypeCfg::LAST_LOG,  fastFromDIP(  42), 0, true }, //leave some room for the sort direction indicator
-    };
-}
-
-const ColumnTypeCfg cfgGridLastSortColumnDefault = ColumnTypeCfg::NAME;
-
-inline
-bool getDefaultSortDirection(ColumnTypeCfg colType)
-{
-    switch (colType)
-    {
-        case ColumnTypeCfg::NAME:
-            return true;
-        case ColumnTypeCfg::LAST_SYNC: //actual sort order is "time since last sync"
-            return false;
-        case ColumnTypeCfg::LAST_LOG:
-            return true;
-    }
-    assert(false);
-    return true;
-}
 //---------------------------------------------------------------------------------------------------------------------
 Zstring getLastRunConfigPath();
 
@@ -18,6 +18,7 @@
 #include <wx+/dc.h>
 #include <wx+/image_tools.h>
 #include <wx+/image_resources.h>
+#include <wx+/async_task.h>
 #include "../base/file_hierarchy.h"
 
 using namespace zen;
@@ -197,7 +198,7 @@ public:
 
     void setIconManager(const std::shared_ptr<IconManager>& iconMgr) { iconMgr_ = iconMgr; }
 
-    void setItemPathForm(ItemPathFormat fmt) { itemPathFormat_ = fmt; }
+    void setItemPathForm(ItemPathFormat fmt) { itemPathFormat_ = fmt; cellTextsBuf_.clear(); }
 
     void getUnbufferedIconsForPreload(std::vector<std::pair<ptrdiff_t, AbstractPath>>& newLoad) //return (priority, filepath) list
     {
@@ -354,111 +355,220 @@ private:
         return output;
     }
 
-    std::wstring getValue(size_t row, ColumnType colType) const override
+    struct CellSource //snapshot of a row's raw data: formatting is thread-safe
     {
-        if (const FileSystemObject* fsObj = getRawData(row))
+        enum class Type
         {
-            const ColumnTypeRim colTypeRim = static_cast<ColumnTypeRim>(colType);
+            EMPTY,
+            FOLDER,
+            FILE,
+            SYMLINK,
+        };
+        Type type = Type::EMPTY;
+        std::optional<AbstractPath> itemPath; //ItemPathFormat::FULL_PATH only
+        Zstring relPath; //ItemPathFormat::RELATIVE_PATH only
+        Zstring itemName;
+        uint64_t fileSize = 0;
+        time_t modTime = 0;
+    };
 
-            std::wstring value;
-            visitFSObject(*fsObj, [&](const FolderPair& folder)
-            {
-                value = [&]
-                {
-                    if (folder.isEmpty<side>())
-                        return std::wstring();
+    struct CellTexts //formatted cell contents
+    {
+        FileSystemObject::ObjectIdConst objId = nullptr; //texts are valid for this object only
+        std::wstring itemPath;
+        std::wstring size;
+        std::wstring date;
+        std::wstring extension;
+    };
 
-                    switch (colTypeRim)
-                    {
-                        case ColumnTypeRim::ITEM_PATH:
-                            switch (itemPathFormat_)
-                            {
-                                case ItemPathFormat::FULL_PATH:
-                                    return AFS::getDisplayPath(folder.getAbstractPath<side>());
-                                case ItemPathFormat::RELATIVE_PATH:
-                                    return utfTo<std::wstring>(folder.getRelativePath<side>());
-                                case ItemPathFormat::ITEM_NAME:
-                                    return utfTo<std::wstring>(folder.getItemName<side>());
-                            }
-                            break;
-                        case ColumnTypeRim::SIZE:
-                            return L"<" + _("Folder") + L">";
-                        case ColumnTypeRim::DATE:
-                            return std::wstring();
-                        case ColumnTypeRim::EXTENSION:
-                            return std::wstring();
-                    }
-                    assert(false);
-                    return std::wstring();
-                }();
-            },
+    static CellSource getCellSource(const FileSystemObject& fsObj, ItemPathFormat itemPathFmt)
+    {
+        CellSource src;
+        if (fsObj.isEmpty<side>()) //always show not existing files/dirs/symlinks as empty
+            return src;
 
-            [&](const FilePair& file)
-            {
-                value = [&]
+        switch (itemPathFmt)
+        {
+            case ItemPathFormat::FULL_PATH:
+                src.itemPath = fsObj.getAbstractPath<side>();
+                break;
+            case ItemPathFormat::RELATIVE_PATH:
+                src.relPath = fsObj.getRelativePath<side>();
+                break;
+            case ItemPathFormat::ITEM_NAME:
+                break;
+        }
+        src.itemName = fsObj.getItemName<side>();
+
+        visitFSObject(fsObj, [&](const FolderPair& folder) { src.type = CellSource::Type::FOLDER; },
+
+        [&](const FilePair& file)
+        {
+            src.type     = CellSource::Type::FILE;
+            src.fileSize = file.getFileSize<side>();
+            src.modTime  = file.getLastWriteTime<side>();
+        },
+
+        [&](const SymlinkPair& symlink)
+        {
+            src.type    = CellSource::Type::SYMLINK;
+            src.modTime = symlink.getLastWriteTime<side>();
+        });
+        return src;
+    }
+
+    static std::wstring formatCellText(const CellSource& src, ColumnTypeRim colTypeRim, ItemPathFormat itemPathFmt) //thread-safe
+    {
+        if (src.type == CellSource::Type::EMPTY)
+            return std::wstring();
+
+        switch (colTypeRim)
+        {
+            case ColumnTypeRim::ITEM_PATH:
+                switch (itemPathFmt)
+                {
+                    case ItemPathFormat::FULL_PATH:
+                        return AFS::getDisplayPath(*src.itemPath);
+                    case ItemPathFormat::RELATIVE_PATH:
+                        return utfTo<std::wstring>(src.relPath);
+                    case ItemPathFormat::ITEM_NAME:
+                        return utfTo<std::wstring>(src.itemName);
+                }
+                break;
+
+            case ColumnTypeRim::SIZE:
+                switch (src.type)
                 {
-                    if (file.isEmpty<side>())
-                        return std::wstring();
+                    case CellSource::Type::FOLDER:
+                        return L"<" + _("Folder") + L">";
+                    case CellSource::Type::FILE:
+                        //return utfTo<std::wstring>(file.getFileId<side>()); // -> test file id
+                        return formatNumber(src.fileSize);
+                    case CellSource::Type::SYMLINK:
+                        return L"<" + _("Symlink") + L">";
+                    case CellSource::Type::EMPTY:
+                        break;
+                }
+                break;
 
-                    switch (colTypeRim)
-                    {
-                        case ColumnTypeRim::ITEM_PATH:
-                            switch (itemPathFormat_)
-                            {
-                                case ItemPathFormat::FULL_PATH:
-                                    return AFS::getDisplayPath(file.getAbstractPath<side>());
-                                case ItemPathFormat::RELATIVE_PATH:
-                                    return utfTo<std::wstring>(file.getRelativePath<side>());
-                                case ItemPathFormat::ITEM_NAME:
-                                    return utfTo<std::wstring>(file.getItemName<side>());
-                            }
-                            break;
-                        case ColumnTypeRim::SIZE:
-                            //return utfTo<std::wstring>(file.getFileId<side>()); // -> test file id
-                            return formatNumber(file.getFileSize<side>());
-                        case ColumnTypeRim::DATE:
-                            return formatUtcToLocalTime(file.getLastWriteTime<side>());
-                        case ColumnTypeRim::EXTENSION:
-                            return utfTo<std::wstring>(getFileExtension(file.getItemName<side>()));
-                    }
-                    assert(false);
+            case ColumnTypeRim::DATE:
+                if (src.type == CellSource::Type::FOLDER)
                     return std::wstring();
-                }();
-            },
+                return formatUtcToLocalTime(src.modTime);
 
-            [&](const SymlinkPair& symlink)
+            case ColumnTypeRim::EXTENSION:
+                if (src.type == CellSource::Type::FOLDER)
+                    return std::wstring();
+                return utfTo<std::wstring>(getFileExtension(src.itemName));
+        }
+        assert(false);
+        return std::wstring();
+    }
+
+    static CellTexts formatCellTexts(const CellSource& src, ItemPathFormat itemPathFmt) //thread-safe
+    {
+        CellTexts ct;
+        ct.itemPath  = formatCellText(src, ColumnTypeRim::ITEM_PATH, itemPathFmt);
+        ct.size      = formatCellText(src, ColumnTypeRim::SIZE,      itemPathFmt);
+        ct.date      = formatCellText(src, ColumnTypeRim::DATE,      itemPathFmt);
+        ct.extension = formatCellText(src, ColumnTypeRim::EXTENSION, itemPathFmt);
+        return ct;
+    }
+
+    const CellTexts* getBufferedCellTexts(size_t row) const //return nullptr if not (yet) available
+    {
+        if (const FileSystemObject* fsObj = getRawData(row))
+            if (cellTextsVersion_ && cellTextsVersion_ == getGridDataView()->getDataVersion())
             {
-                value = [&]
-                {
-                    if (symlink.isEmpty<side>())
-                        return std::wstring();
+                auto it = cellTextsBuf_.find(row);
+                if (it != cellTextsBuf_.end() && it->second.objId == fsObj->getId())
+                    return &it->second;
+            }
+        return nullptr;
+    }
 
-                    switch (colTypeRim)
-                    {
-                        case ColumnTypeRim::ITEM_PATH:
-                            switch (itemPathFormat_)
-                            {
-                                case ItemPathFormat::FULL_PATH:
-                                    return AFS::getDisplayPath(symlink.getAbstractPath<side>());
-                                case ItemPathFormat::RELATIVE_PATH:
-                                    return utfTo<std::wstring>(symlink.getRelativePath<side>());
-                                case ItemPathFormat::ITEM_NAME:
-                                    return utfTo<std::wstring>(symlink.getItemName<side>());
-                            }
-                            break;
-                        case ColumnTypeRim::SIZE:
-                            return L"<" + _("Symlink") + L">";
-                        case ColumnTypeRim::DATE:
-                            return formatUtcToLocalTime(symlink.getLastWriteTime<side>());
-                        case ColumnTypeRim::EXTENSION:
-                            return utfTo<std::wstring>(getFileExtension(symlink.getItemName<side>()));
-                    }
-                    assert(false);
-                    return std::wstring();
-                }();
-            });
-            return value;
+    //format cell texts for rows around the visible range on a worker thread: paint only draws buffered data
+    void prefetchCellTexts()
+    {
+        const FileView* view = getGridDataView();
+        if (!view || cellTextsPending_)
+            return;
+
+        const std::optional<uint64_t> dataVersion = view->getDataVersion();
+        if (!dataVersion)
+            return;
+
+        if (cellTextsVersion_ != dataVersion) //comparison data changed: all buffered texts are outdated
+        {
+            cellTextsBuf_.clear();
+            cellTextsVersion_ = dataVersion;
         }
+
+        const auto& [rowFirst, rowLast] = getVisibleRows(refGrid());
+        const ptrdiff_t visibleRowCount = rowLast - rowFirst;
+        const ptrdiff_t prefetchSize = std::max<ptrdiff_t>(20, visibleRowCount); //see getUnbufferedIconsForPreload()
+
+        const ptrdiff_t prefetchFirst = std::max<ptrdiff_t>(rowFirst - prefetchSize, 0);
+        const ptrdiff_t prefetchLast  = std::min<ptrdiff_t>(rowLast  + prefetchSize, view->rowsOnView());
+
+        //limit memory consumption: forget rows far off the visible range
+        eraseIf(cellTextsBuf_, [&](const auto& item)
+        {
+            const ptrdiff_t row = item.first;
+            return row < prefetchFirst - prefetchSize || row >= prefetchLast + prefetchSize;
+        });
+
+        std::vector<std::tuple<size_t /*row*/, FileSystemObject::ObjectIdConst, CellSource>> workload;
+        for (ptrdiff_t row = prefetchFirst; row < prefetchLast; ++row)
+            if (!getBufferedCellTexts(row))
+                if (const FileSystemObject* fsObj = getRawData(row))
+                    workload.emplace_back(row, fsObj->getId(), getCellSource(*fsObj, itemPathFormat_)); //FileSystemObject must only be accessed by main thread!
+
+        if (workload.empty())
+            return;
+
+        cellTextsPending_ = true;
+        cellTextsGuiQueue_.processAsync([workload = std::move(workload), itemPathFmt = itemPathFormat_]
+        {
+            std::vector<std::pair<size_t, CellTexts>> output;
+            for (const auto& [row, objId, src] : workload)
+            {
+                output.emplace_back(row, formatCellTexts(src, itemPathFmt));
+                output.back().second.objId = objId;
+            }
+            return output;
+        },
+        [this, dataVersion, itemPathFmt = itemPathFormat_](std::vector<std::pair<size_t, CellTexts>>&& cellTexts)
+        {
+            cellTextsPending_ = false;
+
+            if (cellTextsVersion_ == dataVersion && itemPathFormat_ == itemPathFmt) //discard if outdated meanwhile
+                for (auto& [row, ct] : cellTexts)
+                    cellTextsBuf_[row] = std::move(ct);
+            //no need to refresh: rows not yet buffered were already drawn with identical (synchronously formatted) texts
+        });
+    }
+
+    std::wstring getValue(size_t row, ColumnType colType) const override
+    {
+        const ColumnTypeRim colTypeRim = static_cast<ColumnTypeRim>(colType);
+
+        if (const CellTexts* ct = getBufferedCellTexts(row))
+            switch (colTypeRim)
+            {
+                case ColumnTypeRim::ITEM_PATH:
+                    return ct->itemPath;
+                case ColumnTypeRim::SIZE:
+                    return ct->size;
+                case ColumnTypeRim::DATE:
+                    return ct->date;
+                case ColumnTypeRim::EXTENSION:
+                    return ct->extension;
+            }
+
+        if (const FileSystemObject* fsObj = getRawData(row))
+            return formatCellText(getCellSource(*fsObj, itemPathFormat_), colTypeRim, itemPathFormat_);
+
         //if data is not found:
         return std::wstring();
     }
@@ -491,6 +601,9 @@ private:
             rectTmp.width -= extent.GetWidth();
         };
 
+        if (!getBufferedCellTexts(row)) //new rows on screen: prepare the next ones asynchronously
+            prefetchCellTexts();
+
         const std::wstring cellValue = getValue(row, colType);
 
         switch (static_cast<ColumnTypeRim>(colType))
@@ -765,6 +878,11 @@ private:
 
     std::vector<char> failedLoads_; //effectively a vector<bool> of size "number of rows"
     std::optional<wxBitmap> renderBuf_; //avoid costs of recreating this temporary variable
+
+    std::unordered_map<size_t, CellTexts> cellTextsBuf_; //row => formatted texts for rows around the visible range
+    std::optional<uint64_t> cellTextsVersion_; //FileView::getDataVersion() the buffered texts were created for
+    bool cellTextsPending_ = false;
+    AsyncGuiQueue cellTextsGuiQueue_; //destroy first: evalOnGui references "this"
 };
 
 
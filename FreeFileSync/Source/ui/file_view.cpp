@@ -7,6 +7,8 @@
 #include "file_view.h"
 #include <zen/stl_tools.h>
 #include <zen/perf.h>
+#include <zen/thread.h>
+#include <zen/scope_guard.h>
 #include "sorting.h"
 #include "../base/synchronization.h"
 
@@ -51,45 +53,151 @@ void addNumbers(const FileSystemObject& fsObj, StatusResult& result)
 }
 
 
-template <class Predicate>
-void FileView::updateView(Predicate pred)
+std::optional<uint64_t> FileView::getDataVersion() const
+{
+    uint64_t dataVersion = 0;
+    for (const std::weak_ptr<const BaseFolderPair>& baseFolderWeak : baseFolders_)
+        if (std::shared_ptr<const BaseFolderPair> baseFolder = baseFolderWeak.lock())
+            dataVersion += baseFolder->getChangeCount(); //change counts are only ever incremented => sum changes if any of them changes
+        else
+            return {}; //comparison data is gone
+    return dataVersion;
+}
+
+
+template <class GetCategory>
+void FileView::updateCategoryIndex(CategoryIndex& index, size_t categoryCount, GetCategory getCategory)
+{
+    const std::optional<uint64_t> dataVersion = getDataVersion();
+    if (dataVersion && index.dataVersion == dataVersion)
+        return; //nothing changed since last call
+
+    //PERF_START;
+    index.rows.clear();
+    index.rows.resize(2 * categoryCount);
+
+    const size_t wordCount = (sortedRef_.size() + 63) / 64;
+
+    for (size_t row = 0; row < sortedRef_.size(); ++row)
+        if (const FileSystemObject* fsObj = FileSystemObject::retrieve(sortedRef_[row].objId))
+        {
+            const size_t category = getCategory(*fsObj);
+            assert(category < categoryCount);
+
+            CategoryRows& catRows = index.rows[2 * category + (fsObj->isActive() ? 1 : 0)];
+            if (catRows.rowBits.empty())
+                catRows.rowBits.resize(wordCount); //most categories are empty or small => allocate on demand
+
+            catRows.rowBits[row / 64] |= uint64_t(1) << (row % 64);
+            ++catRows.rowCount;
+
+            //calculate total number of bytes for each side
+            addNumbers(*fsObj, catRows);
+        }
+
+    index.dataVersion = dataVersion;
+}
+
+
+template <class StatusResult>
+void FileView::updateView(const std::vector<const CategoryRows*>& rowsOnView, StatusResult& result)
 {
     viewRef_.clear();
     rowPositions_.clear();
     rowPositionsFirstChild_.clear();
+    rowPositionsValid_ = false;
 
-    for (const RefIndex& ref : sortedRef_)
+    std::vector<const CategoryRows*> rowsNonEmpty;
+    size_t viewSize = 0;
+
+    for (const CategoryRows* catRows : rowsOnView)
     {
-        if (const FileSystemObject* fsObj = FileSystemObject::retrieve(ref.objId))
-            if (pred(*fsObj))
+        result.filesOnLeftView    += catRows->filesOnLeftView;
+        result.foldersOnLeftView  += catRows->foldersOnLeftView;
+        result.filesOnRightView   += catRows->filesOnRightView;
+        result.foldersOnRightView += catRows->foldersOnRightView;
+
+        result.filesizeLeftView  += catRows->filesizeLeftView;
+        result.filesizeRightView += catRows->filesizeRightView;
+
+        if (catRows->rowCount > 0)
+        {
+            rowsNonEmpty.push_back(catRows);
+            viewSize += catRows->rowCount;
+        }
+    }
+
+    viewRef_.reserve(viewSize);
+
+    //combine category bitmaps: 64 rows at a time
+    const size_t wordCount = (sortedRef_.size() + 63) / 64;
+    for (size_t i = 0; i < wordCount; ++i)
+    {
+        uint64_t rowBits = 0;
+        for (const CategoryRows* catRows : rowsNonEmpty)
+            rowBits |= catRows->rowBits[i];
+
+        while (rowBits != 0)
+        {
+            const size_t row = i * 64 + __builtin_ctzll(rowBits);
+            rowBits &= rowBits - 1; //clear lowest bit
+
+            viewRef_.push_back(sortedRef_[row].objId);
+        }
+    }
+    assert(viewRef_.size() == viewSize);
+}
+
+
+void FileView::invalidateView()
+{
+    viewRef_.clear();
+    rowPositions_.clear();
+    rowPositionsFirstChild_.clear();
+    rowPositionsValid_ = false;
+
+    //category indexes refer to positions on sortedRef_
+    cmpResultIndex_  .dataVersion = {};
+    syncPreviewIndex_.dataVersion = {};
+}
+
+
+void FileView::updateRowPositions() const
+{
+    if (rowPositionsValid_)
+        return;
+
+    rowPositions_.clear();
+    rowPositionsFirstChild_.clear();
+
+    for (size_t row = 0; row < viewRef_.size(); ++row)
+        if (const FileSystemObject* fsObj = FileSystemObject::retrieve(viewRef_[row]))
+        {
+            //save row position for direct random access to FilePair or FolderPair
+            rowPositions_.emplace(viewRef_[row], row); //costs: 0.28 µs per call - MSVC based on std::set
+
+            //save row position to identify first child *on sorted subview* of FolderPair or BaseFolderPair in case latter are filtered out
+            const ContainerObject* parent = &fsObj->parent();
+            for (;;) //map all yet unassociated parents to this row
             {
-                //save row position for direct random access to FilePair or FolderPair
-                this->rowPositions_.emplace(ref.objId, viewRef_.size()); //costs: 0.28 µs per call - MSVC based on std::set
-                //"this->" required by two-pass lookup as enforced by GCC 4.7
-
-                //save row position to identify first child *on sorted subview* of FolderPair or BaseFolderPair in case latter are filtered out
-                const ContainerObject* parent = &fsObj->parent();
-                for (;;) //map all yet unassociated parents to this row
-                {
-                    const auto rv = this->rowPositionsFirstChild_.emplace(parent, viewRef_.size());
-                    if (!rv.second)
-                        break;
-
-                    if (auto folder = dynamic_cast<const FolderPair*>(parent))
-                        parent = &(folder->parent());
-                    else
-                        break;
-                }
-
-                //build subview
-                this->viewRef_.push_back(ref.objId);
+                const auto rv = rowPositionsFirstChild_.emplace(parent, row);
+                if (!rv.second)
+                    break;
+
+                if (auto folder = dynamic_cast<const FolderPair*>(parent))
+                    parent = &(folder->parent());
+                else
+                    break;
             }
-    }
+        }
+
+    rowPositionsValid_ = true;
 }
 
 
 ptrdiff_t FileView::findRowDirect(FileSystemObject::ObjectIdConst objId) const
 {
+    updateRowPositions();
     auto it = rowPositions_.find(objId);
     return it != rowPositions_.end() ? it->second : -1;
 }
@@ -97,6 +205,7 @@ ptrdiff_t FileView::findRowDirect(FileSystemObject::ObjectIdConst objId) const
 
 ptrdiff_t FileView::findRowFirstChild(const ContainerObject* hierObj) const
 {
+    updateRowPositions();
     auto it = rowPositionsFirstChild_.find(hierObj);
     return it != rowPositionsFirstChild_.end() ? it->second : -1;
 }
@@ -111,54 +220,39 @@ FileView::StatusCmpResult FileView::updateCmpResult(bool showExcluded, //maps so
                                                     bool equalFilesActive,
                                                     bool conflictFilesActive)
 {
+    updateCategoryIndex(cmpResultIndex_, FILE_CONFLICT + 1, [](const FileSystemObject& fsObj) { return static_cast<size_t>(fsObj.getCategory()); });
+
     StatusCmpResult output;
+    std::vector<const CategoryRows*> rowsOnView;
 
-    updateView([&](const FileSystemObject& fsObj) -> bool
+    auto evalCategory = [&](CompareFilesResult cmpResult, bool& existsCategory, bool categoryActive)
     {
-        if (!fsObj.isActive())
-        {
+        const CategoryRows& rowsActive   = cmpResultIndex_.rows[2 * cmpResult + 1];
+        const CategoryRows& rowsExcluded = cmpResultIndex_.rows[2 * cmpResult];
+
+        if (rowsExcluded.rowCount > 0)
             output.existsExcluded = true;
-            if (!showExcluded)
-                return false;
-        }
 
-        switch (fsObj.getCategory())
+        if (rowsActive.rowCount > 0 || (showExcluded && rowsExcluded.rowCount > 0))
+            existsCategory = true;
+
+        if (categoryActive)
         {
-            case FILE_LEFT_SIDE_ONLY:
-                output.existsLeftOnly = true;
-                if (!leftOnlyFilesActive) return false;
-                break;
-            case FILE_RIGHT_SIDE_ONLY:
-                output.existsRightOnly = true;
-                if (!rightOnlyFilesActive) return false;
-                break;
-            case FILE_LEFT_NEWER:
-                output.existsLeftNewer = true;
-                if (!leftNewerFilesActive) return false;
-                break;
-            case FILE_RIGHT_NEWER:
-                output.existsRightNewer = true;
-                if (!rightNewerFilesActive) return false;
-                break;
-            case FILE_DIFFERENT_CONTENT:
-                output.existsDifferent = true;
-                if (!differentFilesActive) return false;
-                break;
-            case FILE_EQUAL:
-            case FILE_DIFFERENT_METADATA: //= sub-category of equal
-                output.existsEqual = true;
-                if (!equalFilesActive) return false;
-                break;
-            case FILE_CONFLICT:
-                output.existsConflict = true;
-                if (!conflictFilesActive) return false;
-                break;
+            rowsOnView.push_back(&rowsActive);
+            if (showExcluded)
+                rowsOnView.push_back(&rowsExcluded);
         }
-        //calculate total number of bytes for each side
-        addNumbers(fsObj, output);
-        return true;
-    });
-
+    };
+    evalCategory(FILE_LEFT_SIDE_ONLY,     output.existsLeftOnly,   leftOnlyFilesActive);
+    evalCategory(FILE_RIGHT_SIDE_ONLY,    output.existsRightOnly,  rightOnlyFilesActive);
+    evalCategory(FILE_LEFT_NEWER,         output.existsLeftNewer,  leftNewerFilesActive);
+    evalCategory(FILE_RIGHT_NEWER,        output.existsRightNewer, rightNewerFilesActive);
+    evalCategory(FILE_DIFFERENT_CONTENT,  output.existsDifferent,  differentFilesActive);
+    evalCategory(FILE_EQUAL,              output.existsEqual,      equalFilesActive);
+    evalCategory(FILE_DIFFERENT_METADATA, output.existsEqual,      equalFilesActive); //= sub-category of equal
+    evalCategory(FILE_CONFLICT,           output.existsConflict,   conflictFilesActive);
+
+    updateView(rowsOnView, output);
     return output;
 }
 
@@ -174,68 +268,46 @@ FileView::StatusSyncPreview FileView::updateSyncPreview(bool showExcluded, //map
                                                         bool syncEqualActive,
                                                         bool conflictFilesActive)
 {
+    updateCategoryIndex(syncPreviewIndex_, SO_UNRESOLVED_CONFLICT + 1, [](const FileSystemObject& fsObj) { return static_cast<size_t>(fsObj.getSyncOperation()); });
+
     StatusSyncPreview output;
+    std::vector<const CategoryRows*> rowsOnView;
 
-    updateView([&](const FileSystemObject& fsObj)
+    auto evalCategory = [&](SyncOperation syncOp, bool& existsCategory, bool categoryActive)
     {
-        if (!fsObj.isActive())
-        {
+        const CategoryRows& rowsActive   = syncPreviewIndex_.rows[2 * syncOp + 1];
+        const CategoryRows& rowsExcluded = syncPreviewIndex_.rows[2 * syncOp];
+
+        if (rowsExcluded.rowCount > 0)
             output.existsExcluded = true;
-            if (!showExcluded)
-                return false;
-        }
 
-        switch (fsObj.getSyncOperation()) //evaluate comparison result and sync direction
+        if (rowsActive.rowCount > 0 || (showExcluded && rowsExcluded.rowCount > 0))
+            existsCategory = true;
+
+        if (categoryActive)
         {
-            case SO_CREATE_NEW_LEFT:
-                output.existsSyncCreateLeft = true;
-                if (!syncCreateLeftActive) return false;
-                break;
-            case SO_CREATE_NEW_RIGHT:
-                output.existsSyncCreateRight = true;
-                if (!syncCreateRightActive) return false;
-                break;
-            case SO_DELETE_LEFT:
-                output.existsSyncDeleteLeft = true;
-                if (!syncDeleteLeftActive) return false;
-                break;
-            case SO_DELETE_RIGHT:
-                output.existsSyncDeleteRight = true;
-                if (!syncDeleteRightActive) return false;
-                break;
-            case SO_OVERWRITE_RIGHT:
-            case SO_COPY_METADATA_TO_RIGHT: //no extra button on screen
-            case SO_MOVE_RIGHT_FROM:
-            case SO_MOVE_RIGHT_TO:
-                output.existsSyncDirRight = true;
-                if (!syncDirOverwRightActive) return false;
-                break;
-            case SO_OVERWRITE_LEFT:
-            case SO_COPY_METADATA_TO_LEFT: //no extra button on screen
-            case SO_MOVE_LEFT_TO:
-            case SO_MOVE_LEFT_FROM:
-                output.existsSyncDirLeft = true;
-                if (!syncDirOverwLeftActive) return false;
-                break;
-            case SO_DO_NOTHING:
-                output.existsSyncDirNone = true;
-                if (!syncDirNoneActive) return false;
-                break;
-            case SO_EQUAL:
-                output.existsEqual = true;
-                if (!syncEqualActive) return false;
-                break;
-            case SO_UNRESOLVED_CONFLICT:
-                output.existsConflict = true;
-                if (!conflictFilesActive) return false;
-                break;
+            rowsOnView.push_back(&rowsActive);
+            if (showExcluded)
+                rowsOnView.push_back(&rowsExcluded);
         }
-
-        //calculate total number of bytes for each side
-        addNumbers(fsObj, output);
-        return true;
-    });
-
+    };
+    evalCategory(SO_CREATE_NEW_LEFT,        output.existsSyncCreateLeft,  syncCreateLeftActive);
+    evalCategory(SO_CREATE_NEW_RIGHT,       output.existsSyncCreateRight, syncCreateRightActive);
+    evalCategory(SO_DELETE_LEFT,            output.existsSyncDeleteLeft,  syncDeleteLeftActive);
+    evalCategory(SO_DELETE_RIGHT,           output.existsSyncDeleteRight, syncDeleteRightActive);
+    evalCategory(SO_OVERWRITE_RIGHT,        output.existsSyncDirRight,    syncDirOverwRightActive);
+    evalCategory(SO_COPY_METADATA_TO_RIGHT, output.existsSyncDirRight,    syncDirOverwRightActive); //no extra button on screen
+    evalCategory(SO_MOVE_RIGHT_FROM,        output.existsSyncDirRight,    syncDirOverwRightActive);
+    evalCategory(SO_MOVE_RIGHT_TO,          output.existsSyncDirRight,    syncDirOverwRightActive);
+    evalCategory(SO_OVERWRITE_LEFT,         output.existsSyncDirLeft,     syncDirOverwLeftActive);
+    evalCategory(SO_COPY_METADATA_TO_LEFT,  output.existsSyncDirLeft,     syncDirOverwLeftActive); //no extra button on screen
+    evalCategory(SO_MOVE_LEFT_TO,           output.existsSyncDirLeft,     syncDirOverwLeftActive);
+    evalCategory(SO_MOVE_LEFT_FROM,         output.existsSyncDirLeft,     syncDirOverwLeftActive);
+    evalCategory(SO_DO_NOTHING,             output.existsSyncDirNone,     syncDirNoneActive);
+    evalCategory(SO_EQUAL,                  output.existsEqual,           syncEqualActive);
+    evalCategory(SO_UNRESOLVED_CONFLICT,    output.existsConflict,        conflictFilesActive);
+
+    updateView(rowsOnView, output);
     return output;
 }
 
@@ -257,9 +329,8 @@ std::vector<FileSystemObject*> FileView::getAllFileRef(const std::vector<size_t>
 
 void FileView::removeInvalidRows()
 {
-    viewRef_.clear();
-    rowPositions_.clear();
-    rowPositionsFirstChild_.clear();
+    invalidateView();
+    sortCache_.clear(); //item names, sizes, etc. may have changed, too
 
     //remove rows that have been deleted meanwhile
     eraseIf(sortedRef_, [&](const RefIndex& refIdx) { return !FileSystemObject::retrieve(refIdx.objId); });
@@ -287,7 +358,7 @@ private:
         No sorting:      30 ms
     */
     template <class ItemPair>
-    static std::vector<ItemPair*> getItemsSorted(std::list<ItemPair>& itemList)
+    static std::vector<ItemPair*> getItemsSorted(FixedList<ItemPair>& itemList)
     {
         std::vector<ItemPair*> output;
         for (ItemPair& item : itemList)
@@ -322,7 +393,11 @@ void FileView::setData(FolderComparison& folderCmp)
     //clear everything
     std::vector<FileSystemObject::ObjectId>().swap(viewRef_); //free mem
     std::vector<RefIndex>().swap(sortedRef_);                 //
+    invalidateView();
     currentSort_ = {};
+    sortCache_.clear();
+
+    baseFolders_.assign(folderCmp.begin(), folderCmp.end());
 
     folderPairCount_ = std::count_if(begin(folderCmp), end(folderCmp),
                                      [](const BaseFolderPair& baseObj) //count non-empty pairs to distinguish single/multiple folder pair cases
@@ -337,8 +412,8 @@ void FileView::setData(FolderComparison& folderCmp)
 
 
 //------------------------------------ SORTING TEMPLATES ------------------------------------------------
-template <bool ascending, SelectedSide side>
-struct FileView::LessFullPath
+template <bool ascending>
+struct FileView::LessCmpResult
 {
     bool operator()(const RefIndex a, const RefIndex b) const
     {
@@ -349,13 +424,13 @@ struct FileView::LessFullPath
         else if (!fsObjB)
             return true;
 
-        return lessFullPath<ascending, side>(*fsObjA, *fsObjB);
+        return lessCmpResult<ascending>(*fsObjA, *fsObjB);
     }
 };
 
 
 template <bool ascending>
-struct FileView::LessRelativeFolder
+struct FileView::LessSyncDirection
 {
     bool operator()(const RefIndex a, const RefIndex b) const
     {
@@ -366,170 +441,189 @@ struct FileView::LessRelativeFolder
         else if (!fsObjB)
             return true;
 
-        //presort by folder pair
-        if (a.folderIndex != b.folderIndex)
-            return ascending ?
-                   a.folderIndex < b.folderIndex :
-                   a.folderIndex > b.folderIndex;
-
-        return lessRelativeFolder<ascending>(*fsObjA, *fsObjB);
+        return lessSyncDirection<ascending>(*fsObjA, *fsObjB);
     }
 };
 
+//-------------------------------------------------------------------------------------------------------
 
-template <bool ascending, SelectedSide side>
-struct FileView::LessShortFileName
+namespace
 {
-    bool operator()(const RefIndex a, const RefIndex b) const
-    {
-        const FileSystemObject* fsObjA = FileSystemObject::retrieve(a.objId);
-        const FileSystemObject* fsObjB = FileSystemObject::retrieve(b.objId);
-        if (!fsObjA) //invalid rows shall appear at the end
-            return false;
-        else if (!fsObjB)
-            return true;
+const size_t PARALLEL_SORT_MIN_ROWS = 10000; //per thread: don't bother for small views
 
-        return lessShortFileName<ascending, side>(*fsObjA, *fsObjB);
-    }
-};
 
-
-template <bool ascending, SelectedSide side>
-struct FileView::LessFilesize
+size_t getSortThreadCount(size_t rowCount)
 {
-    bool operator()(const RefIndex a, const RefIndex b) const
-    {
-        const FileSystemObject* fsObjA = FileSystemObject::retrieve(a.objId);
-        const FileSystemObject* fsObjB = FileSystemObject::retrieve(b.objId);
-        if (!fsObjA) //invalid rows shall appear at the end
-            return false;
-        else if (!fsObjB)
-            return true;
-
-        return lessFilesize<ascending, side>(*fsObjA, *fsObjB);
-    }
-};
+    const size_t cpuCount = std::max<size_t>(std::thread::hardware_concurrency(), 1); //hardware_concurrency() == 0 if "not computable or well defined"
+    return std::clamp<size_t>(rowCount / PARALLEL_SORT_MIN_ROWS, 1, cpuCount);
+}
 
 
-template <bool ascending, SelectedSide side>
-struct FileView::LessFiletime
+//the tasks reference data on the caller's stack => wait for *all* of them before rethrowing the first exception
+void waitAllThenRethrow(std::vector<std::future<void>>& futures) //throw X
 {
-    bool operator()(const RefIndex a, const RefIndex b) const
-    {
-        const FileSystemObject* fsObjA = FileSystemObject::retrieve(a.objId);
-        const FileSystemObject* fsObjB = FileSystemObject::retrieve(b.objId);
-        if (!fsObjA) //invalid rows shall appear at the end
-            return false;
-        else if (!fsObjB)
-            return true;
+    for (std::future<void>& ft : futures)
+        ft.wait();
 
-        return lessFiletime<ascending, side>(*fsObjA, *fsObjB);
-    }
-};
+    std::vector<std::future<void>> futuresDone;
+    futuresDone.swap(futures);
+
+    for (std::future<void>& ft : futuresDone)
+        ft.get(); //rethrow, e.g. std::bad_alloc
+}
 
 
-template <bool ascending, SelectedSide side>
-struct FileView::LessExtension
+template <class Function> //fun(size_t rowFirst, size_t rowLast)
+void processRowsParallel(size_t rowCount, Function fun)
 {
-    bool operator()(const RefIndex a, const RefIndex b) const
-    {
-        const FileSystemObject* fsObjA = FileSystemObject::retrieve(a.objId);
-        const FileSystemObject* fsObjB = FileSystemObject::retrieve(b.objId);
-        if (!fsObjA) //invalid rows shall appear at the end
-            return false;
-        else if (!fsObjB)
-            return true;
+    const size_t threadCount = getSortThreadCount(rowCount);
+    if (threadCount <= 1)
+        return fun(0, rowCount);
 
-        return lessExtension<ascending, side>(*fsObjA, *fsObjB);
-    }
-};
+    std::vector<std::future<void>> futures;
+    ZEN_ON_SCOPE_FAIL(for (std::future<void>& ft : futures) ft.wait()); //failed to start all tasks: wait for the running ones
 
+    for (size_t i = 0; i < threadCount; ++i)
+        futures.push_back(runAsync([&fun, first = rowCount * i / threadCount, last = rowCount * (i + 1) / threadCount] { fun(first, last); }));
 
-template <bool ascending>
-struct FileView::LessCmpResult
+    waitAllThenRethrow(futures); //throw X
+}
+
+
+//sort chunks in parallel, then merge neighboring chunks pairwise in parallel
+template <class RandomAccessIterator, class Compare>
+void sortParallel(RandomAccessIterator first, RandomAccessIterator last, Compare comp, bool stable)
 {
-    bool operator()(const RefIndex a, const RefIndex b) const
-    {
-        const FileSystemObject* fsObjA = FileSystemObject::retrieve(a.objId);
-        const FileSystemObject* fsObjB = FileSystemObject::retrieve(b.objId);
-        if (!fsObjA) //invalid rows shall appear at the end
-            return false;
-        else if (!fsObjB)
-            return true;
+    const size_t rowCount = last - first;
+    const size_t threadCount = getSortThreadCount(rowCount);
 
-        return lessCmpResult<ascending>(*fsObjA, *fsObjB);
-    }
-};
+    std::vector<RandomAccessIterator> bounds; //chunk i: [bounds[i], bounds[i + 1])
+    for (size_t i = 0; i < threadCount; ++i)
+        bounds.push_back(first + rowCount * i / threadCount);
+    bounds.push_back(last);
 
+    std::vector<std::future<void>> futures;
+    ZEN_ON_SCOPE_FAIL(for (std::future<void>& ft : futures) ft.wait()); //failed to start all tasks: wait for the running ones
 
-template <bool ascending>
-struct FileView::LessSyncDirection
-{
-    bool operator()(const RefIndex a, const RefIndex b) const
+    for (size_t i = 0; i + 1 < bounds.size(); ++i)
+        futures.push_back(runAsync([itFirst = bounds[i], itLast = bounds[i + 1], comp, stable]
     {
-        const FileSystemObject* fsObjA = FileSystemObject::retrieve(a.objId);
-        const FileSystemObject* fsObjB = FileSystemObject::retrieve(b.objId);
-        if (!fsObjA) //invalid rows shall appear at the end
-            return false;
-        else if (!fsObjB)
-            return true;
+        if (stable)
+            std::stable_sort(itFirst, itLast, comp);
+        else
+            std::sort(itFirst, itLast, comp);
+    }));
+    waitAllThenRethrow(futures); //throw X
+
+    while (bounds.size() > 2)
+    {
+        std::vector<RandomAccessIterator> boundsMerged;
+        for (size_t i = 0; i + 1 < bounds.size(); i += 2)
+        {
+            boundsMerged.push_back(bounds[i]);
+            if (i + 2 < bounds.size())
+                futures.push_back(runAsync([itFirst = bounds[i], itMid = bounds[i + 1], itLast = bounds[i + 2], comp]
+            { std::inplace_merge(itFirst, itMid, itLast, comp); })); //stable
+        }
+        boundsMerged.push_back(bounds.back());
+        waitAllThenRethrow(futures); //throw X
 
-        return lessSyncDirection<ascending>(*fsObjA, *fsObjB);
+        bounds.swap(boundsMerged);
     }
-};
+}
+}
 
-//-------------------------------------------------------------------------------------------------------
 
 void FileView::sortView(ColumnTypeRim type, ItemPathFormat pathFmt, bool onLeft, bool ascending)
 {
-    viewRef_               .clear();
-    rowPositions_          .clear();
-    rowPositionsFirstChild_.clear();
+    invalidateView();
     currentSort_ = SortInfo({ type, onLeft, ascending });
 
+    if (type != ColumnTypeRim::ITEM_PATH)
+        pathFmt = ItemPathFormat::FULL_PATH; //don't care
+
+    //stable sort depends on previous sort order => don't cache
+    const bool stableSort = type == ColumnTypeRim::EXTENSION;
+
+    //toggling between columns: reuse previous sort results
+    auto itCache = std::find_if(sortCache_.begin(), sortCache_.end(), [&](const SortCacheEntry& ce)
+    {
+        return ce.type == type && ce.pathFmt == pathFmt && ce.onLeft == onLeft && ce.ascending == ascending;
+    });
+    if (itCache != sortCache_.end())
+    {
+        std::rotate(sortCache_.begin(), itCache, itCache + 1);
+        sortedRef_ = sortCache_[0].sortedRef;
+        return;
+    }
+
+    SortKey (*getSortKey)(const FileSystemObject& fsObj) = nullptr;
     switch (type)
     {
         case ColumnTypeRim::ITEM_PATH:
             switch (pathFmt)
             {
                 case ItemPathFormat::FULL_PATH:
-                    if      ( ascending &&  onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFullPath<true,  LEFT_SIDE >());
-                    else if ( ascending && !onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFullPath<true,  RIGHT_SIDE>());
-                    else if (!ascending &&  onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFullPath<false, LEFT_SIDE >());
-                    else if (!ascending && !onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFullPath<false, RIGHT_SIDE>());
+                    getSortKey = onLeft ? getSortKeyFullPath<LEFT_SIDE> : getSortKeyFullPath<RIGHT_SIDE>;
                     break;
-
                 case ItemPathFormat::RELATIVE_PATH:
-                    if      ( ascending) std::sort(sortedRef_.begin(), sortedRef_.end(), LessRelativeFolder<true>());
-                    else if (!ascending) std::sort(sortedRef_.begin(), sortedRef_.end(), LessRelativeFolder<false>());
+                    getSortKey = getSortKeyRelativeFolder;
                     break;
-
                 case ItemPathFormat::ITEM_NAME:
-                    if      ( ascending &&  onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessShortFileName<true,  LEFT_SIDE >());
-                    else if ( ascending && !onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessShortFileName<true,  RIGHT_SIDE>());
-                    else if (!ascending &&  onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessShortFileName<false, LEFT_SIDE >());
-                    else if (!ascending && !onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessShortFileName<false, RIGHT_SIDE>());
+                    getSortKey = onLeft ? getSortKeyShortFileName<LEFT_SIDE> : getSortKeyShortFileName<RIGHT_SIDE>;
                     break;
             }
             break;
-
         case ColumnTypeRim::SIZE:
-            if      ( ascending &&  onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFilesize<true,  LEFT_SIDE >());
-            else if ( ascending && !onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFilesize<true,  RIGHT_SIDE>());
-            else if (!ascending &&  onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFilesize<false, LEFT_SIDE >());
-            else if (!ascending && !onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFilesize<false, RIGHT_SIDE>());
+            getSortKey = onLeft ? getSortKeyFilesize<LEFT_SIDE> : getSortKeyFilesize<RIGHT_SIDE>;
             break;
         case ColumnTypeRim::DATE:
-            if      ( ascending &&  onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFiletime<true,  LEFT_SIDE >());
-            else if ( ascending && !onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFiletime<true,  RIGHT_SIDE>());
-            else if (!ascending &&  onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFiletime<false, LEFT_SIDE >());
-            else if (!ascending && !onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFiletime<false, RIGHT_SIDE>());
+            getSortKey = onLeft ? getSortKeyFiletime<LEFT_SIDE> : getSortKeyFiletime<RIGHT_SIDE>;
             break;
         case ColumnTypeRim::EXTENSION:
-            if      ( ascending &&  onLeft) std::stable_sort(sortedRef_.begin(), sortedRef_.end(), LessExtension<true,  LEFT_SIDE >());
-            else if ( ascending && !onLeft) std::stable_sort(sortedRef_.begin(), sortedRef_.end(), LessExtension<true,  RIGHT_SIDE>());
-            else if (!ascending &&  onLeft) std::stable_sort(sortedRef_.begin(), sortedRef_.end(), LessExtension<false, LEFT_SIDE >());
-            else if (!ascending && !onLeft) std::stable_sort(sortedRef_.begin(), sortedRef_.end(), LessExtension<false, RIGHT_SIDE>());
+            getSortKey = onLeft ? getSortKeyExtension<LEFT_SIDE> : getSortKeyExtension<RIGHT_SIDE>;
             break;
     }
+    assert(getSortKey);
+
+    struct SortRow
+    {
+        SortKey key;
+        RefIndex ref;
+    };
+    std::vector<SortRow> rows(sortedRef_.size());
+
+    processRowsParallel(rows.size(), [&](size_t rowFirst, size_t rowLast) //ObjectMgr: read-only access is fine
+    {
+        for (size_t i = rowFirst; i < rowLast; ++i)
+        {
+            SortRow& row = rows[i];
+            row.ref = sortedRef_[i];
+
+            if (const FileSystemObject* fsObj = FileSystemObject::retrieve(row.ref.objId))
+            {
+                row.key = getSortKey(*fsObj);
+                if (type == ColumnTypeRim::ITEM_PATH && pathFmt == ItemPathFormat::RELATIVE_PATH)
+                    row.key.number = row.ref.folderIndex; //presort by folder pair
+            }
+            else
+                row.key.rank = std::numeric_limits<unsigned char>::max(); //invalid rows shall appear at the end
+        }
+    });
+
+    if (ascending)
+        sortParallel(rows.begin(), rows.end(), [](const SortRow& lhs, const SortRow& rhs) { return lessSortKey<true >(lhs.key, rhs.key); }, stableSort);
+    else
+        sortParallel(rows.begin(), rows.end(), [](const SortRow& lhs, const SortRow& rhs) { return lessSortKey<false>(lhs.key, rhs.key); }, stableSort);
+
+    for (size_t i = 0; i < rows.size(); ++i)
+        sortedRef_[i] = rows[i].ref;
+
+    if (!stableSort)
+    {
+        const size_t SORT_CACHE_SIZE_MAX = 4; //each entry is as large as sortedRef_
+        if (sortCache_.size() >= SORT_CACHE_SIZE_MAX)
+            sortCache_.pop_back();
+        sortCache_.insert(sortCache_.begin(), { type, pathFmt, onLeft, ascending, sortedRef_ });
+    }
 }
@@ -8,6 +8,7 @@
 #define GRID_VIEW_H_9285028345703475842569
 
 #include <vector>
+#include <memory>
 #include <unordered_map>
 #include <zen/stl_tools.h>
 #include "file_grid_attr.h"
@@ -117,6 +118,8 @@ public:
 
     size_t getFolderPairCount() const { return folderPairCount_; } //count non-empty pairs to distinguish single/multiple folder pair cases
 
+    std::optional<uint64_t> getDataVersion() const; //changes whenever the comparison data changes; no value: data not available anymore
+
 private:
     FileView           (const FileView&) = delete;
     FileView& operator=(const FileView&) = delete;
@@ -127,11 +130,38 @@ private:
         FileSystemObject::ObjectId objId = nullptr;
     };
 
-    template <class Predicate> void updateView(Predicate pred);
+    struct CategoryRows //all rows of sortedRef_ sharing the same category and active status
+    {
+        std::vector<uint64_t> rowBits; //bit i set <=> sortedRef_[i] belongs to this category; empty if rowCount == 0
+        size_t rowCount = 0;
+
+        unsigned int filesOnLeftView    = 0;
+        unsigned int foldersOnLeftView  = 0;
+        unsigned int filesOnRightView   = 0;
+        unsigned int foldersOnRightView = 0;
+
+        uint64_t filesizeLeftView  = 0;
+        uint64_t filesizeRightView = 0;
+    };
+
+    struct CategoryIndex
+    {
+        std::vector<CategoryRows> rows; //[2 * category + (isActive ? 1 : 0)]
+        std::optional<uint64_t> dataVersion; //no value: index needs to be rebuilt
+    };
 
+    template <class GetCategory> void updateCategoryIndex(CategoryIndex& index, size_t categoryCount, GetCategory getCategory);
+    template <class StatusResult> void updateView(const std::vector<const CategoryRows*>& rowsOnView, StatusResult& result);
+    void invalidateView();
+    void updateRowPositions() const;
 
-    std::unordered_map<FileSystemObject::ObjectIdConst, size_t> rowPositions_; //find row positions on sortedRef directly
-    std::unordered_map<const void*, size_t> rowPositionsFirstChild_; //find first child on sortedRef of a hierarchy object
+    CategoryIndex cmpResultIndex_;   //toggling category filters requires no access to FileSystemObject
+    CategoryIndex syncPreviewIndex_; //
+    std::vector<std::weak_ptr<const BaseFolderPair>> baseFolders_; //detect changes of the comparison data since the indexes were built
+
+    mutable bool rowPositionsValid_ = false; //row position lookup is only needed for a few operations => build lazily
+    mutable std::unordered_map<FileSystemObject::ObjectIdConst, size_t, FileSystemObject::ObjectIdHash> rowPositions_; //find row positions on sortedRef directly
+    mutable std::unordered_map<const void*, size_t> rowPositionsFirstChild_; //find first child on sortedRef of a hierarchy object
     //void* instead of ContainerObject*: these are weak pointers and should *never be dereferenced*!
 
     std::vector<FileSystemObject::ObjectId> viewRef_; //partial view on sortedRef
@@ -149,24 +179,6 @@ private:
     class SerializeHierarchy;
 
     //sorting classes
-    template <bool ascending, SelectedSide side>
-    struct LessFullPath;
-
-    template <bool ascending>
-    struct LessRelativeFolder;
-
-    template <bool ascending, SelectedSide side>
-    struct LessShortFileName;
-
-    template <bool ascending, SelectedSide side>
-    struct LessFilesize;
-
-    template <bool ascending, SelectedSide side>
-    struct LessFiletime;
-
-    template <bool ascending, SelectedSide side>
-    struct LessExtension;
-
     template <bool ascending>
     struct LessCmpResult;
 
@@ -174,6 +186,16 @@ private:
     struct LessSyncDirection;
 
     std::optional<SortInfo> currentSort_;
+
+    struct SortCacheEntry
+    {
+        ColumnTypeRim  type = ColumnTypeRim::ITEM_PATH;
+        ItemPathFormat pathFmt = ItemPathFormat::FULL_PATH;
+        bool onLeft    = false;
+        bool ascending = false;
+        std::vector<RefIndex> sortedRef;
+    };
+    std::vector<SortCacheEntry> sortCache_; //most recently used first; invalidated by setData() and removeInvalidRows()
 };
 
 
@@ -319,9 +319,13 @@ StatusHandlerFloatingDialog::StatusHandlerFloatingDialog(wxFrame* parentDlg,
                                                          const Zstring& soundFileSyncComplete,
                                                          const Zstring& postSyncCommand,
                                                          PostSyncCondition postSyncCondition,
-                                                         bool& autoCloseDialog) :
+                                                         bool& autoCloseDialog,
+                                                         const Zstring& altLogFolderPathPhrase,
+                                                         int logfilesMaxAgeDays,
+                                                         const std::set<AbstractPath>& logFilePathsToKeep) :
     progressDlg_(createProgressDialog(*this, [this] { this->onProgressDialogTerminate(); }, *this, parentDlg, true /*showProgress*/, autoCloseDialog,
 jobName, soundFileSyncComplete, ignoreErrors, automaticRetryCount, PostSyncAction2::NONE)),
+         logFileWriter_(jobName, startTime, altLogFolderPathPhrase, logfilesMaxAgeDays, logFilePathsToKeep),
          automaticRetryCount_(automaticRetryCount),
          automaticRetryDelay_(automaticRetryDelay),
          jobName_(jobName),
@@ -338,7 +342,14 @@ StatusHandlerFloatingDialog::~StatusHandlerFloatingDialog()
 }
 
 
-StatusHandlerFloatingDialog::Result StatusHandlerFloatingDialog::reportFinalStatus(const Zstring& altLogFolderPathPhrase, int logfilesMaxAgeDays, const std::set<AbstractPath>& logFilePathsToKeep)
+void StatusHandlerFloatingDialog::logMsg(const std::wstring& msg, MessageType type)
+{
+    errorLog_.logMsg(msg, type);
+    logFileWriter_.write(errorLog_.getEntry(errorLog_.size() - 1));
+}
+
+
+StatusHandlerFloatingDialog::Result StatusHandlerFloatingDialog::reportFinalStatus()
 {
     const auto totalTime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now() - startTime_);
 
@@ -349,7 +360,7 @@ StatusHandlerFloatingDialog::Result StatusHandlerFloatingDialog::reportFinalStat
     {
         if (getAbortStatus())
         {
-            errorLog_.logMsg(_("Stopped"), MSG_TYPE_ERROR); //= user cancel; *not* a MSG_TYPE_FATAL_ERROR!
+            logMsg(_("Stopped"), MSG_TYPE_ERROR); //= user cancel; *not* a MSG_TYPE_FATAL_ERROR!
             return SyncResult::ABORTED;
         }
         else if (errorLog_.getItemCount(MSG_TYPE_ERROR | MSG_TYPE_FATAL_ERROR) > 0)
@@ -358,7 +369,7 @@ StatusHandlerFloatingDialog::Result StatusHandlerFloatingDialog::reportFinalStat
             return SyncResult::FINISHED_WITH_WARNINGS;
 
         if (getStatsTotal(currentPhase()) == ProgressStats())
-            errorLog_.logMsg(_("Nothing to synchronize"), MSG_TYPE_INFO);
+            logMsg(_("Nothing to synchronize"), MSG_TYPE_INFO);
         return SyncResult::FINISHED_WITH_SUCCESS;
     }();
 
@@ -398,7 +409,7 @@ StatusHandlerFloatingDialog::Result StatusHandlerFloatingDialog::reportFinalStat
     trim(commandLine);
 
     if (!commandLine.empty())
-        errorLog_.logMsg(replaceCpy(_("Executing command %x"), L"%x", fmtPath(commandLine)), MSG_TYPE_INFO);
+        logMsg(replaceCpy(_("Executing command %x"), L"%x", fmtPath(commandLine)), MSG_TYPE_INFO);
 
     //----------------- always save log under %appdata%\FreeFileSync\Logs ------------------------
     AbstractPath logFilePath = getNullPath();
@@ -406,9 +417,9 @@ StatusHandlerFloatingDialog::Result StatusHandlerFloatingDialog::reportFinalStat
     {
         //do NOT use tryReportingError()! saving log files should not be cancellable!
         auto notifyStatusNoThrow = [&](const std::wstring& msg) { try { reportStatus(msg); /*throw X*/ } catch (...) {} };
-        logFilePath = saveLogFile(summary, errorLog_, startTime_, altLogFolderPathPhrase, logfilesMaxAgeDays, logFilePathsToKeep, notifyStatusNoThrow /*throw (X)*/); //throw FileError
+        logFilePath = logFileWriter_.finalize(summary, errorLog_, notifyStatusNoThrow /*throw (X)*/); //throw FileError
     }
-    catch (const FileError& e) { errorLog_.logMsg(e.toString(), MSG_TYPE_ERROR); }
+    catch (const FileError& e) { logMsg(e.toString(), MSG_TYPE_ERROR); }
 
     //execute post sync command *after* writing log files, so that user can refer to the log via the command!
     if (!commandLine.empty())
@@ -420,7 +431,7 @@ StatusHandlerFloatingDialog::Result StatusHandlerFloatingDialog::reportFinalStat
             //use ExecutionType::ASYNC until there is reason not to: https://freefilesync.org/forum/viewtopic.php?t=31
             shellExecute(expandMacros(commandLine), ExecutionType::ASYNC); //throw FileError
         }
-        catch (const FileError& e) { errorLog_.logMsg(e.toString(), MSG_TYPE_ERROR); }
+        catch (const FileError& e) { logMsg(e.toString(), MSG_TYPE_ERROR); }
 
     if (progressDlg_)
     {
@@ -468,7 +479,7 @@ StatusHandlerFloatingDialog::Result StatusHandlerFloatingDialog::reportFinalStat
                             suspendSystem(); //throw FileError
                             autoClose = progressDlg_->getOptionAutoCloseDialog();
                         }
-                        catch (const FileError& e) { errorLog_.logMsg(e.toString(), MSG_TYPE_ERROR); }
+                        catch (const FileError& e) { logMsg(e.toString(), MSG_TYPE_ERROR); }
                     break;
                 case PostSyncAction2::SHUTDOWN:
                     if (mayRunAfterCountDown(_("System: Shut down")))
@@ -477,7 +488,7 @@ StatusHandlerFloatingDialog::Result StatusHandlerFloatingDialog::reportFinalStat
                             shutdownSystem(); //throw FileError
                             autoClose = exitAfterSync = true;
                         }
-                        catch (const FileError& e) { errorLog_.logMsg(e.toString(), MSG_TYPE_ERROR); }
+                        catch (const FileError& e) { logMsg(e.toString(), MSG_TYPE_ERROR); }
                     break;
             }
 
@@ -519,7 +530,7 @@ void StatusHandlerFloatingDialog::initNewPhase(int itemsTotal, int64_t bytesTota
 
 void StatusHandlerFloatingDialog::logInfo(const std::wstring& msg)
 {
-    errorLog_.logMsg(msg, MSG_TYPE_INFO);
+    logMsg(msg, MSG_TYPE_INFO);
 }
 
 
@@ -528,7 +539,7 @@ void StatusHandlerFloatingDialog::reportWarning(const std::wstring& msg, bool& w
     if (!progressDlg_) abortProcessNow();
     PauseTimers dummy(*progressDlg_);
 
-    errorLog_.logMsg(msg, MSG_TYPE_WARNING);
+    logMsg(msg, MSG_TYPE_WARNING);
 
     if (!warningActive)
         return;
@@ -563,14 +574,14 @@ ProcessCallback::Response StatusHandlerFloatingDialog::reportError(const std::ws
     //auto-retry
     if (retryNumber < automaticRetryCount_)
     {
-        errorLog_.logMsg(msg + L"\n-> " + _("Automatic retry"), MSG_TYPE_INFO);
+        logMsg(msg + L"\n-> " + _("Automatic retry"), MSG_TYPE_INFO);
         delayAndCountDown(_("Automatic retry") + (automaticRetryCount_ <= 1 ? L"" :  L" " + numberTo<std::wstring>(retryNumber + 1) + L"/" + numberTo<std::wstring>(automaticRetryCount_)),
         automaticRetryDelay_, [&](const std::wstring& statusMsg) { this->reportStatus(_("Error") + L": " + statusMsg); });
         return ProcessCallback::RETRY;
     }
 
     //always, except for "retry":
-    auto guardWriteLog = zen::makeGuard<ScopeGuardRunMode::ON_EXIT>([&] { errorLog_.logMsg(msg, MSG_TYPE_ERROR); });
+    auto guardWriteLog = zen::makeGuard<ScopeGuardRunMode::ON_EXIT>([&] { logMsg(msg, MSG_TYPE_ERROR); });
 
     if (!progressDlg_->getOptionIgnoreErrors())
     {
@@ -589,7 +600,7 @@ ProcessCallback::Response StatusHandlerFloatingDialog::reportError(const std::ws
 
             case ConfirmationButton3::DECLINE: //retry
                 guardWriteLog.dismiss();
-                errorLog_.logMsg(msg + L"\n-> " + _("Retrying operation..."), MSG_TYPE_INFO); //explain why there are duplicate "doing operation X" info messages in the log!
+                logMsg(msg + L"\n-> " + _("Retrying operation..."), MSG_TYPE_INFO); //explain why there are duplicate "doing operation X" info messages in the log!
                 return ProcessCallback::RETRY;
 
             case ConfirmationButton3::CANCEL:
@@ -610,7 +621,7 @@ void StatusHandlerFloatingDialog::reportFatalError(const std::wstring& msg)
     if (!progressDlg_) abortProcessNow();
     PauseTimers dummy(*progressDlg_);
 
-    errorLog_.logMsg(msg, MSG_TYPE_FATAL_ERROR);
+    logMsg(msg, MSG_TYPE_FATAL_ERROR);
 
     if (!progressDlg_->getOptionIgnoreErrors())
     {
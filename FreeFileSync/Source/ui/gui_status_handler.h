@@ -12,6 +12,7 @@
 #include "progress_indicator.h"
 #include "main_dlg.h"
 #include "../base/status_handler.h"
+#include "../base/generate_logfile.h"
 
 
 namespace fff
@@ -65,7 +66,10 @@ public:
                                 const Zstring& soundFileSyncComplete,
                                 const Zstring& postSyncCommand,
                                 PostSyncCondition postSyncCondition,
-                                bool& autoCloseDialog); //noexcept!
+                                bool& autoCloseDialog,
+                                const Zstring& altLogFolderPathPhrase,
+                                int logfilesMaxAgeDays,
+                                const std::set<AbstractPath>& logFilePathsToKeep); //noexcept!
     ~StatusHandlerFloatingDialog();
 
     void     initNewPhase    (int itemsTotal, int64_t bytesTotal, Phase phaseID) override; //
@@ -84,13 +88,15 @@ public:
         bool exitAfterSync;
         AbstractPath logFilePath;
     };
-    Result reportFinalStatus(const Zstring& altLogFolderPathPhrase, int logfilesMaxAgeDays, const std::set<AbstractPath>& logFilePathsToKeep); //noexcept!!
+    Result reportFinalStatus(); //noexcept!!
 
 private:
     void onProgressDialogTerminate();
+    void logMsg(const std::wstring& msg, zen::MessageType type); //add to errorLog_ and log file
 
     SyncProgressDialog* progressDlg_; //managed to have shorter lifetime than this handler!
     zen::ErrorLog errorLog_;
+    LogFileWriter logFileWriter_;
     const size_t automaticRetryCount_;
     const std::chrono::seconds automaticRetryDelay_;
     const std::wstring jobName_;
@@ -70,11 +70,12 @@ public:
         if (row < viewRef_.size())
         {
             const Line& line = viewRef_[row];
+            const LogEntry entry = log_->getEntry(line.logIdx_); //spilled entries are cached block-wise: rows on screen are cheap
 
             LogEntryView output;
-            output.time = line.logIt_->time;
-            output.type = line.logIt_->type;
-            output.messageLine = extractLine(line.logIt_->message, line.rowNumber_);
+            output.time = entry.time;
+            output.type = entry.type;
+            output.messageLine = extractLine(entry.message, line.rowNumber_);
             output.firstLine = line.rowNumber_ == 0; //this is virtually always correct, unless first line of the original message is empty!
             return output;
         }
@@ -85,28 +86,28 @@ public:
     {
         viewRef_.clear();
 
-        for (auto it = log_->begin(); it != log_->end(); ++it)
-            if (it->type & includedTypes)
-            {
-                static_assert(std::is_same_v<GetCharTypeT<Zstringw>, wchar_t>);
-                assert(!startsWith(it->message, L'\n'));
+        //stream entries: don't load the complete log into memory
+        log_->visitEntries(includedTypes, [&](size_t logIdx, const LogEntry& entry)
+        {
+            static_assert(std::is_same_v<GetCharTypeT<Zstringw>, wchar_t>);
+            assert(!startsWith(entry.message, L'\n'));
 
-                size_t rowNumber = 0;
-                bool lastCharNewline = true;
-                for (const wchar_t c : it->message)
-                    if (c == L'\n')
-                    {
-                        if (!lastCharNewline) //do not reference empty lines!
-                            viewRef_.emplace_back(it, rowNumber);
-                        ++rowNumber;
-                        lastCharNewline = true;
-                    }
-                    else
-                        lastCharNewline = false;
+            size_t rowNumber = 0;
+            bool lastCharNewline = true;
+            for (const wchar_t c : entry.message)
+                if (c == L'\n')
+                {
+                    if (!lastCharNewline) //do not reference empty lines!
+                        viewRef_.emplace_back(logIdx, rowNumber);
+                    ++rowNumber;
+                    lastCharNewline = true;
+                }
+                else
+                    lastCharNewline = false;
 
-                if (!lastCharNewline)
-                    viewRef_.emplace_back(it, rowNumber);
-            }
+            if (!lastCharNewline)
+                viewRef_.emplace_back(logIdx, rowNumber);
+        });
     }
 
 private:
@@ -132,9 +133,9 @@ private:
 
     struct Line
     {
-        Line(ErrorLog::const_iterator logIt, size_t rowNumber) : logIt_(logIt), rowNumber_(rowNumber) {}
+        Line(size_t logIdx, size_t rowNumber) : logIdx_(logIdx), rowNumber_(rowNumber) {}
 
-        ErrorLog::const_iterator logIt_; //always bound!
+        size_t logIdx_; //see ErrorLog::getEntry()
         size_t rowNumber_; //LogEntry::message may span multiple rows
     };
 
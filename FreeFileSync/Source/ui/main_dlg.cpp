@@ -32,7 +32,6 @@
 #include "small_dlgs.h"
 #include "progress_indicator.h"
 #include "folder_pair.h"
-#include "search_grid.h"
 #include "batch_config.h"
 #include "triple_splitter.h"
 #include "app_icon.h"
@@ -45,6 +44,7 @@
 #include "../base/help_provider.h"
 #include "../base/lock_holder.h"
 #include "../base/localization.h"
+#include "../base/startup_trace.h"
 #include "../version/version.h"
 
 using namespace zen;
@@ -261,6 +261,7 @@ XmlGlobalSettings tryLoadGlobalConfig(const Zstring& globalConfigFilePath) //blo
     XmlGlobalSettings globalCfg;
     try
     {
+        StartupPhase phase("readGlobalConfig");
         std::wstring warningMsg;
         readConfig(globalConfigFilePath, globalCfg, warningMsg); //throw FileError
         assert(warningMsg.empty()); //ignore parsing errors: should be migration problems only *cross-fingers*
@@ -328,6 +329,7 @@ void MainDialog::create(const Zstring& globalConfigFilePath)
     if (!cfgFilePaths.empty())
         try
         {
+            StartupPhase phase("readConfig");
             std::wstring warningMsg;
             readAnyConfig(cfgFilePaths, guiCfg, warningMsg); //throw FileError
 
@@ -357,6 +359,7 @@ void MainDialog::create(const Zstring& globalConfigFilePath,
     try
     {
         //we need to set language *before* creating MainDialog!
+        StartupPhase phase("setLanguage");
         setLanguage(globSett.programLanguage); //throw FileError
     }
     catch (const FileError& e)
@@ -365,7 +368,12 @@ void MainDialog::create(const Zstring& globalConfigFilePath,
         //continue!
     }
 
-    MainDialog* frame = new MainDialog(globalConfigFilePath, guiCfg, referenceFiles, globSett, startComparison);
+    MainDialog* frame = nullptr;
+    {
+        StartupPhase phase("MainDialog()"); //includes MainDialogGenerated, i.e. gui_generated.cpp
+        frame = new MainDialog(globalConfigFilePath, guiCfg, referenceFiles, globSett, startComparison);
+    }
+    StartupPhase phase("Show");
     frame->Show();
 }
 
@@ -878,10 +886,11 @@ void MainDialog::setGlobalCfgOnInit(const XmlGlobalSettings& globalSettings)
     //set dialog size and position:
     // - width/height are invalid if the window is minimized (eg x,y == -32000; height = 28, width = 160)
     // - multi-monitor setups: dialog may be placed on second monitor which is currently turned off
-    if (globalSettings.gui.mainDlg.dlgSize.GetWidth () > 0 &&
-        globalSettings.gui.mainDlg.dlgSize.GetHeight() > 0)
+    if (globalSettings.gui.mainDlg.dlgSize.width  > 0 &&
+        globalSettings.gui.mainDlg.dlgSize.height > 0)
     {
-        newSize = globalSettings.gui.mainDlg.dlgSize;
+        newSize = wxSize(globalSettings.gui.mainDlg.dlgSize.width, globalSettings.gui.mainDlg.dlgSize.height);
+        const wxPoint dlgPos(globalSettings.gui.mainDlg.dlgPos.x, globalSettings.gui.mainDlg.dlgPos.y);
 
         //calculate how much of the dialog will be visible on screen
         const int dlgArea = newSize.GetWidth() * newSize.GetHeight();
@@ -890,13 +899,13 @@ void MainDialog::setGlobalCfgOnInit(const XmlGlobalSettings& globalSettings)
         const int monitorCount = wxDisplay::GetCount();
         for (int i = 0; i < monitorCount; ++i)
         {
-            wxRect intersection = wxDisplay(i).GetClientArea().Intersect(wxRect(globalSettings.gui.mainDlg.dlgPos, newSize));
+            wxRect intersection = wxDisplay(i).GetClientArea().Intersect(wxRect(dlgPos, newSize));
             dlgAreaMaxVisible = std::max(dlgAreaMaxVisible, intersection.GetWidth() * intersection.GetHeight());
         }
 
         if (dlgAreaMaxVisible > 0.1 * dlgArea  //at least 10% of the dialog should be visible!
            )
-            newPos = globalSettings.gui.mainDlg.dlgPos;
+            newPos = dlgPos;
     }
 
     //old comment: "wxGTK's wxWindow::SetSize seems unreliable and behaves like a wxWindow::SetClientSize
@@ -1057,16 +1066,16 @@ XmlGlobalSettings MainDialog::getGlobalCfgBeforeExit()
         Maximize(false);
     }
 
-    globalSettings.gui.mainDlg.dlgSize = GetSize();
-    globalSettings.gui.mainDlg.dlgPos  = GetPosition();
+    globalSettings.gui.mainDlg.dlgSize = { GetSize().GetWidth(), GetSize().GetHeight() };
+    globalSettings.gui.mainDlg.dlgPos  = { GetPosition().x, GetPosition().y };
 
     //wxGTK: returns full screen size and strange position (65/-4)
     //OS X 10.9 (but NO issue on 10.11!) returns full screen size and strange position (0/-22)
     if (globalSettings.gui.mainDlg.isMaximized)
         if (globalSettings.gui.mainDlg.dlgPos.y < 0)
         {
-            globalSettings.gui.mainDlg.dlgSize = wxSize();
-            globalSettings.gui.mainDlg.dlgPos  = wxPoint();
+            globalSettings.gui.mainDlg.dlgSize = {};
+            globalSettings.gui.mainDlg.dlgPos  = {};
         }
     return globalSettings;
 }
@@ -2494,6 +2503,7 @@ void MainDialog::onGridLabelContextRim(Grid& grid, ColumnTypeRim type, bool left
     {
         itemPathFormat = fmt;
         filegrid::setItemPathForm(grid, fmt);
+        gridSearch_.invalidate();
     };
     auto addFormatEntry = [&](const wxString& label, ItemPathFormat fmt)
     {
@@ -3908,7 +3918,10 @@ void MainDialog::OnStartSync(wxCommandEvent& event)
                                                   globalCfg_.soundFileSyncFinished,
                                                   guiCfg.mainCfg.postSyncCommand,
                                                   guiCfg.mainCfg.postSyncCondition,
-                                                  globalCfg_.autoCloseProgressDialog);
+                                                  globalCfg_.autoCloseProgressDialog,
+                                                  guiCfg.mainCfg.altLogFolderPathPhrase,
+                                                  globalCfg_.logfilesMaxAgeDays,
+                                                  logFilePathsToKeep);
         try
         {
             //PERF_START;
@@ -3952,7 +3965,7 @@ void MainDialog::OnStartSync(wxCommandEvent& event)
         }
         catch (AbortProcess&) {}
 
-        StatusHandlerFloatingDialog::Result r = statusHandler.reportFinalStatus(guiCfg.mainCfg.altLogFolderPathPhrase, globalCfg_.logfilesMaxAgeDays, logFilePathsToKeep); //noexcept
+        StatusHandlerFloatingDialog::Result r = statusHandler.reportFinalStatus(); //noexcept
         //---------------------------------------------------------------------------
 
         setLastOperationLog(r.summary, r.errorLog);
@@ -4233,6 +4246,8 @@ void MainDialog::OnSwapSides(wxCommandEvent& event)
 
 void MainDialog::updateGridViewData()
 {
+    gridSearch_.invalidate(); //rows on view and their contents may have changed
+
     size_t filesOnLeftView    = 0;
     size_t foldersOnLeftView  = 0;
     size_t filesOnRightView   = 0;
@@ -4447,6 +4462,8 @@ void MainDialog::showFindPanel() //CTRL + F or F3 with empty search phrase
 
     m_textCtrlSearchTxt->SelectAll();
 
+    prepareFindNext(); //user is about to search
+
     if (wxWindow* focus = wxWindow::FindFocus()) //restore when closing panel!
         if (!isComponentOf(focus, m_panelSearch))
             focusIdAfterSearch_ = focus->GetId();
@@ -4467,6 +4484,26 @@ void MainDialog::hideFindPanel()
 }
 
 
+void MainDialog::prepareFindNext()
+{
+    gridSearch_.prepare(*m_gridMainL, m_checkBoxMatchCase->GetValue());
+    gridSearch_.prepare(*m_gridMainR, m_checkBoxMatchCase->GetValue());
+
+    Disconnect(wxEVT_IDLE, wxIdleEventHandler(MainDialog::OnBuildSearchIndexAsync), nullptr, this); //connect at most once
+    Connect   (wxEVT_IDLE, wxIdleEventHandler(MainDialog::OnBuildSearchIndexAsync), nullptr, this);
+}
+
+
+void MainDialog::OnBuildSearchIndexAsync(wxIdleEvent& event)
+{
+    //data providers are not thread-safe => collect cell texts on main thread, but in small slices: don't block the GUI after comparison of a million rows
+    if (gridSearch_.prepareStep(std::chrono::milliseconds(20)))
+        event.RequestMore(); //continue even if there are no further user events
+    else
+        Disconnect(wxEVT_IDLE, wxIdleEventHandler(MainDialog::OnBuildSearchIndexAsync), nullptr, this);
+}
+
+
 void MainDialog::startFindNext(bool searchAscending) //F3 or ENTER in m_textCtrlSearchTxt
 {
     const std::wstring& searchString = utfTo<std::wstring>(trimCpy(m_textCtrlSearchTxt->GetValue()));
@@ -4482,9 +4519,11 @@ void MainDialog::startFindNext(bool searchAscending) //F3 or ENTER in m_textCtrl
         if ((isComponentOf(focus, m_panelSearch) ? focusIdAfterSearch_ : focus->GetId()) == m_gridMainR->getMainWin().GetId())
             std::swap(grid1, grid2); //select side to start search at grid cursor position
 
+        prepareFindNext(); //e.g. "match case" was toggled: until the index is ready, findNext() falls back to a linear search
+
         wxBeginBusyCursor(wxHOURGLASS_CURSOR);
-        const std::pair<const Grid*, ptrdiff_t> result = findGridMatch(*grid1, *grid2, utfTo<std::wstring>(searchString),
-                                                                       m_checkBoxMatchCase->GetValue(), searchAscending); //parameter owned by GUI, *not* globalCfg structure! => we should better implement a getGlocalCfg()!
+        const std::pair<const Grid*, ptrdiff_t> result = gridSearch_.findNext(*grid1, *grid2, utfTo<std::wstring>(searchString),
+                                                                              m_checkBoxMatchCase->GetValue(), searchAscending); //parameter owned by GUI, *not* globalCfg structure! => we should better implement a getGlocalCfg()!
         wxEndBusyCursor();
 
         if (Grid* grid = const_cast<Grid*>(result.first)) //grid wasn't const when passing to findAndSelectNext(), so this is safe
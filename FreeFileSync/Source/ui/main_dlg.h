@@ -15,6 +15,7 @@
 #include "gui_generated.h"
 #include "file_grid.h"
 #include "tree_grid.h"
+#include "search_grid.h"
 #include "sync_cfg.h"
 #include "log_panel.h"
 #include "folder_history_box.h"
@@ -209,6 +210,7 @@ private:
 
     void OnRegularUpdateCheck  (wxIdleEvent&  event);
     void OnLayoutWindowAsync   (wxIdleEvent&  event);
+    void OnBuildSearchIndexAsync(wxIdleEvent& event);
 
     void OnResizeLeftFolderWidth(wxEvent& event);
     void OnResizeTopButtonPanel (wxEvent& event);
@@ -258,6 +260,7 @@ private:
     void showFindPanel(); //CTRL + F
     void hideFindPanel();
     void startFindNext(bool searchAscending); //F3
+    void prepareFindNext(); //start building search index during idle time
 
     void resetLayout();
 
@@ -344,6 +347,7 @@ private:
     std::unique_ptr<FilterConfig> filterCfgOnClipboard_; //copy/paste of filter config
 
     wxWindowID focusIdAfterSearch_ = wxID_ANY; //used to restore focus after search panel is closed
+    GridSearch gridSearch_; //search index: must be invalidated whenever grid contents change!
 
     bool localKeyEventsEnabled_ = true;
     bool allowMainDialogClose_ = true; //e.g. do NOT allow close while sync is running => crash!!!
@@ -8,6 +8,7 @@
 #include <zen/zstring.h>
 #include <zen/utf.h>
 #include <zen/perf.h>
+#include <zen/thread.h>
 
 using namespace zen;
 using namespace fff;
@@ -19,84 +20,209 @@ inline std::wstring getUnicodeNormalFormWide(const std::wstring& str) { return u
 inline std::wstring makeUpperCopyWide       (const std::wstring& str) { return utfTo<std::wstring>(makeUpperCopy       (utfTo<Zstring>(str))); }
 
 
-template <bool respectCase>
-class MatchFound
+std::wstring normalizeForSearch(std::wstring&& str, bool respectCase)
 {
-public:
-    MatchFound(const std::wstring& textToFind) : textToFind_(getUnicodeNormalFormWide(textToFind)) {}
-    bool operator()(const std::wstring& phrase) const
+    if (respectCase)
     {
-        if (isAsciiString(phrase.c_str())) //perf: save Zstring conversion for getUnicodeNormalFormWide() when not needed
-            return contains(phrase, textToFind_);
+        if (isAsciiString(str)) //perf: save Zstring conversion for getUnicodeNormalFormWide() when not needed
+            return std::move(str);
         else
-            return contains(getUnicodeNormalFormWide(phrase), textToFind_);
+            return getUnicodeNormalFormWide(str);
     }
+    else
+    {
+        if (isAsciiString(str)) //perf: save Zstring conversion for makeUpperCopyWide() when not needed
+        {
+            for (wchar_t& c : str) c = asciiToUpper(c);
+            return std::move(str);
+        }
+        else
+            return makeUpperCopyWide(str); //getUnicodeNormalForm() is implied by makeUpperCopy()
+    }
+}
 
-private:
-    const std::wstring textToFind_;
-};
+
+std::vector<ColumnType> getVisibleColumns(const Grid& grid)
+{
+    std::vector<ColumnType> colTypes;
+    if (grid.getDataProvider()) //no data provider => nothing to search
+        for (const Grid::ColAttributes& ca : grid.getColumnConfig())
+            if (ca.visible)
+                colTypes.push_back(ca.type);
+    return colTypes;
+}
 
 
-template <>
-class MatchFound<false>
+//fallback while the search index is not yet ready: stop at the first match
+ptrdiff_t findRowLinear(const Grid& grid, //return -1 if no matching row found
+                        const std::wstring& textToFind, //normalized!
+                        bool respectCase,
+                        bool searchAscending,
+                        size_t rowFirst, //specify area to search:
+                        size_t rowLast)  // [rowFirst, rowLast)
 {
-public:
-    MatchFound(const std::wstring& textToFind) : textToFind_(makeUpperCopyWide(textToFind)) {}
-    bool operator()(std::wstring&& phrase) const
+    if (const GridData* prov = grid.getDataProvider())
     {
-        if (isAsciiString(phrase.c_str())) //perf: save Zstring conversion for makeUpperCopyWide() when not needed
+        const std::vector<ColumnType> colTypes = getVisibleColumns(grid);
+
+        auto rowMatches = [&](size_t row)
+        {
+            for (ColumnType colType : colTypes)
+                if (contains(normalizeForSearch(prov->getValue(row, colType), respectCase), textToFind))
+                    return true;
+            return false;
+        };
+
+        rowLast = std::min(rowLast, grid.getRowCount());
+        if (searchAscending)
         {
-            for (wchar_t& c : phrase) c = asciiToUpper(c);
-            return contains(phrase, textToFind_);
+            for (size_t row = rowFirst; row < rowLast; ++row)
+                if (rowMatches(row))
+                    return row;
         }
         else
-            return contains(makeUpperCopyWide(phrase), textToFind_); //getUnicodeNormalForm() is implied by makeUpperCopy()
+            for (size_t row = rowLast; row-- > rowFirst;)
+                if (rowMatches(row))
+                    return row;
     }
+    return -1;
+}
 
-private:
-    const std::wstring textToFind_;
-};
 
-//###########################################################################################
+const size_t SEARCH_INDEX_ROWS_PER_TASK = 50000;
+const size_t SEARCH_INDEX_ROWS_PER_TIME_CHECK = 100;
+}
+
 
-template <bool respectCase>
-ptrdiff_t findRow(const Grid& grid, //return -1 if no matching row found
-                  const std::wstring& searchString,
-                  bool searchAscending,
-                  size_t rowFirst, //specify area to search:
-                  size_t rowLast)  // [rowFirst, rowLast)
+void GridSearch::prepare(const Grid& grid, bool respectCase)
 {
-    if (auto prov = grid.getDataProvider())
-    {
-        std::vector<Grid::ColAttributes> colAttr = grid.getColumnConfig();
-        eraseIf(colAttr, [](const Grid::ColAttributes& ca) { return !ca.visible; });
-        if (!colAttr.empty())
+    const size_t rowCount = grid.getRowCount();
+    const std::vector<ColumnType> colTypes = getVisibleColumns(grid);
+
+    //discard outdated index: rows or columns have changed
+    eraseIf(indexes_, [&](const GridIndex& gi) { return gi.grid == &grid && (gi.rowCount != rowCount || gi.colTypes != colTypes); });
+
+    if (std::any_of(indexes_.begin(), indexes_.end(), [&](const GridIndex& gi) { return gi.grid == &grid && gi.respectCase == respectCase; }))
+        return;
+
+    GridIndex gi;
+    gi.grid        = &grid;
+    gi.respectCase = respectCase;
+    gi.rowCount    = rowCount;
+    gi.colTypes    = colTypes;
+    indexes_.push_back(std::move(gi));
+}
+
+
+bool GridSearch::prepareStep(std::chrono::milliseconds timeMax)
+{
+    const auto stopTime = std::chrono::steady_clock::now() + timeMax;
+
+    for (GridIndex& gi : indexes_)
+        if (!gi.textIndexAsync.valid() && !gi.textIndex)
         {
-            const MatchFound<respectCase> matchFound(searchString);
+            //PERF_START;
 
-            if (searchAscending)
+            //1. collect raw cell texts: data provider is not thread-safe => main thread only, a slice at a time to keep the GUI responsive
+            if (gi.rowCount != gi.grid->getRowCount() || gi.colTypes != getVisibleColumns(*gi.grid)) //grid changed since prepare(): start over
             {
-                for (size_t row = rowFirst; row < rowLast; ++row)
-                    for (const Grid::ColAttributes& ca : colAttr)
-                        if (matchFound(prov->getValue(row, ca.type)))
-                            return row;
+                gi.rowCount = gi.grid->getRowCount();
+                gi.colTypes = getVisibleColumns(*gi.grid);
+                gi.cellTexts.clear();
+                gi.rowsCollected = 0;
+            }
+
+            if (const GridData* prov = gi.grid->getDataProvider())
+            {
+                gi.cellTexts.reserve(gi.rowCount * gi.colTypes.size());
+
+                for (; gi.rowsCollected < gi.rowCount; ++gi.rowsCollected)
+                {
+                    if (gi.rowsCollected % SEARCH_INDEX_ROWS_PER_TIME_CHECK == 0 && std::chrono::steady_clock::now() >= stopTime)
+                        return true; //continue with next idle event
+
+                    for (ColumnType colType : gi.colTypes)
+                        gi.cellTexts.push_back(prov->getValue(gi.rowsCollected, colType));
+                }
             }
             else
-                for (size_t row = rowLast; row-- > rowFirst;)
-                    for (const Grid::ColAttributes& ca : colAttr)
-                        if (matchFound(prov->getValue(row, ca.type)))
-                            return row;
+                assert(gi.colTypes.empty());
+
+            //2. normalize texts and put them into a contiguous buffer: CPU-intensive => worker threads
+            gi.textIndexAsync = runAsync([cellTexts = std::move(gi.cellTexts), colCount = gi.colTypes.size(), rowCount = gi.rowCount, respectCase = gi.respectCase]() mutable
+            {
+                struct RowRange
+                {
+                    std::wstring text;
+                    std::vector<size_t> rowOffsets;
+                };
+
+                auto normalizeRows = [&](size_t rowFirst, size_t rowLast) //[rowFirst, rowLast)
+                {
+                    RowRange rr;
+                    for (size_t row = rowFirst; row < rowLast; ++row)
+                    {
+                        rr.rowOffsets.push_back(rr.text.size());
+                        for (size_t col = 0; col < colCount; ++col)
+                        {
+                            std::wstring& cellText = cellTexts[row * colCount + col];
+                            rr.text += normalizeForSearch(std::move(cellText), respectCase);
+                            rr.text += L'\0'; //a match must not span multiple cells
+                            std::wstring().swap(cellText); //release memory early
+                        }
+                    }
+                    return rr;
+                };
+
+                std::vector<std::future<RowRange>> futures;
+                for (size_t rowFirst = 0; rowFirst < rowCount; rowFirst += SEARCH_INDEX_ROWS_PER_TASK)
+                {
+                    const size_t rowLast = std::min(rowFirst + SEARCH_INDEX_ROWS_PER_TASK, rowCount);
+                    if (rowLast == rowCount) //process last chunk on current thread
+                        futures.push_back(std::async(std::launch::deferred, [&, rowFirst, rowLast] { return normalizeRows(rowFirst, rowLast); }));
+                    else
+                        futures.push_back(runAsync([&, rowFirst, rowLast] { return normalizeRows(rowFirst, rowLast); })); //each task works on distinct cellTexts
+                }
+
+                TextIndex index;
+                index.rowOffsets.reserve(rowCount + 1);
+
+                for (std::future<RowRange>& ft : futures)
+                {
+                    RowRange rr = ft.get();
+                    for (size_t offset : rr.rowOffsets)
+                        index.rowOffsets.push_back(index.text.size() + offset);
+                    index.text += rr.text;
+                }
+                index.rowOffsets.push_back(index.text.size());
+                return index;
+            });
         }
-    }
-    return -1;
+    return false;
 }
+
+
+const GridSearch::TextIndex* GridSearch::getReadyIndex(const Grid& grid, bool respectCase)
+{
+    auto it = std::find_if(indexes_.begin(), indexes_.end(), [&](const GridIndex& gi) { return gi.grid == &grid && gi.respectCase == respectCase; });
+    if (it == indexes_.end() || it->rowCount != grid.getRowCount() || it->colTypes != getVisibleColumns(grid))
+        return nullptr;
+
+    if (!it->textIndex && it->textIndexAsync.valid() && isReady(it->textIndexAsync)) //don't wait for background indexing
+        it->textIndex = it->textIndexAsync.get();
+
+    return it->textIndex ? &*it->textIndex : nullptr;
 }
 
 
-std::pair<const Grid*, ptrdiff_t> fff::findGridMatch(const Grid& grid1, const Grid& grid2, const std::wstring& searchString, bool respectCase, bool searchAscending)
+std::pair<const Grid*, ptrdiff_t> GridSearch::findNext(const Grid& grid1, const Grid& grid2, const std::wstring& searchString, bool respectCase, bool searchAscending)
 {
     //PERF_START
 
+    const std::wstring textToFind = normalizeForSearch(std::wstring(searchString), respectCase);
+    if (textToFind.empty())
+        return { nullptr, -1 };
+
     const size_t rowCount1 = grid1.getRowCount();
     const size_t rowCount2 = grid2.getRowCount();
 
@@ -106,17 +232,38 @@ std::pair<const Grid*, ptrdiff_t> fff::findGridMatch(const Grid& grid1, const Gr
 
     std::pair<const Grid*, ptrdiff_t> result(nullptr, -1);
 
-    auto finishSearch = [&](const Grid& grid, size_t rowFirst, size_t rowLast)
+    auto finishSearch = [&](const Grid& grid, size_t rowFirst, size_t rowLast) //[rowFirst, rowLast)
     {
-        const ptrdiff_t targetRow = respectCase ?
-                                    findRow<true >(grid, searchString, searchAscending, rowFirst, rowLast) :
-                                    findRow<false>(grid, searchString, searchAscending, rowFirst, rowLast);
-        if (targetRow >= 0)
+        const TextIndex* index = getReadyIndex(grid, respectCase);
+        if (!index)
         {
+            const ptrdiff_t targetRow = findRowLinear(grid, textToFind, respectCase, searchAscending, rowFirst, rowLast);
+            if (targetRow < 0)
+                return false;
+
             result = { &grid, targetRow };
             return true;
         }
-        return false;
+        assert(index->rowOffsets.size() == grid.getRowCount() + 1);
+
+        rowLast = std::min(rowLast, index->rowOffsets.size() - 1);
+        if (rowFirst >= rowLast)
+            return false;
+
+        const size_t posFirst = index->rowOffsets[rowFirst];
+        const size_t posLast  = index->rowOffsets[rowLast];
+
+        //cell texts are separated by L'\0' => a match found inside [posFirst, posLast) never extends beyond its row
+        const size_t pos = searchAscending ?
+                           index->text.find (textToFind, posFirst) :
+                           index->text.rfind(textToFind, posLast - 1);
+
+        if (pos == std::wstring::npos || pos < posFirst || pos >= posLast)
+            return false;
+
+        const auto itRow = std::upper_bound(index->rowOffsets.begin(), index->rowOffsets.end(), pos) - 1;
+        result = { &grid, itRow - index->rowOffsets.begin() };
+        return true;
     };
 
     if (searchAscending)
@@ -7,13 +7,54 @@
 #ifndef SEARCH_H_423905762345342526587
 #define SEARCH_H_423905762345342526587
 
+#include <chrono>
+#include <future>
+#include <optional>
 #include <wx+/grid.h>
 
 
 namespace fff
 {
-std::pair<const zen::Grid*, ptrdiff_t> findGridMatch(const zen::Grid& grid1, const zen::Grid& grid2, const std::wstring& searchString, bool respectCase, bool searchAscending);
-//returns (grid/row) where the value was found, (nullptr, -1) if not found
+class GridSearch //find text in the visible columns of a grid
+{
+public:
+    GridSearch() {}
+
+    std::pair<const zen::Grid*, ptrdiff_t> findNext(const zen::Grid& grid1, const zen::Grid& grid2, const std::wstring& searchString, bool respectCase, bool searchAscending);
+    //returns (grid/row) where the value was found, (nullptr, -1) if not found
+    //uses the search index if it is ready, a linear search otherwise
+
+    void prepare(const zen::Grid& grid, bool respectCase); //optional: request a search index => built by prepareStep()
+    bool prepareStep(std::chrono::milliseconds timeMax); //call from main thread when idle; returns true if more steps are needed
+    void invalidate() { indexes_.clear(); } //call whenever the grid contents change (rows, sort order, item path format)
+
+private:
+    GridSearch           (const GridSearch&) = delete;
+    GridSearch& operator=(const GridSearch&) = delete;
+
+    struct TextIndex
+    {
+        std::wstring text; //normalized cell texts of all visible columns, each followed by L'\0'
+        std::vector<size_t> rowOffsets; //row i: [rowOffsets[i], rowOffsets[i + 1])
+    };
+
+    struct GridIndex
+    {
+        const zen::Grid* grid = nullptr;
+        bool respectCase = false;
+        size_t rowCount = 0;
+        std::vector<zen::ColumnType> colTypes; //visible columns at the time of indexing
+
+        std::vector<std::wstring> cellTexts;   //1. collected on main thread: one time slice per prepareStep()
+        size_t rowsCollected = 0;              //
+        std::future<TextIndex> textIndexAsync; //2. normalized by worker threads
+        std::optional<TextIndex> textIndex;    //3. ready to use
+    };
+
+    const TextIndex* getReadyIndex(const zen::Grid& grid, bool respectCase); //nullptr if not (yet) available
+
+    std::vector<GridIndex> indexes_;
+};
 }
 
 #endif //SEARCH_H_423905762345342526587
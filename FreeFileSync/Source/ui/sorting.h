@@ -31,149 +31,129 @@ bool isDirectoryPair(const FileSystemObject& fsObj)
 }
 
 
-template <bool ascending, SelectedSide side> inline
-bool lessShortFileName(const FileSystemObject& a, const FileSystemObject& b)
+//sort keys are precomputed once per row: no path building, Unicode normalization or case conversion during sorting
+struct SortKey //compared in order of declaration:
 {
-    //sort order: first files/symlinks, then directories then empty rows
-
-    //empty rows always last
-    if (a.isEmpty<side>())
-        return false;
-    else if (b.isEmpty<side>())
-        return true;
-
-    //directories after files/symlinks:
-    if (isDirectoryPair(a))
-    {
-        if (!isDirectoryPair(b))
-            return false;
-    }
-    else if (isDirectoryPair(b))
-        return true;
-
-    //sort directories and files/symlinks by short name
-    return zen::makeSortDirection(LessNaturalSort() /*even on Linux*/, std::bool_constant<ascending>())(a.getItemName<side>(), b.getItemName<side>());
-}
-
-
-template <bool ascending, SelectedSide side> inline
-bool lessFullPath(const FileSystemObject& a, const FileSystemObject& b)
-{
-    //empty rows always last
-    if (a.isEmpty<side>())
-        return false;
-    else if (b.isEmpty<side>())
-        return true;
-
-    return zen::makeSortDirection(LessNaturalSort() /*even on Linux*/, std::bool_constant<ascending>())(
-               zen::utfTo<Zstring>(AFS::getDisplayPath(a.getAbstractPath<side>())),
-               zen::utfTo<Zstring>(AFS::getDisplayPath(b.getAbstractPath<side>())));
-}
+    unsigned char rank = 0;    //independent from sort direction, e.g. empty rows always last
+    uint64_t      number = 0;  //sort direction applies
+    std::string   text;        //sort direction applies; see getNaturalSortKey()
+    unsigned char subRank = 0; //independent from sort direction
+    std::string   subText;     //sort direction applies
+};
 
 
-template <bool ascending>  inline //side currently unused!
-bool lessRelativeFolder(const FileSystemObject& a, const FileSystemObject& b)
+template <bool ascending> inline
+bool lessSortKey(const SortKey& a, const SortKey& b)
 {
-    const bool isDirectoryA = isDirectoryPair(a);
-    const Zstring& relFolderA = isDirectoryA ?
-                                a.getRelativePathAny() :
-                                a.parent().getRelativePathAny();
+    if (a.rank != b.rank)
+        return a.rank < b.rank;
 
-    const bool isDirectoryB = isDirectoryPair(b);
-    const Zstring& relFolderB = isDirectoryB ?
-                                b.getRelativePathAny() :
-                                b.parent().getRelativePathAny();
+    if (a.number != b.number)
+        return zen::makeSortDirection(std::less<>(), std::bool_constant<ascending>())(a.number, b.number);
 
-    //compare relative names without filepaths first
-    const int rv = compareNatural(relFolderA, relFolderB);
-    if (rv != 0)
+    if (const int rv = a.text.compare(b.text); rv != 0)
         return zen::makeSortDirection(std::less<int>(), std::bool_constant<ascending>())(rv, 0);
 
-    //make directories always appear before contained files
-    if (isDirectoryB)
-        return false;
-    else if (isDirectoryA)
-        return true;
+    if (a.subRank != b.subRank)
+        return a.subRank < b.subRank;
 
-    return zen::makeSortDirection(LessNaturalSort(), std::bool_constant<ascending>())(a.getItemNameAny(), b.getItemNameAny());
+    return zen::makeSortDirection(std::less<>(), std::bool_constant<ascending>())(a.subText, b.subText);
 }
 
 
-template <bool ascending, SelectedSide side> inline
-bool lessFilesize(const FileSystemObject& a, const FileSystemObject& b)
+template <SelectedSide side> inline
+SortKey getSortKeyShortFileName(const FileSystemObject& fsObj)
 {
-    //empty rows always last
-    if (a.isEmpty<side>())
-        return false;
-    else if (b.isEmpty<side>())
-        return true;
-
-    //directories second last
-    if (isDirectoryPair(a))
-        return false;
-    else if (isDirectoryPair(b))
-        return true;
-
-    const FilePair* fileA = dynamic_cast<const FilePair*>(&a);
-    const FilePair* fileB = dynamic_cast<const FilePair*>(&b);
+    //sort order: first files/symlinks, then directories then empty rows
+    SortKey key;
+    if (fsObj.isEmpty<side>())
+        key.rank = 2; //empty rows always last
+    else
+    {
+        key.rank = isDirectoryPair(fsObj) ? 1 : 0; //directories after files/symlinks
+        key.text = getNaturalSortKey(fsObj.getItemName<side>()); //sort directories and files/symlinks by short name
+    }
+    return key;
+}
 
-    //then symlinks
-    if (!fileA)
-        return false;
-    else if (!fileB)
-        return true;
 
-    //return list beginning with largest files first
-    return zen::makeSortDirection(std::less<>(), std::bool_constant<ascending>())(fileA->getFileSize<side>(), fileB->getFileSize<side>());
+template <SelectedSide side> inline
+SortKey getSortKeyFullPath(const FileSystemObject& fsObj)
+{
+    SortKey key;
+    if (fsObj.isEmpty<side>())
+        key.rank = 1; //empty rows always last
+    else
+        key.text = getNaturalSortKey(zen::utfTo<Zstring>(AFS::getDisplayPath(fsObj.getAbstractPath<side>())));
+    return key;
 }
 
 
-template <bool ascending, SelectedSide side> inline
-bool lessFiletime(const FileSystemObject& a, const FileSystemObject& b)
+inline //side currently unused!
+SortKey getSortKeyRelativeFolder(const FileSystemObject& fsObj)
 {
-    if (a.isEmpty<side>())
-        return false; //empty rows always last
-    else if (b.isEmpty<side>())
-        return true; //empty rows always last
-
-    const FilePair* fileA = dynamic_cast<const FilePair*>(&a);
-    const FilePair* fileB = dynamic_cast<const FilePair*>(&b);
+    SortKey key; //caller presorts by folder pair: SortKey::number
 
-    const SymlinkPair* symlinkA = dynamic_cast<const SymlinkPair*>(&a);
-    const SymlinkPair* symlinkB = dynamic_cast<const SymlinkPair*>(&b);
+    //compare relative names without filepaths first
+    const bool isDirectory = isDirectoryPair(fsObj);
+    key.text = getNaturalSortKey(isDirectory ?
+                                 fsObj.getRelativePathAny() :
+                                 fsObj.parent().getRelativePathAny());
 
-    if (!fileA && !symlinkA)
-        return false; //directories last
-    else if (!fileB && !symlinkB)
-        return true; //directories last
+    //make directories always appear before contained files
+    key.subRank = isDirectory ? 0 : 1;
+    if (!isDirectory)
+        key.subText = getNaturalSortKey(fsObj.getItemNameAny());
+    return key;
+}
 
-    const int64_t dateA = fileA ? fileA->getLastWriteTime<side>() : symlinkA->getLastWriteTime<side>();
-    const int64_t dateB = fileB ? fileB->getLastWriteTime<side>() : symlinkB->getLastWriteTime<side>();
 
-    //return list beginning with newest files first
-    return zen::makeSortDirection(std::less<>(), std::bool_constant<ascending>())(dateA, dateB);
+template <SelectedSide side> inline
+SortKey getSortKeyFilesize(const FileSystemObject& fsObj)
+{
+    SortKey key;
+    if (fsObj.isEmpty<side>())
+        key.rank = 3; //empty rows always last
+    else if (isDirectoryPair(fsObj))
+        key.rank = 2; //directories second last
+    else if (const FilePair* file = dynamic_cast<const FilePair*>(&fsObj))
+        key.number = file->getFileSize<side>(); //return list beginning with largest files first
+    else
+        key.rank = 1; //then symlinks
+    return key;
 }
 
 
-template <bool ascending, SelectedSide side> inline
-bool lessExtension(const FileSystemObject& a, const FileSystemObject& b)
+template <SelectedSide side> inline
+SortKey getSortKeyFiletime(const FileSystemObject& fsObj)
 {
-    if (a.isEmpty<side>())
-        return false; //empty rows always last
-    else if (b.isEmpty<side>())
-        return true; //empty rows always last
+    //map signed time to unsigned while preserving order
+    auto timeToNumber = [](int64_t time) { return static_cast<uint64_t>(time) ^ (static_cast<uint64_t>(1) << 63); };
+
+    SortKey key;
+    if (fsObj.isEmpty<side>())
+        key.rank = 2; //empty rows always last
+    else if (const FilePair* file = dynamic_cast<const FilePair*>(&fsObj))
+        key.number = timeToNumber(file->getLastWriteTime<side>()); //return list beginning with newest files first
+    else if (const SymlinkPair* symlink = dynamic_cast<const SymlinkPair*>(&fsObj))
+        key.number = timeToNumber(symlink->getLastWriteTime<side>());
+    else
+        key.rank = 1; //directories last
+    return key;
+}
 
-    if (dynamic_cast<const FolderPair*>(&a))
-        return false; //directories last
-    else if (dynamic_cast<const FolderPair*>(&b))
-        return true; //directories last
 
-    auto getExtension = [](const FileSystemObject& fsObj)
-    {
-        return afterLast(fsObj.getItemName<side>(), Zstr('.'), zen::IF_MISSING_RETURN_NONE);
-    };
-
-    return zen::makeSortDirection(LessNaturalSort() /*even on Linux*/, std::bool_constant<ascending>())(getExtension(a), getExtension(b));
+template <SelectedSide side> inline
+SortKey getSortKeyExtension(const FileSystemObject& fsObj)
+{
+    SortKey key;
+    if (fsObj.isEmpty<side>())
+        key.rank = 2; //empty rows always last
+    else if (isDirectoryPair(fsObj))
+        key.rank = 1; //directories last
+    else
+        key.text = getNaturalSortKey(afterLast(fsObj.getItemName<side>(), Zstr('.'), zen::IF_MISSING_RETURN_NONE));
+    return key;
 }
 
 
@@ -12,6 +12,7 @@
 #include <zen/utf.h>
 #include <zen/stl_tools.h>
 #include <zen/format_unit.h>
+#include <zen/thread.h>
 #include <wx+/rtl.h>
 #include <wx+/dc.h>
 #include <wx+/context_menu.h>
@@ -36,7 +37,7 @@ inline wxColor getColorPercentBackground() { return { 0xf8, 0xf8, 0xf8 }; }
 inline
 void TreeView::compressNode(Container& cont) //remove single-element sub-trees -> gain clarity + usability (call *after* inclusion check!!!)
 {
-    if (cont.subDirs.empty()) //single files node
+    if (cont.subDirCount == 0) //single files node
         cont.firstFileId = nullptr;
 
 #if 0 //let's not go overboard: empty folders should not be condensed => used for file exclusion filter; user expects to see them
@@ -49,10 +50,23 @@ void TreeView::compressNode(Container& cont) //remove single-element sub-trees -
 }
 
 
-template <class Function> //(const FileSystemObject&) -> bool
-void TreeView::extractVisibleSubtree(ContainerObject& hierObj,  //in
-                                     TreeView::Container& cont, //out
-                                     Function pred)
+inline
+void TreeView::setStats(Container& cont, const FolderStats& stats)
+{
+    cont.bytesGross     = stats.bytesGross;
+    cont.bytesNet       = stats.bytesNet;
+    cont.itemCountGross = stats.itemCountGross;
+    cont.itemCountNet   = stats.itemCountNet;
+    cont.subDirCount    = stats.subDirCount;
+    cont.firstFileId    = stats.firstFileId;
+}
+
+
+template <class Predicate> //(const FileSystemObject&) -> bool
+TreeView::FolderStats TreeView::getSubtreeStats(ContainerObject& hierObj,  //in
+                                                const Predicate& pred,
+                                                const FolderStatsMap& statsBuf, //in: numbers of unchanged sub folders are reused
+                                                FolderStatsList& statsOut)      //out: numbers of re-evaluated sub folders
 {
     auto getBytes = [](const FilePair& file) //MSVC screws up miserably if we put this lambda into std::for_each
     {
@@ -73,57 +87,158 @@ void TreeView::extractVisibleSubtree(ContainerObject& hierObj,  //in
         return std::max(file.getFileSize<LEFT_SIDE>(), file.getFileSize<RIGHT_SIDE>());
     };
 
-    cont.firstFileId = nullptr;
+    FolderStats stats;
+    stats.changeCount = hierObj.getChangeCount();
+
     for (FilePair& file : hierObj.refSubFiles())
         if (pred(file))
         {
-            cont.bytesNet += getBytes(file);
-            ++cont.itemCountNet;
+            stats.bytesNet += getBytes(file);
+            ++stats.itemCountNet;
 
-            if (!cont.firstFileId)
-                cont.firstFileId = file.getId();
+            if (!stats.firstFileId)
+                stats.firstFileId = file.getId();
         }
 
     for (SymlinkPair& symlink : hierObj.refSubLinks())
         if (pred(symlink))
         {
-            ++cont.itemCountNet;
+            ++stats.itemCountNet;
 
-            if (!cont.firstFileId)
-                cont.firstFileId = symlink.getId();
+            if (!stats.firstFileId)
+                stats.firstFileId = symlink.getId();
         }
 
-    cont.bytesGross     += cont.bytesNet;
-    cont.itemCountGross += cont.itemCountNet;
-
-    cont.subDirs.reserve(hierObj.refSubFolders().size()); //avoid expensive reallocations!
+    stats.bytesGross     += stats.bytesNet;
+    stats.itemCountGross += stats.itemCountNet;
 
     for (FolderPair& folder : hierObj.refSubFolders())
     {
-        const bool included = pred(folder);
+        const FolderStats subStats = getFolderStats(folder, pred, statsBuf, statsOut);
 
-        cont.subDirs.emplace_back(); //
-        auto& subDirCont = cont.subDirs.back();
-        TreeView::extractVisibleSubtree(folder, subDirCont, pred);
-        if (included)
-            ++subDirCont.itemCountGross;
+        stats.bytesGross     += subStats.bytesGross;
+        stats.itemCountGross += subStats.itemCountGross;
 
-        cont.bytesGross     += subDirCont.bytesGross;
-        cont.itemCountGross += subDirCont.itemCountGross;
+        if (subStats.included || subStats.firstFileId || subStats.subDirCount > 0)
+            ++stats.subDirCount;
+    }
+    return stats;
+}
 
-        if (!included && !subDirCont.firstFileId && subDirCont.subDirs.empty())
-            cont.subDirs.pop_back();
-        else
-        {
-            subDirCont.objId = folder.getId();
-            compressNode(subDirCont);
-        }
+
+template <class Predicate>
+TreeView::FolderStats TreeView::getFolderStats(FolderPair& folder, const Predicate& pred, const FolderStatsMap& statsBuf, FolderStatsList& statsOut)
+{
+    auto it = statsBuf.find(folder.getId());
+    if (it != statsBuf.end() && it->second.changeCount == folder.getChangeCount())
+        return it->second; //sub-tree unchanged since last evaluation
+
+    FolderStats stats = getSubtreeStats(folder, pred, statsBuf, statsOut);
+    stats.included = pred(folder);
+    if (stats.included)
+        ++stats.itemCountGross;
+
+    statsOut.emplace_back(folder.getId(), stats);
+    return stats;
+}
+
+
+template <class Predicate>
+void TreeView::updateFolderStatsParallel(const Predicate& pred)
+{
+    auto isStale = [&](const FolderPair& folder)
+    {
+        auto it = folderStats_.find(folder.getId());
+        return it == folderStats_.end() || it->second.changeCount != folder.getChangeCount();
+    };
+
+    const size_t threadCount = std::max<size_t>(std::thread::hardware_concurrency(), 1); //hardware_concurrency() returns 0 if not computable
+
+    //descend the stale sub-trees until there are enough tasks to keep all threads busy: the levels above are evaluated on the main thread
+    std::vector<FolderPair*> tasks;
+    for (const std::shared_ptr<BaseFolderPair>& baseObj : folderCmp_)
+        for (FolderPair& folder : baseObj->refSubFolders())
+            if (isStale(folder))
+                tasks.push_back(&folder);
+
+    while (tasks.size() < 4 * threadCount) //a few tasks per thread: sub-tree sizes vary greatly
+    {
+        std::vector<FolderPair*> subTasks;
+        for (FolderPair* folder : tasks)
+            for (FolderPair& subFolder : folder->refSubFolders())
+                if (isStale(subFolder))
+                    subTasks.push_back(&subFolder);
+
+        if (subTasks.size() <= tasks.size())
+            break; //no parallelism to gain
+        tasks.swap(subTasks);
+    }
+
+    if (threadCount <= 1 || tasks.size() <= 1)
+        return; //evaluate on main thread
+
+    //PERF_START;
+    std::vector<FolderStatsList> statsOut(threadCount);
+    std::atomic<size_t> nextTask{ 0 };
+
+    std::vector<std::future<void>> futures;
+    for (size_t i = 0; i < threadCount; ++i)
+        futures.push_back(runAsync([&, &threadStatsOut = statsOut[i]]
+    {
+        //sub-trees are disjoint: FolderPair::getSyncOperation() only looks at direct children
+        for (size_t taskIdx = nextTask++; taskIdx < tasks.size(); taskIdx = nextTask++)
+            getFolderStats(*tasks[taskIdx], pred, folderStats_, threadStatsOut); //folderStats_ is read-only until all threads are done
+    }));
+
+    for (std::future<void>& ft : futures)
+        ft.get();
+
+    for (const FolderStatsList& threadStatsOut : statsOut)
+        for (const auto& [folderId, stats] : threadStatsOut)
+            folderStats_[folderId] = stats;
+}
+
+
+void TreeView::loadSubDirs(Container& cont, ContainerObject& hierObj)
+{
+    if (cont.subDirsLoaded)
+        return;
+    cont.subDirsLoaded = true;
+
+    cont.subDirs.reserve(cont.subDirCount); //avoid expensive reallocations! => also keeps TreeLine::node pointers valid
+
+    for (FolderPair& folder : hierObj.refSubFolders())
+    {
+        auto it = folderStats_.find(folder.getId());
+        if (it == folderStats_.end()) //folder added after last view update?
+            continue;
+        const FolderStats& stats = it->second;
+
+        if (stats.included || stats.firstFileId || stats.subDirCount > 0)
+            if (cont.subDirs.size() < cont.subDirs.capacity()) //sub-tree changed after last view update? don't invalidate pointers!
+            {
+                cont.subDirs.emplace_back();
+                DirNodeImpl& subDirCont = cont.subDirs.back();
+                setStats(subDirCont, stats);
+                subDirCont.objId = folder.getId();
+                compressNode(subDirCont);
+            }
     }
 }
 
 
 namespace
 {
+template <class... Flags>
+uint32_t getViewFilterId(bool syncPreview, Flags... flags) //identify view filter: TreeView::folderStats_ are only valid for a single filter
+{
+    uint32_t filterId = syncPreview ? 1 : 0;
+    for (bool flag : { flags... })
+        filterId = filterId << 1 | (flag ? 1 : 0);
+    return filterId;
+}
+
+
 //generate nice percentage numbers which precisely sum up to 100
 void calcPercentage(std::vector<std::pair<uint64_t, int*>>& workList)
 {
@@ -255,13 +370,16 @@ void TreeView::sortSingleLevel(std::vector<TreeLine>& items, ColumnTypeTree colu
 }
 
 
-void TreeView::getChildren(const Container& cont, unsigned int level, std::vector<TreeLine>& output)
+void TreeView::getChildren(Container& cont, ContainerObject* hierObj, unsigned int level, std::vector<TreeLine>& output)
 {
+    if (hierObj)
+        loadSubDirs(cont, *hierObj);
+
     output.clear();
     output.reserve(cont.subDirs.size() + 1); //keep pointers in "workList" valid
     std::vector<std::pair<uint64_t, int*>> workList;
 
-    for (const DirNodeImpl& subDir : cont.subDirs)
+    for (DirNodeImpl& subDir : cont.subDirs)
     {
         output.push_back({ level, 0, &subDir, TreeView::TYPE_DIRECTORY });
         workList.emplace_back(subDir.bytesGross, &output.back().percent);
@@ -281,34 +399,35 @@ void TreeView::getChildren(const Container& cont, unsigned int level, std::vecto
 }
 
 
-void TreeView::applySubView(std::vector<RootNodeImpl>&& newView)
+ContainerObject* TreeView::getContainerObject(const TreeLine& line)
 {
-    //preserve current node expansion status
-    auto getHierAlias = [](const TreeView::TreeLine& tl) -> const ContainerObject*
+    switch (line.type)
     {
-        switch (tl.type)
-        {
-            case TreeView::TYPE_ROOT:
-                return static_cast<const RootNodeImpl*>(tl.node)->baseFolder.get();
+        case TreeView::TYPE_ROOT:
+            return static_cast<const RootNodeImpl*>(line.node)->baseFolder.get();
 
-            case TreeView::TYPE_DIRECTORY:
-                if (auto folder = dynamic_cast<const FolderPair*>(FileSystemObject::retrieve(static_cast<const DirNodeImpl*>(tl.node)->objId)))
-                    return folder;
-                break;
+        case TreeView::TYPE_DIRECTORY:
+            if (auto folder = dynamic_cast<FolderPair*>(FileSystemObject::retrieve(static_cast<const DirNodeImpl*>(line.node)->objId)))
+                return folder;
+            break;
+
+        case TreeView::TYPE_FILES:
+            break; //none!!!
+    }
+    return nullptr;
+}
 
-            case TreeView::TYPE_FILES:
-                break; //none!!!
-        }
-        return nullptr;
-    };
 
+void TreeView::applySubView(std::vector<RootNodeImpl>&& newView)
+{
+    //preserve current node expansion status
     std::unordered_set<const ContainerObject*> expandedNodes;
     if (!flatTree_.empty())
     {
         auto it = flatTree_.begin();
         for (auto iterNext = flatTree_.begin() + 1; iterNext != flatTree_.end(); ++iterNext, ++it)
             if (it->level < iterNext->level)
-                if (auto hierObj = getHierAlias(*it))
+                if (auto hierObj = getContainerObject(*it))
                     expandedNodes.insert(hierObj);
     }
 
@@ -321,7 +440,7 @@ void TreeView::applySubView(std::vector<RootNodeImpl>&& newView)
     if (folderCmp_.size() == 1) //single folder pair case (empty pairs were already removed!) do NOT use folderCmpView for this check!
     {
         if (!folderCmpView_.empty()) //possibly empty!
-            getChildren(folderCmpView_[0], 0, flatTree_); //do not show root
+            getChildren(folderCmpView_[0], folderCmpView_[0].baseFolder.get(), 0, flatTree_); //do not show root
     }
     else
     {
@@ -331,7 +450,7 @@ void TreeView::applySubView(std::vector<RootNodeImpl>&& newView)
         flatTree_.reserve(folderCmpView_.size()); //keep pointers in "workList" valid
         std::vector<std::pair<uint64_t, int*>> workList;
 
-        for (const RootNodeImpl& root : folderCmpView_)
+        for (RootNodeImpl& root : folderCmpView_)
         {
             flatTree_.push_back({ 0, 0, &root, TreeView::TYPE_ROOT });
             workList.emplace_back(root.bytesGross, &flatTree_.back().percent);
@@ -350,11 +469,11 @@ void TreeView::applySubView(std::vector<RootNodeImpl>&& newView)
     {
         const TreeLine& line = flatTree_[row];
 
-        if (auto hierObj = getHierAlias(line))
+        if (auto hierObj = getContainerObject(line))
             if (expandedNodes.find(hierObj) != expandedNodes.end())
             {
                 std::vector<TreeLine> newLines;
-                getChildren(*line.node, line.level + 1, newLines);
+                getChildren(*line.node, hierObj, line.level + 1, newLines);
 
                 flatTree_.insert(flatTree_.begin() + row + 1, newLines.begin(), newLines.end());
             }
@@ -363,24 +482,36 @@ void TreeView::applySubView(std::vector<RootNodeImpl>&& newView)
 
 
 template <class Predicate>
-void TreeView::updateView(Predicate pred)
+void TreeView::updateView(Predicate pred, uint32_t viewFilterId)
 {
-    //update view on full data
+    if (folderStatsFilterId_ != viewFilterId) //buffered numbers are only valid for the view filter they were evaluated with
+    {
+        folderStats_.clear();
+        folderStatsFilterId_ = viewFilterId;
+    }
+
+    //re-evaluate changed sub-trees only: in parallel for large sub-trees
+    updateFolderStatsParallel(pred);
+
+    //update view on full data: only the root nodes are materialized, sub directories are loaded when expanded
     std::vector<RootNodeImpl> newView;
     newView.reserve(folderCmp_.size()); //avoid expensive reallocations!
 
     for (const std::shared_ptr<BaseFolderPair>& baseObj : folderCmp_)
     {
-        newView.emplace_back();
-        RootNodeImpl& root = newView.back();
-        this->extractVisibleSubtree(*baseObj, root, pred); //"this->" is bogus for a static method, but GCC screws this one up
+        FolderStatsList statsOut;
+        const FolderStats stats = this->getSubtreeStats(*baseObj, pred, folderStats_, statsOut); //"this->" is bogus for a static method, but GCC screws this one up
 
-        //warning: the following lines are almost 1:1 copy from extractVisibleSubtree:
+        for (const auto& [folderId, folderStats] : statsOut)
+            folderStats_[folderId] = folderStats;
+
+        //warning: the following lines are almost 1:1 copy from getSubtreeStats:
         //however we *cannot* reuse code here; this were only possible if we replaced "std::vector<RootNodeImpl>" with "Container"!
-        if (!root.firstFileId && root.subDirs.empty())
-            newView.pop_back();
-        else
+        if (stats.firstFileId || stats.subDirCount > 0)
         {
+            newView.emplace_back();
+            RootNodeImpl& root = newView.back();
+            setStats(root, stats);
             root.baseFolder = baseObj;
             root.displayName = getShortDisplayNameForFolderPair(baseObj->getAbstractPath< LEFT_SIDE>(),
                                                                 baseObj->getAbstractPath<RIGHT_SIDE>());
@@ -389,6 +520,9 @@ void TreeView::updateView(Predicate pred)
         }
     }
 
+    //drop numbers of folders that no longer exist, e.g. deleted via context menu or removed after sync: don't keep them until the next comparison
+    eraseIf(folderStats_, [](const auto& item) { return !FileSystemObject::retrieve(item.first); });
+
     lastViewFilterPred_ = pred;
     applySubView(std::move(newView));
 }
@@ -416,7 +550,7 @@ TreeView::NodeStatus TreeView::getStatus(size_t row) const
         {
             case TreeView::TYPE_DIRECTORY:
             case TreeView::TYPE_ROOT:
-                return flatTree_[row].node->firstFileId || !flatTree_[row].node->subDirs.empty() ? TreeView::STATUS_REDUCED : TreeView::STATUS_EMPTY;
+                return flatTree_[row].node->firstFileId || flatTree_[row].node->subDirCount > 0 ? TreeView::STATUS_REDUCED : TreeView::STATUS_EMPTY;
 
             case TreeView::TYPE_FILES:
                 return TreeView::STATUS_EMPTY;
@@ -442,7 +576,7 @@ void TreeView::expandNode(size_t row)
         {
             case TreeView::TYPE_ROOT:
             case TreeView::TYPE_DIRECTORY:
-                getChildren(*flatTree_[row].node, flatTree_[row].level + 1, newLines);
+                getChildren(*flatTree_[row].node, getContainerObject(flatTree_[row]), flatTree_[row].level + 1, newLines);
                 break;
             case TreeView::TYPE_FILES:
                 break;
@@ -499,6 +633,16 @@ void TreeView::updateCmpResult(bool showExcluded,
                                bool equalFilesActive,
                                bool conflictFilesActive)
 {
+    const uint32_t viewFilterId = getViewFilterId(false /*syncPreview*/,
+                                                  showExcluded,
+                                                  leftOnlyFilesActive,
+                                                  rightOnlyFilesActive,
+                                                  leftNewerFilesActive,
+                                                  rightNewerFilesActive,
+                                                  differentFilesActive,
+                                                  equalFilesActive,
+                                                  conflictFilesActive);
+
     updateView([showExcluded, //make sure the predicate can be stored safely!
                               leftOnlyFilesActive,
                               rightOnlyFilesActive,
@@ -531,7 +675,7 @@ void TreeView::updateCmpResult(bool showExcluded,
         }
         assert(false);
         return true;
-    });
+    }, viewFilterId);
 }
 
 
@@ -546,6 +690,18 @@ void TreeView::updateSyncPreview(bool showExcluded,
                                  bool syncEqualActive,
                                  bool conflictFilesActive)
 {
+    const uint32_t viewFilterId = getViewFilterId(true /*syncPreview*/,
+                                                  showExcluded,
+                                                  syncCreateLeftActive,
+                                                  syncCreateRightActive,
+                                                  syncDeleteLeftActive,
+                                                  syncDeleteRightActive,
+                                                  syncDirOverwLeftActive,
+                                                  syncDirOverwRightActive,
+                                                  syncDirNoneActive,
+                                                  syncEqualActive,
+                                                  conflictFilesActive);
+
     updateView([showExcluded, //make sure the predicate can be stored safely!
                               syncCreateLeftActive,
                               syncCreateRightActive,
@@ -589,7 +745,7 @@ void TreeView::updateSyncPreview(bool showExcluded,
         }
         assert(false);
         return true;
-    });
+    }, viewFilterId);
 }
 
 
@@ -597,6 +753,8 @@ void TreeView::setData(FolderComparison& newData)
 {
     std::vector<TreeLine    >().swap(flatTree_);      //free mem
     std::vector<RootNodeImpl>().swap(folderCmpView_); //
+    FolderStatsMap().swap(folderStats_);              //
+    folderStatsFilterId_ = {};
     folderCmp_ = newData;
 
     //remove truly empty folder pairs as early as this: we want to distinguish single/multiple folder pair cases by looking at "folderCmp"
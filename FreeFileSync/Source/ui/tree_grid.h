@@ -8,6 +8,7 @@
 #define TREE_VIEW_H_841703190201835280256673425
 
 #include <functional>
+#include <unordered_map>
 #include <wx+/grid.h>
 #include "tree_grid_attr.h"
 #include "../base/file_hierarchy.h"
@@ -110,6 +111,8 @@ private:
         int itemCountGross  = 0;
         int itemCountNet    = 0; //number of files on view for in this directory only
 
+        int subDirCount = 0; //number of sub directories on view
+        bool subDirsLoaded = false; //subDirs are materialized lazily when the node is expanded
         std::vector<DirNodeImpl> subDirs;
         FileSystemObject::ObjectId firstFileId = nullptr; //weak pointer to first FilePair or SymlinkPair
         //- "compress" algorithm may hide file nodes for directories with a single included file, i.e. itemCountGross == itemCountNet == 1
@@ -139,15 +142,37 @@ private:
     {
         unsigned int level = 0;
         int percent = 0; //[0, 100]
-        const Container* node = nullptr;     //
+        Container* node = nullptr;           //
         NodeType type = NodeType::TYPE_ROOT; //we increase size of "flatTree" using C-style types rather than have a polymorphic "folderCmpView"
     };
 
+    struct FolderStats //numbers of a folder's sub-tree on view: buffered until the sub-tree or the view filter changes
+    {
+        uint64_t changeCount = 0; //ContainerObject::getChangeCount() at the time of evaluation
+        bool included = false; //folder itself matches the view filter
+
+        uint64_t bytesGross = 0;
+        uint64_t bytesNet   = 0;
+        int itemCountGross  = 0; //including the folder itself if "included"
+        int itemCountNet    = 0;
+        int subDirCount     = 0;
+        FileSystemObject::ObjectId firstFileId = nullptr;
+    };
+    using FolderStatsMap = std::unordered_map<FileSystemObject::ObjectIdConst, FolderStats, FileSystemObject::ObjectIdHash>;
+    using FolderStatsList = std::vector<std::pair<FileSystemObject::ObjectIdConst, FolderStats>>;
+
+    template <class Predicate>
+    static FolderStats getSubtreeStats(ContainerObject& hierObj, const Predicate& pred, const FolderStatsMap& statsBuf, FolderStatsList& statsOut);
+    template <class Predicate>
+    static FolderStats getFolderStats(FolderPair& folder, const Predicate& pred, const FolderStatsMap& statsBuf, FolderStatsList& statsOut);
+    template <class Predicate> void updateFolderStatsParallel(const Predicate& pred);
+
+    static void setStats(Container& cont, const FolderStats& stats);
     static void compressNode(Container& cont);
-    template <class Function>
-    static void extractVisibleSubtree(ContainerObject& hierObj, Container& cont, Function includeObject);
-    void getChildren(const Container& cont, unsigned int level, std::vector<TreeLine>& output);
-    template <class Predicate> void updateView(Predicate pred);
+    static ContainerObject* getContainerObject(const TreeLine& line); //returns nullptr if not found
+    void loadSubDirs(Container& cont, ContainerObject& hierObj);
+    void getChildren(Container& cont, ContainerObject* hierObj, unsigned int level, std::vector<TreeLine>& output);
+    template <class Predicate> void updateView(Predicate pred, uint32_t viewFilterId);
     void applySubView(std::vector<RootNodeImpl>&& newView);
 
     template <bool ascending> static void sortSingleLevel(std::vector<TreeLine>& items, ColumnTypeTree columnType);
@@ -159,6 +184,8 @@ private:
                     |                         */
     std::vector<RootNodeImpl> folderCmpView_; //partial view on folderCmp -> unsorted (cannot be, because files are not a separate entity)
     std::function<bool(const FileSystemObject& fsObj)> lastViewFilterPred_; //buffer view filter predicate for lazy evaluation of files/symlinks corresponding to a TYPE_FILES node
+    FolderStatsMap folderStats_; //numbers of *all* folders (not only materialized ones) for the current view filter
+    std::optional<uint32_t> folderStatsFilterId_; //view filter folderStats_ were evaluated for
     /*             /|\
                     | (update...)
                     |                         */
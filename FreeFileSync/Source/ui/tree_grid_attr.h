@@ -9,7 +9,7 @@
 
 #include <vector>
 #include <cassert>
-#include <wx+/dc.h>
+#include <wx+/dpi.h>
 
 
 namespace fff
@@ -0,0 +1,41 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#ifndef DPI_H_7308104618390617423
+#define DPI_H_7308104618390617423
+
+#include <cassert>
+#include <zen/basic_math.h>
+#ifndef ZEN_HEADLESS //no wxWidgets GUI library: e.g. FreeFileSync_Batch needs default window layout settings, but no screen
+    #include <wx/window.h> //for macro: wxHAVE_DPI_INDEPENDENT_PIXELS
+    #include <wx/dcscreen.h>
+#endif
+
+
+namespace zen
+{
+/*
+Standard DPI:
+    Windows/Ubuntu: 96 x 96
+    macOS: wxWidgets uses DIP (note: wxScreenDC().GetPPI() returns 72 x 72 which is a lie; looks like 96 x 96)
+*/
+inline
+int fastFromDIP(int d) //like wxWindow::FromDIP (but tied to primary monitor and buffered)
+{
+#ifdef ZEN_HEADLESS
+    return d;
+#elif defined wxHAVE_DPI_INDEPENDENT_PIXELS
+    return d; //e.g. macOS, GTK3
+#else
+    assert(wxTheApp); //only call after wxWidgets was initalized!
+    static const int dpiY = wxScreenDC().GetPPI().y; //perf: buffering for calls to ::GetDeviceCaps() needed!?
+    const int defaultDpi = 96;
+    return numeric::round(1.0 * d * dpiY / defaultDpi);
+#endif
+}
+}
+
+#endif //DPI_H_7308104618390617423
@@ -11,7 +11,10 @@
 #include <zen/globals.h>
 #include <zen/perf.h>
 #include <zen/thread.h>
-#include <wx/wfstream.h>
+#include <zen/crc.h>
+#include <zen/file_io.h>
+#include <zen/file_access.h>
+#include <zen/scope_guard.h>
 #include <wx/zipstrm.h>
 #include <wx/image.h>
 #include <wx/mstream.h>
@@ -52,12 +55,18 @@ ImageHolder dpiScale(int width, int height, int dpiWidth, int dpiHeight, const u
             *out++ = xbrz::makePixel(*alpha++, rgb[0], rgb[1], rgb[2]);
     }
     //-----------------------------------------------------
-    xbrz::scale(hqScale,       //size_t factor, //valid range: 2 - SCALE_FACTOR_MAX
-                argbSrc,       //const uint32_t* src,
-                xbrTrg,        //uint32_t* trg,
-                width, height, //int srcWidth, int srcHeight,
-                xbrz::ColorFormat::ARGB_UNBUFFERED); //ColorFormat colFmt,
+    xbrz::scaleParallel(hqScale,       //size_t factor, //valid range: 2 - SCALE_FACTOR_MAX
+                        argbSrc,       //const uint32_t* src,
+                        xbrTrg,        //uint32_t* trg,
+                        width, height, //int srcWidth, int srcHeight,
+                        xbrz::ColorFormat::ARGB_UNBUFFERED, //ColorFormat colFmt,
+                        xbrz::ScalerCfg(),                  //const ScalerCfg& cfg,
+                        2);                                 //size_t threadCount
     //test: total xBRZ scaling time with ARGB: 300ms, ARGB_UNBUFFERED: 50ms
+    //small icons are scaled on the current thread; the few large images are split into bands of rows
+    //=> they no longer dominate total time by being the last tasks to finish in DpiParallelScaler
+    //threadCount: we already run inside DpiParallelScaler's one-thread-per-core group => one helper thread per large image
+    //is enough to shorten the tail without oversubscribing the CPU while the group is still busy
     //-----------------------------------------------------
     xbrz::bilinearScale(xbrTrg,               //const uint32_t* src,
                         hqWidth, hqHeight,    //int srcWidth, int srcHeight,
@@ -114,11 +123,11 @@ public:
         threadGroup_->run(getScalerTask(name, img, hqScale_, result_));
     }
 
-    std::map<wxString, wxBitmap> waitAndGetResult()
+    std::map<wxString, wxImage> waitAndGetResult()
     {
         threadGroup_->wait();
 
-        std::map<wxString, wxBitmap> output;
+        std::map<wxString, wxImage> output;
 
         result_.access([&](std::vector<std::pair<std::wstring, ImageHolder>>& r)
         {
@@ -144,6 +153,147 @@ private:
 };
 
 
+//DPI-scaled images persisted across sessions: skip PNG decoding and xBRZ scaling during startup
+//- single file: header + index + raw RGB and alpha data; memory-mapped => only the images actually requested are read
+//- keyed by resource file CRC and DPI scale: an outdated file is replaced with the next scaling result
+struct ImageCacheKey
+{
+    uint32_t resourceCrc = 0;
+    int32_t  dipScale    = 0; //fastFromDIP(1000)
+};
+
+const char IMAGE_CACHE_FILE_ID[] = "FFS_IMG"; //8 bytes including 0-termination
+const int IMAGE_CACHE_FORMAT_VER = 1;
+
+
+class ImageCacheFile
+{
+public:
+    explicit ImageCacheFile(const Zstring& filePath) : file_(filePath) {} //throw FileError
+
+    static std::unique_ptr<ImageCacheFile> load(const Zstring& filePath, const ImageCacheKey& key) //noexcept; nullptr if not existing, outdated or corrupted
+    {
+        try
+        {
+            auto cache = std::make_unique<ImageCacheFile>(filePath); //throw FileError
+            const std::string_view stream = cache->file_.ref();
+            MemoryStreamIn<std::string_view> streamIn(stream);
+
+            char fileId[sizeof(IMAGE_CACHE_FILE_ID)] = {};
+            readArray(streamIn, fileId, sizeof(fileId)); //throw UnexpectedEndOfStreamError
+
+            if (!std::equal(fileId, fileId + sizeof(fileId), IMAGE_CACHE_FILE_ID) ||
+                readNumber<int32_t >(streamIn) != IMAGE_CACHE_FORMAT_VER || //throw UnexpectedEndOfStreamError
+                readNumber<uint32_t>(streamIn) != key.resourceCrc ||        //
+                readNumber<int32_t >(streamIn) != key.dipScale)             //
+                return nullptr;
+
+            const size_t imageCount = readNumber<uint32_t>(streamIn); //throw UnexpectedEndOfStreamError
+            for (size_t i = 0; i < imageCount; ++i)
+            {
+                const std::string imageName = readContainer<std::string>(streamIn); //
+                const int      width   = readNumber<int32_t >(streamIn);            //throw UnexpectedEndOfStreamError
+                const int      height  = readNumber<int32_t >(streamIn);            //
+                const uint64_t dataPos = readNumber<uint64_t>(streamIn);            //
+
+                if (width <= 0 || height <= 0 || width > 4096 || height > 4096 ||
+                    dataPos > stream.size() || stream.size() - dataPos < static_cast<uint64_t>(width) * height * 4)
+                    throw UnexpectedEndOfStreamError(); //data corruption
+
+                cache->images_.emplace(utfTo<wxString>(imageName), CachedImage{ width, height, stream.data() + dataPos });
+            }
+            return cache;
+        }
+        catch (FileError&) {} //not (yet) cached
+        catch (UnexpectedEndOfStreamError&) {} //data corruption => replaced with the next scaling result
+        return nullptr;
+    }
+
+    static void store(const Zstring& filePath, const ImageCacheKey& key, const std::map<wxString, wxImage>& images) //noexcept; caching is best effort only
+    {
+        std::vector<std::pair<std::string, const wxImage*>> imagesUtf8;
+        for (const auto& [imageName, img] : images)
+        {
+            assert(img.HasAlpha()); //see convertToVanillaImage()
+            if (img.HasAlpha())
+                imagesUtf8.emplace_back(utfTo<std::string>(imageName), &img);
+        }
+
+        MemoryStreamOut<std::string> streamOut;
+        writeArray(streamOut, IMAGE_CACHE_FILE_ID, sizeof(IMAGE_CACHE_FILE_ID));
+        writeNumber<int32_t >(streamOut, IMAGE_CACHE_FORMAT_VER);
+        writeNumber<uint32_t>(streamOut, key.resourceCrc);
+        writeNumber<int32_t >(streamOut, key.dipScale);
+        writeNumber<uint32_t>(streamOut, static_cast<uint32_t>(imagesUtf8.size()));
+
+        //write index: data positions can be calculated in advance
+        uint64_t dataPos = streamOut.ref().size();
+        for (const auto& [imageName, img] : imagesUtf8)
+            dataPos += sizeof(uint32_t) + imageName.size() + 2 * sizeof(int32_t) + sizeof(uint64_t);
+
+        for (const auto& [imageName, img] : imagesUtf8)
+        {
+            writeContainer(streamOut, imageName);
+            writeNumber<int32_t >(streamOut, img->GetWidth ());
+            writeNumber<int32_t >(streamOut, img->GetHeight());
+            writeNumber<uint64_t>(streamOut, dataPos);
+            dataPos += static_cast<uint64_t>(img->GetWidth()) * img->GetHeight() * 4;
+        }
+
+        for (const auto& [imageName, img] : imagesUtf8)
+        {
+            writeArray(streamOut, img->GetData (), static_cast<size_t>(img->GetWidth()) * img->GetHeight() * 3);
+            writeArray(streamOut, img->GetAlpha(), static_cast<size_t>(img->GetWidth()) * img->GetHeight());
+        }
+
+        //write to temporary file first: other FreeFileSync instances may have the cache file mapped into memory
+        const Zstring tmpPath = filePath + Zstr('.') + numberTo<Zstring>(getThreadId()) + Zstr(".tmp");
+        try
+        {
+            saveBinContainer(tmpPath, streamOut.ref(), nullptr /*notifyUnbufferedIO*/); //throw FileError
+            ZEN_ON_SCOPE_FAIL(try { removeFilePlain(tmpPath); } catch (FileError&) {});
+            try
+            {
+                renameFile(tmpPath, filePath); //throw FileError, ErrorDifferentVolume, ErrorTargetExisting
+            }
+            catch (ErrorTargetExisting&) //replace outdated cache: existing memory maps remain valid after the file is deleted
+            {
+                removeFilePlain(filePath); //throw FileError
+                renameFile(tmpPath, filePath); //throw FileError, ErrorDifferentVolume, ErrorTargetExisting
+            }
+        }
+        catch (FileError&) {}
+    }
+
+    std::optional<wxImage> getImage(const wxString& name) const
+    {
+        auto it = images_.find(name);
+        if (it == images_.end())
+            return {};
+
+        const auto& [width, height, data] = it->second;
+        const size_t pixelCount = static_cast<size_t>(width) * height;
+
+        wxImage img(width, height, false /*clear*/);
+        img.InitAlpha();
+        std::copy(data, data + pixelCount * 3, img.GetData()); //copy: wxImage wants malloc()-owned memory
+        std::copy(data + pixelCount * 3, data + pixelCount * 4, img.GetAlpha());
+        return img;
+    }
+
+private:
+    struct CachedImage
+    {
+        int width  = 0;
+        int height = 0;
+        const char* data = nullptr; //RGB, followed by alpha; points into file_
+    };
+
+    const MemoryMappedFile file_;
+    std::map<wxString, CachedImage> images_;
+};
+
+
 void loadAnimFromZip(wxZipInputStream& zipInput, wxAnimation& anim)
 {
     //work around wxWidgets bug:
@@ -178,12 +328,13 @@ public:
     GlobalBitmaps() {}
     ~GlobalBitmaps() { assert(bitmaps_.empty() && anims_.empty()); } //don't leave wxWidgets objects for static destruction!
 
-    void init(const Zstring& filePath);
+    void init(const Zstring& zipPath, const Zstring& cacheFilePath);
     void cleanup()
     {
         bitmaps_.clear();
         anims_  .clear();
         dpiScaler_.reset();
+        imageCache_.reset();
     }
 
     const wxBitmap&    getImage    (const wxString& name);
@@ -197,50 +348,70 @@ private:
     std::map<wxString, wxAnimation> anims_;
 
     std::unique_ptr<DpiParallelScaler> dpiScaler_;
+
+    Zstring cacheFilePath_; //optional
+    ImageCacheKey cacheKey_;
+    std::unique_ptr<ImageCacheFile> imageCache_; //DPI-scaled images: converted lazily in getImage()
 };
 
 
-void GlobalBitmaps::init(const Zstring& filePath)
+void GlobalBitmaps::init(const Zstring& zipPath, const Zstring& cacheFilePath)
 {
     assert(bitmaps_.empty() && anims_.empty());
 
-    wxFFileInputStream input(utfTo<wxString>(filePath));
-    if (input.IsOk()) //if not... we don't want to react too harsh here
+    std::string zipStream;
+    try
     {
-        //activate support for .png files
-        wxImage::AddHandler(new wxPNGHandler); //ownership passed
-
-        wxZipInputStream streamIn(input, wxConvUTF8);
-        //do NOT rely on wxConvLocal! On failure shows unhelpful popup "Cannot convert from the charset 'Unknown encoding (-1)'!"
+        zipStream = loadBinContainer<std::string>(zipPath, nullptr /*notifyUnbufferedIO*/); //throw FileError
+    }
+    catch (FileError&) { return; } //if not... we don't want to react too harsh here
 
-        //do we need xBRZ scaling for high quality DPI images?
-        const int hqScale = std::clamp<int>(std::ceil(fastFromDIP(1000) / 1000.0), 1, xbrz::SCALE_FACTOR_MAX);
-        //even for 125% DPI scaling, "2xBRZ + bilinear downscale" gives a better result than mere "125% bilinear upscale"!
-        if (hqScale > 1)
+    //do we need xBRZ scaling for high quality DPI images?
+    const int hqScale = std::clamp<int>(std::ceil(fastFromDIP(1000) / 1000.0), 1, xbrz::SCALE_FACTOR_MAX);
+    //even for 125% DPI scaling, "2xBRZ + bilinear downscale" gives a better result than mere "125% bilinear upscale"!
+    if (hqScale > 1)
+    {
+        if (!cacheFilePath.empty())
+        {
+            cacheFilePath_ = cacheFilePath;
+            cacheKey_ = { getCrc32(zipStream), fastFromDIP(1000) };
+            imageCache_ = ImageCacheFile::load(cacheFilePath_, cacheKey_); //noexcept
+        }
+        if (!imageCache_)
             dpiScaler_ = std::make_unique<DpiParallelScaler>(hqScale);
+    }
+
+    //activate support for .png files
+    wxImage::AddHandler(new wxPNGHandler); //ownership passed
+
+    wxMemoryInputStream input(zipStream.c_str(), zipStream.size()); //stream does not take ownership of data
+    wxZipInputStream streamIn(input, wxConvUTF8);
+    //do NOT rely on wxConvLocal! On failure shows unhelpful popup "Cannot convert from the charset 'Unknown encoding (-1)'!"
 
-        while (const auto& entry = std::unique_ptr<wxZipEntry>(streamIn.GetNextEntry())) //take ownership!)
+    while (const auto& entry = std::unique_ptr<wxZipEntry>(streamIn.GetNextEntry())) //take ownership!)
+    {
+        const wxString name = entry->GetName();
+
+        if (endsWith(name, L".png"))
         {
-            const wxString name = entry->GetName();
+            if (imageCache_) //=> skip PNG decoding: cached image is loaded on first use
+                continue;
 
-            if (endsWith(name, L".png"))
-            {
-                wxImage img(streamIn, wxBITMAP_TYPE_PNG);
+            wxImage img(streamIn, wxBITMAP_TYPE_PNG);
 
-                //end this alpha/no-alpha/mask/wxDC::DrawBitmap/RTL/high-contrast-scheme interoperability nightmare here and now!!!!
-                //=> there's only one type of wxImage: with alpha channel, no mask!!!
-                convertToVanillaImage(img);
+            //end this alpha/no-alpha/mask/wxDC::DrawBitmap/RTL/high-contrast-scheme interoperability nightmare here and now!!!!
+            //=> there's only one type of wxImage: with alpha channel, no mask!!!
+            convertToVanillaImage(img);
 
-                if (dpiScaler_)
-                    dpiScaler_->add(name, img); //scale in parallel!
-                else
-                    bitmaps_.emplace(name, img);
-            }
-            else if (endsWith(name, L".gif"))
-                loadAnimFromZip(streamIn, anims_[name]);
+            if (dpiScaler_)
+                dpiScaler_->add(name, img); //scale in parallel!
             else
-                assert(false);
+                bitmaps_.emplace(name, img);
         }
+        else if (endsWith(name, L".gif"))
+            loadAnimFromZip(streamIn, anims_[name]);
+        else
+            assert(false);
     }
 }
 
@@ -252,13 +423,25 @@ const wxBitmap& GlobalBitmaps::getImage(const wxString& name)
     //debug perf: extra 800-1000ms during startup
     if (dpiScaler_)
     {
-        bitmaps_ = dpiScaler_->waitAndGetResult();
+        const std::map<wxString, wxImage> images = dpiScaler_->waitAndGetResult();
         dpiScaler_.reset();
+
+        if (!cacheFilePath_.empty())
+            ImageCacheFile::store(cacheFilePath_, cacheKey_, images); //noexcept; one-time cost after resource file or DPI scale changed
+
+        for (const auto& [imageName, img] : images)
+            bitmaps_.emplace(imageName, img);
     }
 
-    auto it = bitmaps_.find(contains(name, L'.') ? name : name + L".png"); //assume .png ending if nothing else specified
+    const wxString imageName = contains(name, L'.') ? name : name + L".png"; //assume .png ending if nothing else specified
+
+    auto it = bitmaps_.find(imageName);
     if (it != bitmaps_.end())
         return it->second;
+
+    if (imageCache_)
+        if (std::optional<wxImage> img = imageCache_->getImage(imageName))
+            return bitmaps_.emplace(imageName, *img).first->second;
     assert(false);
     return wxNullBitmap;
 }
@@ -275,10 +458,10 @@ const wxAnimation& GlobalBitmaps::getAnimation(const wxString& name) const
 }
 
 
-void zen::initResourceImages(const Zstring& filepath)
+void zen::initResourceImages(const Zstring& zipPath, const Zstring& cacheFilePath)
 {
     if (std::shared_ptr<GlobalBitmaps> inst = GlobalBitmaps::instance())
-        inst->init(filepath);
+        inst->init(zipPath, cacheFilePath);
     else
         assert(false);
 }
@@ -14,7 +14,8 @@
 
 namespace zen
 {
-void initResourceImages(const Zstring& filePath); //pass resources .zip file at application startup
+void initResourceImages(const Zstring& zipPath, const Zstring& cacheFilePath); //pass resources .zip file at application startup
+//cacheFilePath: optional; persist DPI-scaled images => faster startup
 void cleanupResourceImages();
 
 const wxBitmap&    getResourceImage    (const wxString& name);
@@ -0,0 +1,42 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#include "zstd_wrap.h"
+#include <zstd.h>
+
+using namespace zen;
+
+
+size_t zen::impl::zstd_compressBound(size_t len)
+{
+    return ::ZSTD_compressBound(len); //upper limit for buffer size, larger than input size!!!
+}
+
+
+size_t zen::impl::zstd_compress(const void* src, size_t srcLen, void* trg, size_t trgLen, int level) //throw ZstdInternalError
+{
+    const size_t rv = ::ZSTD_compress(trg,    //void* dst,
+                                      trgLen, //size_t dstCapacity,
+                                      src,    //const void* src,
+                                      srcLen, //size_t srcSize,
+                                      level); //int compressionLevel
+    if (::ZSTD_isError(rv) || rv > trgLen)
+        throw ZstdInternalError();
+    return rv;
+}
+
+
+size_t zen::impl::zstd_decompress(const void* src, size_t srcLen, void* trg, size_t trgLen) //throw ZstdInternalError
+{
+    const size_t rv = ::ZSTD_decompress(trg,     //void* dst,
+                                        trgLen,  //size_t dstCapacity,
+                                        src,     //const void* src,
+                                        srcLen); //size_t compressedSize
+    //fails if input data was corrupted or incomplete or not enough room in the output buffer
+    if (::ZSTD_isError(rv) || rv > trgLen)
+        throw ZstdInternalError();
+    return rv;
+}
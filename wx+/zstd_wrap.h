@@ -0,0 +1,111 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#ifndef ZSTD_WRAP_H_0381720563942081
+#define ZSTD_WRAP_H_0381720563942081
+
+#include <zen/serialize.h>
+
+
+namespace zen
+{
+class ZstdInternalError {};
+
+// compression level must be between 1 and 19 (negative levels: faster, less compression)
+// 3: zstd default
+template <class BinContainer> //as specified in serialize.h
+BinContainer compressZstd(const BinContainer& stream, int level); //throw ZstdInternalError
+//caveat: output stream is physically larger than input! => strip additional reserved space if needed: "BinContainer(output.begin(), output.end())"
+
+template <class BinContainer>
+BinContainer decompressZstd(const BinContainer& stream);          //throw ZstdInternalError
+
+
+
+
+
+
+
+
+
+
+
+//######################## implementation ##########################
+namespace impl
+{
+size_t zstd_compressBound(size_t len);
+size_t zstd_compress  (const void* src, size_t srcLen, void* trg, size_t trgLen, int level); //throw ZstdInternalError
+size_t zstd_decompress(const void* src, size_t srcLen, void* trg, size_t trgLen);            //throw ZstdInternalError
+}
+
+
+template <class BinContainer>
+BinContainer compressZstd(const BinContainer& stream, int level) //throw ZstdInternalError
+{
+    BinContainer contOut;
+    if (!stream.empty()) //don't dereference iterator into empty container!
+    {
+        //save uncompressed stream size for decompression: same layout as zlib_wrap.h
+        const uint64_t uncompressedSize = stream.size(); //use portable number type!
+        contOut.resize(sizeof(uncompressedSize));
+        std::copy(reinterpret_cast<const std::byte*>(&uncompressedSize),
+                  reinterpret_cast<const std::byte*>(&uncompressedSize) + sizeof(uncompressedSize),
+                  &*contOut.begin());
+
+        const size_t bufferEstimate = impl::zstd_compressBound(stream.size()); //upper limit for buffer size, larger than input size!!!
+
+        contOut.resize(contOut.size() + bufferEstimate);
+
+        const size_t bytesWritten = impl::zstd_compress(&*stream.begin(),
+                                                        stream.size(),
+                                                        &*contOut.begin() + contOut.size() - bufferEstimate,
+                                                        bufferEstimate,
+                                                        level); //throw ZstdInternalError
+        if (bytesWritten < bufferEstimate)
+            contOut.resize(contOut.size() - (bufferEstimate - bytesWritten)); //caveat: unsigned arithmetics
+        //caveat: physical memory consumption still *unchanged*!
+    }
+    return contOut;
+}
+
+
+template <class BinContainer>
+BinContainer decompressZstd(const BinContainer& stream) //throw ZstdInternalError
+{
+    BinContainer contOut;
+    if (!stream.empty()) //don't dereference iterator into empty container!
+    {
+        //retrieve size of uncompressed data
+        uint64_t uncompressedSize = 0; //use portable number type!
+        if (stream.size() < sizeof(uncompressedSize))
+            throw ZstdInternalError();
+        std::copy(&*stream.begin(),
+                  &*stream.begin() + sizeof(uncompressedSize),
+                  reinterpret_cast<std::byte*>(&uncompressedSize));
+        if (uncompressedSize == 0) //cannot be 0: compressZstd() directly maps empty -> empty container skipping zstd!
+            throw ZstdInternalError();
+
+        try
+        {
+            contOut.resize(static_cast<size_t>(uncompressedSize)); //throw std::bad_alloc
+        }
+        catch (std::bad_alloc&) //most likely due to data corruption!
+        {
+            throw ZstdInternalError();
+        }
+
+        const size_t bytesWritten = impl::zstd_decompress(&*stream.begin() + sizeof(uncompressedSize),
+                                                          stream.size() - sizeof(uncompressedSize),
+                                                          &*contOut.begin(),
+                                                          static_cast<size_t>(uncompressedSize)); //throw ZstdInternalError
+        if (bytesWritten != static_cast<size_t>(uncompressedSize))
+            throw ZstdInternalError();
+    }
+    return contOut;
+}
+}
+
+#endif //ZSTD_WRAP_H_0381720563942081
@@ -19,8 +19,15 @@
 #include <vector>
 #include <algorithm>
 #include <cmath> //std::sqrt
+#include <atomic>
+#include <thread>
+#include <system_error>
 #include "xbrz_tools.h"
 
+#ifdef __SSE2__
+    #include <emmintrin.h>
+#endif
+
 using namespace xbrz;
 
 
@@ -50,6 +57,28 @@ uint32_t gradientARGB(uint32_t pixFront, uint32_t pixBack) //find intermediate c
     if (weightSum == 0)
         return 0;
 
+#ifdef __SSE2__
+    //perf: weighted average of all channels at once; numerators are < 2^26 => double division + truncation is exact, same result as integer division
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i front = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(static_cast<int>(pixFront)), zero), zero); //B, G, R, A as int32
+    const __m128i back  = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(static_cast<int>(pixBack )), zero), zero); //
+
+    const __m128d wFront = _mm_set1_pd(weightFront);
+    const __m128d wBack  = _mm_set1_pd(weightBack);
+    const __m128d wSum   = _mm_set1_pd(weightSum);
+
+    auto calcColors = [&](__m128i colFront, __m128i colBack) //two channels per call
+    {
+        return _mm_cvttpd_epi32(_mm_div_pd(_mm_add_pd(_mm_mul_pd(_mm_cvtepi32_pd(colFront), wFront),
+                                                      _mm_mul_pd(_mm_cvtepi32_pd(colBack ), wBack)), wSum));
+    };
+    const __m128i colBG = calcColors(front, back);
+    const __m128i colRA = calcColors(_mm_srli_si128(front, 8), _mm_srli_si128(back, 8));
+
+    const __m128i col = _mm_packus_epi16(_mm_packs_epi32(_mm_unpacklo_epi64(colBG, colRA), zero), zero);
+
+    return (static_cast<uint32_t>(_mm_cvtsi128_si32(col)) & 0xffffff) | ((weightSum / N) << 24);
+#else
     auto calcColor = [=](unsigned char colFront, unsigned char colBack)
     {
         return static_cast<unsigned char>((colFront * weightFront + colBack * weightBack) / weightSum);
@@ -59,6 +88,7 @@ uint32_t gradientARGB(uint32_t pixFront, uint32_t pixBack) //find intermediate c
                      calcColor(getRed  (pixFront), getRed  (pixBack)),
                      calcColor(getGreen(pixFront), getGreen(pixBack)),
                      calcColor(getBlue (pixFront), getBlue (pixBack)));
+#endif
 }
 
 
@@ -280,10 +310,14 @@ BlendResult preProcessCorners(const Kernel_4x4& ker, const xbrz::ScalerCfg& cfg)
          ker.g == ker.k))
         return result;
 
-    auto dist = [&](uint32_t pix1, uint32_t pix2) { return ColorDistance::dist(pix1, pix2, cfg.luminanceWeight); };
+    //evaluate all color distances in one go => SIMD-friendly
+    const uint32_t pix1[] = { ker.i, ker.f, ker.n, ker.k, ker.j, /**/ ker.e, ker.j, ker.b, ker.g, ker.f };
+    const uint32_t pix2[] = { ker.f, ker.c, ker.k, ker.h, ker.g, /**/ ker.j, ker.o, ker.g, ker.l, ker.k };
+    double d[std::size(pix1)];
+    ColorDistance::distBatch(pix1, pix2, d, cfg.luminanceWeight);
 
-    double jg = dist(ker.i, ker.f) + dist(ker.f, ker.c) + dist(ker.n, ker.k) + dist(ker.k, ker.h) + cfg.centerDirectionBias * dist(ker.j, ker.g);
-    double fk = dist(ker.e, ker.j) + dist(ker.j, ker.o) + dist(ker.b, ker.g) + dist(ker.g, ker.l) + cfg.centerDirectionBias * dist(ker.f, ker.k);
+    double jg = d[0] + d[1] + d[2] + d[3] + cfg.centerDirectionBias * d[4];
+    double fk = d[5] + d[6] + d[7] + d[8] + cfg.centerDirectionBias * d[9];
 
     if (jg < fk) //test sample: 70% of values max(jg, fk) / min(jg, fk) are between 1.1 and 3.7 with median being 1.8
     {
@@ -988,7 +1022,19 @@ struct Scaler6x : public ColorGradient
 
 //------------------------------------------------------------------------------------
 
-struct ColorDistanceRGB
+template <class ColorDistance>
+struct DistBatchScalar //color distance policy: evaluate "N" color distances at once
+{
+    template <size_t N>
+    static void distBatch(const uint32_t (&pix1)[N], const uint32_t (&pix2)[N], double (&dist)[N], double luminanceWeight)
+    {
+        for (size_t i = 0; i < N; ++i)
+            dist[i] = ColorDistance::dist(pix1[i], pix2[i], luminanceWeight);
+    }
+};
+
+
+struct ColorDistanceRGB : public DistBatchScalar<ColorDistanceRGB>
 {
     static double dist(uint32_t pix1, uint32_t pix2, double luminanceWeight)
     {
@@ -1000,7 +1046,7 @@ struct ColorDistanceRGB
     }
 };
 
-struct ColorDistanceARGB
+struct ColorDistanceARGB : public DistBatchScalar<ColorDistanceARGB> //distYCbCrBuffered() is a table lookup => nothing to gain from SIMD
 {
     static double dist(uint32_t pix1, uint32_t pix2, double luminanceWeight)
     {
@@ -1027,7 +1073,7 @@ struct ColorDistanceARGB
 };
 
 
-struct ColorDistanceUnbufferedARGB
+struct ColorDistanceUnbufferedARGB : public DistBatchScalar<ColorDistanceUnbufferedARGB>
 {
     static double dist(uint32_t pix1, uint32_t pix2, double luminanceWeight)
     {
@@ -1040,6 +1086,59 @@ struct ColorDistanceUnbufferedARGB
         else
             return a2 * d + 255 * (a1 - a2);
     }
+
+#ifdef __SSE2__
+    //perf: two color distances per iteration; same operations in the same order as dist() => bit-identical results
+    template <size_t N>
+    static void distBatch(const uint32_t (&pix1)[N], const uint32_t (&pix2)[N], double (&dist)[N], double luminanceWeight)
+    {
+        static_assert(N % 2 == 0);
+
+        const double k_b = 0.0593; //ITU-R BT.2020 conversion
+        const double k_r = 0.2627; //
+        const double k_g = 1 - k_b - k_r;
+
+        const double scale_b = 0.5 / (1 - k_b);
+        const double scale_r = 0.5 / (1 - k_r);
+
+        const __m128i byteMask = _mm_set1_epi32(0xff);
+
+        for (size_t i = 0; i < N; i += 2)
+        {
+            const __m128i p1 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(pix1 + i));
+            const __m128i p2 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(pix2 + i));
+
+            auto getDiff = [&](int shift) //int subtraction first, like distYCbCr()
+            {
+                return _mm_cvtepi32_pd(_mm_sub_epi32(_mm_and_si128(_mm_srli_epi32(p1, shift), byteMask),
+                                                     _mm_and_si128(_mm_srli_epi32(p2, shift), byteMask)));
+            };
+            const __m128d r_diff = getDiff(16);
+            const __m128d g_diff = getDiff(8);
+            const __m128d b_diff = getDiff(0);
+
+            const __m128d y   = _mm_add_pd(_mm_add_pd(_mm_mul_pd(_mm_set1_pd(k_r), r_diff),
+                                                      _mm_mul_pd(_mm_set1_pd(k_g), g_diff)),
+                                           /**/       _mm_mul_pd(_mm_set1_pd(k_b), b_diff));
+            const __m128d c_b = _mm_mul_pd(_mm_set1_pd(scale_b), _mm_sub_pd(b_diff, y));
+            const __m128d c_r = _mm_mul_pd(_mm_set1_pd(scale_r), _mm_sub_pd(r_diff, y));
+
+            const __m128d y_w = _mm_mul_pd(_mm_set1_pd(luminanceWeight), y);
+            const __m128d d = _mm_sqrt_pd(_mm_add_pd(_mm_add_pd(_mm_mul_pd(y_w, y_w),
+                                                                _mm_mul_pd(c_b, c_b)),
+                                                     /**/       _mm_mul_pd(c_r, c_r)));
+
+            const __m128d a1 = _mm_div_pd(_mm_cvtepi32_pd(_mm_srli_epi32(p1, 24)), _mm_set1_pd(255.0));
+            const __m128d a2 = _mm_div_pd(_mm_cvtepi32_pd(_mm_srli_epi32(p2, 24)), _mm_set1_pd(255.0));
+
+            const __m128d aMin = _mm_min_pd(a1, a2);
+            const __m128d aMax = _mm_max_pd(a1, a2);
+
+            _mm_storeu_pd(dist + i, _mm_add_pd(_mm_mul_pd(aMin, d),
+                                               _mm_mul_pd(_mm_set1_pd(255), _mm_sub_pd(aMax, aMin))));
+        }
+    }
+#endif
 };
 
 
@@ -1126,6 +1225,45 @@ void xbrz::scale(size_t factor, const uint32_t* src, uint32_t* trg, int srcWidth
 }
 
 
+void xbrz::scaleParallel(size_t factor, const uint32_t* src, uint32_t* trg, int srcWidth, int srcHeight, ColorFormat colFmt, const xbrz::ScalerCfg& cfg, size_t threadCount)
+{
+    //each band re-evaluates the preprocessing of the row above and reads two rows below (= border overlap)
+    //=> small bands waste time on the redundant work; 16 rows are a good compromise for scaling icons
+    const int bandHeight = 16;
+    const int bandCount = srcHeight > 0 ? (srcHeight + bandHeight - 1) / bandHeight : 0;
+    const int minBandsPerThread = 4; //don't start a thread for less work than the thread creation costs
+
+    if (threadCount == 0)
+        threadCount = std::max<size_t>(std::thread::hardware_concurrency(), 1); //hardware_concurrency() == 0 if "not computable or well defined"
+    threadCount = std::min<size_t>(threadCount, bandCount / minBandsPerThread);
+
+    if (threadCount <= 1)
+        return scale(factor, src, trg, srcWidth, srcHeight, colFmt, cfg, 0, srcHeight);
+
+    std::atomic<int> nextBand{0};
+
+    auto processBands = [&] //THREAD-SAFETY: bands do not overlap, see scale()
+    {
+        for (int band = nextBand++; band < bandCount; band = nextBand++)
+            scale(factor, src, trg, srcWidth, srcHeight, colFmt, cfg, band * bandHeight, std::min((band + 1) * bandHeight, srcHeight));
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(threadCount - 1); //calling thread is a worker, too
+    try
+    {
+        for (size_t i = 0; i < threadCount - 1; ++i)
+            workers.emplace_back(processBands);
+    }
+    catch (const std::system_error&) {} //out of threads? => the remaining bands are processed by the others
+
+    processBands();
+
+    for (std::thread& worker : workers)
+        worker.join();
+}
+
+
 bool xbrz::equalColorTest(uint32_t col1, uint32_t col2, ColorFormat colFmt, double luminanceWeight, double equalColorTolerance)
 {
     switch (colFmt)
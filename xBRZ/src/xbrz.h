@@ -66,6 +66,17 @@ void scale(size_t factor, //valid range: 2 - SCALE_FACTOR_MAX
            const ScalerCfg& cfg = ScalerCfg(),
            int yFirst = 0, int yLast = std::numeric_limits<int>::max()); //slice of source image
 
+/*
+-> like scale(), but split the image into bands of rows which are processed by a pool of worker threads
+-> threadCount == 0: use one thread per CPU core; small images (less than about 128 rows) are scaled on the calling thread only
+-> when called from an already busy thread pool, pass a small threadCount (e.g. 2) to avoid oversubscribing the CPU
+*/
+void scaleParallel(size_t factor, //valid range: 2 - SCALE_FACTOR_MAX
+                   const uint32_t* src, uint32_t* trg, int srcWidth, int srcHeight,
+                   ColorFormat colFmt,
+                   const ScalerCfg& cfg = ScalerCfg(),
+                   size_t threadCount = 0);
+
 void bilinearScale(const uint32_t* src, int srcWidth, int srcHeight,
                    /**/  uint32_t* trg, int trgWidth, int trgHeight);
 
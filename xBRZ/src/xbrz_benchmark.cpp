@@ -0,0 +1,144 @@
+// ****************************************************************************
+// * This file is part of the xBRZ project. It is distributed under           *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0         *
+// * Copyright (C) Zenju (zenju AT gmx DOT de) - All Rights Reserved          *
+// *                                                                          *
+// * Additionally and as a special exception, the author gives permission     *
+// * to link the code of this program with the following libraries            *
+// * (or with modified versions that use the same licenses), and distribute   *
+// * linked combinations including the two: MAME, FreeFileSync, Snes9x, ePSXe *
+// * You must obey the GNU General Public License in all respects for all of  *
+// * the code used other than MAME, FreeFileSync, Snes9x, ePSXe.              *
+// * If you modify this file, you may extend this exception to your version   *
+// * of the file, but you are not obligated to do so. If you do not wish to   *
+// * do so, delete this exception statement from your version.                *
+// ****************************************************************************
+
+/*
+Standalone benchmark: scale() vs scaleParallel() for each ColorFormat and scale factor
+
+- input: synthetic pixel-art image (random color blocks, diagonal lines, varying alpha) => all rule paths are exercised
+- output of both functions is compared: bands must not change the result
+- usage: xbrz_benchmark [width] [height] [runs] [threads]     (threads == 0: one per CPU core)
+- build + run: make benchmark_xbrz (FreeFileSync/Source/Makefile)
+*/
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <vector>
+#include "xbrz.h"
+#include "xbrz_tools.h"
+
+
+namespace
+{
+std::vector<uint32_t> createTestImage(int width, int height)
+{
+    std::vector<uint32_t> img(static_cast<size_t>(width) * height);
+
+    uint32_t rnd = 123456789; //xorshift: reproducible without <random> overhead
+    auto nextRandom = [&]
+    {
+        rnd ^= rnd << 13;
+        rnd ^= rnd >> 17;
+        rnd ^= rnd << 5;
+        return rnd;
+    };
+
+    const int blockSize = 4;
+    for (int y = 0; y < height; y += blockSize)
+        for (int x = 0; x < width; x += blockSize)
+        {
+            const uint32_t r = nextRandom();
+            const unsigned char a = (r & 0x7) == 0 ? 0 : (r & 0x7) == 1 ? 0x80 : 0xff;
+            const uint32_t col = xbrz::makePixel(a, (r >> 8) & 0xe0, (r >> 16) & 0xe0, (r >> 24) & 0xe0); //few distinct colors => many equal neighbors
+
+            for (int yy = y; yy < std::min(y + blockSize, height); ++yy)
+                for (int xx = x; xx < std::min(x + blockSize, width); ++xx)
+                    img[static_cast<size_t>(yy) * width + xx] = col;
+        }
+
+    for (int i = 0; i < width + height; i += 7) //diagonal lines
+        for (int k = 0; k < std::min(width, height); ++k)
+            if (const int x = i - height + k; 0 <= x && x < width)
+                img[static_cast<size_t>(k) * width + x] = xbrz::makePixel(0xff, 0, 0, 0);
+
+    return img;
+}
+
+
+template <class Function>
+double getBestTimeMs(int runs, Function fun)
+{
+    fun(); //warm-up: exclude the one-time buffer creation of RGB/ARGB and first-touch page faults
+
+    double bestMs = std::numeric_limits<double>::max();
+    for (int i = 0; i < runs; ++i)
+    {
+        const auto startTime = std::chrono::steady_clock::now();
+        fun();
+        bestMs = std::min(bestMs, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count());
+    }
+    return bestMs;
+}
+}
+
+
+int main(int argc, char* argv[])
+{
+    const int    width       = argc > 1 ? std::atoi(argv[1]) : 512;
+    const int    height      = argc > 2 ? std::atoi(argv[2]) : 512;
+    const int    runs        = argc > 3 ? std::atoi(argv[3]) : 5;
+    const size_t threadCount = argc > 4 ? std::strtoul(argv[4], nullptr, 10) : 0;
+
+    if (width <= 0 || height <= 0 || runs <= 0)
+    {
+        std::cerr << "Usage: xbrz_benchmark [width] [height] [runs] [threads]\n";
+        return EXIT_FAILURE;
+    }
+
+    const std::vector<uint32_t> src = createTestImage(width, height);
+
+    std::cout << "Image: " << width << "x" << height << ", " << runs << " runs, threads: ";
+    if (threadCount == 0)
+        std::cout << "auto";
+    else
+        std::cout << threadCount;
+    std::cout << "\n\nformat\t\tfactor\tscale [ms]\tscaleParallel [ms]\tspeedup\n";
+
+    const std::pair<xbrz::ColorFormat, const char*> formats[] =
+    {
+        { xbrz::ColorFormat::RGB,             "RGB\t\t" },
+        { xbrz::ColorFormat::ARGB,            "ARGB\t\t" },
+        { xbrz::ColorFormat::ARGB_UNBUFFERED, "ARGB_UNBUFFERED\t" },
+    };
+
+    bool resultsEqual = true;
+
+    for (const auto& [colFmt, fmtName] : formats)
+        for (size_t factor = 2; factor <= xbrz::SCALE_FACTOR_MAX; ++factor)
+        {
+            std::vector<uint32_t> trgSerial  (src.size() * factor * factor);
+            std::vector<uint32_t> trgParallel(src.size() * factor * factor);
+
+            const double serialMs = getBestTimeMs(runs, [&]
+            {
+                xbrz::scale(factor, src.data(), trgSerial.data(), width, height, colFmt);
+            });
+
+            const double parallelMs = getBestTimeMs(runs, [&]
+            {
+                xbrz::scaleParallel(factor, src.data(), trgParallel.data(), width, height, colFmt, xbrz::ScalerCfg(), threadCount);
+            });
+
+            const bool equal = trgSerial == trgParallel;
+            resultsEqual = resultsEqual && equal;
+
+            std::cout << fmtName << factor << "\t" << serialMs << "\t\t" << parallelMs << "\t\t\t" << serialMs / parallelMs << "x" <<
+                      (equal ? "" : "\t[!] result differs") << "\n";
+        }
+
+    return resultsEqual ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -9,10 +9,14 @@
 
 #include <cassert>
 #include <algorithm>
+#include <array>
+#include <cstdio>
+#include <memory>
 #include <vector>
 #include <string>
 #include "time.h"
 #include "i18n.h"
+#include "utf.h"
 #include "zstring.h"
 
 
@@ -30,12 +34,16 @@ struct LogEntry
 {
     time_t      time = 0;
     MessageType type = MSG_TYPE_FATAL_ERROR;
-    Zstringw    message; //std::wstring may employ small string optimization: we cannot accept bloating the "ErrorLog::entries" memory block below (think 1 million items)
+    Zstringw    message; //std::wstring may employ small string optimization: we cannot accept bloating the "ErrorLog::tail_" memory block below (think 1 million items)
 };
 
 std::wstring formatMessage(const LogEntry& entry);
 
 
+//memory-bounded log: only the most recent entries are held as LogEntry, older ones are encoded block-wise
+//(prefix-compressed against the preceding message => "Creating file" templates and shared parent paths are stored once)
+//and spilled to an anonymous temporary file; if the file is not available, encoded blocks stay in memory
+//THREAD-SAFETY: const member functions update a block cache => do not share between threads!
 class ErrorLog
 {
 public:
@@ -43,14 +51,75 @@ public:
 
     int getItemCount(int typeFilter = MSG_TYPE_INFO | MSG_TYPE_WARNING | MSG_TYPE_ERROR | MSG_TYPE_FATAL_ERROR) const;
 
-    //subset of std::vector<> interface:
-    using const_iterator = std::vector<LogEntry>::const_iterator;
-    const_iterator begin() const { return entries_.begin(); }
-    const_iterator end  () const { return entries_.end  (); }
-    bool           empty() const { return entries_.empty(); }
+    size_t size () const { return blocks_.size() * BLOCK_SIZE + tail_.size(); }
+    bool   empty() const { return size() == 0; }
+
+    LogEntry getEntry(size_t index) const; //spilled entries are read back block-wise: sequential access is cheap
+
+    //stream all entries matching "typeFilter" in order; spilled blocks without matching entries are skipped without reading them
+    template <class Function> //void(size_t index, const LogEntry& entry)
+    void visitEntries(int typeFilter, Function onEntry) const; //throw X
+
+    class const_iterator //input iterator: yields entries by value
+    {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = LogEntry;
+        using difference_type = ptrdiff_t;
+        using pointer   = const LogEntry*;
+        using reference = LogEntry;
+
+        const_iterator(const ErrorLog& log, size_t index) : log_(&log), index_(index) {}
+        const_iterator& operator++() { ++index_; return *this; }
+        inline friend bool operator==(const const_iterator& lhs, const const_iterator& rhs) { return lhs.index_ == rhs.index_; }
+        inline friend bool operator!=(const const_iterator& lhs, const const_iterator& rhs) { return !(lhs == rhs); }
+        LogEntry operator*() const { return log_->getEntry(index_); }
+    private:
+        const ErrorLog* log_;
+        size_t index_;
+    };
+
+    const_iterator begin() const { return { *this, 0      }; }
+    const_iterator end  () const { return { *this, size() }; }
 
 private:
-    std::vector<LogEntry> entries_;
+    static constexpr size_t BLOCK_SIZE    = 1024;           //entries per spilled block
+    static constexpr size_t TAIL_SIZE_MAX = 2 * BLOCK_SIZE; //entries held as LogEntry
+
+    struct SpilledBlock
+    {
+        std::string encoded; //empty if written to segment file
+        uint64_t fileOffset = 0;
+        size_t   byteCount  = 0;
+        int      typeMask   = 0; //MessageType of all entries in block
+    };
+
+    struct CachedBlock
+    {
+        size_t blockIdx = 0;
+        std::vector<LogEntry> entries; //empty if not in use
+    };
+
+    struct FileCloser { void operator()(std::FILE* f) const { std::fclose(f); } };
+
+    void spillBlock();
+    std::vector<LogEntry> loadBlock(size_t blockIdx) const;
+    const std::vector<LogEntry>& getCachedBlock(size_t blockIdx) const;
+
+    static size_t getTypeIdx(MessageType type);
+    static std::string           encodeBlock(std::vector<LogEntry>::const_iterator first, std::vector<LogEntry>::const_iterator last);
+    static std::vector<LogEntry> decodeBlock(const std::string& buf);
+
+    std::vector<LogEntry> tail_;
+    std::vector<SpilledBlock> blocks_; //entries [0, blocks_.size() * BLOCK_SIZE)
+    std::unique_ptr<std::FILE, FileCloser> segmentFile_; //deleted automatically when closed
+    uint64_t segmentSize_ = 0;
+    bool segmentFailed_ = false;
+
+    std::array<int, 4> typeCounts_{}; //see getTypeIdx()
+
+    mutable std::array<CachedBlock, 2> blockCache_; //support alternating access, e.g. rendering rows across a block boundary
+    mutable size_t blockCacheNext_ = 0;
 };
 
 
@@ -65,14 +134,231 @@ private:
 inline
 void ErrorLog::logMsg(const std::wstring& msg, MessageType type)
 {
-    entries_.push_back({ std::time(nullptr), type, copyStringTo<Zstringw>(msg) });
+    tail_.push_back({ std::time(nullptr), type, copyStringTo<Zstringw>(msg) });
+    ++typeCounts_[getTypeIdx(type)];
+
+    if (tail_.size() >= TAIL_SIZE_MAX)
+        spillBlock();
 }
 
 
 inline
 int ErrorLog::getItemCount(int typeFilter) const
 {
-    return static_cast<int>(std::count_if(entries_.begin(), entries_.end(), [&](const LogEntry& e) { return e.type & typeFilter; }));
+    int count = 0;
+    for (const MessageType type : { MSG_TYPE_INFO, MSG_TYPE_WARNING, MSG_TYPE_ERROR, MSG_TYPE_FATAL_ERROR })
+        if (type & typeFilter)
+            count += typeCounts_[getTypeIdx(type)];
+    return count;
+}
+
+
+inline
+LogEntry ErrorLog::getEntry(size_t index) const
+{
+    const size_t spilledCount = blocks_.size() * BLOCK_SIZE;
+    if (index >= spilledCount)
+    {
+        assert(index - spilledCount < tail_.size());
+        return tail_[index - spilledCount];
+    }
+    return getCachedBlock(index / BLOCK_SIZE)[index % BLOCK_SIZE];
+}
+
+
+template <class Function> inline
+void ErrorLog::visitEntries(int typeFilter, Function onEntry) const //throw X
+{
+    for (size_t blockIdx = 0; blockIdx < blocks_.size(); ++blockIdx)
+        if (blocks_[blockIdx].typeMask & typeFilter)
+        {
+            const std::vector<LogEntry> entries = loadBlock(blockIdx); //don't reference block cache: onEntry() may call getEntry()
+            for (size_t i = 0; i < entries.size(); ++i)
+                if (entries[i].type & typeFilter)
+                    onEntry(blockIdx * BLOCK_SIZE + i, entries[i]); //throw X
+        }
+
+    const size_t spilledCount = blocks_.size() * BLOCK_SIZE;
+    for (size_t i = 0; i < tail_.size(); ++i)
+        if (tail_[i].type & typeFilter)
+            onEntry(spilledCount + i, tail_[i]); //throw X
+}
+
+
+inline
+size_t ErrorLog::getTypeIdx(MessageType type)
+{
+    switch (type)
+    {
+        case MSG_TYPE_INFO:
+            return 0;
+        case MSG_TYPE_WARNING:
+            return 1;
+        case MSG_TYPE_ERROR:
+            return 2;
+        case MSG_TYPE_FATAL_ERROR:
+            return 3;
+    }
+    assert(false);
+    return 3;
+}
+
+
+inline
+void ErrorLog::spillBlock()
+{
+    assert(tail_.size() >= BLOCK_SIZE);
+    SpilledBlock block;
+    block.encoded = encodeBlock(tail_.begin(), tail_.begin() + BLOCK_SIZE);
+    for (auto it = tail_.begin(); it != tail_.begin() + BLOCK_SIZE; ++it)
+        block.typeMask |= it->type;
+
+    if (!segmentFile_ && !segmentFailed_)
+    {
+        segmentFile_.reset(std::tmpfile()); //file is unlinked already => no cleanup required, not even after crash
+        segmentFailed_ = !segmentFile_;
+    }
+
+    if (segmentFile_ &&
+        std::fseek(segmentFile_.get(), static_cast<long>(segmentSize_), SEEK_SET) == 0 &&
+        std::fwrite(block.encoded.data(), 1, block.encoded.size(), segmentFile_.get()) == block.encoded.size())
+    {
+        block.fileOffset = segmentSize_;
+        block.byteCount  = block.encoded.size();
+        segmentSize_ += block.byteCount;
+        block.encoded = std::string(); //release memory
+    }
+    //else: keep encoded block in memory: still much smaller than LogEntry
+
+    blocks_.push_back(std::move(block));
+    tail_.erase(tail_.begin(), tail_.begin() + BLOCK_SIZE);
+}
+
+
+inline
+std::vector<LogEntry> ErrorLog::loadBlock(size_t blockIdx) const
+{
+    const SpilledBlock& block = blocks_[blockIdx];
+    if (!block.encoded.empty())
+        return decodeBlock(block.encoded);
+
+    std::string buf(block.byteCount, '\0');
+    if (std::fseek(segmentFile_.get(), static_cast<long>(block.fileOffset), SEEK_SET) != 0 ||
+        std::fread(&buf[0], 1, buf.size(), segmentFile_.get()) != buf.size())
+        buf.clear(); //=> decodeBlock() returns default entries
+
+    return decodeBlock(buf);
+}
+
+
+inline
+const std::vector<LogEntry>& ErrorLog::getCachedBlock(size_t blockIdx) const
+{
+    for (const CachedBlock& cb : blockCache_)
+        if (cb.blockIdx == blockIdx && !cb.entries.empty())
+            return cb.entries;
+
+    CachedBlock& cb = blockCache_[blockCacheNext_];
+    blockCacheNext_ = (blockCacheNext_ + 1) % blockCache_.size();
+
+    cb.blockIdx = blockIdx;
+    cb.entries  = loadBlock(blockIdx);
+    return cb.entries;
+}
+
+
+namespace impl
+{
+inline
+void writeVarInt(std::string& buf, uint64_t num)
+{
+    while (num >= 0x80)
+    {
+        buf += static_cast<char>((num & 0x7f) | 0x80);
+        num >>= 7;
+    }
+    buf += static_cast<char>(num);
+}
+
+
+inline
+uint64_t readVarInt(const std::string& buf, size_t& pos) //caller must check pos <= buf.size()
+{
+    uint64_t num = 0;
+    for (int shift = 0; pos < buf.size() && shift < 64; shift += 7)
+    {
+        const unsigned char b = buf[pos++];
+        num |= static_cast<uint64_t>(b & 0x7f) << shift;
+        if (!(b & 0x80))
+            break;
+    }
+    return num;
+}
+}
+
+
+//per entry: type | zigzag time delta | shared prefix length (UTF-8 bytes) | suffix length | suffix
+inline
+std::string ErrorLog::encodeBlock(std::vector<LogEntry>::const_iterator first, std::vector<LogEntry>::const_iterator last)
+{
+    std::string buf;
+    std::string prevMsg;
+    int64_t prevTime = 0;
+
+    for (auto it = first; it != last; ++it)
+    {
+        std::string msg = utfTo<std::string>(it->message);
+        const size_t prefixLen = std::mismatch(prevMsg.begin(), prevMsg.end(), msg.begin(), msg.end()).first - prevMsg.begin();
+
+        const int64_t timeDelta = static_cast<int64_t>(it->time) - prevTime;
+
+        buf += static_cast<char>(it->type);
+        impl::writeVarInt(buf, (static_cast<uint64_t>(timeDelta) << 1) ^ static_cast<uint64_t>(timeDelta >> 63));
+        impl::writeVarInt(buf, prefixLen);
+        impl::writeVarInt(buf, msg.size() - prefixLen);
+        buf.append(msg, prefixLen, std::string::npos);
+
+        prevMsg  = std::move(msg);
+        prevTime = it->time;
+    }
+    return buf;
+}
+
+
+inline
+std::vector<LogEntry> ErrorLog::decodeBlock(const std::string& buf)
+{
+    std::vector<LogEntry> entries;
+    entries.reserve(BLOCK_SIZE);
+
+    std::string msg;
+    int64_t prevTime = 0;
+
+    for (size_t pos = 0; pos < buf.size() && entries.size() < BLOCK_SIZE;)
+    {
+        const auto type = static_cast<MessageType>(static_cast<unsigned char>(buf[pos++]));
+        const uint64_t timeZigZag = impl::readVarInt(buf, pos);
+        const uint64_t prefixLen  = impl::readVarInt(buf, pos);
+        const uint64_t suffixLen  = impl::readVarInt(buf, pos);
+
+        if (prefixLen > msg.size() || suffixLen > buf.size() - pos) //data corruption
+            break;
+
+        const bool sameMessage = prefixLen == msg.size() && suffixLen == 0;
+
+        msg.resize(static_cast<size_t>(prefixLen));
+        msg.append(buf, pos, static_cast<size_t>(suffixLen));
+        pos += static_cast<size_t>(suffixLen);
+
+        prevTime += static_cast<int64_t>(timeZigZag >> 1) ^ -static_cast<int64_t>(timeZigZag & 1);
+
+        //repeated messages share one (ref-counted) string
+        entries.push_back({ static_cast<time_t>(prevTime), type, sameMessage && !entries.empty() ? entries.back().message : utfTo<Zstringw>(msg) });
+    }
+
+    assert(entries.size() == BLOCK_SIZE);
+    entries.resize(BLOCK_SIZE); //corrupted data: don't break indexing
+    return entries;
 }
 
 
@@ -8,6 +8,7 @@
 #include "file_access.h"
 
     #include <sys/stat.h>
+    #include <sys/mman.h> //mmap
     #include <fcntl.h>  //open
     #include <unistd.h> //close, read, write
 
@@ -313,3 +314,34 @@ void FileOutput::preAllocateSpaceBestEffort(uint64_t expectedSize) //throw FileE
         return; //may fail with EOPNOTSUPP, unlike posix_fallocate
 
 }
+
+//----------------------------------------------------------------------------------------------------
+
+MemoryMappedFile::MemoryMappedFile(const Zstring& filePath) //throw FileError
+{
+    const int fdFile = ::open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fdFile == -1)
+        THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot open file %x."), L"%x", fmtPath(filePath)), L"open");
+    ZEN_ON_SCOPE_EXIT(::close(fdFile)); //mapping remains valid after close()
+
+    struct ::stat fileInfo = {};
+    if (::fstat(fdFile, &fileInfo) != 0)
+        THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot read file attributes of %x."), L"%x", fmtPath(filePath)), L"fstat");
+
+    if (fileInfo.st_size > 0)
+    {
+        void* view = ::mmap(nullptr, fileInfo.st_size, PROT_READ, MAP_PRIVATE, fdFile, 0);
+        if (view == MAP_FAILED)
+            THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(filePath)), L"mmap");
+
+        view_ = static_cast<const char*>(view);
+        size_ = fileInfo.st_size;
+    }
+}
+
+
+MemoryMappedFile::~MemoryMappedFile()
+{
+    if (view_)
+        ::munmap(const_cast<char*>(view_), size_);
+}
@@ -100,6 +100,23 @@ private:
     size_t bufPosEnd_ = 0;
 };
 
+
+class MemoryMappedFile //read-only: the OS loads pages on first access only
+{
+public:
+    explicit MemoryMappedFile(const Zstring& filePath); //throw FileError
+    ~MemoryMappedFile();
+
+    std::string_view ref() const { return { view_, size_ }; } //CAVEAT: file must not be truncated while mapped => replace via rename only!
+
+private:
+    MemoryMappedFile           (const MemoryMappedFile&) = delete;
+    MemoryMappedFile& operator=(const MemoryMappedFile&) = delete;
+
+    const char* view_ = nullptr;
+    size_t size_ = 0;
+};
+
 //-----------------------------------------------------------------------------------------------
 
 //native stream I/O convenience functions:
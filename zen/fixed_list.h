@@ -0,0 +1,159 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#ifndef FIXED_LIST_H_452674359823045897
+#define FIXED_LIST_H_452674359823045897
+
+#include <cassert>
+#include <iterator>
+#include <utility>
+
+
+namespace zen
+{
+//std::list(C++11)-like class for inplace element construction supporting non-copyable/non-movable types
+//-> no iterator invalidation after emplace_back(); in contrast to std::list: singly-linked => 8 bytes less per element and no virtual end node
+template <class T>
+class FixedList
+{
+    struct Node
+    {
+        template <class... Args>
+        Node(Args&& ... args) : val(std::forward<Args>(args)...) {}
+
+        Node* next = nullptr; //singly-linked list is sufficient
+        T val;
+    };
+
+public:
+    FixedList() {}
+
+    ~FixedList() { clear(); }
+
+    template <class NodeT, class U>
+    class FixedIterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = U;
+        using difference_type = ptrdiff_t;
+        using pointer   = U*;
+        using reference = U&;
+
+        FixedIterator(NodeT* it = nullptr) : it_(it) {}
+        FixedIterator& operator++() { it_ = it_->next; return *this; }
+        inline friend bool operator==(const FixedIterator& lhs, const FixedIterator& rhs) { return lhs.it_ == rhs.it_; }
+        inline friend bool operator!=(const FixedIterator& lhs, const FixedIterator& rhs) { return !(lhs == rhs); }
+        U& operator* () const { return  it_->val; }
+        U* operator->() const { return &it_->val; }
+    private:
+        NodeT* it_;
+    };
+
+    using value_type      = T;
+    using iterator        = FixedIterator<      Node,       T>;
+    using const_iterator  = FixedIterator<const Node, const T>;
+    using reference       = T&;
+    using const_reference = const T&;
+
+    iterator begin() { return firstInsert_; }
+    iterator end  () { return iterator(); }
+
+    const_iterator begin() const { return firstInsert_; }
+    const_iterator end  () const { return const_iterator(); }
+
+    //const_iterator cbegin() const { return firstInsert_; }
+    //const_iterator cend  () const { return const_iterator(); }
+
+    reference       front()       { assert(!empty()); return firstInsert_->val; }
+    const_reference front() const { assert(!empty()); return firstInsert_->val; }
+
+    reference       back()       { assert(!empty()); return lastInsert_->val; }
+    const_reference back() const { assert(!empty()); return lastInsert_->val; }
+
+    template <class... Args>
+    void emplace_back(Args&& ... args)
+    {
+        Node* newNode = new Node(std::forward<Args>(args)...);
+        pushNode(newNode);
+    }
+
+    template <class Predicate>
+    void remove_if(Predicate pred)
+    {
+        Node* prev = nullptr;
+        Node* ptr  = firstInsert_;
+
+        while (ptr)
+            if (pred(ptr->val))
+            {
+                Node* next = ptr->next;
+
+                delete ptr;
+                assert(sz_ > 0);
+                --sz_;
+
+                ptr = next;
+
+                if (prev)
+                    prev->next = next;
+                else
+                    firstInsert_ = next;
+                if (!next)
+                    lastInsert_ = prev;
+            }
+            else
+            {
+                prev = ptr;
+                ptr = ptr->next;
+            }
+    }
+
+    void clear()
+    {
+        Node* ptr = firstInsert_;
+        while (ptr)
+        {
+            Node* next = ptr->next;
+            delete ptr;
+            ptr = next;
+        }
+
+        sz_ = 0;
+        firstInsert_ = lastInsert_ = nullptr;
+    }
+
+    bool empty() const { return sz_ == 0; }
+
+    size_t size() const { return sz_; }
+
+private:
+    FixedList           (const FixedList&) = delete;
+    FixedList& operator=(const FixedList&) = delete;
+
+    void pushNode(Node* newNode) //throw()
+    {
+        ++sz_;
+        if (!lastInsert_)
+        {
+            assert(!firstInsert_ && sz_ == 1);
+            firstInsert_ = lastInsert_ = newNode;
+        }
+        else
+        {
+            assert(!lastInsert_->next);
+            lastInsert_->next = newNode;
+            lastInsert_ = newNode;
+        }
+    }
+
+    size_t sz_ = 0;
+    Node* firstInsert_ = nullptr;
+    Node* lastInsert_  = nullptr; //point to last element! => O(1) emplace_back()
+};
+}
+
+#endif //FIXED_LIST_H_452674359823045897
@@ -9,11 +9,13 @@
 
 #include <set>
 #include <map>
+#include <unordered_map>
 #include <vector>
 #include <memory>
 #include <cassert>
 #include <algorithm>
 #include <optional>
+#include <cstring> //memrchr
 #include "string_traits.h"
 //#include "build_info.h"
 
@@ -31,6 +33,9 @@ void eraseIf(std::set<T, LessType, Alloc>& s, Predicate p);
 template <class KeyType, class ValueType, class LessType, class Alloc, class Predicate>
 void eraseIf(std::map<KeyType, ValueType, LessType, Alloc>& m, Predicate p);
 
+template <class KeyType, class ValueType, class HashType, class KeyEqual, class Alloc, class Predicate>
+void eraseIf(std::unordered_map<KeyType, ValueType, HashType, KeyEqual, Alloc>& m, Predicate p);
+
 //append STL containers
 template <class T, class Alloc, class C>
 void append(std::vector<T, Alloc>& v, const C& c);
@@ -145,6 +150,10 @@ template <class KeyType, class ValueType, class LessType, class Alloc, class Pre
 void eraseIf(std::map<KeyType, ValueType, LessType, Alloc>& m, Predicate p) { impl::setOrMapEraseIf(m, p); }
 
 
+template <class KeyType, class ValueType, class HashType, class KeyEqual, class Alloc, class Predicate> inline
+void eraseIf(std::unordered_map<KeyType, ValueType, HashType, KeyEqual, Alloc>& m, Predicate p) { impl::setOrMapEraseIf(m, p); }
+
+
 template <class T, class Alloc, class C> inline
 void append(std::vector<T, Alloc>& v, const C& c) { v.insert(v.end(), c.begin(), c.end()); }
 
@@ -195,6 +204,14 @@ Iterator binarySearch(Iterator first, Iterator last, const T& value, CompLess le
 template <class BidirectionalIterator, class T> inline
 BidirectionalIterator findLast(const BidirectionalIterator first, const BidirectionalIterator last, const T& value)
 {
+    if constexpr (std::is_pointer_v<BidirectionalIterator> &&
+                  std::is_same_v<std::remove_cv_t<std::remove_pointer_t<BidirectionalIterator>>, char> && std::is_same_v<T, char>)
+    {
+        //perf: glibc's memrchr() is vectorized, e.g. find last path separator
+        const void* it = ::memrchr(first, value, last - first);
+        return it ? first + (static_cast<const char*>(it) - first) : last;
+    }
+
     for (BidirectionalIterator it = last; it != first;) //reverse iteration: 1. check 2. decrement 3. evaluate
     {
         --it; //
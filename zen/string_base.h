@@ -399,6 +399,11 @@ size_t Zbase<Char, SP>::find(Char ch, size_t pos) const
     assert(pos <= length());
     const size_t len = length();
     const Char* thisEnd = begin() + len; //respect embedded 0
+    if constexpr (sizeof(Char) == 1) //perf: glibc's memchr() is vectorized
+    {
+        const void* it = std::memchr(begin() + std::min(pos, len), ch, len - std::min(pos, len));
+        return it ? static_cast<const Char*>(it) - begin() : npos;
+    }
     const Char* it = std::find(begin() + std::min(pos, len), thisEnd, ch);
     return it == thisEnd ? npos : it - begin();
 }
@@ -460,6 +465,8 @@ void Zbase<Char, SP>::resize(size_t newSize, Char fillChar)
 template <class Char, template <class> class SP> inline
 bool operator==(const Zbase<Char, SP>& lhs, const Zbase<Char, SP>& rhs)
 {
+    if (lhs.begin() == rhs.begin()) //perf: shared (ref-counted) buffer, e.g. see StringPool
+        return true;
     return lhs.length() == rhs.length() && std::equal(lhs.begin(), lhs.end(), rhs.begin()); //respect embedded 0
 }
 
@@ -474,6 +481,8 @@ bool operator==(const Zbase<Char, SP>& lhs, const Char* rhs)
 template <class Char, template <class> class SP> inline
 bool operator<(const Zbase<Char, SP>& lhs, const Zbase<Char, SP>& rhs)
 {
+    if (lhs.begin() == rhs.begin()) //perf: shared (ref-counted) buffer
+        return false;
     return std::lexicographical_compare(lhs.begin(), lhs.end(), //respect embedded 0
                                         rhs.begin(), rhs.end());
 }
@@ -0,0 +1,218 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+/* Standalone micro-benchmarks: previous scalar string helpers vs the SSE2 fast paths
+
+    - isAsciiString():      per-char loop            vs impl::getAsciiPrefixLength()
+    - strcmpAsciiNoCase():  per-char asciiToLower()  vs impl::findMismatchAsciiNoCase()
+    - utfTo<>/isValidUtf(): UtfDecoder per code point vs impl::decodeUtfRuns()
+
+    - inputs: typical file paths (short, mostly ASCII) and long text, each ASCII-only and with some non-ASCII chars
+    - scalar and SSE2 results are compared before timing
+    - build + run: make benchmark_strings (FreeFileSync/Source/Makefile)          */
+
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+#include "perf.h"
+#include "utf.h"
+
+using namespace zen;
+
+
+namespace
+{
+//============ previous scalar implementations, kept verbatim for comparison =============
+namespace scalar
+{
+template <class Char> inline
+bool isAsciiString(const Char* str)
+{
+    static_assert(std::is_same_v<Char, char> || std::is_same_v<Char, wchar_t>);
+    for (Char c = *str; c != 0; c = *++str)
+        if (zen::makeUnsigned(c) >= 128)
+            return false;
+    return true;
+}
+
+
+template <class Char> inline
+int strcmpAsciiNoCase(const Char* lhs, const Char* rhs, size_t len)
+{
+    while (len-- > 0)
+    {
+        const Char charL = asciiToLower(*lhs++); //ordering: lower-case chars have higher code points than uppper-case
+        const Char charR = asciiToLower(*rhs++); //
+        if (charL != charR)
+            return static_cast<unsigned int>(charL) - static_cast<unsigned int>(charR); //unsigned char-comparison is the convention!
+        //unsigned underflow is well-defined!
+    }
+    return 0;
+}
+
+
+template <class UtfString> inline
+bool isValidUtf(const UtfString& str)
+{
+    using namespace impl;
+
+    UtfDecoder<GetCharTypeT<UtfString>> decoder(strBegin(str), strLength(str));
+    while (const std::optional<CodePoint> cp = decoder.getNext())
+        if (*cp == REPLACEMENT_CHAR)
+            return false;
+
+    return true;
+}
+
+
+template <class TargetString, class SourceString> inline
+TargetString utfTo(const SourceString& str)
+{
+    using namespace impl;
+    using CharTrg = GetCharTypeT<TargetString>;
+
+    TargetString output;
+
+    UtfDecoder<GetCharTypeT<SourceString>> decoder(strBegin(str), strLength(str));
+    while (const std::optional<CodePoint> cp = decoder.getNext())
+        codePointToUtf<CharTrg>(*cp, [&](CharTrg c) { output += c; });
+
+    return output;
+}
+}
+//========================================================================================
+
+
+struct TestSet
+{
+    const char* name;
+    std::vector<std::string>  utf8;
+    std::vector<std::wstring> wide;
+    std::vector<std::string>  upper; //ASCII upper-case copy of utf8 => strcmpAsciiNoCase() scans the full length
+};
+
+
+TestSet createTestSet(const char* name, size_t strCount, size_t strLen, bool withNonAscii)
+{
+    const std::string pathChars = "/home/zenju/Documents/Backup 2019/Photos/Holiday_";
+
+    TestSet ts{ name, {}, {}, {} };
+    for (size_t i = 0; i < strCount; ++i)
+    {
+        std::string str;
+        while (str.size() < strLen)
+        {
+            str += pathChars;
+            str += numberTo<std::string>(i);
+        }
+        str.resize(strLen);
+
+        if (withNonAscii) //one 2-byte char near the end: long ASCII run first, then decoding
+            str.replace(strLen - strLen / 8, 2, "\xc3\xa4"); //U+00E4: a-umlaut
+
+        ts.utf8.push_back(str);
+        ts.wide.push_back(utfTo<std::wstring>(str));
+
+        for (char& c : str)
+            c = asciiToUpper(c);
+        ts.upper.push_back(str);
+    }
+    return ts;
+}
+
+
+template <class Function>
+void runBenchmark(const char* testName, const TestSet& ts, size_t& sink, Function fun /*(const TestSet&, size_t index) -> size_t*/)
+{
+    const int runs = 5;
+    const int repeat = 20;
+
+    std::chrono::nanoseconds best = std::chrono::nanoseconds::max();
+    for (int i = 0; i < runs; ++i)
+    {
+        StopWatch watch;
+        for (int k = 0; k < repeat; ++k)
+            for (size_t j = 0; j < ts.utf8.size(); ++j)
+                sink += fun(ts, j);
+        best = std::min(best, watch.elapsed());
+    }
+
+    const double nsPerString = std::chrono::duration<double, std::nano>(best).count() / (repeat * ts.utf8.size());
+    std::cout << ts.name << "\t" << testName << "\t" << nsPerString << " ns/string\n";
+}
+
+
+template <class T>
+bool checkEqual(const char* testName, const TestSet& ts, T (*fun)(const TestSet&, size_t), T (*funScalar)(const TestSet&, size_t))
+{
+    for (size_t j = 0; j < ts.utf8.size(); ++j)
+        if (fun(ts, j) != funScalar(ts, j))
+        {
+            std::cerr << "Error: " << ts.name << " " << testName << ": scalar and SSE2 results differ!\n";
+            return false;
+        }
+    return true;
+}
+
+
+//wrappers: identical call signature for old and new implementation
+bool isAsciiChar         (const TestSet& ts, size_t i) { return isAsciiString(ts.utf8[i]); }
+bool isAsciiCharScalar   (const TestSet& ts, size_t i) { return scalar::isAsciiString(ts.utf8[i].c_str()); }
+bool isAsciiWchar        (const TestSet& ts, size_t i) { return isAsciiString(ts.wide[i]); }
+bool isAsciiWcharScalar  (const TestSet& ts, size_t i) { return scalar::isAsciiString(ts.wide[i].c_str()); }
+
+int  cmpNoCase           (const TestSet& ts, size_t i) { return impl  ::strcmpAsciiNoCase(ts.utf8[i].c_str(), ts.upper[i].c_str(), ts.utf8[i].size()); }
+int  cmpNoCaseScalar     (const TestSet& ts, size_t i) { return scalar::strcmpAsciiNoCase(ts.utf8[i].c_str(), ts.upper[i].c_str(), ts.utf8[i].size()); }
+
+bool validUtf8           (const TestSet& ts, size_t i) { return isValidUtf(ts.utf8[i]); }
+bool validUtf8Scalar     (const TestSet& ts, size_t i) { return scalar::isValidUtf(ts.utf8[i]); }
+
+std::wstring toWide      (const TestSet& ts, size_t i) { return utfTo<std::wstring>(ts.utf8[i]); }
+std::wstring toWideScalar(const TestSet& ts, size_t i) { return scalar::utfTo<std::wstring>(ts.utf8[i]); }
+std::string  toUtf8      (const TestSet& ts, size_t i) { return utfTo<std::string>(ts.wide[i]); }
+std::string  toUtf8Scalar(const TestSet& ts, size_t i) { return scalar::utfTo<std::string>(ts.wide[i]); }
+}
+
+
+int main()
+{
+    const TestSet testSets[] =
+    {
+        createTestSet("path ASCII    ", 10000,   60, false),
+        createTestSet("path non-ASCII", 10000,   60, true),
+        createTestSet("text ASCII    ",   100, 4096, false),
+        createTestSet("text non-ASCII",   100, 4096, true),
+    };
+
+    size_t sink = 0;
+
+    for (const TestSet& ts : testSets)
+    {
+        if (!checkEqual("isAsciiString<char>",    ts, isAsciiChar,  isAsciiCharScalar ) ||
+            !checkEqual("isAsciiString<wchar_t>", ts, isAsciiWchar, isAsciiWcharScalar) ||
+            !checkEqual("isValidUtf",             ts, validUtf8,    validUtf8Scalar   ) ||
+            !checkEqual("utfTo<std::wstring>",    ts, toWide,       toWideScalar      ) ||
+            !checkEqual("utfTo<std::string>",     ts, toUtf8,       toUtf8Scalar      ) ||
+            !checkEqual("strcmpAsciiNoCase",      ts, cmpNoCase,    cmpNoCaseScalar   ))
+            return EXIT_FAILURE;
+
+        runBenchmark("isAsciiString<char>    scalar", ts, sink, isAsciiCharScalar);
+        runBenchmark("isAsciiString<char>    SSE2  ", ts, sink, isAsciiChar);
+        runBenchmark("isAsciiString<wchar_t> scalar", ts, sink, isAsciiWcharScalar);
+        runBenchmark("isAsciiString<wchar_t> SSE2  ", ts, sink, isAsciiWchar);
+        runBenchmark("strcmpAsciiNoCase      scalar", ts, sink, cmpNoCaseScalar);
+        runBenchmark("strcmpAsciiNoCase      SSE2  ", ts, sink, cmpNoCase);
+        runBenchmark("isValidUtf             scalar", ts, sink, validUtf8Scalar);
+        runBenchmark("isValidUtf             SSE2  ", ts, sink, validUtf8);
+        runBenchmark("utfTo<std::wstring>    scalar", ts, sink, [](const TestSet& t, size_t i) { return toWideScalar(t, i).size(); });
+        runBenchmark("utfTo<std::wstring>    SSE2  ", ts, sink, [](const TestSet& t, size_t i) { return toWide      (t, i).size(); });
+        runBenchmark("utfTo<std::string>     scalar", ts, sink, [](const TestSet& t, size_t i) { return toUtf8Scalar(t, i).size(); });
+        runBenchmark("utfTo<std::string>     SSE2  ", ts, sink, [](const TestSet& t, size_t i) { return toUtf8      (t, i).size(); });
+        std::cout << "\n";
+    }
+
+    return sink != 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,61 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#ifndef STRING_POOL_H_3801947256340918
+#define STRING_POOL_H_3801947256340918
+
+#include <array>
+#include <mutex>
+#include <unordered_set>
+#include "stl_tools.h"
+
+
+namespace zen
+{
+/* share memory of identical strings, e.g. file names like "Thumbs.db", ".git", "index.html" found thousands of times during folder traversal
+   - Zbase is ref-counted: interned strings refer to the same buffer => also enables pointer equality fast path in operator==
+   - thread-safe: sharded by hash to avoid lock contention between worker threads
+   - strings stay valid after pool destruction: use one pool per scan                                                                      */
+template <class Str>
+class StringPool
+{
+public:
+    StringPool() {}
+
+    Str intern(const Str& str) //thread-safe
+    {
+        const size_t strHash = StringHash()(str);
+        Shard& shard = shards_[strHash % shards_.size()];
+
+        std::lock_guard dummy(shard.lock);
+        return *shard.strings.insert(str).first; //ref-counted copy
+    }
+
+    size_t size() const
+    {
+        size_t count = 0;
+        for (const Shard& shard : shards_)
+        {
+            std::lock_guard dummy(shard.lock);
+            count += shard.strings.size();
+        }
+        return count;
+    }
+
+private:
+    StringPool           (const StringPool&) = delete;
+    StringPool& operator=(const StringPool&) = delete;
+
+    struct Shard
+    {
+        mutable std::mutex lock;
+        std::unordered_set<Str, StringHash> strings;
+    };
+    std::array<Shard, 16> shards_;
+};
+}
+
+#endif //STRING_POOL_H_3801947256340918
@@ -18,6 +18,10 @@
 #include "stl_tools.h"
 #include "string_traits.h"
 
+#ifdef __SSE2__ //x86-64 baseline => no runtime dispatch needed
+    #include <emmintrin.h>
+#endif
+
 
 //enhance arbitray string class with useful non-member functions:
 namespace zen
@@ -26,7 +30,7 @@ template <class Char> bool isWhiteSpace(Char c);
 template <class Char> bool isDigit     (Char c); //not exactly the same as "std::isdigit" -> we consider '0'-'9' only!
 template <class Char> bool isHexDigit  (Char c);
 template <class Char> bool isAsciiAlpha(Char c);
-template <class Char> bool isAsciiString(const Char* str);
+template <class S>    bool isAsciiString(const S& str);
 template <class Char> Char asciiToLower(Char c);
 template <class Char> Char asciiToUpper(Char c);
 
@@ -142,14 +146,48 @@ bool isAsciiAlpha(Char c)
 }
 
 
-template <class Char> inline
-bool isAsciiString(const Char* str)
+namespace impl
 {
-    static_assert(std::is_same_v<Char, char> || std::is_same_v<Char, wchar_t>);
-    for (Char c = *str; c != 0; c = *++str)
-        if (zen::makeUnsigned(c) >= 128)
-            return false;
-    return true;
+//perf: check 16 bytes at a time
+inline
+size_t getAsciiPrefixLength(const char* str, size_t len)
+{
+    size_t i = 0;
+#ifdef __SSE2__
+    for (; i + 16 <= len; i += 16)
+        if (const int nonAsciiMask = ::_mm_movemask_epi8(::_mm_loadu_si128(reinterpret_cast<const __m128i*>(str + i))); nonAsciiMask != 0)
+            return i + __builtin_ctz(nonAsciiMask);
+#endif
+    while (i < len && makeUnsigned(str[i]) < 128)
+        ++i;
+    return i;
+}
+
+
+inline
+size_t getAsciiPrefixLength(const wchar_t* str, size_t len)
+{
+    size_t i = 0;
+#if defined __SSE2__ && __SIZEOF_WCHAR_T__ == 4
+    const __m128i nonAsciiBits = ::_mm_set1_epi32(~0x7f);
+    for (; i + 4 <= len; i += 4)
+        if (::_mm_movemask_epi8(::_mm_cmpeq_epi32(::_mm_and_si128(::_mm_loadu_si128(reinterpret_cast<const __m128i*>(str + i)), nonAsciiBits),
+                                                  ::_mm_setzero_si128())) != 0xffff)
+            break;
+#endif
+    while (i < len && makeUnsigned(str[i]) < 128)
+        ++i;
+    return i;
+}
+}
+
+
+template <class S> inline
+bool isAsciiString(const S& str)
+{
+    static_assert(std::is_same_v<GetCharTypeT<S>, char> || std::is_same_v<GetCharTypeT<S>, wchar_t>);
+    const size_t len = strLength(str);
+    return impl::getAsciiPrefixLength(strBegin(str), len) == len;
 }
 
 
@@ -190,6 +228,48 @@ int strcmpAsciiNoCase(const Char* lhs, const Char* rhs, size_t len)
     }
     return 0;
 }
+
+
+//return first position where chars differ after ASCII lower-case conversion; non-ASCII chars are compared as is
+inline
+size_t findMismatchAsciiNoCase(const char* lhs, const char* rhs, size_t len)
+{
+    size_t i = 0;
+#ifdef __SSE2__
+    const __m128i charBeforeA = ::_mm_set1_epi8('A' - 1);
+    const __m128i charAfterZ  = ::_mm_set1_epi8('Z' + 1);
+    const __m128i lowerCaseBit = ::_mm_set1_epi8(0x20);
+
+    auto toLower = [&](__m128i chars)
+    {
+        //signed comparison: non-ASCII chars are negative => never upper-case
+        const __m128i isUpper = ::_mm_and_si128(::_mm_cmpgt_epi8(chars, charBeforeA), ::_mm_cmplt_epi8(chars, charAfterZ));
+        return ::_mm_or_si128(chars, ::_mm_and_si128(isUpper, lowerCaseBit));
+    };
+
+    for (; i + 16 <= len; i += 16)
+    {
+        const __m128i charsL = ::_mm_loadu_si128(reinterpret_cast<const __m128i*>(lhs + i));
+        const __m128i charsR = ::_mm_loadu_si128(reinterpret_cast<const __m128i*>(rhs + i));
+        if (const int equalMask = ::_mm_movemask_epi8(::_mm_cmpeq_epi8(toLower(charsL), toLower(charsR))); equalMask != 0xffff)
+            return i + __builtin_ctz(~equalMask);
+    }
+#endif
+    while (i < len && asciiToLower(lhs[i]) == asciiToLower(rhs[i]))
+        ++i;
+    return i;
+}
+
+
+inline
+int strcmpAsciiNoCase(const char* lhs, const char* rhs, size_t len)
+{
+    const size_t pos = findMismatchAsciiNoCase(lhs, rhs, len);
+    if (pos == len)
+        return 0;
+    //same result as the generic version above:
+    return static_cast<unsigned int>(asciiToLower(lhs[pos])) - static_cast<unsigned int>(asciiToLower(rhs[pos]));
+}
 }
 
 
@@ -303,6 +303,32 @@ private:
 
 template <class CharType>
 using UtfDecoder = UtfDecoderImpl<CharType, sizeof(CharType)>;
+
+
+//perf: pass runs of ASCII chars as a block without decoding
+//=> equivalent to UtfDecoder: an ASCII char is never consumed as part of a multi-unit sequence, not even an invalid one
+template <class CharType, class OnAsciiRun, class OnCodePoint> inline
+void decodeUtfRuns(const CharType* str, size_t len, OnAsciiRun onAsciiRun /*(const CharType* first, const CharType* last)*/, OnCodePoint onCodePoint /*(CodePoint cp)*/)
+{
+    const CharType*       it    = str;
+    const CharType* const itEnd = str + len;
+    while (it != itEnd)
+    {
+        const CharType* const itAsciiEnd = it + getAsciiPrefixLength(it, itEnd - it);
+        if (it != itAsciiEnd)
+        {
+            onAsciiRun(it, itAsciiEnd);
+            it = itAsciiEnd;
+        }
+
+        const CharType* const itNonAsciiEnd = std::find_if(it, itEnd, [](CharType c) { return makeUnsigned(c) < 128; });
+
+        UtfDecoder<CharType> decoder(it, itNonAsciiEnd - it);
+        while (const std::optional<CodePoint> cp = decoder.getNext())
+            onCodePoint(*cp);
+        it = itNonAsciiEnd;
+    }
+}
 }
 
 //-------------------------------------------------------------------------------------------
@@ -312,12 +338,13 @@ bool isValidUtf(const UtfString& str)
 {
     using namespace impl;
 
-    UtfDecoder<GetCharTypeT<UtfString>> decoder(strBegin(str), strLength(str));
-    while (const std::optional<CodePoint> cp = decoder.getNext())
-        if (*cp == REPLACEMENT_CHAR)
-            return false;
-
-    return true;
+    bool valid = true;
+    decodeUtfRuns(strBegin(str), strLength(str), [](auto, auto) {}, [&](CodePoint cp)
+    {
+        if (cp == REPLACEMENT_CHAR)
+            valid = false;
+    });
+    return valid;
 }
 
 
@@ -366,9 +393,16 @@ TargetString utfTo(const SourceString& str, std::false_type)
 
     TargetString output;
 
-    UtfDecoder<CharSrc> decoder(strBegin(str), strLength(str));
-    while (const std::optional<CodePoint> cp = decoder.getNext())
-        codePointToUtf<CharTrg>(*cp, [&](CharTrg c) { output += c; });
+    const size_t strLen = strLength(str);
+    if (strLen > 0)
+        output.reserve(strLen); //exact for ASCII-only strings (= the common case)
+
+    decodeUtfRuns(strBegin(str), strLen, [&](const CharSrc* first, const CharSrc* last)
+    {
+        for (; first != last; ++first)
+            output += static_cast<CharTrg>(*first);
+    },
+    [&](CodePoint cp) { codePointToUtf<CharTrg>(cp, [&](CharTrg c) { output += c; }); });
 
     return output;
 }
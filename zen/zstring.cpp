@@ -7,72 +7,248 @@
 #include "zstring.h"
 #include <stdexcept>
 #include "utf.h"
-
-    #include <gtk/gtk.h>
-    #include "sys_error.h"
+#include "unicode_tables.h"
 
 using namespace zen;
+using impl::CodePoint;
 
 
-Zstring makeUpperCopy(const Zstring& str)
+namespace
 {
-    //fast pre-check:
-    if (isAsciiString(str.c_str())) //perf: in the range of 3.5ns
+template <class Range, size_t N> inline
+const Range* findRange(const Range (&ranges)[N], CodePoint cp) //ranges sorted by "first", non-overlapping
+{
+    auto it = std::upper_bound(std::begin(ranges), std::end(ranges), cp, [](CodePoint cp2, const Range& r) { return cp2 < r.first; });
+    if (it == std::begin(ranges))
+        return nullptr;
+    --it;
+    return cp <= it->last ? &*it : nullptr;
+}
+
+
+//Hangul syllables: https://www.unicode.org/versions/Unicode14.0.0/ch03.pdf#G56669
+const CodePoint HANGUL_S_BASE = 0xac00;
+const CodePoint HANGUL_L_BASE = 0x1100;
+const CodePoint HANGUL_V_BASE = 0x1161;
+const CodePoint HANGUL_T_BASE = 0x11a7;
+const CodePoint HANGUL_L_COUNT = 19;
+const CodePoint HANGUL_V_COUNT = 21;
+const CodePoint HANGUL_T_COUNT = 28;
+const CodePoint HANGUL_N_COUNT = HANGUL_V_COUNT * HANGUL_T_COUNT; //588
+const CodePoint HANGUL_S_COUNT = HANGUL_L_COUNT * HANGUL_N_COUNT; //11172
+
+
+inline
+uint8_t getCombiningClass(CodePoint cp)
+{
+    if (cp < 0x300) //perf: no combining marks below
+        return 0;
+    if (const unicode::CombiningClassRange* r = findRange(unicode::COMBINING_CLASS_RANGES, cp))
+        return r->ccc;
+    return 0;
+}
+
+
+//NFC quick check: "true" => definitively NFC; "false" => maybe not
+//perf: most non-ASCII names are already NFC (Linux, Windows) => no need to decompose/recompose
+bool isNfcQuick(const Zstring& str)
+{
+    impl::UtfDecoder<char> decoder(str.c_str(), str.size());
+    while (const std::optional<CodePoint> cp = decoder.getNext())
+        if (*cp >= 0x300 && //perf: ASCII, Latin-1, Latin Extended-A/B, IPA are NFC-safe
+            !(0x3400 <= *cp && *cp < 0xa66f) && //perf: CJK Unified Ideographs, Yi
+            !(HANGUL_S_BASE <= *cp && *cp < HANGUL_S_BASE + HANGUL_S_COUNT))
+            if (*cp == impl::REPLACEMENT_CHAR || //invalid UTF-8? => let slow path decide
+                findRange(unicode::NFC_UNSAFE_RANGES, *cp))
+                return false;
+    return true;
+}
+
+
+struct CharCcc
+{
+    CodePoint cp;
+    uint8_t ccc;
+};
+
+void appendDecomposed(CodePoint cp, std::vector<CharCcc>& buf)
+{
+    if (HANGUL_S_BASE <= cp && cp < HANGUL_S_BASE + HANGUL_S_COUNT)
     {
-        Zstring output = str;
-        for (Zchar& c : output) c = asciiToUpper(c);
-        return output;
+        const CodePoint sIdx = cp - HANGUL_S_BASE;
+        buf.push_back({ HANGUL_L_BASE + sIdx / HANGUL_N_COUNT, 0 });
+        buf.push_back({ HANGUL_V_BASE + sIdx % HANGUL_N_COUNT / HANGUL_T_COUNT, 0 });
+        if (const CodePoint tIdx = sIdx % HANGUL_T_COUNT; tIdx != 0)
+            buf.push_back({ HANGUL_T_BASE + tIdx, 0 });
+        return;
     }
 
-    Zstring strNorm = getUnicodeNormalForm(str);
-    try
+    if (cp >= 0xc0) //perf: no decompositions below
     {
-        static_assert(sizeof(impl::CodePoint) == sizeof(gunichar));
-        Zstring output;
-        output.reserve(strNorm.size());
+        auto it = std::lower_bound(std::begin(unicode::DECOMPOSITIONS), std::end(unicode::DECOMPOSITIONS), cp,
+        [](const unicode::Decomposition& d, CodePoint cp2) { return d.cp < cp2; });
 
-        impl::UtfDecoder<char> decoder(strNorm.c_str(), strNorm.size());
-        while (const std::optional<impl::CodePoint> cp = decoder.getNext())
-            impl::codePointToUtf<char>(::g_unichar_toupper(*cp), [&](char c) { output += c; }); //don't use std::towupper: *incomplete* and locale-dependent!
+        if (it != std::end(unicode::DECOMPOSITIONS) && it->cp == cp)
+        {
+            std::for_each(unicode::DECOMPOSITION_DATA + it->pos,
+                          unicode::DECOMPOSITION_DATA + it->pos + it->len, [&](CodePoint cpD) { buf.push_back({ cpD, getCombiningClass(cpD) }); });
+            return;
+        }
+    }
+    buf.push_back({ cp, getCombiningClass(cp) });
+}
+
+
+CodePoint getPrimaryComposite(CodePoint first, CodePoint second) //returns 0 if none
+{
+    if (HANGUL_L_BASE <= first  && first  < HANGUL_L_BASE + HANGUL_L_COUNT &&
+        HANGUL_V_BASE <= second && second < HANGUL_V_BASE + HANGUL_V_COUNT)
+        return HANGUL_S_BASE + ((first - HANGUL_L_BASE) * HANGUL_V_COUNT + second - HANGUL_V_BASE) * HANGUL_T_COUNT; //LV
+
+    if (HANGUL_S_BASE <= first  && first  < HANGUL_S_BASE + HANGUL_S_COUNT && (first - HANGUL_S_BASE) % HANGUL_T_COUNT == 0 &&
+        HANGUL_T_BASE <  second && second < HANGUL_T_BASE + HANGUL_T_COUNT)
+        return first + (second - HANGUL_T_BASE); //LVT
+
+    auto it = std::lower_bound(std::begin(unicode::COMPOSITIONS), std::end(unicode::COMPOSITIONS), std::pair(first, second),
+    [](const unicode::Composition& c, const std::pair<CodePoint, CodePoint>& key) { return std::pair(c.first, c.second) < key; });
+
+    if (it != std::end(unicode::COMPOSITIONS) && it->first == first && it->second == second)
+        return it->composite;
+    return 0;
+}
 
-        return output;
 
+//Unicode Standard Annex #15: https://www.unicode.org/reports/tr15/
+void appendNfc(const Zstring& str, Zstring& output)
+{
+    if (!isValidUtf(str)) //file names on Linux are byte strings => don't "repair" to U+FFFD
+    {
+        output.append(str.begin(), str.end());
+        return;
     }
-    catch (const SysError& e)
+
+    //1. canonical decomposition
+    std::vector<CharCcc> buf;
+    buf.reserve(str.size() + 8);
+
+    impl::UtfDecoder<char> decoder(str.c_str(), str.size());
+    while (const std::optional<CodePoint> cp = decoder.getNext())
+        appendDecomposed(*cp, buf);
+
+    //2. canonical ordering: stable sort of each sequence of non-starters by combining class
+    for (size_t i = 1; i < buf.size(); ++i)
+        if (const CharCcc cc = buf[i]; cc.ccc != 0)
+        {
+            size_t j = i;
+            for (; j > 0 && buf[j - 1].ccc > cc.ccc; --j)
+                buf[j] = buf[j - 1];
+            buf[j] = cc;
+        }
+
+    //3. canonical composition: compact "buf" in place
+    const size_t noStarter = static_cast<size_t>(-1);
+    size_t starterPos = noStarter;
+    uint8_t lastCcc = 0;
+    size_t posOut = 0;
+
+    for (const CharCcc cc : buf)
     {
-        (void)e;
-        assert(false);
-        return str;
+        if (starterPos != noStarter &&
+            (posOut == starterPos + 1 || lastCcc < cc.ccc)) //not blocked: canonical order => lastCcc is the max. ccc since the starter
+            if (const CodePoint composite = getPrimaryComposite(buf[starterPos].cp, cc.cp))
+            {
+                buf[starterPos].cp = composite;
+                continue;
+            }
+
+        if (cc.ccc == 0)
+            starterPos = posOut;
+        lastCcc = cc.ccc;
+        buf[posOut++] = cc;
     }
+    buf.resize(posOut);
+
+    for (const CharCcc cc : buf)
+        impl::codePointToUtf<char>(cc.cp, [&](char c) { output += c; });
 }
 
 
-Zstring getUnicodeNormalForm(const Zstring& str)
+inline
+CodePoint toUpperSimple(CodePoint cp) //don't use std::towupper: *incomplete* and locale-dependent!
 {
-    //fast pre-check:
-    if (isAsciiString(str.c_str())) //perf: in the range of 3.5ns
-        return str; //god bless our ref-counting! => save output string memory consumption!
+    if (cp < 0x80)
+        return asciiToUpper(static_cast<char>(cp));
 
-    //Example: const char* decomposed  = "\x6f\xcc\x81";
-    //         const char* precomposed = "\xc3\xb3";
-    try
-    {
-        gchar* outStr = ::g_utf8_normalize (str.c_str(), str.length(), G_NORMALIZE_DEFAULT_COMPOSE);
-        if (!outStr)
-            throw SysError(L"g_utf8_normalize: conversion failed. (" + utfTo<std::wstring>(str) + L")");
-        ZEN_ON_SCOPE_EXIT(::g_free(outStr));
-        return outStr;
+    if (const unicode::UpperCaseRange* r = findRange(unicode::UPPER_CASE_RANGES, cp))
+        if ((cp - r->first) % r->stride == 0)
+            return cp + r->delta;
+    return cp;
+}
+
+
+void appendUpperCase(const char* str, size_t len, Zstring& output)
+{
+    impl::UtfDecoder<char> decoder(str, len);
+    while (const std::optional<CodePoint> cp = decoder.getNext())
+        impl::codePointToUtf<char>(toUpperSimple(*cp), [&](char c) { output += c; });
+}
+}
+
+
+void makeUpperCopy(const Zstring& str, Zstring& output)
+{
+    output.clear();
 
+    //fast pre-check:
+    if (isAsciiString(str)) //perf: in the range of 3.5ns
+    {
+        output.append(str.begin(), str.end());
+        for (Zchar& c : output) c = asciiToUpper(c);
     }
-    catch (const SysError& e)
+    else if (isNfcQuick(str))
+        appendUpperCase(str.c_str(), str.size(), output);
+    else
     {
-        (void)e;
-        assert(false);
-        return str;
+        Zstring strNorm;
+        appendNfc(str, strNorm);
+        appendUpperCase(strNorm.c_str(), strNorm.size(), output);
+    }
+}
+
+
+Zstring makeUpperCopy(const Zstring& str)
+{
+    Zstring output;
+    output.reserve(str.size());
+    makeUpperCopy(str, output);
+    return output;
+}
+
+
+void getUnicodeNormalForm(const Zstring& str, Zstring& output)
+{
+    //fast pre-check:
+    if (isAsciiString(str) || //perf: in the range of 3.5ns
+        isNfcQuick(str))
+        output = str; //god bless our ref-counting! => save output string memory consumption!
+    else
+    {
+        //Example: const char* decomposed  = "\x6f\xcc\x81";
+        //         const char* precomposed = "\xc3\xb3";
+        output.clear();
+        appendNfc(str, output);
     }
 }
 
 
+Zstring getUnicodeNormalForm(const Zstring& str)
+{
+    Zstring output;
+    getUnicodeNormalForm(str, output);
+    return output;
+}
+
+
 Zstring replaceCpyAsciiNoCase(const Zstring& str, const Zstring& oldTerm, const Zstring& newTerm)
 {
     if (oldTerm.empty())
@@ -139,7 +315,16 @@ int compareNoCaseUtf8(const char* lhs, size_t lhsLen, const char* rhs, size_t rh
 {
     //- strncasecmp implements ASCII CI-comparsion only! => signature is broken for UTF8-input; toupper() similarly doesn't support Unicode
     //- wcsncasecmp: https://opensource.apple.com/source/Libc/Libc-763.12/string/wcsncasecmp-fbsd.c
-    // => re-implement comparison based on g_unichar_tolower() to avoid memory allocations
+    // => re-implement comparison based on toUpperSimple() to avoid memory allocations
+
+    //perf: skip common prefix (ASCII: ignoring case), then continue decoding after the last ASCII char (= code point boundary)
+    size_t pos = impl::findMismatchAsciiNoCase(lhs, rhs, std::min(lhsLen, rhsLen));
+    while (pos > 0 && makeUnsigned(lhs[pos - 1]) >= 128)
+        --pos;
+    lhs += pos;
+    rhs += pos;
+    lhsLen -= pos;
+    rhsLen -= pos;
 
     impl::UtfDecoder<char> decL(lhs, lhsLen);
     impl::UtfDecoder<char> decR(rhs, rhsLen);
@@ -150,10 +335,8 @@ int compareNoCaseUtf8(const char* lhs, size_t lhsLen, const char* rhs, size_t rh
         if (!cpL || !cpR)
             return static_cast<int>(!cpR) - static_cast<int>(!cpL);
 
-        static_assert(sizeof(gunichar) == sizeof(impl::CodePoint));
-
-        const gunichar charL = ::g_unichar_toupper(*cpL); //note: tolower can be ambiguous, so don't use:
-        const gunichar charR = ::g_unichar_toupper(*cpR); //e.g. "Σ" (upper case) can be lower-case "ς" in the end of the word or "σ" in the middle.
+        const CodePoint charL = toUpperSimple(*cpL); //note: tolower can be ambiguous, so don't use:
+        const CodePoint charR = toUpperSimple(*cpR); //e.g. "Σ" (upper case) can be lower-case "ς" in the end of the word or "σ" in the middle.
         if (charL != charR)
             //ordering: "to lower" converts to higher code points than "to upper"
             return static_cast<unsigned int>(charL) - static_cast<unsigned int>(charR); //unsigned char-comparison is the convention!
@@ -168,7 +351,7 @@ int compareNatural(const Zstring& lhs, const Zstring& rhs)
 {
     //Unicode normal forms:
     //      Windows: CompareString() already ignores NFD/NFC differences: nice...
-    //      Linux:  g_unichar_toupper() can't ignore differences
+    //      Linux:  toUpperSimple() can't ignore differences
     //      macOS:  CFStringCompare() considers differences
 
     const Zstring& lhsNorm = getUnicodeNormalForm(lhs);
@@ -247,3 +430,49 @@ int compareNatural(const Zstring& lhs, const Zstring& rhs)
     }
 
 }
+
+
+std::string getNaturalSortKey(const Zstring& str)
+{
+    //encode the blocks of whitespace/numbers/text exactly as compared by compareNatural():
+    const Zstring& strNorm = getUnicodeNormalForm(str);
+
+    const char* it = strNorm.c_str();
+    const char* const itEnd = it + strNorm.size();
+
+    std::string key;
+    key.reserve(strNorm.size() + 2);
+
+    while (it != itEnd) //"nothing" before "something": std::string comparison puts a prefix first
+        if (isWhiteSpace(*it))
+        {
+            key += '\x01'; //whitespace before numbers before text
+            ++it;
+            while (it != itEnd && isWhiteSpace(*it)) ++it;
+        }
+        else if (isDigit(*it))
+        {
+            while (it != itEnd && *it == '0') ++it;
+            const char* const digitsBegin = it;
+            while (it != itEnd && isDigit(*it)) ++it;
+
+            //more digits means bigger number; same number of digits: compare from left
+            const uint32_t digitCount = static_cast<uint32_t>(it - digitsBegin);
+            key += '\x02';
+            for (int shift = 24; shift >= 0; shift -= 8) //big endian
+                key += static_cast<char>((digitCount >> shift) & 0xff);
+            key.append(digitsBegin, it);
+        }
+        else
+        {
+            const char* const textBegin = it++;
+            while (it != itEnd && !isWhiteSpace(*it) && !isDigit(*it)) ++it;
+
+            key += '\x03';
+            impl::UtfDecoder<char> dec(textBegin, it - textBegin);
+            while (const std::optional<CodePoint> cp = dec.getNext())
+                impl::codePointToUtf<char>(toUpperSimple(*cp), [&](char c) { key += c; }); //UTF-8 byte order == code point order
+            key += '\0'; //shorter text first: upper-case code point is never 0
+        }
+    return key;
+}
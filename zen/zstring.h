@@ -27,11 +27,16 @@ using Zstringw = zen::Zbase<wchar_t>;
 // - different UTF-8 encoding length of upper-case chars
 // - different number of upper case chars (e.g. "" => "SS" on macOS)
 // - output is Unicode-normalized
+// - simple (1:1) upper case mapping, independent from locale
 Zstring makeUpperCopy(const Zstring& str);
 
 //Windows, Linux: precomposed
 //macOS: decomposed
 Zstring getUnicodeNormalForm(const Zstring& str);
+
+//perf: write into caller-provided buffer => reuse memory when converting many items in a row
+void makeUpperCopy       (const Zstring& str, Zstring& output);
+void getUnicodeNormalForm(const Zstring& str, Zstring& output);
 //	"In fact, Unicode declares that there is an equivalence relationship between decomposed and composed sequences, 
 //	and conformant software should not treat canonically equivalent sequences, whether composed or decomposed or something inbetween, as different."
 //																							http://www.win.tue.nl/~aeb/linux/uc/nfc_vs_nfd.html
@@ -67,6 +72,10 @@ struct LessNativePath { bool operator()(const Zstring& lhs, const Zstring& rhs)
 int compareNatural(const Zstring& lhs, const Zstring& rhs);
 
 struct LessNaturalSort { bool operator()(const Zstring& lhs, const Zstring rhs) const { return compareNatural(lhs, rhs) < 0; } };
+
+//binary sort key: "getNaturalSortKey(lhs) < getNaturalSortKey(rhs)" <=> "compareNatural(lhs, rhs) < 0"
+//=> perf: normalize + convert case only once per item when sorting large lists
+std::string getNaturalSortKey(const Zstring& str);
 //------------------------------------------------------------------------------------------
 
 
@@ -236,6 +236,10 @@ public:
     */
     std::pair<AttrIter, AttrIter> getAttributes() const { return { attributes_.begin(), attributes_.end() }; }
 
+    //direct access without string conversion, e.g. for serialization  -> disabled documentation extraction
+    const std::string& getNameRef () const { return name_;  }
+    const std::string& getValueRef() const { return value_; }
+
     //swap two elements while keeping references to parent.  -> disabled documentation extraction
     void swapSubtree(XmlElement& other) noexcept
     {
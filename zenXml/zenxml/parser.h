@@ -9,6 +9,7 @@
 
 #include <cstdio>
 #include <cstddef> //ptrdiff_t; req. on Linux
+#include <string_view>
 #include <zen/string_tools.h>
 #include "dom.h"
 
@@ -50,6 +51,27 @@ struct XmlParsingError
 */
 XmlDoc parseXml(const std::string& stream); //throw XmlParsingError
 
+///Load XML byte stream without building a document object model (SAX-style)
+/**
+\tparam Handler Receives the XML structure in document order:
+\code
+struct MyHandler
+{
+    void onDeclaration (std::string_view name, std::string_view value); //e.g. version="1.0" encoding="utf-8"
+    void onElementBegin(std::string_view name);
+    void onAttribute   (std::string_view name, std::string_view value);
+    void onElementValue(std::string_view value); //value elements only
+    void onElementEnd();
+};
+\endcode
+All strings are fully decoded (entities, line breaks), but only valid during the callback: they refer to the input stream or an internal buffer.
+\param stream Input byte stream
+\param handler Receives the parsing events
+\throw XmlParsingError
+*/
+template <class Handler>
+void parseXml(std::string_view stream, Handler& handler); //throw XmlParsingError
+
 
 
 
@@ -74,59 +96,88 @@ XmlDoc parseXml(const std::string& stream); //throw XmlParsingError
 
 namespace xml_impl
 {
-template <class Predicate> inline
-std::string normalize(const std::string& str, Predicate pred) //pred: unary function taking a char, return true if value shall be encoded as hex
+//append "str" to "output": findEscape(first, last) returns position of next char to be normalized (= escaped)
+template <class FindEscape> inline
+void normalize(std::string_view str, std::string& output, FindEscape findEscape)
 {
-    std::string output;
-    for (const char c : str)
+    for (const char* it = str.data(), * const itEnd = str.data() + str.size();;)
     {
+        const char* const itEsc = findEscape(it, itEnd);
+        output.append(it, itEsc); //perf: copy non-escaped chars as a block
+        if (itEsc == itEnd)
+            return;
+
+        const char c = *itEsc;
+        it = itEsc + 1;
+
         if (c == '&')      //
             output += "&amp;";
         else if (c == '<') //normalization mandatory: http://www.w3.org/TR/xml/#syntax
             output += "&lt;";
         else if (c == '>') //
             output += "&gt;";
-        else if (pred(c))
+        else if (c == '\'')
+            output += "&apos;";
+        else if (c == '"')
+            output += "&quot;";
+        else
         {
-            if (c == '\'')
-                output += "&apos;";
-            else if (c == '"')
-                output += "&quot;";
-            else
-            {
-                output += "&#x";
-                const auto hexDigits = hexify(c);
-                output += hexDigits.first;
-                output += hexDigits.second;
-                output += ';';
-            }
+            output += "&#x";
+            const auto hexDigits = hexify(c);
+            output += hexDigits.first;
+            output += hexDigits.second;
+            output += ';';
         }
-        else
-            output += c;
     }
-    return output;
 }
 
-inline
-std::string normalizeName(const std::string& str)
-{
-    const std::string nameFmt = normalize(str, [](char c) { return isWhiteSpace(c) || c == '=' || c == '/' || c == '\'' || c == '"'; });
-    assert(!nameFmt.empty());
-    return nameFmt;
-}
 
-inline
-std::string normalizeElementValue(const std::string& str)
+//perf: check 16 chars at a time: element and attribute values make up most of the document
+template <bool escapeQuotes> inline
+const char* findValueEscape(const char* first, const char* last)
 {
-    return normalize(str, [](char c) { return static_cast<unsigned char>(c) < 32; });
+#ifdef __SSE2__
+    const __m128i maxControlChar = ::_mm_set1_epi8(31);
+    for (; last - first >= 16; first += 16)
+    {
+        const __m128i chars = ::_mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+
+        __m128i escapeChars = ::_mm_cmpeq_epi8(::_mm_max_epu8(chars, maxControlChar), maxControlChar); //unsigned: c < 32
+        escapeChars = ::_mm_or_si128(escapeChars, ::_mm_cmpeq_epi8(chars, ::_mm_set1_epi8('&')));
+        escapeChars = ::_mm_or_si128(escapeChars, ::_mm_cmpeq_epi8(chars, ::_mm_set1_epi8('<')));
+        escapeChars = ::_mm_or_si128(escapeChars, ::_mm_cmpeq_epi8(chars, ::_mm_set1_epi8('>')));
+        if constexpr (escapeQuotes)
+        {
+            escapeChars = ::_mm_or_si128(escapeChars, ::_mm_cmpeq_epi8(chars, ::_mm_set1_epi8('\'')));
+            escapeChars = ::_mm_or_si128(escapeChars, ::_mm_cmpeq_epi8(chars, ::_mm_set1_epi8('"')));
+        }
+        if (const int escapeMask = ::_mm_movemask_epi8(escapeChars); escapeMask != 0)
+            return first + __builtin_ctz(escapeMask);
+    }
+#endif
+    return std::find_if(first, last, [](char c)
+    {
+        return static_cast<unsigned char>(c) < 32 || c == '&' || c == '<' || c == '>' || (escapeQuotes && (c == '\'' || c == '"'));
+    });
 }
 
+
 inline
-std::string normalizeAttribValue(const std::string& str)
+void normalizeName(std::string_view str, std::string& output)
 {
-    return normalize(str, [](char c) { return static_cast<unsigned char>(c) < 32 || c == '\'' || c == '"'; });
+    assert(!str.empty());
+    normalize(str, output, [](const char* first, const char* last)
+    {
+        return std::find_if(first, last, [](char c)
+        {
+            return c == '&' || c == '<' || c == '>' || isWhiteSpace(c) || c == '=' || c == '/' || c == '\'' || c == '"';
+        });
+    });
 }
 
+inline void normalizeElementValue(std::string_view str, std::string& output) { normalize(str, output, findValueEscape<false>); }
+inline void normalizeAttribValue (std::string_view str, std::string& output) { normalize(str, output, findValueEscape<true >); }
+
 
 template <class CharIterator, size_t N> inline
 bool checkEntity(CharIterator& first, CharIterator last, const char (&placeholder)[N])
@@ -144,9 +195,13 @@ bool checkEntity(CharIterator& first, CharIterator last, const char (&placeholde
 
 namespace
 {
-std::string denormalize(const std::string& str)
+//perf: return "str" as is if nothing needs to be denormalized (= the common case), otherwise write to "buf"
+std::string_view denormalize(std::string_view str, std::string& buf)
 {
-    std::string output;
+    if (str.find_first_of("&\r") == std::string_view::npos)
+        return str;
+
+    buf.clear();
     for (auto it = str.begin(); it != str.end(); ++it)
     {
         const char c = *it;
@@ -154,15 +209,15 @@ std::string denormalize(const std::string& str)
         if (c == '&')
         {
             if (checkEntity(it, str.end(), "&amp;"))
-                output += '&';
+                buf += '&';
             else if (checkEntity(it, str.end(), "&lt;"))
-                output += '<';
+                buf += '<';
             else if (checkEntity(it, str.end(), "&gt;"))
-                output += '>';
+                buf += '>';
             else if (checkEntity(it, str.end(), "&apos;"))
-                output += '\'';
+                buf += '\'';
             else if (checkEntity(it, str.end(), "&quot;"))
-                output += '"';
+                buf += '"';
             else if (str.end() - it >= 6 &&
                      it[1] == '#' &&
                      it[2] == 'x' &&
@@ -170,23 +225,48 @@ std::string denormalize(const std::string& str)
                      isHexDigit(it[4]) &&
                      it[5] == ';')
             {
-                output += unhexify(it[3], it[4]);
+                buf += unhexify(it[3], it[4]);
                 it += 5;
             }
             else
-                output += c; //unexpected char!
+                buf += c; //unexpected char!
         }
         else if (c == '\r') //map all end-of-line characters to \n http://www.w3.org/TR/xml/#sec-line-ends
         {
             auto itNext = it + 1;
             if (itNext != str.end() && *itNext == '\n')
                 ++it;
-            output += '\n';
+            buf += '\n';
         }
         else
-            output += c;
+            buf += c;
     }
-    return output;
+    return buf;
+}
+
+
+//perf: reserve output buffer up front (ignoring escape sequences)
+size_t getSerializedSize(const XmlElement& element, size_t lineBreakLen, size_t indentLen, size_t indentLevel)
+{
+    const size_t nameLen = element.getNameRef().size();
+    size_t bytes = indentLen * indentLevel + 1 + nameLen;
+
+    auto attr = element.getAttributes();
+    for (auto it = attr.first; it != attr.second; ++it)
+        bytes += 4 + it->name.size() + it->value.size();
+
+    auto iterPair = element.getChildren();
+    if (iterPair.first != iterPair.second) //structured element
+    {
+        bytes += 1 + lineBreakLen + indentLen * indentLevel + 3 + nameLen + lineBreakLen;
+        std::for_each(iterPair.first, iterPair.second,
+        [&](const XmlElement& el) { bytes += getSerializedSize(el, lineBreakLen, indentLen, indentLevel + 1); });
+    }
+    else if (!element.getValueRef().empty()) //value element
+        bytes += 1 + element.getValueRef().size() + 2 + nameLen + 1 + lineBreakLen;
+    else //empty element
+        bytes += 2 + lineBreakLen;
+    return bytes;
 }
 
 
@@ -195,39 +275,59 @@ void serialize(const XmlElement& element, std::string& stream,
                const std::string& indent,
                size_t indentLevel)
 {
-    const std::string& nameFmt = normalizeName(element.getNameAs<std::string>());
+    const std::string& name = element.getNameRef();
 
     for (size_t i = 0; i < indentLevel; ++i)
         stream += indent;
 
-    stream += '<' + nameFmt;
+    stream += '<';
+    normalizeName(name, stream);
 
     auto attr = element.getAttributes();
     for (auto it = attr.first; it != attr.second; ++it)
-        stream += ' ' + normalizeName(it->name) + "=\"" + normalizeAttribValue(it->value) + '"';
+    {
+        stream += ' ';
+        normalizeName(it->name, stream);
+        stream += "=\"";
+        normalizeAttribValue(it->value, stream);
+        stream += '"';
+    }
 
     auto iterPair = element.getChildren();
     if (iterPair.first != iterPair.second) //structured element
     {
         //no support for mixed-mode content
-        stream += '>' + lineBreak;
+        stream += '>';
+        stream += lineBreak;
 
         std::for_each(iterPair.first, iterPair.second,
         [&](const XmlElement& el) { serialize(el, stream, lineBreak, indent, indentLevel + 1); });
 
         for (size_t i = 0; i < indentLevel; ++i)
             stream += indent;
-        stream += "</" + nameFmt + '>' + lineBreak;
+        stream += "</";
+        normalizeName(name, stream);
+        stream += '>';
+        stream += lineBreak;
     }
     else
     {
-        std::string value;
-        element.getValue(value);
+        const std::string& value = element.getValueRef();
 
         if (!value.empty()) //value element
-            stream += '>' + normalizeElementValue(value) + "</" + nameFmt + '>' + lineBreak;
+        {
+            stream += '>';
+            normalizeElementValue(value, stream);
+            stream += "</";
+            normalizeName(name, stream);
+            stream += '>';
+            stream += lineBreak;
+        }
         else //empty element
-            stream += "/>" + lineBreak;
+        {
+            stream += "/>";
+            stream += lineBreak;
+        }
     }
 }
 }
@@ -238,19 +338,28 @@ std::string serializeXml(const XmlDoc& doc,
                          const std::string& lineBreak,
                          const std::string& indent)
 {
-    std::string version = doc.getVersionAs<std::string>();
-    if (!version.empty())
-        version = " version=\"" + xml_impl::normalizeAttribValue(version) + '"';
+    std::string output;
+    output.reserve(100 + xml_impl::getSerializedSize(doc.root(), lineBreak.size(), indent.size(), 0));
 
-    std::string encoding = doc.getEncodingAs<std::string>();
-    if (!encoding.empty())
-        encoding = " encoding=\"" + xml_impl::normalizeAttribValue(encoding) + '"';
+    auto addDeclAttribute = [&](const char* name, const std::string& value)
+    {
+        if (!value.empty())
+        {
+            output += ' ';
+            output += name;
+            output += "=\"";
+            xml_impl::normalizeAttribValue(value, output);
+            output += '"';
+        }
+    };
 
-    std::string standalone = doc.getStandaloneAs<std::string>();
-    if (!standalone.empty())
-        standalone = " standalone=\"" + xml_impl::normalizeAttribValue(standalone) + '"';
+    output += "<?xml";
+    addDeclAttribute("version",    doc.getVersionAs   <std::string>());
+    addDeclAttribute("encoding",   doc.getEncodingAs  <std::string>());
+    addDeclAttribute("standalone", doc.getStandaloneAs<std::string>());
+    output += "?>";
+    output += lineBreak;
 
-    std::string output = "<?xml" + version + encoding + standalone + "?>" + lineBreak;
     xml_impl::serialize(doc.root(), output, lineBreak, indent, 0);
     return output;
 }
@@ -298,48 +407,67 @@ struct Token
     };
 
     Token(Type t) : type(t) {}
-    Token(const std::string& txt) : type(TK_NAME), name(txt) {}
+    Token(std::string_view txt) : type(TK_NAME), name(txt) {}
 
     Type type;
-    std::string name; //filled if type == TK_NAME
+    std::string_view name; //filled if type == TK_NAME; *not* yet denormalized; refers to input stream
 };
 
-class Scanner
+
+class Scanner //zero-copy: references the input stream, which must outlive the scanner
 {
 public:
-    Scanner(const std::string& stream) : stream_(stream), pos_(stream_.begin())
+    Scanner(std::string_view stream) : first_(stream.data()), last_(first_ + stream.size()), pos_(first_)
     {
-        if (zen::startsWith(stream_, BYTE_ORDER_MARK_UTF8))
+        if (stream.substr(0, strLength(BYTE_ORDER_MARK_UTF8)) == BYTE_ORDER_MARK_UTF8)
             pos_ += strLength(BYTE_ORDER_MARK_UTF8);
     }
 
     Token getNextToken() //throw XmlParsingError
     {
-        //skip whitespace
-        pos_ = std::find_if_not(pos_, stream_.end(), isWhiteSpace<char>);
-
-        if (pos_ == stream_.end())
-            return Token::TK_END;
-
-        //skip XML comments
-        if (startsWith(xmlCommentBegin_))
+        for (;;)
         {
-            auto it = std::search(pos_ + xmlCommentBegin_.size(), stream_.end(), xmlCommentEnd_.begin(), xmlCommentEnd_.end());
-            if (it != stream_.end())
-            {
-                pos_ = it + xmlCommentEnd_.size();
-                return getNextToken(); //throw XmlParsingError
-            }
+            //skip whitespace
+            pos_ = std::find_if_not(pos_, last_, isWhiteSpace<char>);
+
+            if (pos_ == last_)
+                return Token::TK_END;
+
+            //skip XML comments
+            if (!startsWith("<!--"))
+                break;
+            const char* const it = std::search(pos_ + 4, last_, XML_COMMENT_END, XML_COMMENT_END + 3);
+            if (it == last_)
+                break;
+            pos_ = it + 3;
         }
 
-        for (auto it = tokens_.begin(); it != tokens_.end(); ++it)
-            if (startsWith(it->first))
-            {
-                pos_ += it->first.size();
-                return it->second;
-            }
+        switch (*pos_) //perf: dispatch on first char instead of testing all tokens
+        {
+            case '<':
+                if (startsWith("<?xml"))
+                    return consume(5, Token::TK_DECL_BEGIN);
+                if (startsWith("</"))
+                    return consume(2, Token::TK_LESS_SLASH);
+                return consume(1, Token::TK_LESS);
+            case '?':
+                if (startsWith("?>"))
+                    return consume(2, Token::TK_DECL_END);
+                break;
+            case '/':
+                if (startsWith("/>"))
+                    return consume(2, Token::TK_SLASH_GREATER);
+                break;
+            case '>':
+                return consume(1, Token::TK_GREATER);
+            case '=':
+                return consume(1, Token::TK_EQUAL);
+            case '"':
+            case '\'':
+                return consume(1, Token::TK_QUOTE);
+        }
 
-        const auto itNameEnd = std::find_if(pos_, stream_.end(), [](char c)
+        const char* const itNameEnd = std::find_if(pos_, last_, [](char c)
         {
             return c == '<'  ||
                    c == '>'  ||
@@ -352,45 +480,45 @@ public:
 
         if (itNameEnd != pos_)
         {
-            std::string name(pos_, itNameEnd);
+            const std::string_view name = makeView(pos_, itNameEnd);
             pos_ = itNameEnd;
-            return denormalize(name);
+            return name;
         }
 
         //unknown token
         throw XmlParsingError(posRow(), posCol());
     }
 
-    std::string extractElementValue()
+    std::string_view extractElementValue() //not yet denormalized!
     {
-        auto it = std::find_if(pos_, stream_.end(), [](char c)
+        const char* const it = std::find_if(pos_, last_, [](char c)
         {
             return c == '<'  ||
                    c == '>';
         });
-        std::string output(pos_, it);
+        const std::string_view output = makeView(pos_, it);
         pos_ = it;
-        return denormalize(output);
+        return output;
     }
 
-    std::string extractAttributeValue()
+    std::string_view extractAttributeValue() //not yet denormalized!
     {
-        auto it = std::find_if(pos_, stream_.end(), [](char c)
+        const char* const it = std::find_if(pos_, last_, [](char c)
         {
             return c == '<'  ||
                    c == '>'  ||
                    c == '\'' ||
                    c == '"';
         });
-        std::string output(pos_, it);
+        const std::string_view output = makeView(pos_, it);
         pos_ = it;
-        return denormalize(output);
+        return output;
     }
 
     size_t posRow() const //current row beginning with 0
     {
-        const size_t crSum = std::count(stream_.begin(), pos_, '\r'); //carriage returns
-        const size_t nlSum = std::count(stream_.begin(), pos_, '\n'); //new lines
+        const size_t crSum = std::count(first_, pos_, '\r'); //carriage returns
+        const size_t nlSum = std::count(first_, pos_, '\n'); //new lines
         assert(crSum == 0 || nlSum == 0 || crSum == nlSum);
         return std::max(crSum, nlSum); //be compatible with Linux/Mac/Win
     }
@@ -398,154 +526,128 @@ public:
     size_t posCol() const //current col beginning with 0
     {
         //seek beginning of line
-        for (auto it = pos_; it != stream_.begin(); )
+        for (const char* it = pos_; it != first_; )
         {
             --it;
             if (*it == '\r' || *it == '\n')
                 return pos_ - it - 1;
         }
-        return pos_ - stream_.begin();
+        return pos_ - first_;
     }
 
 private:
     Scanner           (const Scanner&) = delete;
     Scanner& operator=(const Scanner&) = delete;
 
-    bool startsWith(const std::string& prefix) const
+    template <size_t N>
+    bool startsWith(const char (&prefix)[N]) const
     {
-        return zen::startsWith(StringRef<const char>(pos_, stream_.end()), prefix);
+        return static_cast<size_t>(last_ - pos_) >= N - 1 && std::equal(prefix, prefix + N - 1, pos_);
     }
 
-    using TokenList = std::vector<std::pair<std::string, Token::Type>>;
-    const TokenList tokens_
+    Token consume(size_t len, Token::Type t)
     {
-        { "<?xml", Token::TK_DECL_BEGIN    },
-        { "?>",    Token::TK_DECL_END      },
-        { "</",    Token::TK_LESS_SLASH    },
-        { "/>",    Token::TK_SLASH_GREATER },
-        { "<",     Token::TK_LESS          }, //evaluate after TK_DECL_BEGIN!
-        { ">",     Token::TK_GREATER       },
-        { "=",     Token::TK_EQUAL         },
-        { "\"",    Token::TK_QUOTE         },
-        { "\'",    Token::TK_QUOTE         },
-    };
+        pos_ += len;
+        return t;
+    }
+
+    static std::string_view makeView(const char* first, const char* last) { return std::string_view(first, last - first); }
 
-    const std::string xmlCommentBegin_ = "<!--";
-    const std::string xmlCommentEnd_   = "-->";
+    static constexpr char XML_COMMENT_END[] = "-->";
 
-    const std::string stream_;
-    std::string::const_iterator pos_;
+    const char* const first_;
+    const char* const last_;
+    const char* pos_;
 };
 
 
+template <class Handler>
 class XmlParser
 {
 public:
-    XmlParser(const std::string& stream) :
+    XmlParser(std::string_view stream, Handler& handler) :
         scn_(stream),
-        tk_(scn_.getNextToken()) {} //throw XmlParsingError
+        tk_(scn_.getNextToken()), //throw XmlParsingError
+        handler_(handler) {}
 
-    XmlDoc parse() //throw XmlParsingError
+    void parse() //throw XmlParsingError
     {
-        XmlDoc doc;
-
         //declaration (optional)
         if (token().type == Token::TK_DECL_BEGIN)
         {
             nextToken(); //throw XmlParsingError
-
-            while (token().type == Token::TK_NAME)
-            {
-                std::string attribName = token().name;
-                nextToken(); //throw XmlParsingError
-
-                consumeToken(Token::TK_EQUAL); //throw XmlParsingError
-                expectToken (Token::TK_QUOTE); //
-                std::string attribValue = scn_.extractAttributeValue();
-                nextToken(); //throw XmlParsingError
-
-                consumeToken(Token::TK_QUOTE); //throw XmlParsingError
-
-                if (attribName == "version")
-                    doc.setVersion(attribValue);
-                else if (attribName == "encoding")
-                    doc.setEncoding(attribValue);
-                else if (attribName == "standalone")
-                    doc.setStandalone(attribValue);
-            }
+            parseAttributes([&](std::string_view attribName, std::string_view attribValue) { handler_.onDeclaration(attribName, attribValue); });
             consumeToken(Token::TK_DECL_END); //throw XmlParsingError
         }
 
-        XmlElement dummy;
-        parseChildElements(dummy);
-
-        auto itPair = dummy.getChildren();
-        if (itPair.first != itPair.second)
-            doc.root().swapSubtree(*itPair.first);
+        parseChildElements(); //throw XmlParsingError
 
         expectToken(Token::TK_END); //throw XmlParsingError
-        return doc;
     }
 
 private:
     XmlParser           (const XmlParser&) = delete;
     XmlParser& operator=(const XmlParser&) = delete;
 
-    void parseChildElements(XmlElement& parent)
+    void parseChildElements() //throw XmlParsingError
     {
         while (token().type == Token::TK_LESS)
         {
             nextToken(); //throw XmlParsingError
 
             expectToken(Token::TK_NAME); //throw XmlParsingError
-            std::string elementName = token().name;
+            const std::string_view elementName = token().name; //refers to input stream: stays valid
             nextToken(); //throw XmlParsingError
 
-            XmlElement& newElement = parent.addChild(elementName);
+            handler_.onElementBegin(denormalize(elementName, bufName_));
 
-            parseAttributes(newElement);
+            parseAttributes([&](std::string_view attribName, std::string_view attribValue) { handler_.onAttribute(attribName, attribValue); });
 
             if (token().type == Token::TK_SLASH_GREATER) //empty element
             {
                 nextToken(); //throw XmlParsingError
+                handler_.onElementEnd();
                 continue;
             }
 
             expectToken(Token::TK_GREATER); //throw XmlParsingError
-            std::string elementValue = scn_.extractElementValue();
+            const std::string_view elementValue = scn_.extractElementValue();
             nextToken(); //throw XmlParsingError
 
             //no support for mixed-mode content
             if (token().type == Token::TK_LESS) //structure-element
-                parseChildElements(newElement);
+                parseChildElements(); //throw XmlParsingError
             else                                //value-element
-                newElement.setValue(elementValue);
+                handler_.onElementValue(denormalize(elementValue, bufValue_));
 
             consumeToken(Token::TK_LESS_SLASH); //throw XmlParsingError
 
             expectToken(Token::TK_NAME); //throw XmlParsingError
-            if (token().name != elementName)
+            if (token().name != elementName &&
+                denormalize(token().name, bufName_) != denormalize(elementName, bufValue_))
                 throw XmlParsingError(scn_.posRow(), scn_.posCol());
             nextToken(); //throw XmlParsingError
 
             consumeToken(Token::TK_GREATER); //throw XmlParsingError
+            handler_.onElementEnd();
         }
     }
 
-    void parseAttributes(XmlElement& element)
+    template <class Function>
+    void parseAttributes(Function onAttribute) //throw XmlParsingError
     {
         while (token().type == Token::TK_NAME)
         {
-            std::string attribName = token().name;
+            const std::string_view attribName = token().name;
             nextToken(); //throw XmlParsingError
 
             consumeToken(Token::TK_EQUAL); //throw XmlParsingError
             expectToken (Token::TK_QUOTE); //
-            std::string attribValue = scn_.extractAttributeValue();
+            const std::string_view attribValue = scn_.extractAttributeValue();
             nextToken(); //throw XmlParsingError
 
             consumeToken(Token::TK_QUOTE); //throw XmlParsingError
-            element.setAttribute(attribName, attribValue);
+            onAttribute(denormalize(attribName, bufName_), denormalize(attribValue, bufValue_));
         }
     }
 
@@ -567,13 +669,74 @@ private:
 
     Scanner scn_;
     Token tk_;
+    Handler& handler_;
+
+    std::string bufName_;  //reuse memory for the (rare) strings that need denormalization
+    std::string bufValue_; //
 };
+
+
+class DomBuilder
+{
+public:
+    explicit DomBuilder(XmlDoc& doc) : doc_(doc) {}
+
+    void onDeclaration(std::string_view name, std::string_view value)
+    {
+        if (name == "version")
+            doc_.setVersion(std::string(value));
+        else if (name == "encoding")
+            doc_.setEncoding(std::string(value));
+        else if (name == "standalone")
+            doc_.setStandalone(std::string(value));
+    }
+
+    void onElementBegin(std::string_view name)
+    {
+        XmlElement& parent = elementStack_.empty() ? dummy_ : *elementStack_.back();
+        elementStack_.push_back(&parent.addChild(std::string(name)));
+    }
+
+    void onAttribute(std::string_view name, std::string_view value) { elementStack_.back()->setAttribute(std::string(name), std::string(value)); }
+
+    void onElementValue(std::string_view value) { elementStack_.back()->setValue(std::string(value)); }
+
+    void onElementEnd() { elementStack_.pop_back(); }
+
+    void finalize()
+    {
+        assert(elementStack_.empty());
+        auto itPair = dummy_.getChildren();
+        if (itPair.first != itPair.second)
+            doc_.root().swapSubtree(*itPair.first);
+    }
+
+private:
+    DomBuilder           (const DomBuilder&) = delete;
+    DomBuilder& operator=(const DomBuilder&) = delete;
+
+    XmlDoc& doc_;
+    XmlElement dummy_;
+    std::vector<XmlElement*> elementStack_;
+};
+}
+
+
+template <class Handler> inline
+void parseXml(std::string_view stream, Handler& handler) //throw XmlParsingError
+{
+    xml_impl::XmlParser<Handler>(stream, handler).parse(); //throw XmlParsingError
 }
 
+
 inline
 XmlDoc parseXml(const std::string& stream) //throw XmlParsingError
 {
-    return xml_impl::XmlParser(stream).parse(); //throw XmlParsingError
+    XmlDoc doc;
+    xml_impl::DomBuilder builder(doc);
+    parseXml(std::string_view(stream), builder); //throw XmlParsingError
+    builder.finalize();
+    return doc;
 }
 }
 
@@ -0,0 +1,518 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+/* Standalone benchmark: zero-copy SAX-style parser vs the former token-based DOM parser
+
+    - input: synthetic document shaped like GlobalSettings.xml with a long config and folder history
+    - "legacy DOM":  previous Scanner/XmlParser (one std::string per token, denormalize() per name/value)
+    - "DOM":         parseXml(const std::string&) => SAX parser + DomBuilder
+    - "SAX":         parseXml(std::string_view, Handler&) with a handler that only counts events
+
+    build + run: make benchmark_xml (FreeFileSync/Source/Makefile)               */
+
+#include <cstdlib>
+#include <iostream>
+#include <zen/perf.h>
+#include "cvrt_struc.h"
+#include "parser.h"
+
+using namespace zen;
+
+
+namespace
+{
+//============ former parser (zenXml before the SAX rewrite), kept verbatim for comparison =============
+namespace legacy
+{
+using xml_impl::checkEntity;
+
+
+std::string denormalize(const std::string& str)
+{
+    std::string output;
+    for (auto it = str.begin(); it != str.end(); ++it)
+    {
+        const char c = *it;
+
+        if (c == '&')
+        {
+            if (checkEntity(it, str.end(), "&amp;"))
+                output += '&';
+            else if (checkEntity(it, str.end(), "&lt;"))
+                output += '<';
+            else if (checkEntity(it, str.end(), "&gt;"))
+                output += '>';
+            else if (checkEntity(it, str.end(), "&apos;"))
+                output += '\'';
+            else if (checkEntity(it, str.end(), "&quot;"))
+                output += '"';
+            else if (str.end() - it >= 6 &&
+                     it[1] == '#' &&
+                     it[2] == 'x' &&
+                     isHexDigit(it[3]) &&
+                     isHexDigit(it[4]) &&
+                     it[5] == ';')
+            {
+                output += unhexify(it[3], it[4]);
+                it += 5;
+            }
+            else
+                output += c; //unexpected char!
+        }
+        else if (c == '\r') //map all end-of-line characters to \n http://www.w3.org/TR/xml/#sec-line-ends
+        {
+            auto itNext = it + 1;
+            if (itNext != str.end() && *itNext == '\n')
+                ++it;
+            output += '\n';
+        }
+        else
+            output += c;
+    }
+    return output;
+}
+
+
+struct Token
+{
+    enum Type
+    {
+        TK_LESS,
+        TK_GREATER,
+        TK_LESS_SLASH,
+        TK_SLASH_GREATER,
+        TK_EQUAL,
+        TK_QUOTE,
+        TK_DECL_BEGIN,
+        TK_DECL_END,
+        TK_NAME,
+        TK_END
+    };
+
+    Token(Type t) : type(t) {}
+    Token(const std::string& txt) : type(TK_NAME), name(txt) {}
+
+    Type type;
+    std::string name; //filled if type == TK_NAME
+};
+
+class Scanner
+{
+public:
+    Scanner(const std::string& stream) : stream_(stream), pos_(stream_.begin())
+    {
+        if (zen::startsWith(stream_, BYTE_ORDER_MARK_UTF8))
+            pos_ += strLength(BYTE_ORDER_MARK_UTF8);
+    }
+
+    Token getNextToken() //throw XmlParsingError
+    {
+        //skip whitespace
+        pos_ = std::find_if_not(pos_, stream_.end(), isWhiteSpace<char>);
+
+        if (pos_ == stream_.end())
+            return Token::TK_END;
+
+        //skip XML comments
+        if (startsWith(xmlCommentBegin_))
+        {
+            auto it = std::search(pos_ + xmlCommentBegin_.size(), stream_.end(), xmlCommentEnd_.begin(), xmlCommentEnd_.end());
+            if (it != stream_.end())
+            {
+                pos_ = it + xmlCommentEnd_.size();
+                return getNextToken(); //throw XmlParsingError
+            }
+        }
+
+        for (auto it = tokens_.begin(); it != tokens_.end(); ++it)
+            if (startsWith(it->first))
+            {
+                pos_ += it->first.size();
+                return it->second;
+            }
+
+        const auto itNameEnd = std::find_if(pos_, stream_.end(), [](char c)
+        {
+            return c == '<'  ||
+                   c == '>'  ||
+                   c == '='  ||
+                   c == '/'  ||
+                   c == '\'' ||
+                   c == '"'  ||
+                   isWhiteSpace(c);
+        });
+
+        if (itNameEnd != pos_)
+        {
+            std::string name(pos_, itNameEnd);
+            pos_ = itNameEnd;
+            return denormalize(name);
+        }
+
+        //unknown token
+        throw XmlParsingError(posRow(), posCol());
+    }
+
+    std::string extractElementValue()
+    {
+        auto it = std::find_if(pos_, stream_.end(), [](char c)
+        {
+            return c == '<'  ||
+                   c == '>';
+        });
+        std::string output(pos_, it);
+        pos_ = it;
+        return denormalize(output);
+    }
+
+    std::string extractAttributeValue()
+    {
+        auto it = std::find_if(pos_, stream_.end(), [](char c)
+        {
+            return c == '<'  ||
+                   c == '>'  ||
+                   c == '\'' ||
+                   c == '"';
+        });
+        std::string output(pos_, it);
+        pos_ = it;
+        return denormalize(output);
+    }
+
+    size_t posRow() const //current row beginning with 0
+    {
+        const size_t crSum = std::count(stream_.begin(), pos_, '\r'); //carriage returns
+        const size_t nlSum = std::count(stream_.begin(), pos_, '\n'); //new lines
+        assert(crSum == 0 || nlSum == 0 || crSum == nlSum);
+        return std::max(crSum, nlSum); //be compatible with Linux/Mac/Win
+    }
+
+    size_t posCol() const //current col beginning with 0
+    {
+        //seek beginning of line
+        for (auto it = pos_; it != stream_.begin(); )
+        {
+            --it;
+            if (*it == '\r' || *it == '\n')
+                return pos_ - it - 1;
+        }
+        return pos_ - stream_.begin();
+    }
+
+private:
+    Scanner           (const Scanner&) = delete;
+    Scanner& operator=(const Scanner&) = delete;
+
+    bool startsWith(const std::string& prefix) const
+    {
+        return zen::startsWith(StringRef<const char>(pos_, stream_.end()), prefix);
+    }
+
+    using TokenList = std::vector<std::pair<std::string, Token::Type>>;
+    const TokenList tokens_
+    {
+        { "<?xml", Token::TK_DECL_BEGIN    },
+        { "?>",    Token::TK_DECL_END      },
+        { "</",    Token::TK_LESS_SLASH    },
+        { "/>",    Token::TK_SLASH_GREATER },
+        { "<",     Token::TK_LESS          }, //evaluate after TK_DECL_BEGIN!
+        { ">",     Token::TK_GREATER       },
+        { "=",     Token::TK_EQUAL         },
+        { "\"",    Token::TK_QUOTE         },
+        { "\'",    Token::TK_QUOTE         },
+    };
+
+    const std::string xmlCommentBegin_ = "<!--";
+    const std::string xmlCommentEnd_   = "-->";
+
+    const std::string stream_;
+    std::string::const_iterator pos_;
+};
+
+
+class XmlParser
+{
+public:
+    XmlParser(const std::string& stream) :
+        scn_(stream),
+        tk_(scn_.getNextToken()) {} //throw XmlParsingError
+
+    XmlDoc parse() //throw XmlParsingError
+    {
+        XmlDoc doc;
+
+        //declaration (optional)
+        if (token().type == Token::TK_DECL_BEGIN)
+        {
+            nextToken(); //throw XmlParsingError
+
+            while (token().type == Token::TK_NAME)
+            {
+                std::string attribName = token().name;
+                nextToken(); //throw XmlParsingError
+
+                consumeToken(Token::TK_EQUAL); //throw XmlParsingError
+                expectToken (Token::TK_QUOTE); //
+                std::string attribValue = scn_.extractAttributeValue();
+                nextToken(); //throw XmlParsingError
+
+                consumeToken(Token::TK_QUOTE); //throw XmlParsingError
+
+                if (attribName == "version")
+                    doc.setVersion(attribValue);
+                else if (attribName == "encoding")
+                    doc.setEncoding(attribValue);
+                else if (attribName == "standalone")
+                    doc.setStandalone(attribValue);
+            }
+            consumeToken(Token::TK_DECL_END); //throw XmlParsingError
+        }
+
+        XmlElement dummy;
+        parseChildElements(dummy);
+
+        auto itPair = dummy.getChildren();
+        if (itPair.first != itPair.second)
+            doc.root().swapSubtree(*itPair.first);
+
+        expectToken(Token::TK_END); //throw XmlParsingError
+        return doc;
+    }
+
+private:
+    XmlParser           (const XmlParser&) = delete;
+    XmlParser& operator=(const XmlParser&) = delete;
+
+    void parseChildElements(XmlElement& parent)
+    {
+        while (token().type == Token::TK_LESS)
+        {
+            nextToken(); //throw XmlParsingError
+
+            expectToken(Token::TK_NAME); //throw XmlParsingError
+            std::string elementName = token().name;
+            nextToken(); //throw XmlParsingError
+
+            XmlElement& newElement = parent.addChild(elementName);
+
+            parseAttributes(newElement);
+
+            if (token().type == Token::TK_SLASH_GREATER) //empty element
+            {
+                nextToken(); //throw XmlParsingError
+                continue;
+            }
+
+            expectToken(Token::TK_GREATER); //throw XmlParsingError
+            std::string elementValue = scn_.extractElementValue();
+            nextToken(); //throw XmlParsingError
+
+            //no support for mixed-mode content
+            if (token().type == Token::TK_LESS) //structure-element
+                parseChildElements(newElement);
+            else                                //value-element
+                newElement.setValue(elementValue);
+
+            consumeToken(Token::TK_LESS_SLASH); //throw XmlParsingError
+
+            expectToken(Token::TK_NAME); //throw XmlParsingError
+            if (token().name != elementName)
+                throw XmlParsingError(scn_.posRow(), scn_.posCol());
+            nextToken(); //throw XmlParsingError
+
+            consumeToken(Token::TK_GREATER); //throw XmlParsingError
+        }
+    }
+
+    void parseAttributes(XmlElement& element)
+    {
+        while (token().type == Token::TK_NAME)
+        {
+            std::string attribName = token().name;
+            nextToken(); //throw XmlParsingError
+
+            consumeToken(Token::TK_EQUAL); //throw XmlParsingError
+            expectToken (Token::TK_QUOTE); //
+            std::string attribValue = scn_.extractAttributeValue();
+            nextToken(); //throw XmlParsingError
+
+            consumeToken(Token::TK_QUOTE); //throw XmlParsingError
+            element.setAttribute(attribName, attribValue);
+        }
+    }
+
+    const Token& token() const { return tk_; }
+
+    void nextToken() { tk_ = scn_.getNextToken(); } //throw XmlParsingError
+
+    void expectToken(Token::Type t) //throw XmlParsingError
+    {
+        if (token().type != t)
+            throw XmlParsingError(scn_.posRow(), scn_.posCol());
+    }
+
+    void consumeToken(Token::Type t) //throw XmlParsingError
+    {
+        expectToken(t); //throw XmlParsingError
+        nextToken();    //
+    }
+
+    Scanner scn_;
+    Token tk_;
+};
+}
+//======================================================================================================
+
+
+//roughly the layout of GlobalSettings.xml: a few option blocks + long config/folder histories
+std::string createGlobalSettingsDoc(size_t historyItems)
+{
+    XmlDoc doc("FreeFileSync");
+    XmlElement& root = doc.root();
+    root.setAttribute("XmlType", "GLOBAL");
+    root.setAttribute("XmlFormat", 14);
+
+    XmlElement& general = root.addChild("General");
+    general.addChild("Language").setAttribute("Name", "English (US)");
+    general.addChild("FailSafeFileCopy").setAttribute("Enabled", true);
+    general.addChild("CopyLockedFiles").setAttribute("Enabled", false);
+    general.addChild("FileTimeTolerance").setAttribute("Seconds", 2);
+    general.addChild("SoundFileSyncFinished").setAttribute("Path", "gong.wav");
+
+    XmlElement& externalApps = general.addChild("ExternalApps");
+    for (int i = 0; i < 5; ++i)
+    {
+        XmlElement& cmd = externalApps.addChild("Command");
+        cmd.setAttribute("Label", "Open with default application #" + numberTo<std::string>(i));
+        cmd.setValue("xdg-open \"%local_path%\" && echo 'done' < /dev/null");
+    }
+
+    XmlElement& gui = root.addChild("Gui");
+    XmlElement& mainDlg = gui.addChild("MainDialog");
+    mainDlg.setAttribute("Width", 1280);
+    mainDlg.setAttribute("Height", 800);
+    mainDlg.setAttribute("Maximized", false);
+
+    XmlElement& cfgHist = mainDlg.addChild("ConfigHistory");
+    cfgHist.setAttribute("MaxSize", historyItems);
+    for (size_t i = 0; i < historyItems; ++i)
+    {
+        XmlElement& item = cfgHist.addChild("Item");
+        item.setAttribute("LastSync", 1500000000 + i);
+        item.setAttribute("Result", "Success");
+        item.setAttribute("Log", "/home/zenju/.config/FreeFileSync/Logs/Job " + numberTo<std::string>(i) + " 2019-01-01 120000.123.html");
+        item.setValue("/home/zenju/Desktop/Sync & Backup/Job <" + numberTo<std::string>(i) + ">.ffs_batch");
+    }
+
+    XmlElement& folderHist = mainDlg.addChild("FolderHistory");
+    for (const char* side : { "Left", "Right" })
+    {
+        XmlElement& sideHist = folderHist.addChild(side);
+        for (size_t i = 0; i < historyItems; ++i)
+            sideHist.addChild("Item").setValue("/media/zenju/Backup Drive/Documents \"" + numberTo<std::string>(i) + "\"/Photos");
+    }
+
+    XmlElement& columns = mainDlg.addChild("FileGrid").addChild("ColumnsLeft");
+    for (const char* type : { "Base", "Full", "Rel", "Name", "Size", "Date", "Ext" })
+    {
+        XmlElement& col = columns.addChild("Column");
+        col.setAttribute("Type", type);
+        col.setAttribute("Visible", true);
+        col.setAttribute("Width", -1);
+    }
+
+    return serializeXml(doc, "\r\n", "    ");
+}
+
+
+struct CountingHandler
+{
+    void onDeclaration (std::string_view name, std::string_view value) { ++count; bytes += name.size() + value.size(); }
+    void onElementBegin(std::string_view name)                         { ++count; bytes += name.size(); }
+    void onAttribute   (std::string_view name, std::string_view value) { ++count; bytes += name.size() + value.size(); }
+    void onElementValue(std::string_view value)                        { ++count; bytes += value.size(); }
+    void onElementEnd()                                                { ++count; }
+
+    size_t count = 0;
+    size_t bytes = 0;
+};
+
+
+template <class Function>
+void runBenchmark(const char* name, size_t streamSize, int runs, Function fun)
+{
+    std::chrono::nanoseconds best = std::chrono::nanoseconds::max();
+    std::chrono::nanoseconds total{};
+
+    for (int i = 0; i < runs; ++i)
+    {
+        StopWatch watch;
+        fun();
+        const std::chrono::nanoseconds elapsed = watch.elapsed();
+
+        best = std::min(best, elapsed);
+        total += elapsed;
+    }
+
+    const double bestMs = std::chrono::duration<double, std::milli>(best).count();
+    const double meanMs = std::chrono::duration<double, std::milli>(total).count() / runs;
+
+    std::cout << name << "\tbest " << bestMs << " ms\tmean " << meanMs << " ms\t" <<
+              streamSize / (1024.0 * 1024) / (bestMs / 1000) << " MB/s\n";
+}
+}
+
+
+int main(int argc, char* argv[])
+{
+    const size_t historyItems = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 20000;
+    const int runs            = argc > 2 ? std::atoi   (argv[2])                : 10;
+
+    const std::string stream = createGlobalSettingsDoc(historyItems);
+
+    std::cout << "Document: " << historyItems << " history items, " << stream.size() / 1024 << " KB, " << runs << " runs\n";
+
+    try
+    {
+        //same input => same output?
+        const std::string lineBreak = "\n";
+        const std::string indent    = "\t";
+        if (serializeXml(legacy::XmlParser(stream).parse(), lineBreak, indent) !=
+            serializeXml(parseXml(stream),                 lineBreak, indent))
+        {
+            std::cerr << "Error: legacy and SAX-based parser produce different documents!\n";
+            return EXIT_FAILURE;
+        }
+
+        size_t sink = 0;
+
+        runBenchmark("legacy DOM", stream.size(), runs, [&]
+        {
+            XmlDoc doc = legacy::XmlParser(stream).parse(); //throw XmlParsingError
+            sink += doc.root().getNameAs<std::string>().size();
+        });
+
+        runBenchmark("DOM       ", stream.size(), runs, [&]
+        {
+            XmlDoc doc = parseXml(stream); //throw XmlParsingError
+            sink += doc.root().getNameAs<std::string>().size();
+        });
+
+        runBenchmark("SAX       ", stream.size(), runs, [&]
+        {
+            CountingHandler handler;
+            parseXml(std::string_view(stream), handler); //throw XmlParsingError
+            sink += handler.count + handler.bytes;
+        });
+
+        return sink != 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    catch (const XmlParsingError& e)
+    {
+        std::cerr << "Error: XML parsing failed, row " << e.row + 1 << ", column " << e.col + 1 << "\n";
+        return EXIT_FAILURE;
+    }
+}